@@ -4,11 +4,20 @@ import math
 import kurve_funcs
 from postprocessor import *
 
+try:
+    # HeeksCNC's own python can check the moves between curves in C++, which is much quicker
+    from heekscnc import feed_possible_area, feed_possible as native_feed_possible
+except ImportError:
+    feed_possible_area = None
+
 # some globals, to save passing variables as parameters too much
 area_for_feed_possible = None
+native_area_for_feed_possible = None
 tool_radius_for_pocket = None
+name_of_pocket = None
 
-def cut_curve(curve, raise_cutter, first, prev_p, rapid_safety_space, current_start_depth, final_depth, clearance_height):
+def cut_curve(curve, raise_cutter, first, prev_p, rapid_safety_space, current_start_depth, final_depth, clearance_height, dx = 0.0, dy = 0.0):
+    # dx and dy move the cut, for a pattern's copies, but not prev_p, which stays where the curve is
 
     slot_ratio = 1.0 if first else 0.0
 
@@ -16,12 +25,12 @@ def cut_curve(curve, raise_cutter, first, prev_p, rapid_safety_space, current_st
         if first or raise_cutter:
             if raise_cutter:
                 rapid(z = clearance_height)
-                rapid(vertex.p.x, vertex.p.y)
+                rapid(vertex.p.x + dx, vertex.p.y + dy)
                 rapid(z = current_start_depth + rapid_safety_space)
     
             else:
                 rapid(z = current_start_depth + rapid_safety_space)
-                rapid(vertex.p.x, vertex.p.y)
+                rapid(vertex.p.x + dx, vertex.p.y + dy)
 
              #feed down
             feed(z = final_depth)
@@ -29,11 +38,11 @@ def cut_curve(curve, raise_cutter, first, prev_p, rapid_safety_space, current_st
             raise_cutter = False
 
         if vertex.type == 1:
-            arc_ccw(slot_ratio, vertex.p.x, vertex.p.y, i = vertex.c.x, j = vertex.c.y)
+            arc_ccw(slot_ratio, vertex.p.x + dx, vertex.p.y + dy, i = vertex.c.x + dx, j = vertex.c.y + dy)
         elif vertex.type == -1:
-            arc_cw(slot_ratio, vertex.p.x, vertex.p.y, i = vertex.c.x, j = vertex.c.y)
+            arc_cw(slot_ratio, vertex.p.x + dx, vertex.p.y + dy, i = vertex.c.x + dx, j = vertex.c.y + dy)
         else:
-            feed(slot_ratio, vertex.p.x, vertex.p.y)
+            feed(slot_ratio, vertex.p.x + dx, vertex.p.y + dy)
             
         prev_p = vertex.p
     return prev_p
@@ -61,6 +70,8 @@ def make_obround(p0, p1, radius):
 def feed_possible(p0, p1):
     if p0 == p1:
         return True
+    if native_area_for_feed_possible != None:
+        return native_feed_possible(native_area_for_feed_possible, p0.x, p0.y, p1.x, p1.y)
     obround = make_obround(p0, p1, tool_radius_for_pocket)
     a = area.Area(area_for_feed_possible)
     obround.Subtract(a)
@@ -68,16 +79,18 @@ def feed_possible(p0, p1):
         return False
     return True
 
-def cut_curvelist(prev_p, curve_list, rapid_safety_space, current_start_depth, depth, clearance_height):
+def cut_curvelist(prev_p, curve_list, rapid_safety_space, current_start_depth, depth, clearance_height, dx = 0.0, dy = 0.0, joined_only = False):
+    # joined_only keeps the cutter down only from a curve to one which starts where it ended
+    # adaptive's curves start like that where there's a way through what's been cut; a straight feed could go through the material left
     first = True
     for curve in curve_list:
         raise_cutter = True
         if prev_p != None:
             s = curve.FirstVertex().p
-            if (s.x == prev_p.x and s.y == prev_p.y) or feed_possible(prev_p, s):
+            if (s.x == prev_p.x and s.y == prev_p.y) or (not joined_only and feed_possible(prev_p, s)):
                 raise_cutter = False
 
-        prev_p = cut_curve(curve, raise_cutter, first, prev_p, rapid_safety_space, current_start_depth, depth, clearance_height)
+        prev_p = cut_curve(curve, raise_cutter, first, prev_p, rapid_safety_space, current_start_depth, depth, clearance_height, dx, dy)
         first = False
     return prev_p
 
@@ -108,41 +121,190 @@ def cut_curvelist_with_start(prev_p, curve_list, rapid_safety_space, current_sta
 
     return prev_p
 
-def pocket(a, tool_radius, extra_offset, stepover, depthparams, from_center, post_processor, zig_angle, start_point = None, cut_mode = 'conventional'):
+def get_curve_list(a_offset, material, tool_radius, stepover, from_center, post_processor, zig_angle, cut_mode):
+    # a_offset is where the centre of the tool can go, material is what's to be cut
+    if a_offset.num_curves() == 0:
+        return []
+
+    if post_processor == 'zigzag':
+        return zigzag(a_offset, stepover, False, zig_angle)
+    elif post_processor == 'zigzag-unidirectional':
+        return zigzag(a_offset, stepover, True, zig_angle)
+    elif post_processor == 'offsets':
+        return offsets(a_offset, stepover, from_center, cut_mode)
+    elif post_processor == 'trochoidal':
+        return trochoidal(a_offset, stepover, cut_mode)
+    elif post_processor == 'adaptive':
+        return adaptive(a_offset, material, tool_radius, stepover, cut_mode, name_of_pocket)
+
+def pocket_cleared(a, tool_radius, extra_offset):
+    # what a pocket of a cut; where the centre of its tool went, then all the tool cut
+    cleared = area.Area(a)
+    cleared.Offset(tool_radius + extra_offset)
+    cleared.Offset(-tool_radius)
+    return cleared
+
+def swept_area(curve, radius):
+    # what a tool of radius cuts going along curve, which needn't be closed
+    # arcs are followed by chords, no further from them than the tolerance, with the tool made smaller by that much
+    tolerance = 0.01 / area.get_units()
+    swept = area.Area()
+    if radius <= tolerance:
+        return swept
+    prev_p = None
+    for vertex in curve.getVertices():
+        points = [vertex.p]
+        if prev_p != None and vertex.type != 0:
+            arc_radius = math.sqrt((prev_p.x - vertex.c.x) * (prev_p.x - vertex.c.x) + (prev_p.y - vertex.c.y) * (prev_p.y - vertex.c.y))
+            a0 = math.atan2(prev_p.y - vertex.c.y, prev_p.x - vertex.c.x)
+            a1 = math.atan2(vertex.p.y - vertex.c.y, vertex.p.x - vertex.c.x)
+            sweep = (a1 - a0) * vertex.type
+            while sweep <= 0.0:
+                sweep = sweep + 2 * math.pi
+            step = math.pi / 2
+            if arc_radius > tolerance:
+                step = min(step, 2 * math.acos(1.0 - tolerance / arc_radius))
+            n = int(math.ceil(sweep / step))
+            points = []
+            for i in range(1, n + 1):
+                angle = a0 + sweep * vertex.type * i / n
+                points.append(area.Point(vertex.c.x + arc_radius * math.cos(angle), vertex.c.y + arc_radius * math.sin(angle)))
+            points[-1] = vertex.p
+        for p in points:
+            if prev_p != None and (p.x != prev_p.x or p.y != prev_p.y):
+                swept.Union(make_obround(prev_p, p, radius - tolerance))
+            prev_p = p
+    return swept
+
+def profile_cleared(a, side, tool_radius, extra_offset):
+    # what a profile of the curves of a cut
+    # side is 1 for left of the curve, or outside for a closed one, -1 for right, or inside, and 0 for on
+    cleared = area.Area()
+    for curve in a.getCurves():
+        if curve.IsClosed():
+            # where the centre of the tool went, as an area
+            centre = area.Area()
+            centre.append(curve)
+            centre.Reorder()
+            if side != 0:
+                centre.Offset(-side * (tool_radius + extra_offset))
+            inside = area.Area(centre)
+            inside.Offset(tool_radius)
+            swept = area.Area(centre)
+            swept.Offset(-tool_radius)
+            swept.Subtract(inside)
+        else:
+            centre = area.Curve(curve)
+            if side != 0 and centre.Offset(side * (tool_radius + extra_offset)) == False:
+                # the profile couldn't be made either
+                continue
+            swept = swept_area(centre, tool_radius)
+        cleared.Union(swept)
+    return cleared
+
+def holes_cleared(points, tool_radius):
+    # what drilling holes at points, each (x, y), cut
+    cleared = area.Area()
+    for x, y in points:
+        c = area.Curve()
+        c.append(area.Vertex(0, area.Point(x + tool_radius, y), area.Point(0, 0)))
+        c.append(area.Vertex(1, area.Point(x - tool_radius, y), area.Point(x, y)))
+        c.append(area.Vertex(1, area.Point(x + tool_radius, y), area.Point(x, y)))
+        cleared.append(c)
+    return cleared
+
+def get_rest_key(rest_areas, start_depth, final_depth):
+    # the indexes of the rest_areas which cut all the way from start_depth to final_depth, or None if none do
+    tolerance = 0.001 / area.get_units()
+    key = tuple([i for i in range(len(rest_areas)) if rest_areas[i][1] >= start_depth - tolerance and rest_areas[i][2] <= final_depth + tolerance])
+    if len(key) == 0:
+        return None
+    return key
+
+def get_rest_material(material, rest_areas):
+    # takes away what the rest_areas' tools cleared from the material
+    remaining = area.Area(material)
+    for cleared, rest_start_depth, rest_final_depth in rest_areas:
+        remaining.Subtract(cleared)
+
+    # get rid of thin slivers left along the edges of what was cleared
+    sliver = 0.01 / area.get_units()
+    remaining.Offset(sliver)
+    remaining.Offset(-sliver)
+    remaining.Reorder()
+    return remaining
+
+def pocket(a, tool_radius, extra_offset, stepover, depthparams, from_center, post_processor, zig_angle, start_point = None, cut_mode = 'conventional', rest_areas = None, shifts = None, name = None):
+    # rest_areas is a list of what the operations done before this one cut, as (area, start depth, final depth)
+    # the areas are made by pocket_cleared, profile_cleared and holes_cleared
+    # if it's given, only what they have left is cut
+    # shifts is a list of (x, y), one for each copy of a pattern; the curves are made once and cut at each copy, one copy after another
+    # name is the pocket's, for the errors
+
     global tool_radius_for_pocket
     global area_for_feed_possible
+    global native_area_for_feed_possible
+    global name_of_pocket
 
     tool_radius_for_pocket = tool_radius
+    name_of_pocket = name
 
     area_for_feed_possible = area.Area(a)
     area_for_feed_possible.Offset(extra_offset - 0.05)
 
+    # made once, for all the moves at all the depths
+    native_area_for_feed_possible = None
+    if feed_possible_area != None:
+        curves = []
+        for curve in area_for_feed_possible.getCurves():
+            curves.append([(v.type, v.p.x, v.p.y, v.c.x, v.c.y) for v in curve.getVertices()])
+        native_area_for_feed_possible = feed_possible_area(curves, tool_radius)
+
     a_offset = area.Area(a)
     current_offset = tool_radius + extra_offset
     a_offset.Offset(current_offset)
     a_offset.Reorder()
 
-    if post_processor == 'zigzag':
-        curve_list = zigzag(a_offset, stepover, False, zig_angle)
-    elif post_processor == 'zigzag-unidirectional':
-        curve_list = zigzag(a_offset, stepover, True, zig_angle)
-    elif post_processor == 'offsets':
-        curve_list = offsets(a_offset, stepover, from_center, cut_mode)
-    elif post_processor == 'trochoidal':
-        curve_list = trochoidal(a_offset, stepover, cut_mode)
+    material = area.Area(a)
+    material.Offset(extra_offset)
 
     depths = depthparams.get_depths()
 
+    # the curves for each set of rest_areas which cut the same depths, so they are only made once
+    curve_lists = dict()
+
+    if shifts == None:
+        shifts = [(0.0, 0.0)]
+
+    for dx, dy in shifts:
+        pocket_copy(a_offset, material, tool_radius, stepover, depthparams, depths, from_center, post_processor, zig_angle, start_point, cut_mode, rest_areas, curve_lists, dx, dy)
+
+def pocket_copy(a_offset, material, tool_radius, stepover, depthparams, depths, from_center, post_processor, zig_angle, start_point, cut_mode, rest_areas, curve_lists, dx, dy):
     current_start_depth = depthparams.start_depth
+    prev_p = None
 
-    if start_point == None:
-        prev_p = None
-        for depth in depths:
-            prev_p = cut_curvelist(prev_p, curve_list, depthparams.rapid_safety_space, current_start_depth, depth, depthparams.clearance_height)
-            current_start_depth = depth
+    for depth in depths:
+        key = None
+        if rest_areas != None:
+            key = get_rest_key(rest_areas, current_start_depth, depth)
 
-    else:
-        for depth in depths:
+        curve_list = curve_lists.get(key)
+        if curve_list == None:
+            if key == None:
+                curve_list = get_curve_list(a_offset, material, tool_radius, stepover, from_center, post_processor, zig_angle, cut_mode)
+            else:
+                remaining = get_rest_material(material, [rest_areas[i] for i in key])
+                # where the centre of the tool has to go to cut what's left
+                a_rest = area.Area(remaining)
+                a_rest.Offset(-tool_radius)
+                a_rest.Intersect(a_offset)
+                curve_list = get_curve_list(a_rest, remaining, tool_radius, stepover, from_center, post_processor, zig_angle, cut_mode)
+            curve_lists[key] = curve_list
+
+        if start_point == None:
+            prev_p = cut_curvelist(prev_p, curve_list, depthparams.rapid_safety_space, current_start_depth, depth, depthparams.clearance_height, dx, dy, post_processor == 'adaptive')
+        else:
             cut_curvelist_with_start(curve_list, depthparams.rapid_safety_space, current_start_depth, depth, depthparams.clearance_height, start_point)
             rapid(z = depthparams.clearance_height)
-            current_start_depth = depth
+
+        current_start_depth = depth
@@ -1,12 +1,23 @@
 import sys
-from nc.hxml_writer import HxmlWriter
 
 if len(sys.argv)>2:
     reader = sys.argv[1]
     nc_file = sys.argv[2]
-    
+
+    # the writer can be given as a third argument; "hbin" for the binary backplot, which HeeksCNC reads
+    writer_name = 'hxml'
+    if len(sys.argv)>3:
+        writer_name = sys.argv[3]
+
+    if writer_name == 'hbin':
+        from nc.hbin_writer import HbinWriter
+        writer = HbinWriter()
+    else:
+        from nc.hxml_writer import HxmlWriter
+        writer = HxmlWriter()
+
     machine_module = __import__('nc.' + reader, fromlist = ['dummy'])
         
-    parser = machine_module.Parser(HxmlWriter())
+    parser = machine_module.Parser(writer)
 
     parser.Parse(nc_file)
@@ -8,9 +8,54 @@ import recreator
 import ocl
 import ocl_funcs
 import nc
+import math
+
+try:
+    # HeeksCNC's own python has a drop cutter in C++, which doesn't need OpenCAMLib's STLSurf or cutters
+    from heekscnc import drop_cutter_mesh as native_drop_cutter_mesh
+    from heekscnc import drop_cutter as native_drop_cutter
+except ImportError:
+    native_drop_cutter = None
 
 attached = False
 
+# the native meshes, by STL file, so each file is only read once
+native_meshes = {}
+
+sampling = 0.1 # the distance between the points dropped onto the surface, like PathDropCutter.setSampling
+filter_tolerance = 0.005 # like LineCLFilter.setTolerance
+
+def native_mesh(stl_file):
+    if stl_file not in native_meshes:
+        native_meshes[stl_file] = native_drop_cutter_mesh(stl_file)
+    return native_meshes[stl_file]
+
+def arc_points(p0, p1, c, ccw):
+    # points along an arc from p0 to p1 about c, not including p0, sampling apart
+    a0 = math.atan2(p0[1] - c[1], p0[0] - c[0])
+    a1 = math.atan2(p1[1] - c[1], p1[0] - c[0])
+    if ccw:
+        if a1 <= a0: a1 = a1 + 2 * math.pi
+    else:
+        if a1 >= a0: a1 = a1 - 2 * math.pi
+    radius = math.hypot(p0[0] - c[0], p0[1] - c[1])
+    steps = int(abs(a1 - a0) * radius / sampling) + 1
+    points = []
+    for i in range(1, steps + 1):
+        f = float(i) / steps
+        a = a0 + (a1 - a0) * f
+        points.append((c[0] + radius * math.cos(a), c[1] + radius * math.sin(a)))
+    return points
+
+def line_points(p0, p1):
+    # points along a line from p0 to p1, not including p0, sampling apart
+    steps = int(math.hypot(p1[0] - p0[0], p1[1] - p0[1]) / sampling) + 1
+    points = []
+    for i in range(1, steps + 1):
+        f = float(i) / steps
+        points.append((p0[0] + (p1[0] - p0[0]) * f, p0[1] + (p1[1] - p0[1]) * f))
+    return points
+
 ################################################################################
 class Creator(recreator.Redirector):
 
@@ -18,7 +63,11 @@ class Creator(recreator.Redirector):
         recreator.Redirector.__init__(self, original)
 
         self.stl = None
+        self.stl_file = None
         self.cutter = None
+        self.native_cutter = None # (radius, corner radius), for the native drop cutter
+        self.native_path = None
+        self.tolerance = 0.001
         self.minz = None
         self.path = None
         self.pdcf = None
@@ -35,7 +84,21 @@ class Creator(recreator.Redirector):
             self.pdcf.setSampling(0.1)
             self.pdcf.setZ(self.minz)
                     
+    def use_native(self):
+        return native_drop_cutter != None and self.stl_file != None and self.native_cutter != None
+
+    def native_drop(self, points, filter_tolerance = None):
+        # the points, with z added, dropped onto the surface; with filter_tolerance, only the ones not within it of the line past them, like LineCLFilter
+        minz = self.minz
+        if self.z > self.minz: minz = self.z
+        if filter_tolerance != None:
+            return native_drop_cutter(native_mesh(self.stl_file), self.native_cutter[0], self.native_cutter[1], self.tolerance, minz, points, filter_tolerance)
+        zs = native_drop_cutter(native_mesh(self.stl_file), self.native_cutter[0], self.native_cutter[1], self.tolerance, minz, points)
+        return [(points[i][0], points[i][1], zs[i]) for i in range(0, len(points))]
+
     def z2(self, z):
+        if self.use_native():
+            return self.native_drop([(self.x, self.y)])[0][2] + self.material_allowance
         path = ocl.Path()
         # use a line with no length
         path.append(ocl.Line(ocl.Point(self.x, self.y, self.z), ocl.Point(self.x, self.y, self.z)))
@@ -51,6 +114,9 @@ class Creator(recreator.Redirector):
         return p.z + self.material_allowance
         
     def cut_path(self):
+        if self.use_native():
+            self.cut_native_path()
+            return
         if self.path == None: return
         self.setPdcfIfNotSet()
         
@@ -81,6 +147,13 @@ class Creator(recreator.Redirector):
             
         self.path = ocl.Path()
 
+    def cut_native_path(self):
+        if self.native_path == None or len(self.native_path) == 0: return
+        plist = self.native_drop(self.native_path, filter_tolerance)
+        for p in plist[1:]:
+            self.original.feed(p[0]/units, p[1]/units, p[2]/units + self.material_allowance)
+        self.native_path = None
+
     def feed(self, x=None, y=None, z=None, a=None, b=None, c=None):
         px = self.x
         py = self.y
@@ -92,6 +165,10 @@ class Creator(recreator.Redirector):
             return
             
         # add a line to the path
+        if self.use_native():
+            if self.native_path == None: self.native_path = [(px, py)]
+            self.native_path += line_points((px, py), (self.x, self.y))
+            return
         if self.path == None: self.path = ocl.Path()
         self.path.append(ocl.Line(ocl.Point(px, py, pz), ocl.Point(self.x, self.y, self.z)))
         
@@ -102,12 +179,21 @@ class Creator(recreator.Redirector):
         recreator.Redirector.arc(self, x, y, z, i, j, k, r, ccw)
         
         # add an arc to the path
+        if self.use_native():
+            if self.native_path == None: self.native_path = [(px, py)]
+            self.native_path += arc_points((px, py), (self.x, self.y), (i, j), ccw)
+            return
         if self.path == None: self.path = ocl.Path()
         self.path.append(ocl.Arc(ocl.Point(px, py, pz), ocl.Point(self.x, self.y, self.z), ocl.Point(i, j, pz), ccw))
         
     def set_ocl_cutter(self, cutter):
         self.cutter = cutter
 
+    def set_native_cutter(self, radius, corner_radius):
+        # None, for cutters which the native drop cutter can't do
+        if radius == None: self.native_cutter = None
+        else: self.native_cutter = (radius, corner_radius)
+
 ################################################################################
 
 def attach_begin():
@@ -118,6 +204,7 @@ def attach_begin():
     attached = True
     nc.creator.pdcf = None
     nc.creator.path = None
+    nc.creator.native_path = None
 
 def attach_end():
     global attached
@@ -0,0 +1,69 @@
+################################################################################
+# backplot_writer.py
+#
+# What HxmlWriter and HbinWriter have in common; the readers in nc_read.py and
+# the other *_read.py files call these methods.
+# A move is written as begin_path(colour), then add_line or add_arc, then end_path.
+
+class BackplotWriter:
+    def __init__(self):
+        self.t = None
+        self.oldx = None
+        self.oldy = None
+        self.oldz = None
+
+    def write(self, s):
+        pass
+
+############################################
+
+    def metric(self):
+        self.set_mode(units = 1.0)
+
+    def imperial(self):
+        self.set_mode(units = 25.4)
+
+    def rapid(self, x=None, y=None, z=None, a=None, b=None, c=None):
+        self.begin_path("rapid")
+        self.add_line(x, y, z, a, b, c)
+        self.end_path()
+
+    def feed(self, x=None, y=None, z=None, a=None, b=None, c=None):
+        self.begin_path("feed")
+        self.add_line(x, y, z, a, b, c)
+        self.end_path()
+
+    def arc_cw(self, x=None, y=None, z=None, i=None, j=None, k=None, r=None):
+        self.begin_path("feed")
+        self.add_arc(x, y, z, i, j, k, r, -1)
+        self.end_path()
+
+    def arc_ccw(self, x=None, y=None, z=None, i=None, j=None, k=None, r=None):
+        self.begin_path("feed")
+        self.add_arc(x, y, z, i, j, k, r, 1)
+        self.end_path()
+
+    def current_tool(self):
+        return self.t
+
+    def spindle(self, s, clockwise):
+        pass
+
+    def feedrate(self, f):
+        pass
+
+    def arc_centre(self, i, j, k):
+        # returns the arc's centre relative to its start point
+        # any of i, j and k given before the start point's x, y or z is known is left out, as None
+        ci = None
+        cj = None
+        ck = None
+        if i != None and self.oldx != None: ci = i - self.oldx
+        if j != None and self.oldy != None: cj = j - self.oldy
+        if k != None and self.oldz != None: ck = k - self.oldz
+        return (ci, cj, ck)
+
+    def moved_to(self, x, y, z):
+        if x != None: self.oldx = x
+        if y != None: self.oldy = y
+        if z != None: self.oldz = z
@@ -0,0 +1,151 @@
+################################################################################
+# hbin_writer.py
+#
+# Writes the backplot as a compact binary stream, instead of the xml that
+# hxml_writer.py writes. It has the same methods as HxmlWriter; what they have
+# in common is in backplot_writer.py.
+#
+# The file starts with 'HNCB' and a version byte, followed by records.
+# Each record is a type byte, a varint payload length, then the payload.
+# Coordinates are written as zigzag varints of millionths of a unit; x, y and z
+# are written as the difference from the previous x, y or z.
+# CNCCodeLoader in src/NCCodeLoader.cpp reads it.
+# HeeksCNC reads the file while it is being written, so it is flushed every
+# so often, to show the first blocks straight away.
+
+import tempfile
+import struct
+import time
+from backplot_writer import BackplotWriter
+
+HBIN_VERSION = 1
+
+REC_BLOCK_BEGIN = 1
+REC_BLOCK_END = 2
+REC_COLOR = 3
+REC_TEXT = 4
+REC_UNITS = 5
+REC_TOOL = 6
+REC_LINE = 7
+REC_ARC = 8
+
+NO_COLOR = 255
+
+byte = [chr(n) for n in range(0, 256)]
+
+def varint(n):
+    if n < 128: return byte[n]
+    s = ''
+    while n > 127:
+        s += chr((n & 127) | 128)
+        n = n >> 7
+    return s + chr(n)
+
+def zigzag(n):
+    if n >= 0: return varint(n << 1)
+    return varint(((-n) << 1) - 1)
+
+def fixed(v):
+    return int(round(v * 1000000.0))
+
+class HbinWriter(BackplotWriter):
+    def __init__(self, file_out = None):
+        BackplotWriter.__init__(self)
+        if file_out == None:
+            file_out = open(tempfile.gettempdir()+'/backplot.hbin', 'wb')
+        self.file_out = file_out
+        self.file_out.write('HNCB' + chr(HBIN_VERSION))
+        self.records = [] # the records of the block being read, which are written all together at the end of it
+        self.path_col = None
+        self.colors = {}
+        self.last = [0, 0, 0]
+        self.blocks = 0
+        self.flush_time = time.time()
+
+    def __del__(self):
+        self.file_out.write(''.join(self.records))
+        self.file_out.close()
+
+    def record(self, type, payload = ''):
+        self.records.append(byte[type] + varint(len(payload)) + payload)
+
+    def color_id(self, col):
+        id = self.colors.get(col)
+        if id == None:
+            if col == None: return byte[NO_COLOR]
+            id = byte[len(self.colors)]
+            self.colors[col] = id
+            self.record(REC_COLOR, id + col)
+        return id
+
+############################################
+
+    def begin_ncblock(self):
+        self.record(REC_BLOCK_BEGIN)
+
+    def end_ncblock(self):
+        self.record(REC_BLOCK_END)
+        self.file_out.write(''.join(self.records))
+        self.records = []
+        self.blocks = self.blocks + 1
+        if self.blocks == 1 or (self.blocks & 255) == 0:
+            t = time.time()
+            if self.blocks == 1 or t - self.flush_time > 0.25:
+                self.file_out.flush()
+                self.flush_time = t
+
+    def add_text(self, s, col, cdata):
+        # this is called for every word, so the record is made here
+        self.records.append(byte[REC_TEXT] + varint(len(s) + 1) + self.color_id(col) + s)
+
+    def set_mode(self, units):
+        if (units != None) : self.record(REC_UNITS, struct.pack('<d', units))
+
+    def begin_path(self, col):
+        # there is no path record; each move has the colour of the path it is in
+        self.path_col = col
+
+    def end_path(self):
+        self.path_col = None
+
+    def tool_change(self, id):
+        if (id != None) : self.record(REC_TOOL, zigzag(int(id)))
+        self.t = id
+
+    def xyz(self, x, y, z):
+        # returns the flags and the varints for the coordinates which are given
+        flags = 0
+        s = ''
+        n = 0
+        for v in (x, y, z):
+            if v != None:
+                flags = flags | (1 << n)
+                f = fixed(v)
+                s += zigzag(f - self.last[n])
+                self.last[n] = f
+            n = n + 1
+        return (flags, s)
+
+    def add_line(self, x, y, z, a = None, b = None, c = None):
+        color = self.color_id(self.path_col)
+        (flags, s) = self.xyz(x, y, z)
+        self.moved_to(x, y, z)
+        self.record(REC_LINE, color + byte[flags] + s)
+
+    def add_arc(self, x, y, z, i, j, k, r = None, d = None):
+        color = self.color_id(self.path_col)
+        ijk = ''
+        flags = 0
+        n = 0
+        for v in self.arc_centre(i, j, k):
+            if v != None:
+                flags = flags | (8 << n)
+                ijk += zigzag(fixed(v))
+            n = n + 1
+        if (r != None):
+            flags = flags | 64
+            ijk += zigzag(fixed(r))
+        if d == None: d = 1
+        (xyz_flags, s) = self.xyz(x, y, z)
+        self.moved_to(x, y, z)
+        self.record(REC_ARC, color + byte[d & 255] + byte[flags | xyz_flags] + s + ijk)
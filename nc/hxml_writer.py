@@ -1,14 +1,12 @@
 import tempfile
+from backplot_writer import BackplotWriter
 
-class HxmlWriter:
+class HxmlWriter(BackplotWriter):
     def __init__(self):
+        BackplotWriter.__init__(self)
         self.file_out = open(tempfile.gettempdir()+'/backplot.xml', 'w')
         self.file_out.write('<?xml version="1.0" ?>\n')
         self.file_out.write('<nccode>\n')
-        self.t = None
-        self.oldx = None
-        self.oldy = None
-        self.oldz = None
 
     def __del__(self):
         self.file_out.write('</nccode>\n')
@@ -39,12 +37,6 @@ class HxmlWriter:
         self.file_out.write('\t\t<mode')
         if (units != None) : self.file_out.write(' units="'+str(units)+'"')
         self.file_out.write(' />\n')
-        
-    def metric(self):
-        self.set_mode(units = 1.0)
-        
-    def imperial(self):
-        self.set_mode(units = 25.4)
 
     def begin_path(self, col):
         if (col != None) : self.file_out.write('\t\t<path col="'+col+'">\n')
@@ -52,42 +44,13 @@ class HxmlWriter:
 
     def end_path(self):
         self.file_out.write('\t\t</path>\n')
-        
-    def rapid(self, x=None, y=None, z=None, a=None, b=None, c=None):
-        self.begin_path("rapid")
-        self.add_line(x, y, z, a, b, c)
-        self.end_path()
-        
-    def feed(self, x=None, y=None, z=None, a=None, b=None, c=None):
-        self.begin_path("feed")
-        self.add_line(x, y, z, a, b, c)
-        self.end_path()
 
-    def arc_cw(self, x=None, y=None, z=None, i=None, j=None, k=None, r=None):
-        self.begin_path("feed")
-        self.add_arc(x, y, z, i, j, k, r, -1)
-        self.end_path()
-
-    def arc_ccw(self, x=None, y=None, z=None, i=None, j=None, k=None, r=None):
-        self.begin_path("feed")
-        self.add_arc(x, y, z, i, j, k, r, 1)
-        self.end_path()
-        
     def tool_change(self, id):
         self.file_out.write('\t\t<tool')
         if (id != None) : 
             self.file_out.write(' number="'+str(id)+'"')
             self.file_out.write(' />\n')
         self.t = id
-            
-    def current_tool(self):
-        return self.t
-            
-    def spindle(self, s, clockwise):
-        pass
-    
-    def feedrate(self, f):
-        pass
 
     def add_line(self, x, y, z, a = None, b = None, c = None):
         self.file_out.write('\t\t\t<line')
@@ -101,10 +64,8 @@ class HxmlWriter:
         if (b != None) : self.file_out.write(' b="%.6f"' % b)
         if (c != None) : self.file_out.write(' c="%.6f"' % c)
         self.file_out.write(' />\n')
-        if x != None: self.oldx = x
-        if y != None: self.oldy = y
-        if z != None: self.oldz = z
-        
+        self.moved_to(x, y, z)
+
     def add_arc(self, x, y, z, i, j, k, r = None, d = None):
         self.file_out.write('\t\t\t<arc')
         if (x != None) :
@@ -113,18 +74,11 @@ class HxmlWriter:
             self.file_out.write(' y="%.6f"' % y)
         if (z != None) :
             self.file_out.write(' z="%.6f"' % z)
-        if (i != None):
-            if self.oldx == None: print 'arc move "i" without x set!'
-            else: self.file_out.write(' i="%.6f"' % (i - self.oldx))
-        if (j != None):
-            if self.oldy == None: print 'arc move "j" without y set!'
-            else: self.file_out.write(' j="%.6f"' % (j - self.oldy))
-        if (k != None):
-            if self.oldz == None: print 'arc move "k" without z set!'
-            else: self.file_out.write(' k="%.6f"' % (k - self.oldz))
+        (i, j, k) = self.arc_centre(i, j, k)
+        if (i != None) : self.file_out.write(' i="%.6f"' % i)
+        if (j != None) : self.file_out.write(' j="%.6f"' % j)
+        if (k != None) : self.file_out.write(' k="%.6f"' % k)
         if (r != None) : self.file_out.write(' r="%.6f"' % r)
         if (d != None) : self.file_out.write(' d="%i"' % d)
         self.file_out.write(' />\n')
-        if x != None: self.oldx = x
-        if y != None: self.oldy = y
-        if z != None: self.oldz = z
+        self.moved_to(x, y, z)
@@ -235,7 +235,7 @@ class Creator(nc.Creator):
             if self.fixture_order[i] == self.fixture_wanted:
                 self.fixture_wanted = self.fixture_order[i+1]
                 return
-        raise 'too many fixtures wanted!'
+        raise Exception('too many fixtures wanted!')
     
     def get_fixture(self):
         return self.fixture_wanted
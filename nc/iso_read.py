@@ -64,6 +64,10 @@ class Parser(nc.Parser):
             self.path_col = "feed"
             self.col = "feed"
             self.arc = +1
+        elif (word == 'G4' or word == 'G04'):
+            # a dwell; its P is the time, not a move
+            self.col = "prep"
+            self.no_move = True
         elif (word == 'G10'):
             self.no_move = True
         elif (word == 'G53'):
@@ -79,10 +83,12 @@ class Parser(nc.Parser):
             self.col = "prep"
             self.writer.metric()
         elif (word == 'G43'):
+            # drawn as a rapid, even after an arc
             self.height_offset = True
             self.move = True
             self.path_col = "rapid"
             self.col = "rapid"
+            self.arc = 0
         elif (word == 'G80'):
             self.drill_off = True
         elif (word == 'G81'):
@@ -108,7 +114,7 @@ class Parser(nc.Parser):
             self.drilling_uses_clearance = True
         elif (word == 'G99'):
             self.drilling_uses_clearance = False
-        elif (word[0] == 'G') : col = "prep"
+        elif (word[0] == 'G') : self.col = "prep"
         elif (word[0] == 'I'):
             self.col = "axis"
             self.i = eval(word[1:])
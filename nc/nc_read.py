@@ -116,11 +116,17 @@ class Parser:
                 self.writer.rapid(self.x, self.y, rapid_z)
                 self.writer.feed(self.x, self.y, self.drillz)
                 self.writer.feed(self.x, self.y, rapid_z)
+                # an arc after the cycle starts from the last hole
+                if self.x != None: self.oldx = self.x
+                if self.y != None: self.oldy = self.y
 
             else:
                 if (self.move and not self.no_move):
                     if (self.arc==0):
-                        if self.path_col == "feed":
+                        if self.x == None and self.y == None and self.z == None and self.a == None and self.b == None and self.c == None:
+                            # lines like "G43 H1" don't go anywhere
+                            pass
+                        elif self.path_col == "feed":
                             self.writer.feed(self.x, self.y, self.z)
                         else:
                             self.writer.rapid(self.x, self.y, self.z, self.a, self.b, self.c)
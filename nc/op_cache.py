@@ -0,0 +1,336 @@
+################################################################################
+# op_cache.py
+#
+# Keeps the NC code made by each operation, so operations which haven't changed
+# don't have to be made again.
+#
+# HeeksCNC puts each operation's python in a function, and gives run_ops a list of
+# them, with a key for each one, which is a hash of the operation's python.
+#
+# Operations which don't use a pattern or a surface only call nc.creator's commands,
+# like rapid and feed, whatever state nc.creator is in. Their commands are recorded,
+# saved by key, then played to nc.creator in the order of the program. If there are
+# several to record, they are recorded in separate processes, one for each core.
+#
+# For the other operations, the NC code is saved along with the state of nc.creator
+# before and after the operation. If the same operation is found with nc.creator in
+# the same state, the saved NC code is written instead and nc.creator is given its
+# saved state.
+
+import nc
+import os
+import sys
+import pickle
+import hashlib
+
+cache_dir = None
+enabled = False
+max_files = 2000
+
+current_key = None
+current_state_key = None
+current_tee = None
+current_file = None
+current_sub_files = None
+
+# the commands which can be recorded; none of them return anything
+recordable = set(['write', 'comment', 'program_stop', 'flush_nc', 'imperial', 'metric', 'absolute', 'incremental',
+    'set_plane', 'tool_defn', 'tool_change', 'offset_radius', 'offset_length', 'workplane', 'feedrate', 'feedrate_hv',
+    'spindle', 'coolant', 'gearrange', 'rapid', 'feed', 'arc', 'arc_cw', 'arc_ccw', 'dwell', 'rapid_home',
+    'start_CRC', 'end_CRC', 'drill', 'tap', 'bore', 'end_canned_cycle', 'set_path_control_mode'])
+
+class NotRecordable(Exception):
+    pass
+
+class Recorder(object):
+    # stands in for nc.creator and keeps a list of the commands given to it
+    def __init__(self):
+        self.calls = []
+
+    def __getattr__(self, name):
+        if name not in recordable:
+            raise NotRecordable(name)
+        def record(*args, **kwargs):
+            self.calls.append((name, args, kwargs))
+        return record
+
+def record(fn):
+    save_creator = nc.creator
+    recorder = Recorder()
+    nc.creator = recorder
+    try:
+        fn()
+    finally:
+        nc.creator = save_creator
+    return recorder.calls
+
+def play(calls):
+    for name, args, kwargs in calls:
+        getattr(nc.creator, name)(*args, **kwargs)
+
+class Tee:
+    # writes to the output file, and keeps a copy of what is written
+    def __init__(self, file):
+        self.file = file
+        self.parts = []
+
+    def write(self, s):
+        self.file.write(s)
+        self.parts.append(s)
+
+    def flush(self):
+        self.file.flush()
+
+    def close(self):
+        self.file.close()
+
+def cache_begin(dir):
+    global cache_dir
+    global enabled
+    cache_dir = dir
+    try:
+        if not os.path.isdir(cache_dir):
+            os.makedirs(cache_dir)
+        enabled = True
+    except:
+        enabled = False
+
+def creator_state():
+    # everything in nc.creator, except the files it writes to
+    d = {}
+    for name, value in nc.creator.__dict__.items():
+        if name == 'file' or name == 'save_file':
+            continue
+        d[name] = value
+    return d
+
+def canonical(value, depth = 0):
+    # the same text for the same state, whatever order the dictionaries are in
+    if depth > 20:
+        raise ValueError('state too deep')
+    if isinstance(value, dict):
+        items = []
+        for k, v in value.items():
+            items.append(canonical(k, depth + 1) + ':' + canonical(v, depth + 1))
+        items.sort()
+        return '{' + ','.join(items) + '}'
+    if isinstance(value, (list, tuple)):
+        return '[' + ','.join([canonical(v, depth + 1) for v in value]) + ']'
+    if hasattr(value, '__dict__'):
+        return value.__class__.__name__ + canonical(value.__dict__, depth + 1)
+    return repr(value)
+
+def state_key(state):
+    s = nc.creator.__class__.__module__ + '.' + nc.creator.__class__.__name__ + canonical(state)
+    return hashlib.md5(s).hexdigest()
+
+def sub_files():
+    # the subroutines written so far; iso.py appends each one to the same temporary file, unless they have their own files
+    temp_file = getattr(nc.creator, 'temp_file_to_append_on_close', None)
+    temp_file_size = None
+    if temp_file != None:
+        try:
+            temp_file_size = os.path.getsize(temp_file)
+        except:
+            pass
+    return (temp_file, temp_file_size, len(getattr(nc.creator, 'subroutine_files', [])))
+
+def op_begin(key):
+    global enabled
+    global current_key
+    global current_state_key
+    global current_tee
+    global current_file
+    global current_sub_files
+
+    current_key = None
+    if not enabled:
+        return True
+
+    try:
+        current_state_key = state_key(creator_state())
+    except:
+        # something in this post's creator can't be saved
+        enabled = False
+        return True
+
+    path = os.path.join(cache_dir, key + '_' + current_state_key)
+    if os.path.exists(path + '.nc') and os.path.exists(path + '.state'):
+        try:
+            f = open(path + '.state', 'rb')
+            state = pickle.load(f)
+            f.close()
+            f = open(path + '.nc', 'r')
+            text = f.read()
+            f.close()
+            nc.creator.write(text)
+            nc.creator.__dict__.update(state)
+            os.utime(path + '.nc', None)
+            os.utime(path + '.state', None)
+            return False
+        except:
+            # make it again
+            pass
+
+    current_key = key
+    current_file = nc.creator.file
+    current_sub_files = sub_files()
+    current_tee = Tee(current_file)
+    nc.creator.file = current_tee
+    return True
+
+def op_end():
+    global current_key
+    if current_key == None:
+        return
+
+    key = current_key
+    current_key = None
+    tee = current_tee
+    if nc.creator.file != tee:
+        return
+    nc.creator.file = current_file
+
+    if sub_files() != current_sub_files:
+        # the operation wrote to other files too
+        return
+
+    path = os.path.join(cache_dir, key + '_' + current_state_key)
+    try:
+        state = creator_state()
+        f = open(path + '.state', 'wb')
+        pickle.dump(state, f, 2)
+        f.close()
+        f = open(path + '.nc', 'w')
+        f.write(''.join(tee.parts))
+        f.close()
+    except:
+        for ext in ['.nc', '.state']:
+            try:
+                os.remove(path + ext)
+            except:
+                pass
+
+def cache_end():
+    # only keep the most recently used files
+    if not enabled:
+        return
+    try:
+        names = os.listdir(cache_dir)
+        if len(names) <= max_files:
+            return
+        files = []
+        for name in names:
+            path = os.path.join(cache_dir, name)
+            files.append((os.path.getmtime(path), path))
+        files.sort()
+        for t, path in files[0:len(files) - max_files]:
+            os.remove(path)
+    except:
+        pass
+
+def calls_path(key):
+    return os.path.join(cache_dir, key + '.calls')
+
+def load_calls(key):
+    if not enabled:
+        return None
+    try:
+        f = open(calls_path(key), 'rb')
+        calls = pickle.load(f)
+        f.close()
+        os.utime(calls_path(key), None)
+        return calls
+    except:
+        return None
+
+def save_calls(key, s):
+    if not enabled:
+        return
+    try:
+        f = open(calls_path(key), 'wb')
+        f.write(s)
+        f.close()
+    except:
+        try:
+            os.remove(calls_path(key))
+        except:
+            pass
+
+parallel_ops = None
+
+def record_op(i):
+    # runs in a worker process
+    try:
+        return pickle.dumps(record(parallel_ops[i][1]), 2)
+    except:
+        return None
+
+def record_in_parallel(ops, calls, not_recordable):
+    global parallel_ops
+    todo = []
+    for i in range(0, len(ops)):
+        if ops[i][2] and calls[i] == None:
+            todo.append(i)
+    if len(todo) < 2:
+        return
+    # the worker processes are forked, so they have the operations' functions
+    if sys.platform == 'win32':
+        print 'the operations are made one at a time, as they can only be made in parallel where python can fork'
+        return
+    try:
+        import multiprocessing
+        processes = min(multiprocessing.cpu_count(), len(todo))
+        if processes < 2:
+            print 'the operations are made one at a time, as there is only one core'
+            return
+        nc.creator.file.flush()
+        parallel_ops = ops
+        pool = multiprocessing.Pool(processes)
+        try:
+            results = pool.map(record_op, todo, 1)
+        finally:
+            pool.close()
+            pool.join()
+            parallel_ops = None
+    except Exception, e:
+        print 'the operations are made one at a time, as they couldn\'t be made in parallel: ' + str(e)
+        return
+    for i, s in zip(todo, results):
+        if s == None:
+            not_recordable.add(i)
+        else:
+            calls[i] = pickle.loads(s)
+            save_calls(ops[i][0], s)
+
+def run_ops(ops, parallel = True):
+    # ops is a list of (key, function, independent of nc.creator's state)
+    calls = []
+    for key, fn, independent in ops:
+        if independent:
+            calls.append(load_calls(key))
+        else:
+            calls.append(None)
+
+    not_recordable = set()
+    if parallel:
+        record_in_parallel(ops, calls, not_recordable)
+
+    for i in range(0, len(ops)):
+        key, fn, independent = ops[i]
+        if independent and calls[i] == None and not i in not_recordable:
+            try:
+                calls[i] = record(fn)
+            except NotRecordable:
+                pass
+            else:
+                try:
+                    save_calls(key, pickle.dumps(calls[i], 2))
+                except:
+                    pass
+        if calls[i] != None:
+            play(calls[i])
+        else:
+            if op_begin(key):
+                fn()
+            op_end()
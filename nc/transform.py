@@ -10,33 +10,44 @@ import recreator
 
 transformed = False
 
-class FeedXY:
-    def __init__(self, x, y):
+class FeedXY(object):
+    __slots__ = ('slot_ratio', 'x', 'y')
+
+    def __init__(self, slot_ratio, x, y):
+        self.slot_ratio = slot_ratio
         self.x = x
         self.y = y
         
     def Do(self, original, matrix):
         x,y,z = matrix.TransformedPoint(self.x, self.y, 0)
-        original.feed(x, y)
+        original.feed(self.slot_ratio, x, y)
 
-class FeedZ:
-    def __init__(self, z):
+class FeedZ(object):
+    __slots__ = ('slot_ratio', 'z')
+
+    def __init__(self, slot_ratio, z):
+        self.slot_ratio = slot_ratio
         self.z = z
         
     def Do(self, original, matrix):
-        original.feed(z = self.z)
+        original.feed(self.slot_ratio, z = self.z)
         
-class FeedXYZ:
-    def __init__(self, x, y, z):
+class FeedXYZ(object):
+    __slots__ = ('slot_ratio', 'x', 'y', 'z')
+
+    def __init__(self, slot_ratio, x, y, z):
+        self.slot_ratio = slot_ratio
         self.x = x
         self.y = y
         self.z = z
         
     def Do(self, original, matrix):
         x,y,z = matrix.TransformedPoint(self.x, self.y, self.z)
-        original.feed(x,y,z)
+        original.feed(self.slot_ratio, x,y,z)
+
+class RapidXY(object):
+    __slots__ = ('x', 'y')
 
-class RapidXY:
     def __init__(self, x, y):
         self.x = x
         self.y = y
@@ -45,14 +56,18 @@ class RapidXY:
         x,y,z = matrix.TransformedPoint(self.x, self.y, 0)
         original.rapid(x, y)
 
-class RapidZ:
+class RapidZ(object):
+    __slots__ = ('z',)
+
     def __init__(self, z):
         self.z = z
         
     def Do(self, original, matrix):
         original.rapid(z = self.z)
         
-class RapidXYZ:
+class RapidXYZ(object):
+    __slots__ = ('x', 'y', 'z')
+
     def __init__(self, x, y, z):
         self.x = x
         self.y = y
@@ -62,7 +77,9 @@ class RapidXYZ:
         x,y,z = matrix.TransformedPoint(self.x, self.y, self.z)
         original.rapid(x,y,z)
         
-class Feedrate:
+class Feedrate(object):
+    __slots__ = ('h', 'v')
+
     def __init__(self, h, v):
         self.h = h
         self.v = v
@@ -70,8 +87,11 @@ class Feedrate:
     def Do(self, original, matrix):
         original.feedrate_hv(self.h, self.v)
         
-class Arc:
-    def __init__(self, x, y, z, i, j, ccw):
+class Arc(object):
+    __slots__ = ('slot_ratio', 'x', 'y', 'z', 'i', 'j', 'ccw')
+
+    def __init__(self, slot_ratio, x, y, z, i, j, ccw):
+        self.slot_ratio = slot_ratio
         self.x = x
         self.y = y
         self.z = z
@@ -80,16 +100,19 @@ class Arc:
         self.ccw = ccw
         
     def Do(self, original, matrix):
-        x,y,z = matrix.TransformedPoint(self.x, self.y, self.z)
-        cx,cy,cz = matrix.TransformedPoint(original.x + self.i, original.y + self.j, self.z)
-        i = cx - original.x
-        j = cy - original.y
+        # i and j are where the centre is, not how far it is from the start, as the creators take them
+        # z is None for an arc in the plane, which mustn't write a Z
+        x,y,z = matrix.TransformedPoint(self.x, self.y, 0.0 if self.z == None else self.z)
+        i,j,k = matrix.TransformedPoint(self.i, self.j, 0.0 if self.z == None else self.z)
+        if self.z == None: z = None
         if self.ccw:
-            original.arc_ccw(x, y, z, i, j)
+            original.arc_ccw(self.slot_ratio, x, y, z, i, j)
         else:
-            original.arc_cw(x, y, z, i, j)
+            original.arc_cw(self.slot_ratio, x, y, z, i, j)
             
-class Drill:
+class Drill(object):
+    __slots__ = ('x', 'y', 'dwell', 'depthparams', 'retract_mode', 'spindle_mode', 'internal_coolant_on', 'rapid_to_clearance')
+
     def __init__(self, x, y, dwell, depthparams, retract_mode, spindle_mode, internal_coolant_on, rapid_to_clearance):
         self.x = x
         self.y = y
@@ -104,28 +127,36 @@ class Drill:
         x,y,z = matrix.TransformedPoint(self.x, self.y, 0.0)
         original.drill(x, y, self.dwell, self.depthparams, self.retract_mode, self.spindle_mode, self.internal_coolant_on, self.rapid_to_clearance)
     
-class Absolute:
+class Absolute(object):
+    __slots__ = ()
+
     def __init__(self):
         pass
     
     def Do(self, original, matrix):
         original.absolute()
         
-class Incremental:
+class Incremental(object):
+    __slots__ = ()
+
     def __init__(self):
         pass
     
     def Do(self, original, matrix):
         original.incremental()
         
-class EndCannedCycle:
+class EndCannedCycle(object):
+    __slots__ = ()
+
     def __init__(self):
         pass
     
     def Do(self, original, matrix):
         original.end_canned_cycle()
         
-class Comment:
+class Comment(object):
+    __slots__ = ('text',)
+
     def __init__(self, text):
         self.text = text
     
@@ -136,30 +167,40 @@ class Comment:
 matrix_fixtures = {}
 
 class Creator(recreator.Redirector):
-    def __init__(self, original, matrix_list):
+    def __init__(self, original, matrix_list, use_subroutine = None):
         recreator.Redirector.__init__(self, original)
         self.matrix_list = matrix_list
         self.commands = []
+        self.use_subroutine = use_subroutine # None to do what the machine does
         
-        # allocate fixtures to pattern positions
+        # allocate fixtures to pattern positions; this raises if the machine hasn't enough of them
         if self.pattern_uses_subroutine() == True:
             save_fixture = self.get_fixture()
+            first = True
             for matrix in self.matrix_list:
                 global matrix_fixtures
                 if (matrix in matrix_fixtures) == False:
+                    if first == False:
+                        self.increment_fixture()
                     matrix_fixtures[matrix] = self.get_fixture()
-                    self.increment_fixture()
+                    first = False
             self.set_fixture(save_fixture)
 
+    def pattern_uses_subroutine(self):
+        if self.use_subroutine != None:
+            return self.use_subroutine
+        return self.original.pattern_uses_subroutine()
+
     def DoAllCommands(self):
         subroutine_written = False
-            
+
         for matrix in self.matrix_list:
             if len(self.commands) > 0:
                 if self.pattern_uses_subroutine() == True:
                     # set fixture
                     global matrix_fixtures
-                    self.set_fixture(matrix_fixtures[matrix])
+                    if matrix in matrix_fixtures:
+                        self.set_fixture(matrix_fixtures[matrix])
                     # rapid to the pattern point in x and y
                     x,y,z = matrix.TransformedPoint(0.0, 0.0, 0.0)
                     self.original.rapid(x, y)
@@ -167,15 +208,20 @@ class Creator(recreator.Redirector):
             subroutine_started = False
             output_disabled = False
             
-            for command in self.commands:
+            for command_index in range(0, len(self.commands)):
+                command = self.commands[command_index]
                 if (output_disabled == False) and (self.pattern_uses_subroutine() == True):
                     # in main program do commands up to the first z move
                     cname = command.__class__.__name__
                     if cname == 'FeedZ' or cname == 'Drill':
                         if subroutine_written:
                             self.sub_call(None)
-                            self.disable_output() # ignore all the other commands
-                            output_disabled = True
+                            # the other commands are in the subroutine; they are done without output, to leave the machine's
+                            # position and modal state, like the last feed rate written, as writing them all out would
+                            self.disable_output()
+                            for state_command in self.commands[command_index:]:
+                                state_command.Do(self.original, matrix)
+                            break
                         else:
                             if subroutine_started == False:
                                 self.sub_begin(None)
@@ -218,26 +264,33 @@ class Creator(recreator.Redirector):
         else:
             self.commands.append(RapidXYZ(self.x, self.y, self.z))
         
-    def feed(self, x=None, y=None, z=None, a = None, b = None, c = None):
+    def feed(self, slot_ratio=0.0, x=None, y=None, z=None, a = None, b = None, c = None):
         if x != None: self.x = x
         if y != None: self.y = y
         if z != None: self.z = z
         if self.x == None and self.y == None and self.z == None:
             return
         if z == None:
-            self.commands.append(FeedXY(self.x, self.y))
+            self.commands.append(FeedXY(slot_ratio, self.x, self.y))
         elif x == None and y == None:
-            self.commands.append(FeedZ(self.z))
+            self.commands.append(FeedZ(slot_ratio, self.z))
         else:
-            self.commands.append(FeedXYZ(self.x, self.y, self.z))
+            self.commands.append(FeedXYZ(slot_ratio, self.x, self.y, self.z))
         
-    def arc(self, x=None, y=None, z=None, i=None, j=None, k=None, r=None, ccw = True):
+    def arc(self, slot_ratio=0.0, x=None, y=None, z=None, i=None, j=None, k=None, r=None, ccw = True):
         if x != None: self.x = x
         if y != None: self.y = y
         if z != None: self.z = z
         if self.x == None and self.y == None and self.z == None:
             return
-        self.commands.append(Arc(self.x, self.y, self.z, i, j, ccw))
+        self.commands.append(Arc(slot_ratio, self.x, self.y, z, i, j, ccw))
+
+    # nc.arc_cw and nc.arc_ccw give the slot ratio first, as nc.feed does
+    def arc_cw(self, slot_ratio=0.0, x=None, y=None, z=None, i=None, j=None, k=None, r=None):
+        self.arc(slot_ratio, x, y, z, i, j, k, r, False)
+
+    def arc_ccw(self, slot_ratio=0.0, x=None, y=None, z=None, i=None, j=None, k=None, r=None):
+        self.arc(slot_ratio, x, y, z, i, j, k, r, True)
         
     def drill(self, x=None, y=None, dwell=None, depthparams = None, retract_mode=None, spindle_mode=None, internal_coolant_on=None, rapid_to_clearance=None):
         self.commands.append(Drill(x, y, dwell, depthparams, retract_mode, spindle_mode, internal_coolant_on, rapid_to_clearance))
@@ -256,11 +309,11 @@ class Creator(recreator.Redirector):
         
 ################################################################################
 
-def transform_begin(matrix_list):
+def transform_begin(matrix_list, use_subroutine = None):
     global transformed
     if transformed == True:
         transform_end()
-    nc.creator = Creator(nc.creator, matrix_list)
+    nc.creator = Creator(nc.creator, matrix_list, use_subroutine)
     transformed = True
 
 def transform_end():
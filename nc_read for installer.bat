@@ -1,3 +1,3 @@
-.\python.exe backplot.py %1 %2
+.\python.exe backplot.py %1 %2 %3
 
 #pause
\ No newline at end of file
@@ -1,3 +1,3 @@
-%HOMEDRIVE%\python26\python.exe backplot.py %1 %2
+%HOMEDRIVE%\python26\python.exe backplot.py %1 %2 %3
 
 pause
\ No newline at end of file
@@ -1,3 +1,4 @@
+from adaptive import adaptive
 from offsets import offsets
 from trochoidal import trochoidal
 from zigzag import zigzag
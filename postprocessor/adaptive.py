@@ -0,0 +1,48 @@
+import area
+
+try:
+    # HeeksCNC's own python has the adaptive clearing in C++
+    from heekscnc import adaptive as native_adaptive
+except ImportError:
+    native_adaptive = None
+
+
+def adaptive(a, material, tool_radius, stepover, cut_mode, name = None):
+    # a is where the centre of the tool can go, material is the area to clear, name is the pocket's, for the errors
+    # The paths are fed for a cut no wider than the stepover; offsets take full width cuts, so they aren't done instead.
+    if a.num_curves() == 0:
+        return []
+
+    if native_adaptive == None:
+        # the material is kept as a grid of cells, which is too slow in python
+        raise Exception('%s: adaptive pockets need HeeksCNC\'s own python; turn on "Post and backplot without starting python", or choose another post-processor' % pocket_title(name))
+
+    paths = native_adaptive(get_curves(material), get_curves(a), tool_radius, stepover, cut_mode == 'climb')
+    if paths == None:
+        raise Exception('%s: the pocket is too big for adaptive, for cells small enough to keep to the stepover; make the stepover bigger, split the pocket, or choose another post-processor' % pocket_title(name))
+
+    curve_list = []
+    for path in paths:
+        c = area.Curve()
+        for vertex_type, x, y, cx, cy in path:
+            c.append(area.Vertex(vertex_type, area.Point(x, y), area.Point(cx, cy)))
+        curve_list.append(c)
+
+    # finish round the boundary, to leave the same walls as the offsets do
+    for curve in a.getCurves():
+        if cut_mode == 'climb':
+            curve.Reverse()
+        curve_list.append(curve)
+
+    return curve_list
+
+def pocket_title(name):
+    if name == None:
+        return 'pocket'
+    return 'pocket "' + name + '"'
+
+def get_curves(a):
+    curves = []
+    for curve in a.getCurves():
+        curves.append([(v.type, v.p.x, v.p.y, v.c.x, v.c.y) for v in curve.getVertices()])
+    return curves
@@ -1,54 +1,162 @@
 import area
+import sys
+
+# the offset areas made for each area and stepover, so pocket operations on the same area don't offset it again
+ring_cache = dict()
+ring_cache_order = list()
+max_rings_cached = 16
+
+# when the area splits into separate areas with at least this many vertices between them, each one is offset in a process of its own
+min_vertices_in_parallel = 2000
 
 
 def offsets(a, stepover, from_center, cut_mode):
-    arealist = list()
-    recur(arealist, a, stepover, from_center)
+    arealist = get_offset_areas(a, stepover)
+    if from_center:
+        arealist = arealist[::-1]
     return get_curve_list(arealist, cut_mode == 'climb')
 
-def recur(arealist, a1, stepover, from_center):
-    # this makes arealist by recursively offsetting a1 inwards
+def area_settings():
+    # the settings of the area module which change what Offset makes; the accuracy and the round corner factor can only be read where it has getters for them
+    settings = [area.get_units(), area.holes_linked()]
+    for name in ['get_accuracy', 'get_round_corner_factor']:
+        if hasattr(area, name):
+            settings.append(getattr(area, name)())
+    return tuple(settings)
 
-    if a1.num_curves() == 0:
-        return
+def curves_of(a):
+    return [[(v.type, v.p.x, v.p.y, v.c.x, v.c.y) for v in curve.getVertices()] for curve in a.getCurves()]
 
-    if from_center:
-        arealist.insert(0, a1)
-    else:
-        arealist.append(a1)
+def area_from_curves(curves):
+    a = area.Area()
+    for vertices in curves:
+        curve = area.Curve()
+        for type, x, y, cx, cy in vertices:
+            curve.append(area.Vertex(type, area.Point(x, y), area.Point(cx, cy)))
+        a.append(curve)
+    return a
 
-    a_offset = area.Area(a1)
-    a_offset.Offset(stepover)
+def area_key(a, stepover):
+    return (tuple([tuple(vertices) for vertices in curves_of(a)]), stepover, area_settings())
 
-    # split curves into new areas
-    if area.holes_linked():
-        for curve in a_offset.getCurves():
-            a2 = area.Area()
-            a2.append(curve)
-            recur(arealist, a2, stepover, from_center)
+def get_offset_areas(a, stepover):
+    key = area_key(a, stepover)
+    arealist = ring_cache.get(key)
+    if arealist == None:
+        arealist = list()
+        recur(arealist, a, stepover)
+        if len(ring_cache_order) >= max_rings_cached:
+            del ring_cache[ring_cache_order.pop(0)]
+        ring_cache[key] = arealist
+        ring_cache_order.append(key)
+    return arealist
 
-    else:
-        # split curves into new areas
-        a_offset.Reorder()
-        a2 = None
+def recur(arealist, a1, stepover, parallel = True):
+    # this makes arealist by offsetting a1 inwards, then each of the areas that splits into, in turn, and so on
+    # it uses a stack, rather than calling itself, so a small stepover doesn't run out of recursion depth
 
-        for curve in a_offset.getCurves():
-            if curve.IsClockwise():
-                if a2 != None:
-                    a2.append(curve)
-            else:
-                if a2 != None:
-                    recur(arealist, a2, stepover, from_center)
+    stack = [area.Area(a1)]
+
+    while len(stack) > 0:
+        # where it first splits, see if the rest can be done in parallel
+        if parallel and len(stack) > 1:
+            parallel = False
+            if recur_in_parallel(arealist, stack, stepover):
+                return
+
+        a1 = stack.pop()
+        if a1.num_curves() == 0:
+            continue
+
+        arealist.append(a1)
+
+        a_offset = area.Area(a1)
+        a_offset.Offset(stepover)
+
+        # split curves into new areas
+        children = list()
+        if area.holes_linked():
+            for curve in a_offset.getCurves():
                 a2 = area.Area()
                 a2.append(curve)
+                children.append(a2)
+
+        else:
+            a_offset.Reorder()
+            a2 = None
+
+            for curve in a_offset.getCurves():
+                if curve.IsClockwise():
+                    if a2 != None:
+                        a2.append(curve)
+                else:
+                    if a2 != None:
+                        children.append(a2)
+                    a2 = area.Area()
+                    a2.append(curve)
+
+            if a2 != None:
+                children.append(a2)
+
+        # do the first one next, to keep the order they used to be done in
+        children.reverse()
+        stack.extend(children)
+
+parallel_stack = None
+parallel_stepover = None
+
+def recur_stack_entry(i):
+    # runs in a worker process
+    try:
+        arealist = list()
+        recur(arealist, parallel_stack[i], parallel_stepover, False)
+        return [curves_of(a) for a in arealist]
+    except:
+        return None
 
-        if a2 != None:
-            recur(arealist, a2, stepover, from_center)
+def recur_in_parallel(arealist, stack, stepover):
+    # the areas on the stack don't depend on each other, so they are offset in separate processes, one for each core, as nc/op_cache.py does
+    # the processes are forked, and the areas go between them as lists of vertices, as libarea's can't be pickled
+    # returns False, leaving the stack as it was, if they can't be done like that
+    global parallel_stack
+    global parallel_stepover
+    if sum([len(vertices) for a in stack for vertices in curves_of(a)]) < min_vertices_in_parallel:
+        return False
+    if sys.platform == 'win32':
+        return False
+    try:
+        import multiprocessing
+        processes = min(multiprocessing.cpu_count(), len(stack))
+        if processes < 2:
+            return False
+        parallel_stack = stack
+        parallel_stepover = stepover
+        pool = multiprocessing.Pool(processes)
+        try:
+            # the top of the stack is done first
+            results = pool.map(recur_stack_entry, range(len(stack) - 1, -1, -1), 1)
+        finally:
+            pool.close()
+            pool.join()
+            parallel_stack = None
+            parallel_stepover = None
+    except Exception:
+        # like in one of op_cache.py's worker processes, which can't start processes of their own
+        return False
+    if None in results:
+        return False
+    for result in results:
+        for curves in result:
+            arealist.append(area_from_curves(curves))
+    del stack[:]
+    return True
 
 def get_curve_list(arealist, reverse_curves = False):
     curve_list = list()
     for a in arealist:
         for curve in a.getCurves():
+            # copy it, so the areas in ring_cache aren't changed
+            curve = area.Curve(curve)
             if reverse_curves == True:
                 curve.Reverse()
             curve_list.append(curve)
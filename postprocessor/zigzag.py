@@ -1,6 +1,12 @@
 import area
 import math
 
+try:
+    # HeeksCNC's own python has the zig zag in C++, which is much quicker
+    from heekscnc import zigzag as native_zigzag
+except ImportError:
+    native_zigzag = None
+
 curve_list_for_zigs = []
 rightward_for_zigs = True
 sin_angle_for_zigs = 0.0
@@ -30,6 +36,9 @@ def zigzag(a, stepover, zig_unidirectional, zig_angle):
 
     one_over_units = 1 / area.get_units()
 
+    if native_zigzag != None:
+        return zigzag_from_native(a, stepover, zig_unidirectional, zig_angle)
+
     a = rotated_area(a)
 
     b = area.Box()
@@ -69,78 +78,90 @@ def zigzag(a, stepover, zig_unidirectional, zig_angle):
     return curve_list_for_zigs
 
 
+def zigzag_from_native(a, stepover, zig_unidirectional, zig_angle):
+    curves = []
+    for curve in a.getCurves():
+        curves.append([(v.type, v.p.x, v.p.y, v.c.x, v.c.y) for v in curve.getVertices()])
+
+    curve_list = []
+    for zig in native_zigzag(curves, stepover, zig_unidirectional, zig_angle, 0.1 * one_over_units, 0.002 * one_over_units):
+        c = area.Curve()
+        for vertex_type, x, y, cx, cy in zig:
+            c.append(area.Vertex(vertex_type, area.Point(x, y), area.Point(cx, cy)))
+        curve_list.append(c)
+    return curve_list
+
+
+def on_line(p, y):
+    return math.fabs(p.y - y) < 0.002 * one_over_units
+
 def make_zig_curve(curve, y0, y, zig_unidirectional):
+    # returns a zig, with where it starts along y0, for each run of the curve along y0, from where it comes down from y to where it goes up to y again
+    # the bumps up from y0 in between are followed, so they are cut
+    # a curve which doesn't get to y, at the top of the area, gets one zig, from the run furthest back, which stays on y0 at the end
     if rightward_for_zigs:
         curve.Reverse()
 
-    # find a high point to start looking from
-    high_point = None
-    for vertex in curve.getVertices():
-        if high_point == None:
-            high_point = vertex.p
-        elif vertex.p.y > high_point.y:
-            # use this as the new high point
-            high_point = vertex.p
-        elif math.fabs(vertex.p.y - high_point.y) < 0.002 * one_over_units:
-            # equal high point
-            if rightward_for_zigs:
-                # use the furthest left point
-                if vertex.p.x < high_point.x:
-                    high_point = vertex.p
-            else:
-                 # use the furthest right point
-                if vertex.p.x > high_point.x:
-                    high_point = vertex.p
-
-    zig = area.Curve()
-
-    high_point_found = False
-    zig_started = False
-    zag_found = False
-
-    for i in range(0, 2): # process the curve twice because we don't know where it will start
-        prev_p = None
-        for vertex in curve.getVertices():
-            if zag_found: break
-            if prev_p != None:
-                if zig_started:
-                    zig.append(unrotated_vertex(vertex))
-                    if math.fabs(vertex.p.y - y) < 0.002 * one_over_units:
-                        zag_found = True
-                        break
-                elif high_point_found:
-                    if math.fabs(vertex.p.y - y0) < 0.002 * one_over_units:
-                        if zig_started:
-                            zig.append(unrotated_vertex(vertex))
-                        elif math.fabs(prev_p.y - y0) < 0.002 * one_over_units and vertex.type == 0:
-                            zig.append(area.Vertex(0, unrotated_point(prev_p), area.Point(0, 0)))
-                            zig.append(unrotated_vertex(vertex))
-                            zig_started = True
-                elif vertex.p.x == high_point.x and vertex.p.y == high_point.y:
-                    high_point_found = True
-            prev_p = vertex.p
-
-    if zig_started:
-
-        if zig_unidirectional == True:
-            # remove the last bit of zig
-            if math.fabs(zig.LastVertex().p.y - y) < 0.002 * one_over_units:
-                vertices = zig.getVertices()
-                while len(vertices) > 0:
-                    v = vertices[len(vertices)-1]
-                    if math.fabs(v.p.y - y0) < 0.002 * one_over_units:
-                        break
-                    else:
-                        vertices.pop()
-                zig = area.Curve()
-                for v in vertices:
-                    zig.append(v)
-
-        curve_list_for_zigs.append(zig)
+    vertices = curve.getVertices()
+    n = len(vertices) - 1 # the last is the first again
+    zigs = []
+    if n < 1:
+        return zigs
+
+    def along_y0(i):
+        return on_line(vertices[i-1].p, y0) and on_line(vertices[i].p, y0) and vertices[i].type == 0
+
+    # start after a vertex on y, so each run is found from its start
+    start = None
+    for i in range(1, n + 1):
+        if on_line(vertices[i].p, y):
+            start = i % n + 1
+            break
+    if start == None:
+        for i in range(1, n + 1):
+            if along_y0(i):
+                x = vertices[i-1].p.x
+                if start == None or (x < vertices[start-1].p.x if rightward_for_zigs else x > vertices[start-1].p.x):
+                    start = i
+        if start == None:
+            return zigs
+
+    zig = None
+    for m in range(0, n):
+        i = (start - 1 + m) % n + 1
+        vertex = vertices[i]
+        if zig == None:
+            if along_y0(i):
+                start_x = vertices[i-1].p.x
+                zig = [area.Vertex(0, unrotated_point(vertices[i-1].p), area.Point(0, 0)), unrotated_vertex(vertex)]
+                size_after_y0 = len(zig)
+        else:
+            zig.append(unrotated_vertex(vertex))
+            if along_y0(i):
+                size_after_y0 = len(zig)
+            elif on_line(vertex.p, y):
+                if zig_unidirectional == True:
+                    # remove the last bit of zig
+                    zig = zig[:size_after_y0]
+                zigs.append((start_x, zig))
+                zig = None
+
+    if zig != None:
+        zigs.append((start_x, zig[:size_after_y0]))
+
+    return zigs
 
 def make_zig(a, y0, y, zig_unidirectional):
+    # in the order they go along the scanline, so they don't depend on the order of the curves
+    zigs = []
     for curve in a.getCurves():
-        make_zig_curve(curve, y0, y, zig_unidirectional)
+        zigs += make_zig_curve(curve, y0, y, zig_unidirectional)
+    zigs.sort(key = lambda z: z[0], reverse = (rightward_for_zigs == False))
+    for start_x, vertices in zigs:
+        zig = area.Curve()
+        for v in vertices:
+            zig.append(v)
+        curve_list_for_zigs.append(zig)
 
 reorder_zig_list_list = []
 
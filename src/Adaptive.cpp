@@ -0,0 +1,665 @@
+// Adaptive.cpp
+/*
+ * Copyright (c) 2009, Dan Heeks
+ * This program is released under the BSD license. See the file COPYING for
+ * details.
+ */
+
+#include "stdafx.h"
+#include "Adaptive.h"
+#include "FeedPossible.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <algorithm>
+
+static const double PI = 3.1415926535897932;
+
+// lengths smaller than this are nothing
+static const double tiny_length = 1.0e-9;
+
+// the cells are made bigger, if they need to be, to keep to this many, but not bigger than a quarter of the stepover
+static const double max_cells = 8000000.0;
+
+// the directions tried for the first step of a path, all the way round
+static const int num_start_directions = 32;
+
+// the directions tried for the other steps, from max_turn one way to max_turn the other way
+static const int num_fan_directions = 25;
+static const double max_turn = PI * 0.75;
+
+// the times a step is halved to get it inside the boundary
+static const int num_shorter_steps = 4;
+
+// the tries between two directions of the fan, to find the one which removes the stepover
+static const int num_refinements = 4;
+
+// the longest straight line made from the steps
+static const size_t max_steps_in_line = 64;
+
+// sets distances to how far each cell is from the nearest cell of cells which is value, in cells, with a two pass chamfer
+static void Distances(const std::vector<char> &cells, char value, int nx, int ny, std::vector<float> &distances)
+{
+	const float far_away = 1.0e30f;
+	const float diagonal = 1.41421356f;
+	distances.resize(cells.size());
+	for(size_t i = 0; i < cells.size(); i++)distances[i] = (cells[i] == value) ? 0.0f : far_away;
+
+	for(int j = 0; j < ny; j++)
+	{
+		for(int i = 0; i < nx; i++)
+		{
+			float &d = distances[j * nx + i];
+			if(i > 0)d = std::min(d, distances[j * nx + i - 1] + 1.0f);
+			if(j > 0)
+			{
+				d = std::min(d, distances[(j - 1) * nx + i] + 1.0f);
+				if(i > 0)d = std::min(d, distances[(j - 1) * nx + i - 1] + diagonal);
+				if(i + 1 < nx)d = std::min(d, distances[(j - 1) * nx + i + 1] + diagonal);
+			}
+		}
+	}
+
+	for(int j = ny - 1; j >= 0; j--)
+	{
+		for(int i = nx - 1; i >= 0; i--)
+		{
+			float &d = distances[j * nx + i];
+			if(i + 1 < nx)d = std::min(d, distances[j * nx + i + 1] + 1.0f);
+			if(j + 1 < ny)
+			{
+				d = std::min(d, distances[(j + 1) * nx + i] + 1.0f);
+				if(i + 1 < nx)d = std::min(d, distances[(j + 1) * nx + i + 1] + diagonal);
+				if(i > 0)d = std::min(d, distances[(j + 1) * nx + i - 1] + diagonal);
+			}
+		}
+	}
+}
+
+static double PointToLine(const CCurveVertex &p, const CCurveVertex &a, const CCurveVertex &b)
+{
+	double dx = b.x - a.x, dy = b.y - a.y;
+	double length_squared = dx * dx + dy * dy;
+	double t = (length_squared > 0.0) ? ((p.x - a.x) * dx + (p.y - a.y) * dy) / length_squared : 0.0;
+	if(t < 0.0)t = 0.0;
+	if(t > 1.0)t = 1.0;
+	double x = a.x + t * dx - p.x, y = a.y + t * dy - p.y;
+	return sqrt(x * x + y * y);
+}
+
+// joins the steps which are nearly in line into longer lines, which stay inside the boundary
+static void Simplify(const CCurve &path, double tolerance, CFeedPossible &boundary, CCurve &simple)
+{
+	simple.clear();
+	if(path.size() == 0)return;
+	simple.push_back(path[0]);
+	size_t anchor = 0;
+	for(size_t i = 1; i < path.size(); i++)
+	{
+		if(i + 1 < path.size() && i + 1 - anchor <= max_steps_in_line)
+		{
+			bool in_line = true;
+			for(size_t k = anchor + 1; k <= i; k++)
+			{
+				if(PointToLine(path[k], path[anchor], path[i + 1]) > tolerance)
+				{
+					in_line = false;
+					break;
+				}
+			}
+			if(in_line && boundary.Possible(path[anchor].x, path[anchor].y, path[i + 1].x, path[i + 1].y))continue;
+		}
+		simple.push_back(path[i]);
+		anchor = i;
+	}
+}
+
+class CAdaptiveClearing
+{
+public:
+	double m_radius, m_stepover, m_step;
+	int m_side; // 1 to turn to the left towards the material, -1 to turn to the right
+	double m_min_x, m_min_y, m_cell;
+	int m_nx, m_ny;
+	std::vector<char> m_material; // 1 for each cell which hasn't been cut yet
+	std::vector<char> m_allowed; // 1 for each cell the centre of the cutter can go to
+	std::vector<char> m_tried; // 1 for each cell a path has started from
+	std::vector<float> m_wall_distances; // how far each cell is from the boundary, in cells
+	bool m_too_big; // true if the cells would have to be more than a quarter of the stepover across
+	CFeedPossible m_boundary;
+	double m_from_x, m_from_y; // where the cutter was for m_from_k0 and m_from_k1
+	int m_from_j0; // the row of m_from_k0[0]
+	std::vector<int> m_from_k0, m_from_k1; // the first and last cells of each row under the cutter there
+
+	CAdaptiveClearing(const std::vector<CCurve> &material_curves, const std::vector<CCurve> &boundary_curves, double tool_radius, double stepover, bool climb)
+		: m_radius(tool_radius), m_stepover(stepover), m_step(0.0), m_side(climb ? 1 : -1), m_min_x(0.0), m_min_y(0.0), m_cell(1.0), m_nx(0), m_ny(0),
+		m_too_big(false), m_boundary(boundary_curves, tiny_length), m_from_x(0.0), m_from_y(0.0), m_from_j0(0)
+	{
+		CCurveSpans material_edges, boundary_edges;
+		for(std::vector<CCurve>::const_iterator It = material_curves.begin(); It != material_curves.end(); It++)material_edges.AddCurve(*It);
+		for(std::vector<CCurve>::const_iterator It = boundary_curves.begin(); It != boundary_curves.end(); It++)boundary_edges.AddCurve(*It);
+
+		double xmin, ymin, xmax, ymax;
+		if(!material_edges.GetBox(xmin, ymin, xmax, ymax))return;
+		double bxmin, bymin, bxmax, bymax;
+		if(!boundary_edges.GetBox(bxmin, bymin, bxmax, bymax))return;
+		xmin = std::min(xmin, bxmin);
+		ymin = std::min(ymin, bymin);
+		xmax = std::max(xmax, bxmax);
+		ymax = std::max(ymax, bymax);
+
+		// fine enough to see a quarter of the stepover, and of the cutter's radius
+		m_cell = std::min(stepover, tool_radius) / 4;
+		double width = xmax - xmin, height = ymax - ymin;
+		if(width * height / (m_cell * m_cell) > max_cells)
+		{
+			// bigger cells would hide widths of cut bigger than the stepover
+			m_cell = sqrt(width * height / max_cells);
+			if(m_cell > stepover / 4)
+			{
+				m_too_big = true;
+				return;
+			}
+		}
+		m_step = std::min(m_cell * 2, tool_radius / 2);
+
+		m_min_x = xmin - m_cell;
+		m_min_y = ymin - m_cell;
+		m_nx = (int)(width / m_cell) + 3;
+		m_ny = (int)(height / m_cell) + 3;
+
+		Fill(material_edges, m_material);
+		Fill(boundary_edges, m_allowed);
+		m_tried.resize(m_nx * m_ny, 0);
+		Distances(m_allowed, 0, m_nx, m_ny, m_wall_distances);
+	}
+
+	double CellX(int i)const{ return m_min_x + (i + 0.5) * m_cell; }
+	double CellY(int j)const{ return m_min_y + (j + 0.5) * m_cell; }
+
+	// the first column with its centre at x or after it
+	int FirstColumn(double x)const{ int i = (int)ceil((x - m_min_x) / m_cell - 0.5); return (i < 0) ? 0 : i; }
+
+	// the last column with its centre at x or before it
+	int LastColumn(double x)const{ int i = (int)floor((x - m_min_x) / m_cell - 0.5); return (i >= m_nx) ? (m_nx - 1) : i; }
+
+	int FirstRow(double y)const{ int j = (int)ceil((y - m_min_y) / m_cell - 0.5); return (j < 0) ? 0 : j; }
+	int LastRow(double y)const{ int j = (int)floor((y - m_min_y) / m_cell - 0.5); return (j >= m_ny) ? (m_ny - 1) : j; }
+
+	// sets the cells with their centres inside the curves
+	void Fill(const CCurveSpans &edges, std::vector<char> &cells)const
+	{
+		cells.resize(m_nx * m_ny, 0);
+		std::vector<double> crossings;
+		for(int j = 0; j < m_ny; j++)
+		{
+			double y = CellY(j);
+			crossings.clear();
+			for(std::vector<CCurveSpan>::const_iterator It = edges.m_spans.begin(); It != edges.m_spans.end(); It++)
+			{
+				if(It->Crosses(y))crossings.push_back(It->X(y));
+			}
+			std::sort(crossings.begin(), crossings.end());
+			for(size_t k = 0; k + 1 < crossings.size(); k += 2)
+			{
+				int i1 = LastColumn(crossings[k + 1]);
+				for(int i = FirstColumn(crossings[k]); i <= i1; i++)cells[j * m_nx + i] = 1;
+			}
+		}
+	}
+
+	// remembers which cells of each row are under the cutter at x, y, for all the moves tried from there
+	void SetFrom(double x, double y)
+	{
+		m_from_x = x;
+		m_from_y = y;
+		m_from_j0 = FirstRow(y - m_radius - m_step);
+		int j1 = LastRow(y + m_radius + m_step);
+		m_from_k0.clear();
+		m_from_k1.clear();
+		for(int j = m_from_j0; j <= j1; j++)
+		{
+			double dy = CellY(j) - y;
+			double half_width2 = m_radius * m_radius - dy * dy;
+			if(half_width2 < 0.0)
+			{
+				m_from_k0.push_back(1);
+				m_from_k1.push_back(0);
+				continue;
+			}
+			double half_width = sqrt(half_width2);
+			m_from_k0.push_back(FirstColumn(x - half_width));
+			m_from_k1.push_back(LastColumn(x + half_width));
+		}
+	}
+
+	// counts the material cells under the cutter at x1, y1 which weren't under it at x0, y0, and removes them if remove is true
+	// With from set to false, it counts all the cells under it.
+	int Cut(double x0, double y0, double x1, double y1, bool from, bool remove)
+	{
+		if(from && (m_from_k0.size() == 0 || x0 != m_from_x || y0 != m_from_y))SetFrom(x0, y0);
+
+		int count = 0;
+		double r2 = m_radius * m_radius;
+		int j1 = LastRow(y1 + m_radius);
+		for(int j = FirstRow(y1 - m_radius); j <= j1; j++)
+		{
+			double y = CellY(j);
+			double half_width2 = r2 - (y - y1) * (y - y1);
+			if(half_width2 < 0.0)continue;
+			double half_width = sqrt(half_width2);
+			int i0 = FirstColumn(x1 - half_width);
+			int i1 = LastColumn(x1 + half_width);
+
+			// the cells which were under it before
+			int k0 = i1 + 1, k1 = i1;
+			int f = j - m_from_j0;
+			if(from && f >= 0 && f < (int)m_from_k0.size())
+			{
+				k0 = m_from_k0[f];
+				k1 = m_from_k1[f];
+			}
+
+			char* row = &m_material[j * m_nx];
+			for(int i = i0; i <= i1; i++)
+			{
+				if(i >= k0 && i <= k1)
+				{
+					i = k1;
+					continue;
+				}
+				if(row[i])
+				{
+					count++;
+					if(remove)row[i] = 0;
+				}
+			}
+		}
+		return count;
+	}
+
+	// Sets nx, ny to where a step from x, y in the direction at angle a gets to. It is made shorter if it would go past the boundary,
+	// so the cutter can get right up to it, and then go along it. Returns false if even the shortest step would go past it.
+	bool Move(double x, double y, double a, double &nx, double &ny)
+	{
+		double step = m_step;
+		for(int i = 0; i < num_shorter_steps; i++, step /= 2)
+		{
+			nx = x + step * cos(a);
+			ny = y + step * sin(a);
+			if(m_boundary.Possible(x, y, nx, ny))return true;
+		}
+		return false;
+	}
+
+	// the width of cut for a step from x, y in the direction at angle a, or -1 if the cutter can't go there
+	double Width(double x, double y, double a)
+	{
+		double nx, ny;
+		if(!Move(x, y, a, nx, ny))return -1.0;
+		double step = sqrt((nx - x) * (nx - x) + (ny - y) * (ny - y));
+		return Cut(x, y, nx, ny, true, false) * m_cell * m_cell / step;
+	}
+
+	// true if a width of cut of w is better than best_w; the widest one up to the stepover, or else the narrowest, but not one which cuts nothing
+	bool Better(double w, double best_w)const
+	{
+		if(w <= 0.0)return false;
+		if(best_w < 0.0)return true;
+		if(w <= m_stepover)return best_w > m_stepover || w > best_w;
+		return best_w > m_stepover && w < best_w;
+	}
+
+	// Moves the cutter one step, if it removes some material.
+	// heading is the direction it was going in, or more than two PI at the start of a path.
+	bool Step(double &x, double &y, double &heading)
+	{
+		double best_a = 0.0, best_w = -1.0;
+
+		if(heading > 2 * PI)
+		{
+			for(int k = 0; k < num_start_directions; k++)
+			{
+				double a = 2 * PI * k / num_start_directions;
+				double w = Width(x, y, a);
+				if(Better(w, best_w))
+				{
+					best_a = a;
+					best_w = w;
+				}
+			}
+		}
+		else
+		{
+			// turn towards the material from turning away from it, until it would take more than the stepover
+			double prev_a = 0.0, prev_w = -1.0;
+			bool crossed = false;
+			for(int k = 0; k < num_fan_directions; k++)
+			{
+				double a = heading + m_side * (-max_turn + 2 * max_turn * k / (num_fan_directions - 1));
+				double w = Width(x, y, a);
+				if(prev_w >= 0.0 && prev_w < m_stepover && (w < 0.0 || w >= m_stepover))
+				{
+					// find where it crosses the stepover, staying under it
+					double lo = prev_a, lo_w = prev_w, hi = a, hi_w = w;
+					for(int r = 0; r < num_refinements; r++)
+					{
+						double mid = (lo + hi) / 2;
+						double mid_w = Width(x, y, mid);
+						if(mid_w >= 0.0 && mid_w < m_stepover)
+						{
+							lo = mid;
+							lo_w = mid_w;
+						}
+						else
+						{
+							hi = mid;
+							hi_w = mid_w;
+						}
+					}
+
+					// if going under the stepover doesn't cut anything, go over it, rather than end the path
+					if(lo_w > 0.0 || hi_w < 0.0)
+					{
+						best_a = lo;
+						best_w = lo_w;
+					}
+					else
+					{
+						best_a = hi;
+						best_w = hi_w;
+					}
+					crossed = true;
+					break;
+				}
+				if(Better(w, best_w))
+				{
+					best_a = a;
+					best_w = w;
+				}
+				prev_a = a;
+				prev_w = w;
+			}
+			if(!crossed && best_w < 0.0)return false;
+		}
+
+		if(best_w < 0.0)return false;
+
+		double nx, ny;
+		Move(x, y, best_a, nx, ny);
+		if(Cut(x, y, nx, ny, true, true) == 0)return false;
+		x = nx;
+		y = ny;
+		heading = best_a;
+		return true;
+	}
+
+	// copies the material in the columns i0 to i1 and the rows j0 to j1, and sets distances to how far each of its cells is from it
+	void MaterialDistances(int i0, int j0, int i1, int j1, std::vector<char> &material, std::vector<float> &distances)const
+	{
+		int nx = i1 - i0 + 1, ny = j1 - j0 + 1;
+		material.resize(nx * ny);
+		for(int j = 0; j < ny; j++)
+		{
+			for(int i = 0; i < nx; i++)material[j * nx + i] = m_material[(j + j0) * m_nx + i + i0];
+		}
+		Distances(material, 1, nx, ny, distances);
+	}
+
+	// Finds the cell to start the next path from, in the columns i0 to i1 and the rows j0 to j1; in the cleared area, nearest to x, y,
+	// with the edge of the material under the cutter, but not more than the stepover of it. Only cells at least margin cells in from
+	// the edge of the window are used, because the material outside it isn't looked at. If plunges is true and there is nowhere like that,
+	// it gives the material furthest from the boundary. Returns -1 if it finds nowhere.
+	int FindStart(int i0, int j0, int i1, int j1, int margin, bool plunges, bool have_position, double x, double y)
+	{
+		int nx = i1 - i0 + 1, ny = j1 - j0 + 1;
+		std::vector<char> material;
+		std::vector<float> material_distances;
+		MaterialDistances(i0, j0, i1, j1, material, material_distances);
+
+		double min_distance = (m_radius - m_stepover) / m_cell;
+		double max_distance = m_radius / m_cell - 0.5;
+		int best = -1;
+		double best_d = 0.0;
+		bool plunge = false;
+
+		for(int j = margin; j < ny - margin; j++)
+		{
+			for(int i = margin; i < nx - margin; i++)
+			{
+				int c = (j + j0) * m_nx + i + i0;
+				if(!m_allowed[c] || m_tried[c])continue;
+
+				if(material[j * nx + i])
+				{
+					// somewhere to plunge, if there's nowhere else
+					if(plunges && (best == -1 || (plunge && m_wall_distances[c] > best_d)))
+					{
+						best = c;
+						best_d = m_wall_distances[c];
+						plunge = true;
+					}
+					continue;
+				}
+
+				float d = material_distances[j * nx + i];
+				if(d < min_distance || d > max_distance)continue;
+				double dx = CellX(i + i0) - x, dy = CellY(j + j0) - y;
+				double d2 = have_position ? (dx * dx + dy * dy) : 0.0;
+				if(best == -1 || plunge || d2 < best_d)
+				{
+					best = c;
+					best_d = d2;
+					plunge = false;
+				}
+			}
+		}
+
+		return best;
+	}
+
+	// Finds where to start the next path, looking near x, y first. Returns false when there is nothing more it can cut.
+	bool NextStart(bool have_position, double x, double y, double &sx, double &sy)
+	{
+		int best = -1;
+
+		if(have_position)
+		{
+			// look in bigger and bigger windows round x, y, to save working out the distances to the material for the whole grid each time
+			int ci = (int)((x - m_min_x) / m_cell), cj = (int)((y - m_min_y) / m_cell);
+			int margin = (int)(m_radius / m_cell) + 2;
+			for(int half = margin * 2; best == -1; half *= 2)
+			{
+				int i0 = std::max(ci - half, 0), j0 = std::max(cj - half, 0);
+				int i1 = std::min(ci + half, m_nx - 1), j1 = std::min(cj + half, m_ny - 1);
+				if(i0 == 0 && j0 == 0 && i1 == m_nx - 1 && j1 == m_ny - 1)break;
+				best = FindStart(i0, j0, i1, j1, margin, false, true, x, y);
+
+				// there may be one nearer, just outside the window
+				if(best != -1)
+				{
+					double dx = CellX(best % m_nx) - x, dy = CellY(best / m_nx) - y;
+					if(sqrt(dx * dx + dy * dy) > (half - margin) * m_cell)best = -1;
+				}
+			}
+		}
+
+		if(best == -1)best = FindStart(0, 0, m_nx - 1, m_ny - 1, 0, true, have_position, x, y);
+
+		if(best == -1)return false;
+		m_tried[best] = 1;
+		sx = CellX(best % m_nx);
+		sy = CellY(best / m_nx);
+		return true;
+	}
+
+	// true if the cutter can go straight from x0, y0 to x1, y1, inside the boundary, over the cells of clear, which is for the columns from i0 and the rows from j0
+	bool Clear(const std::vector<char> &clear, int i0, int j0, int nx, int ny, double x0, double y0, double x1, double y1)
+	{
+		double dx = x1 - x0, dy = y1 - y0;
+		int samples = (int)(sqrt(dx * dx + dy * dy) * 2 / m_cell) + 1;
+		for(int s = 1; s <= samples; s++)
+		{
+			double t = (double)s / samples;
+			int i = (int)floor((x0 + dx * t - m_min_x) / m_cell) - i0, j = (int)floor((y0 + dy * t - m_min_y) / m_cell) - j0;
+			if(i < 0 || j < 0 || i >= nx || j >= ny || !clear[j * nx + i])return false;
+		}
+		return m_boundary.Possible(x0, y0, x1, y1);
+	}
+
+	// Finds a way for the cutter from x, y, where the last path ended, to sx, sy, where the next one starts, over cells of the cleared area
+	// where it is no further into the material than the stepover, as it is on the paths, and at sx, sy. It searches breadth first, in a window round the two, then pulls the way straight, checking each line
+	// against the boundary. Sets link to the corners of the way, not including x, y. Returns false if it finds no way, so the cutter
+	// has to be raised to get there.
+	bool Link(double x, double y, double sx, double sy, std::vector<CCurveVertex> &link)
+	{
+		link.clear();
+		int from_i = (int)floor((x - m_min_x) / m_cell), from_j = (int)floor((y - m_min_y) / m_cell);
+		int start_i = (int)floor((sx - m_min_x) / m_cell), start_j = (int)floor((sy - m_min_y) / m_cell);
+		if(m_material[start_j * m_nx + start_i])return false; // a plunge
+		int margin = (int)(m_radius / m_cell) + 2;
+		int spread = std::max(abs(start_i - from_i), abs(start_j - from_j)) + margin * 2;
+		int i0 = std::max(std::min(from_i, start_i) - spread, 0), j0 = std::max(std::min(from_j, start_j) - spread, 0);
+		int i1 = std::min(std::max(from_i, start_i) + spread, m_nx - 1), j1 = std::min(std::max(from_j, start_j) + spread, m_ny - 1);
+		int nx = i1 - i0 + 1, ny = j1 - j0 + 1;
+		if(from_i < i0 || from_j < j0 || from_i > i1 || from_j > j1)return false;
+
+		std::vector<char> material;
+		std::vector<float> material_distances;
+		MaterialDistances(i0, j0, i1, j1, material, material_distances);
+
+		// the cells near a side of the window which isn't a side of the grid don't see all the material near them, so they aren't used
+		int left = (i0 > 0) ? margin : 0, bottom = (j0 > 0) ? margin : 0;
+		int right = (i1 < m_nx - 1) ? margin : 0, top = (j1 < m_ny - 1) ? margin : 0;
+		// the lines between the cells are checked against the boundary itself, as one can clip a cell with its centre just outside it
+		double min_distance = (m_radius - m_stepover) / m_cell;
+		std::vector<char> clear(nx * ny, 0), passable(nx * ny, 0);
+		for(int j = bottom; j < ny - top; j++)
+		{
+			for(int i = left; i < nx - right; i++)
+			{
+				int k = j * nx + i;
+				clear[k] = !material[k] && material_distances[k] >= min_distance;
+				passable[k] = clear[k] && m_allowed[(j + j0) * m_nx + i + i0];
+			}
+		}
+
+		// the cutter has just been at x, y, so its cell is clear, even if its centre is just outside the boundary
+		int from = (from_j - j0) * nx + from_i - i0;
+		int to = (start_j - j0) * nx + start_i - i0;
+		clear[from] = 1;
+		passable[from] = 1;
+		if(!passable[to])return false;
+
+		std::vector<int> previous(nx * ny, -1);
+		std::vector<int> queue;
+		queue.push_back(from);
+		previous[from] = from;
+		for(size_t q = 0; q < queue.size() && previous[to] == -1; q++)
+		{
+			int k = queue[q];
+			int i = k % nx, j = k / nx;
+			for(int dj = -1; dj <= 1; dj++)
+			{
+				for(int di = -1; di <= 1; di++)
+				{
+					int ni = i + di, nj = j + dj;
+					if(ni < 0 || nj < 0 || ni >= nx || nj >= ny)continue;
+					int n = nj * nx + ni;
+					if(!passable[n] || previous[n] != -1)continue;
+					previous[n] = k;
+					queue.push_back(n);
+				}
+			}
+		}
+		if(previous[to] == -1)return false;
+
+		std::vector<int> way;
+		for(int k = to; k != from; k = previous[k])way.push_back(k);
+		std::reverse(way.begin(), way.end());
+
+		// go as far along the way as it can in a straight line each time
+		double ax = x, ay = y;
+		size_t next = 0;
+		while(next < way.size())
+		{
+			int furthest = -1;
+			for(size_t w = next; w < way.size(); w++)
+			{
+				if(!Clear(clear, i0, j0, nx, ny, ax, ay, CellX(way[w] % nx + i0), CellY(way[w] / nx + j0)))break;
+				furthest = (int)w;
+			}
+			if(furthest == -1)return false;
+			ax = CellX(way[furthest] % nx + i0);
+			ay = CellY(way[furthest] / nx + j0);
+			link.push_back(CCurveVertex(0, ax, ay, 0.0, 0.0));
+			next = furthest + 1;
+		}
+		return true;
+	}
+
+	// removes the material under the cutter going from x0, y0 to x1, y1, a step at a time
+	void CutAlong(double x0, double y0, double x1, double y1)
+	{
+		double dx = x1 - x0, dy = y1 - y0;
+		int steps = (int)(sqrt(dx * dx + dy * dy) / m_step) + 1;
+		double x = x0, y = y0;
+		for(int s = 1; s <= steps; s++)
+		{
+			double nx = x0 + dx * s / steps, ny = y0 + dy * s / steps;
+			Cut(x, y, nx, ny, true, true);
+			x = nx;
+			y = ny;
+		}
+	}
+};
+
+bool CAdaptive::Make(const std::vector<CCurve> &material_curves, const std::vector<CCurve> &boundary_curves, double tool_radius, double stepover, bool climb, std::vector<CCurve> &paths)
+{
+	paths.clear();
+	if(tool_radius <= 0.0 || stepover <= 0.0)return true;
+
+	CAdaptiveClearing clearing(material_curves, boundary_curves, tool_radius, stepover, climb);
+	if(clearing.m_too_big)return false;
+	if(clearing.m_nx == 0)return true;
+
+	double x = 0.0, y = 0.0; // where the last path ended
+	bool have_position = false;
+	double sx, sy;
+	std::vector<CCurveVertex> link;
+	while(clearing.NextStart(have_position, x, y, sx, sy))
+	{
+		CCurve path;
+		if(have_position && clearing.Link(x, y, sx, sy, link))
+		{
+			// start from where the last path ended, and go along the link, so python keeps the cutter down
+			path.push_back(CCurveVertex(0, x, y, 0.0, 0.0));
+			for(std::vector<CCurveVertex>::iterator It = link.begin(); It != link.end(); It++)
+			{
+				clearing.CutAlong(path.back().x, path.back().y, It->x, It->y);
+				path.push_back(*It);
+			}
+		}
+		else
+		{
+			path.push_back(CCurveVertex(0, sx, sy, 0.0, 0.0));
+		}
+		double px = sx, py = sy;
+
+		// the cutter goes down here, or gets here, so everything under it is cut
+		int removed = clearing.Cut(px, py, px, py, false, true);
+
+		double heading = 4 * PI;
+		while(clearing.Step(px, py, heading))path.push_back(CCurveVertex(0, px, py, 0.0, 0.0));
+
+		if(path.size() > 1 || removed > 0)
+		{
+			paths.push_back(CCurve());
+			Simplify(path, clearing.m_cell / 4, clearing.m_boundary, paths.back());
+			x = px;
+			y = py;
+			have_position = true;
+		}
+	}
+	return true;
+}
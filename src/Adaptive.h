@@ -0,0 +1,30 @@
+// Adaptive.h
+/*
+ * Copyright (c) 2009, Dan Heeks
+ * This program is released under the BSD license. See the file COPYING for
+ * details.
+ */
+
+// Makes the paths for clearing a pocket with the cutter taking about the same width of cut all the time, for postprocessor/adaptive.py.
+// The other pocket post-processors sometimes take a full width slot, so they have to be fed for that everywhere.
+// The material left is kept as a grid of cells. Each step of a path tries moves in a fan of directions and takes the one which
+// removes closest to stepover times the length of the step, then the cells the cutter has gone over are removed.
+// When a step can't remove any more, the path ends, and the next one starts in the cleared area, at the edge of the material
+// nearest to where the last one ended. The cutter goes there through the cleared area, if it can, as part of the next path.
+// It has no wx or OpenCascade in it.
+
+#pragma once
+
+#include "CurveSpans.h"
+
+class CAdaptive
+{
+public:
+	// Sets paths to the paths of the centre of the cutter, which clear the material made by material_curves, keeping the centre inside
+	// boundary_curves. Both are closed curves; the outsides and the islands, going either way round.
+	// Each path is made of lines. It starts where the last one ended, if the cutter can get from there to the material without taking
+	// more than the stepover, or else with a plunge, or in material already cleared, which the cutter has to be raised to get to.
+	// climb keeps the material on the left of the cutter, else it is kept on the right.
+	// Returns false, with no paths, if the cells would have to be more than a quarter of the stepover across, for the size of the pocket.
+	static bool Make(const std::vector<CCurve> &material_curves, const std::vector<CCurve> &boundary_curves, double tool_radius, double stepover, bool climb, std::vector<CCurve> &paths);
+};
@@ -1264,6 +1264,31 @@ Python CTool::OCLDefinition(CSurface* surface) const
 
 } // End GetShape() method
 
+// the radius and corner radius for nc.attach's native drop cutter, the same shape as OCLDefinition gives, or None, None
+Python CTool::NativeCutterDefinition(CSurface* surface) const
+{
+	Python python;
+	double radius = m_params.m_diameter / 2 + surface->m_material_allowance;
+
+	switch (m_params.m_type)
+	{
+		case CToolParams::eBallEndMill:
+			python << radius << _T(", ") << radius;
+			break;
+
+		case CToolParams::eChamfer:
+		case CToolParams::eEngravingTool:
+			python << _T("None, None");
+			break;
+
+		default:
+			python << radius << _T(", ") << ((m_params.m_corner_radius > 0.000000001) ? m_params.m_corner_radius : 0.0);
+			break;
+	}
+
+	return python;
+}
+
 TopoDS_Face CTool::GetSideProfile() const
 {
    try {
@@ -272,6 +272,7 @@ public:
     // program whose job is to generate RS-274 GCode.
     Python AppendTextToProgram();
     Python OCLDefinition(CSurface* surface)const;
+    Python NativeCutterDefinition(CSurface* surface)const;
 
     void GetProperties(std::list<Property *> *list);
     void CopyFrom(const HeeksObj* object);
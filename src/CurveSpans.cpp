@@ -0,0 +1,233 @@
+// CurveSpans.cpp
+/*
+ * Copyright (c) 2009, Dan Heeks
+ * This program is released under the BSD license. See the file COPYING for
+ * details.
+ */
+
+#include "stdafx.h"
+#include "CurveSpans.h"
+
+#include <math.h>
+#include <algorithm>
+
+static const double PI = 3.1415926535897932;
+
+// lengths and angles smaller than this are nothing
+static const double tiny_length = 1.0e-9;
+static const double tiny_angle = 1.0e-12;
+
+static double PointToLine(double px, double py, double x0, double y0, double x1, double y1)
+{
+	double dx = x1 - x0, dy = y1 - y0;
+	double length_squared = dx * dx + dy * dy;
+	double t = (length_squared > 0.0) ? ((px - x0) * dx + (py - y0) * dy) / length_squared : 0.0;
+	if(t < 0.0)t = 0.0;
+	if(t > 1.0)t = 1.0;
+	double x = x0 + t * dx - px, y = y0 + t * dy - py;
+	return sqrt(x * x + y * y);
+}
+
+static double Cross(double ax, double ay, double bx, double by)
+{
+	return ax * by - ay * bx;
+}
+
+static bool LinesCross(double ax0, double ay0, double ax1, double ay1, double bx0, double by0, double bx1, double by1)
+{
+	double d0 = Cross(ax1 - ax0, ay1 - ay0, bx0 - ax0, by0 - ay0);
+	double d1 = Cross(ax1 - ax0, ay1 - ay0, bx1 - ax0, by1 - ay0);
+	double d2 = Cross(bx1 - bx0, by1 - by0, ax0 - bx0, ay0 - by0);
+	double d3 = Cross(bx1 - bx0, by1 - by0, ax1 - bx0, ay1 - by0);
+	return ((d0 > 0.0) != (d1 > 0.0)) && ((d2 > 0.0) != (d3 > 0.0));
+}
+
+CCurveSpan::CCurveSpan(int type_, double sx_, double sy_, double ex_, double ey_, double cx_, double cy_, double radius_, int side_)
+	: type(type_), sx(sx_), sy(sy_), ex(ex_), ey(ey_), cx(cx_), cy(cy_), radius(radius_), side(side_),
+	ymin(sy_ < ey_ ? sy_ : ey_), ymax(sy_ < ey_ ? ey_ : sy_), loop_begin(0), loop_end(0)
+{
+}
+
+double CCurveSpan::X(double y)const
+{
+	if(type == 0)return sx + (y - sy) * (ex - sx) / (ey - sy);
+	double dy = y - cy;
+	double d = radius * radius - dy * dy;
+	if(d < 0.0)d = 0.0;
+	return cx + side * sqrt(d);
+}
+
+// true if the direction dx, dy from the centre is on the arc; an arc span is never more than half a circle
+static bool OnArc(const CCurveSpan &span, double dx, double dy)
+{
+	double c0 = Cross(span.sx - span.cx, span.sy - span.cy, dx, dy);
+	double c1 = Cross(dx, dy, span.ex - span.cx, span.ey - span.cy);
+	if(span.type > 0)return c0 >= 0.0 && c1 >= 0.0;
+	return c0 <= 0.0 && c1 <= 0.0;
+}
+
+static double PointToArc(const CCurveSpan &span, double px, double py)
+{
+	double dx = px - span.cx, dy = py - span.cy;
+	double d = sqrt(dx * dx + dy * dy);
+	if(d > tiny_length && OnArc(span, dx, dy))return fabs(d - span.radius);
+	double ds = sqrt((px - span.sx) * (px - span.sx) + (py - span.sy) * (py - span.sy));
+	double de = sqrt((px - span.ex) * (px - span.ex) + (py - span.ey) * (py - span.ey));
+	return (ds < de) ? ds : de;
+}
+
+double CCurveSpan::Distance(double x0, double y0, double x1, double y1)const
+{
+	if(type == 0)
+	{
+		if(LinesCross(x0, y0, x1, y1, sx, sy, ex, ey))return 0.0;
+		double d = PointToLine(x0, y0, sx, sy, ex, ey);
+		d = std::min(d, PointToLine(x1, y1, sx, sy, ex, ey));
+		d = std::min(d, PointToLine(sx, sy, x0, y0, x1, y1));
+		return std::min(d, PointToLine(ex, ey, x0, y0, x1, y1));
+	}
+
+	// the nearest points are at the ends of one of them, where the line crosses the arc, or on the line through the centre at right angles to the line
+	double d = PointToArc(*this, x0, y0);
+	d = std::min(d, PointToArc(*this, x1, y1));
+	d = std::min(d, PointToLine(sx, sy, x0, y0, x1, y1));
+	d = std::min(d, PointToLine(ex, ey, x0, y0, x1, y1));
+
+	double dx = x1 - x0, dy = y1 - y0;
+	double a = dx * dx + dy * dy;
+	if(a > 0.0)
+	{
+		double fx = x0 - cx, fy = y0 - cy;
+		double b = 2 * (fx * dx + fy * dy);
+		double c = fx * fx + fy * fy - radius * radius;
+		double discriminant = b * b - 4 * a * c;
+		if(discriminant >= 0.0)
+		{
+			double s = sqrt(discriminant);
+			double ts[2] = {(-b - s) / (2 * a), (-b + s) / (2 * a)};
+			for(int i = 0; i < 2; i++)
+			{
+				if(ts[i] >= 0.0 && ts[i] <= 1.0 && OnArc(*this, fx + ts[i] * dx, fy + ts[i] * dy))return 0.0;
+			}
+		}
+
+		double t = -(fx * dx + fy * dy) / a;
+		if(t < 0.0)t = 0.0;
+		if(t > 1.0)t = 1.0;
+		double qx = fx + t * dx, qy = fy + t * dy;
+		double q = sqrt(qx * qx + qy * qy);
+		if(q > tiny_length && OnArc(*this, qx, qy))d = std::min(d, fabs(q - radius));
+	}
+
+	return d;
+}
+
+void CCurveSpan::GetBox(double &xmin, double &ymin_, double &xmax, double &ymax_)const
+{
+	xmin = std::min(sx, ex);
+	xmax = std::max(sx, ex);
+	ymin_ = ymin;
+	ymax_ = ymax;
+	if(type != 0)
+	{
+		if(OnArc(*this, 1.0, 0.0))xmax = cx + radius;
+		if(OnArc(*this, -1.0, 0.0))xmin = cx - radius;
+	}
+}
+
+void CCurveSpans::AddLine(double x0, double y0, double x1, double y1)
+{
+	if(fabs(x1 - x0) < tiny_length && fabs(y1 - y0) < tiny_length)return;
+	m_spans.push_back(CCurveSpan(0, x0, y0, x1, y1, 0.0, 0.0, 0.0, 0));
+}
+
+void CCurveSpans::AddArcSpan(int dir, double x0, double y0, double x1, double y1, double cx, double cy, double radius, double mid_angle)
+{
+	if(fabs(x1 - x0) < tiny_length && fabs(y1 - y0) < tiny_length)return;
+	m_spans.push_back(CCurveSpan(dir, x0, y0, x1, y1, cx, cy, radius, (cos(mid_angle) >= 0.0) ? 1 : -1));
+}
+
+void CCurveSpans::AddArc(int dir, double x0, double y0, double x1, double y1, double cx, double cy)
+{
+	if(fabs(x1 - x0) < tiny_length && fabs(y1 - y0) < tiny_length)return;
+	double radius = sqrt((x0 - cx) * (x0 - cx) + (y0 - cy) * (y0 - cy));
+	if(radius < tiny_length)
+	{
+		AddLine(x0, y0, x1, y1);
+		return;
+	}
+
+	double a0 = atan2(y0 - cy, x0 - cx);
+	double a1 = atan2(y1 - cy, x1 - cx);
+	double sweep = (a1 - a0) * dir;
+	while(sweep <= tiny_angle)sweep += 2 * PI;
+
+	// split it at the top and the bottom of the circle
+	std::vector<double> splits;
+	double tops[2] = {PI / 2, -PI / 2};
+	for(int i = 0; i < 2; i++)
+	{
+		double t = fmod((tops[i] - a0) * dir, 2 * PI);
+		if(t < 0.0)t += 2 * PI;
+		if(t > tiny_angle && t < sweep - tiny_angle)splits.push_back(t);
+	}
+	std::sort(splits.begin(), splits.end());
+
+	double px = x0, py = y0, pt = 0.0;
+	for(std::vector<double>::iterator It = splits.begin(); It != splits.end(); It++)
+	{
+		double t = *It;
+		double a = a0 + dir * t;
+		double x = cx;
+		double y = (sin(a) > 0.0) ? (cy + radius) : (cy - radius);
+		AddArcSpan(dir, px, py, x, y, cx, cy, radius, a0 + dir * (pt + t) / 2);
+		px = x;
+		py = y;
+		pt = t;
+	}
+	AddArcSpan(dir, px, py, x1, y1, cx, cy, radius, a0 + dir * (pt + sweep) / 2);
+}
+
+void CCurveSpans::AddCurve(const CCurve &curve, double cos_a, double sin_a)
+{
+	if(curve.size() < 2)return;
+	int loop_begin = (int)m_spans.size();
+
+	double fx = curve[0].x * cos_a - curve[0].y * sin_a;
+	double fy = curve[0].x * sin_a + curve[0].y * cos_a;
+	double px = fx, py = fy;
+	for(size_t i = 1; i < curve.size(); i++)
+	{
+		const CCurveVertex &v = curve[i];
+		double x = v.x * cos_a - v.y * sin_a;
+		double y = v.x * sin_a + v.y * cos_a;
+		if(v.type == 0)AddLine(px, py, x, y);
+		else AddArc(v.type > 0 ? 1 : -1, px, py, x, y, v.cx * cos_a - v.cy * sin_a, v.cx * sin_a + v.cy * cos_a);
+		px = x;
+		py = y;
+	}
+	AddLine(px, py, fx, fy); // in case it isn't closed
+
+	int loop_end = (int)m_spans.size();
+	for(int i = loop_begin; i < loop_end; i++)
+	{
+		m_spans[i].loop_begin = loop_begin;
+		m_spans[i].loop_end = loop_end;
+	}
+}
+
+bool CCurveSpans::GetBox(double &xmin, double &ymin, double &xmax, double &ymax)const
+{
+	if(m_spans.size() == 0)return false;
+	m_spans[0].GetBox(xmin, ymin, xmax, ymax);
+	for(std::vector<CCurveSpan>::const_iterator It = m_spans.begin(); It != m_spans.end(); It++)
+	{
+		double x0, y0, x1, y1;
+		It->GetBox(x0, y0, x1, y1);
+		if(x0 < xmin)xmin = x0;
+		if(y0 < ymin)ymin = y0;
+		if(x1 > xmax)xmax = x1;
+		if(y1 > ymax)ymax = y1;
+	}
+	return true;
+}
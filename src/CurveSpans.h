@@ -0,0 +1,65 @@
+// CurveSpans.h
+/*
+ * Copyright (c) 2009, Dan Heeks
+ * This program is released under the BSD license. See the file COPYING for
+ * details.
+ */
+
+// The edges of an area, given as closed curves of lines and arcs like libarea's, split into spans which only go one way in y.
+// Arcs are split at their top and bottom, so a horizontal line crosses a span at most once.
+// It has no wx or OpenCascade in it.
+
+#pragma once
+
+#include <vector>
+
+class CCurveVertex
+{
+public:
+	int type; // 0 for a line to x, y from the previous vertex, 1 for an anti-clockwise arc, -1 for a clockwise arc
+	double x, y;
+	double cx, cy; // the centre of an arc
+	CCurveVertex(int type_, double x_, double y_, double cx_, double cy_): type(type_), x(x_), y(y_), cx(cx_), cy(cy_) {}
+};
+
+typedef std::vector<CCurveVertex> CCurve; // the first vertex is the start point
+
+class CCurveSpan
+{
+public:
+	int type; // as in CCurveVertex
+	double sx, sy, ex, ey;
+	double cx, cy, radius;
+	int side; // 1 if an arc is to the right of its centre, -1 if it is to the left
+	double ymin, ymax;
+	int loop_begin, loop_end; // the spans of the curve it is part of
+
+	CCurveSpan(int type_, double sx_, double sy_, double ex_, double ey_, double cx_, double cy_, double radius_, int side_);
+
+	// a vertex exactly on a horizontal line belongs to the span going up from it, or down from it, so the crossings pair up
+	bool Crosses(double y)const{ return ymin <= y && y < ymax; }
+
+	// where it crosses the horizontal line at y
+	double X(double y)const;
+
+	// the nearest distance from the line from x0, y0 to x1, y1
+	double Distance(double x0, double y0, double x1, double y1)const;
+
+	void GetBox(double &xmin, double &ymin, double &xmax, double &ymax)const;
+};
+
+class CCurveSpans
+{
+public:
+	std::vector<CCurveSpan> m_spans;
+
+	// adds the curve, rotated by cos_a and sin_a, closing it if it isn't closed
+	void AddCurve(const CCurve &curve, double cos_a = 1.0, double sin_a = 0.0);
+
+	bool GetBox(double &xmin, double &ymin, double &xmax, double &ymax)const; // false if there are no spans
+
+private:
+	void AddLine(double x0, double y0, double x1, double y1);
+	void AddArc(int dir, double x0, double y0, double x1, double y1, double cx, double cy);
+	void AddArcSpan(int dir, double x0, double y0, double x1, double y1, double cx, double cy, double radius, double mid_angle);
+};
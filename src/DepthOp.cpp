@@ -231,6 +231,19 @@ Python CDepthOp::AppendTextToProgram()
     return(python);
 }
 
+// the depth_params which AppendTextToProgram writes
+CNCDepthParams CDepthOp::GetNCDepthParams()
+{
+    double scale = Length::Conversion(theApp.m_program->m_units, UnitTypeMillimeter);
+    return CNCDepthParams(PythonNumber(m_depth_op_params.m_clearance_height / scale),
+        PythonNumber(m_depth_op_params.m_rapid_safety_space / scale),
+        PythonNumber(m_depth_op_params.m_start_depth / scale),
+        PythonNumber(m_depth_op_params.m_step_down / scale),
+        PythonNumber(m_depth_op_params.m_z_finish_depth / scale),
+        PythonNumber(m_depth_op_params.m_z_thru_depth / scale),
+        PythonNumber(m_depth_op_params.m_final_depth / scale));
+}
+
 void CDepthOp::GetTools(std::list<Tool*>* t_list, const wxPoint* p)
 {
     CSpeedOp::GetTools( t_list, p );
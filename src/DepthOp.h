@@ -11,6 +11,7 @@
 #define DEPTH_OP_HEADER
 
 #include "SpeedOp.h"
+#include "NCCreator.h"
 #include <list>
 
 class CDepthOp;
@@ -58,6 +59,7 @@ public:
 	void WriteDefaultValues();
 	void ReadDefaultValues();
 	Python AppendTextToProgram();
+	CNCDepthParams GetNCDepthParams();
 	void GetTools(std::list<Tool*>* t_list, const wxPoint* p);
 	void glCommands(bool select, bool marked, bool no_color);
 
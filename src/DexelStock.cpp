@@ -0,0 +1,389 @@
+// DexelStock.cpp
+/*
+ * Copyright (c) 2009, Dan Heeks
+ * This program is released under the BSD license. See the file COPYING for
+ * details.
+ */
+
+#include "stdafx.h"
+#include "DexelStock.h"
+
+#include <math.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#ifndef PI
+#define PI 3.14159265358979323846
+#endif
+
+static const int tool_profile_samples = 64;
+static const size_t segments_per_batch = 65536;
+
+CDexelTool::CDexelTool(double radius, double flat_radius, double corner_radius, double cutting_edge_angle)
+{
+	m_radius = (radius > 0.0) ? radius : 0.001;
+	m_dr = m_radius / tool_profile_samples;
+	m_heights.resize(tool_profile_samples + 1);
+
+	double tan_angle = tan(cutting_edge_angle * PI / 180.0);
+	double rc = (corner_radius < m_radius) ? corner_radius : m_radius;
+	for(int i = 0; i <= tool_profile_samples; i++)
+	{
+		double r = i * m_dr;
+		double h = 0.0;
+		if(cutting_edge_angle > 0.0 && cutting_edge_angle < 90.0)
+		{
+			// chamfer mill, engraving tool or drill point
+			if(r > flat_radius)h = (r - flat_radius) / tan_angle;
+		}
+		else if(rc > 0.0)
+		{
+			// ball end mill or bull nose
+			double r0 = m_radius - rc;
+			if(r > r0)
+			{
+				double d = r - r0;
+				h = rc - sqrt((rc * rc > d * d) ? (rc * rc - d * d) : 0.0);
+			}
+		}
+		m_heights[i] = h;
+	}
+}
+
+double CDexelTool::Height(double r)const
+{
+	double f = r / m_dr;
+	int i = (int)f;
+	if(i >= tool_profile_samples)return m_heights.back();
+	f -= i;
+	return m_heights[i] + (m_heights[i + 1] - m_heights[i]) * f;
+}
+
+CDexelStock::CDexelStock(const double* box, double cell_size)
+{
+	m_cell_size = cell_size;
+	m_x0 = box[0];
+	m_y0 = box[1];
+	m_nx = (size_t)ceil((box[3] - box[0]) / cell_size);
+	m_ny = (size_t)ceil((box[4] - box[1]) / cell_size);
+	if(m_nx < 1)m_nx = 1;
+	if(m_ny < 1)m_ny = 1;
+	m_top.resize(m_nx * m_ny, 0.0f);
+	m_bottom.resize(m_nx * m_ny, 0.0f);
+}
+
+void CDexelStock::AddBlock(const double* box)
+{
+	for(size_t iy = 0; iy < m_ny; iy++)
+	{
+		double y = m_y0 + (iy + 0.5) * m_cell_size;
+		if(y < box[1] || y > box[4])continue;
+		for(size_t ix = 0; ix < m_nx; ix++)
+		{
+			double x = m_x0 + (ix + 0.5) * m_cell_size;
+			if(x < box[0] || x > box[3])continue;
+			size_t i = iy * m_nx + ix;
+			if(m_top[i] <= m_bottom[i])
+			{
+				m_top[i] = (float)box[5];
+				m_bottom[i] = (float)box[2];
+			}
+			else
+			{
+				if(box[5] > m_top[i])m_top[i] = (float)box[5];
+				if(box[2] < m_bottom[i])m_bottom[i] = (float)box[2];
+			}
+		}
+	}
+}
+
+double CDexelStock::CutCell(size_t ix, size_t iy, const Segment &segment)
+{
+	size_t i = iy * m_nx + ix;
+	float &top = m_top[i];
+	float bottom = m_bottom[i];
+	if(top <= bottom)return 0.0; // no material left here
+
+	const double* p0 = segment.m_p0;
+	const double* p1 = segment.m_p1;
+	const CDexelTool &tool = *segment.m_tool;
+	double radius = tool.Radius();
+
+	double cx = m_x0 + (ix + 0.5) * m_cell_size;
+	double cy = m_y0 + (iy + 0.5) * m_cell_size;
+	double vx = p1[0] - p0[0], vy = p1[1] - p0[1];
+	double wx = p0[0] - cx, wy = p0[1] - cy;
+	double vv = vx * vx + vy * vy;
+
+	// lowest height of the bottom of the tool over the centre of the cell
+	double z;
+	if(vv < 1e-18)
+	{
+		// a plunge, or a move too short to matter
+		double d = sqrt(wx * wx + wy * wy);
+		if(d > radius)return 0.0;
+		z = ((p0[2] < p1[2]) ? p0[2] : p1[2]) + tool.Height(d);
+	}
+	else
+	{
+		double t = -(wx * vx + wy * vy) / vv;
+		if(t < 0.0)t = 0.0;
+		if(t > 1.0)t = 1.0;
+		double dx = wx + t * vx, dy = wy + t * vy;
+		double d_squared = dx * dx + dy * dy;
+		if(d_squared > radius * radius)return 0.0;
+
+		double dz = p1[2] - p0[2];
+		if(fabs(dz) < 1e-9)
+		{
+			// the nearest point along the move is the lowest
+			z = p0[2] + tool.Height(sqrt(d_squared));
+		}
+		else
+		{
+			// try points along the part of the move where the tool is over the cell
+			double b = (wx * vx + wy * vy) / vv;
+			double c = (wx * wx + wy * wy - radius * radius) / vv;
+			double disc = b * b - c;
+			if(disc < 0.0)disc = 0.0;
+			double ta = -b - sqrt(disc), tb = -b + sqrt(disc);
+			if(ta < 0.0)ta = 0.0;
+			if(tb > 1.0)tb = 1.0;
+			if(tb < ta)tb = ta;
+			int n = (int)ceil((tb - ta) * sqrt(vv) * 4.0 / m_cell_size);
+			if(n < 1)n = 1;
+			z = 1e300;
+			for(int j = 0; j <= n; j++)
+			{
+				double tj = ta + (tb - ta) * j / n;
+				double ex = wx + tj * vx, ey = wy + tj * vy;
+				double dj = sqrt(ex * ex + ey * ey);
+				if(dj > radius)continue;
+				double zj = p0[2] + tj * dz + tool.Height(dj);
+				if(zj < z)z = zj;
+			}
+			if(z == 1e300)return 0.0;
+		}
+	}
+
+	if(z >= top)return 0.0;
+
+	double removed = top - ((z > bottom) ? z : bottom);
+	top = (z > bottom) ? (float)z : bottom;
+	return removed * m_cell_size * m_cell_size;
+}
+
+void CDexelStock::CutSegments(const std::vector<Segment> &segments, size_t row0, size_t row1, std::vector<double> &volumes)
+{
+	double band_ymin = m_y0 + row0 * m_cell_size;
+	double band_ymax = m_y0 + row1 * m_cell_size;
+
+	for(size_t s = 0; s < segments.size(); s++)
+	{
+		const Segment &segment = segments[s];
+		if(segment.m_ymax < band_ymin || segment.m_ymin > band_ymax)continue;
+
+		double radius = segment.m_tool->Radius();
+		double xmin = ((segment.m_p0[0] < segment.m_p1[0]) ? segment.m_p0[0] : segment.m_p1[0]) - radius;
+		double xmax = ((segment.m_p0[0] > segment.m_p1[0]) ? segment.m_p0[0] : segment.m_p1[0]) + radius;
+
+		long ix0 = (long)floor((xmin - m_x0) / m_cell_size);
+		long ix1 = (long)floor((xmax - m_x0) / m_cell_size);
+		long iy0 = (long)floor((segment.m_ymin - m_y0) / m_cell_size);
+		long iy1 = (long)floor((segment.m_ymax - m_y0) / m_cell_size);
+		if(ix0 < 0)ix0 = 0;
+		if(ix1 >= (long)m_nx)ix1 = (long)m_nx - 1;
+		if(iy0 < (long)row0)iy0 = (long)row0;
+		if(iy1 >= (long)row1)iy1 = (long)row1 - 1;
+
+		double volume = 0.0;
+		for(long iy = iy0; iy <= iy1; iy++)
+		{
+			for(long ix = ix0; ix <= ix1; ix++)
+			{
+				volume += CutCell(ix, iy, segment);
+			}
+		}
+		volumes[s] += volume;
+	}
+}
+
+void CDexelStock::Cut(const CNCMoveBuffer &moves, const std::map<int, CDexelTool> &tools, std::vector<double>* volumes)
+{
+	if(volumes)volumes->assign(moves.size(), 0.0);
+
+	// split the moves into straight segments, with arcs split finely enough for the cells
+	std::vector<Segment> segments;
+	std::vector<double> arc_points;
+	for(size_t i = 1; i < moves.size(); i++)
+	{
+		std::map<int, CDexelTool>::const_iterator FindIt = tools.find(moves.m_tool_number[i]);
+		if(FindIt == tools.end())continue;
+
+		const double* start = moves.StartPoint(i);
+		arc_points.clear();
+		if(moves.Type(i) == CNCMoveBuffer::eArc)
+		{
+			const double* c = moves.ArcCentre(i);
+			double r = sqrt(c[0] * c[0] + c[1] * c[1]);
+			int n = (int)ceil(2 * PI * r / m_cell_size);
+			if(n < 4)n = 4;
+			if(n > 360)n = 360;
+			moves.ArcPoints(i, n, arc_points);
+		}
+		else
+		{
+			arc_points.insert(arc_points.end(), moves.EndPoint(i), moves.EndPoint(i) + 3);
+		}
+
+		const double* p0 = start;
+		for(size_t j = 0; j < arc_points.size(); j += 3)
+		{
+			Segment segment;
+			memcpy(segment.m_p0, p0, 3 * sizeof(double));
+			memcpy(segment.m_p1, &arc_points[j], 3 * sizeof(double));
+			segment.m_move = i;
+			segment.m_tool = &FindIt->second;
+			double radius = segment.m_tool->Radius();
+			segment.m_ymin = ((segment.m_p0[1] < segment.m_p1[1]) ? segment.m_p0[1] : segment.m_p1[1]) - radius;
+			segment.m_ymax = ((segment.m_p0[1] > segment.m_p1[1]) ? segment.m_p0[1] : segment.m_p1[1]) + radius;
+			segments.push_back(segment);
+			p0 = segment.m_p1;
+		}
+	}
+
+	// several bands per thread, so a thread which finishes early can take another band
+	int number_of_bands = 1;
+#ifdef _OPENMP
+	number_of_bands = omp_get_max_threads() * 4;
+#endif
+	if(number_of_bands > (int)m_ny)number_of_bands = (int)m_ny;
+
+	std::vector< std::vector<double> > band_volumes(number_of_bands);
+	std::vector<Segment> batch;
+	for(size_t first = 0; first < segments.size(); first += segments_per_batch)
+	{
+		size_t last = first + segments_per_batch;
+		if(last > segments.size())last = segments.size();
+		batch.assign(segments.begin() + first, segments.begin() + last);
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+		for(int band = 0; band < number_of_bands; band++)
+		{
+			band_volumes[band].assign(batch.size(), 0.0);
+			size_t row0 = m_ny * band / number_of_bands;
+			size_t row1 = m_ny * (band + 1) / number_of_bands;
+			CutSegments(batch, row0, row1, band_volumes[band]);
+		}
+
+		if(volumes)
+		{
+			for(int band = 0; band < number_of_bands; band++)
+			{
+				for(size_t s = 0; s < batch.size(); s++)(*volumes)[batch[s].m_move] += band_volumes[band][s];
+			}
+		}
+	}
+}
+
+double CDexelStock::Volume(void)const
+{
+	double volume = 0.0;
+	for(size_t i = 0; i < m_top.size(); i++)
+	{
+		if(m_top[i] > m_bottom[i])volume += m_top[i] - m_bottom[i];
+	}
+	return volume * m_cell_size * m_cell_size;
+}
+
+static void AddQuad(std::vector<float> &triangles, std::vector<float> &normals, const double* p, const double* n)
+{
+	// p is four corners, anti-clockwise looking against the normal
+	static const int corners[6] = {0, 1, 2, 0, 2, 3};
+	for(int i = 0; i < 6; i++)
+	{
+		for(int k = 0; k < 3; k++)triangles.push_back((float)p[corners[i] * 3 + k]);
+	}
+	for(int t = 0; t < 2; t++)
+	{
+		for(int k = 0; k < 3; k++)normals.push_back((float)n[k]);
+	}
+}
+
+void CDexelStock::GetTriangles(std::vector<float> &triangles, std::vector<float> &normals)const
+{
+	static const int side_dx[4] = {1, 0, -1, 0};
+	static const int side_dy[4] = {0, 1, 0, -1};
+
+	for(size_t iy = 0; iy < m_ny; iy++)
+	{
+		for(size_t ix = 0; ix < m_nx; ix++)
+		{
+			size_t i = iy * m_nx + ix;
+			double top = m_top[i], bottom = m_bottom[i];
+			if(top <= bottom)continue;
+
+			double x0 = m_x0 + ix * m_cell_size, x1 = x0 + m_cell_size;
+			double y0 = m_y0 + iy * m_cell_size, y1 = y0 + m_cell_size;
+
+			double up[3] = {0, 0, 1};
+			double top_quad[12] = {x0, y0, top, x1, y0, top, x1, y1, top, x0, y1, top};
+			AddQuad(triangles, normals, top_quad, up);
+
+			double down[3] = {0, 0, -1};
+			double bottom_quad[12] = {x0, y0, bottom, x0, y1, bottom, x1, y1, bottom, x1, y0, bottom};
+			AddQuad(triangles, normals, bottom_quad, down);
+
+			// the walls, where the next cell doesn't cover this one's sides
+			for(int side = 0; side < 4; side++)
+			{
+				long nx = (long)ix + side_dx[side];
+				long ny = (long)iy + side_dy[side];
+				double exposed[2][2];
+				int number_exposed = 0;
+				if(nx < 0 || ny < 0 || nx >= (long)m_nx || ny >= (long)m_ny || m_top[ny * m_nx + nx] <= m_bottom[ny * m_nx + nx])
+				{
+					exposed[0][0] = bottom;
+					exposed[0][1] = top;
+					number_exposed = 1;
+				}
+				else
+				{
+					double next_top = m_top[ny * m_nx + nx], next_bottom = m_bottom[ny * m_nx + nx];
+					if(next_bottom > bottom)
+					{
+						exposed[number_exposed][0] = bottom;
+						exposed[number_exposed][1] = (next_bottom < top) ? next_bottom : top;
+						number_exposed++;
+					}
+					if(next_top < top)
+					{
+						exposed[number_exposed][0] = (next_top > bottom) ? next_top : bottom;
+						exposed[number_exposed][1] = top;
+						number_exposed++;
+					}
+				}
+
+				for(int e = 0; e < number_exposed; e++)
+				{
+					double z0 = exposed[e][0], z1 = exposed[e][1];
+					double n[3] = {(double)side_dx[side], (double)side_dy[side], 0};
+					double a[2], b[2]; // the wall's ends, anti-clockwise seen from outside
+					switch(side)
+					{
+					case 0: a[0] = x1; a[1] = y0; b[0] = x1; b[1] = y1; break;
+					case 1: a[0] = x1; a[1] = y1; b[0] = x0; b[1] = y1; break;
+					case 2: a[0] = x0; a[1] = y1; b[0] = x0; b[1] = y0; break;
+					default: a[0] = x0; a[1] = y0; b[0] = x1; b[1] = y0; break;
+					}
+					double wall[12] = {a[0], a[1], z0, b[0], b[1], z0, b[0], b[1], z1, a[0], a[1], z1};
+					AddQuad(triangles, normals, wall, n);
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,80 @@
+// DexelStock.h
+/*
+ * Copyright (c) 2009, Dan Heeks
+ * This program is released under the BSD license. See the file COPYING for
+ * details.
+ */
+
+// Material removal simulation, with the stock held as a grid of dexels.
+// Each cell of the grid, looking down Z, has one column of material, from a bottom height to a top height.
+// The tools cut down the tops of the columns, as they are swept along the moves of a CNCMoveBuffer.
+// It has no wx or OpenCascade in it, so it can be used without the user interface.
+// If the compiler has OpenMP, the grid is split into bands of rows, one for each thread.
+
+#pragma once
+
+#include "NCMoveBuffer.h"
+
+#include <vector>
+#include <map>
+#include <cstddef>
+
+// the shape of the bottom of a milling cutter, spinning around its axis
+class CDexelTool
+{
+	double m_radius;
+	double m_dr;
+	std::vector<double> m_heights; // height above the tip, every m_dr out from the centre
+
+public:
+	CDexelTool(void): m_radius(0.0), m_dr(1.0) {}
+
+	// cutting_edge_angle is in degrees, from the tool's axis; 0 for an end mill or ball end mill
+	CDexelTool(double radius, double flat_radius, double corner_radius, double cutting_edge_angle);
+
+	double Radius(void)const { return m_radius; }
+
+	// height of the bottom of the tool above its tip, at r from its axis; r must be no more than Radius()
+	double Height(double r)const;
+};
+
+class CDexelStock
+{
+public:
+	// an empty stock, with cells of the given size covering the box; box is xmin, ymin, zmin, xmax, ymax, zmax
+	CDexelStock(const double* box, double cell_size);
+
+	// adds a block of material
+	void AddBlock(const double* box);
+
+	// Removes the material swept by the moves, in order. tools are by tool number; moves with any other tool are skipped.
+	// If volumes isn't NULL, it is set to the volume removed by each move.
+	void Cut(const CNCMoveBuffer &moves, const std::map<int, CDexelTool> &tools, std::vector<double>* volumes = NULL);
+
+	double Volume(void)const;
+
+	// triangles, as 9 floats each, with a normal, as 3 floats, for each triangle, for the surface of the material
+	void GetTriangles(std::vector<float> &triangles, std::vector<float> &normals)const;
+
+	size_t NumberOfCellsX(void)const { return m_nx; }
+	size_t NumberOfCellsY(void)const { return m_ny; }
+
+private:
+	double m_x0, m_y0; // the corner of the grid
+	double m_cell_size;
+	size_t m_nx, m_ny;
+	std::vector<float> m_top, m_bottom; // m_top <= m_bottom for an empty cell
+
+	class Segment
+	{
+	public:
+		double m_p0[3], m_p1[3];
+		size_t m_move;
+		const CDexelTool* m_tool;
+		double m_ymin, m_ymax; // extent of the swept area
+	};
+
+	// each thread cuts its own band of rows, so the threads never change the same cells
+	void CutSegments(const std::vector<Segment> &segments, size_t row0, size_t row1, std::vector<double> &volumes);
+	double CutCell(size_t ix, size_t iy, const Segment &segment);
+};
@@ -19,6 +19,8 @@
 #include "Program.h"
 #include "DrillingDlg.h"
 #include "Tools.h"
+#include "PointOrder.h"
+#include "Pattern.h"
 
 #include <sstream>
 #include <iomanip>
@@ -125,6 +127,65 @@ const wxBitmap &CDrilling::GetIcon()
 	return *icon;
 }
 
+void CDrilling::GetLocations(std::vector<CNCPoint> &locations, double* length_before_sorting, double* length_after_sorting)
+{
+    locations.clear();
+    std::list<gp_Trsf> matrices;
+    CPattern* pattern = (m_pattern == 0) ? NULL : (CPattern*)heeksCAD->GetIDObject(PatternType, m_pattern);
+    if(pattern)pattern->GetMatrices(matrices);
+    else matrices.push_back(gp_Trsf());
+
+    // The pattern only moves the holes, so they are all drilled in one cycle, instead of a cycle for each copy.
+    for(std::list<gp_Trsf>::iterator MIt = matrices.begin(); MIt != matrices.end(); MIt++)
+    {
+        for (std::list<int>::iterator It = m_points.begin(); It != m_points.end(); It++)
+        {
+            HeeksObj* object = heeksCAD->GetIDObject(PointType, *It);
+            if(object == NULL)continue;
+            double p[3];
+            if(object->GetEndPoint(p) == false)
+                continue;
+            locations.push_back(CNCPoint(gp_Pnt(p[0], p[1], p[2]).Transformed(*MIt)));
+        } // End for
+    } // End for
+
+    if((m_params.m_sort_drilling_locations == 0) || (locations.size() < 2))return;
+
+    // Start from where the last operation finished, if that's known, or else from the first point, as it was given.
+    CPointOrder::Point start(locations.front().X(), locations.front().Y());
+    if(theApp.m_location_known)start = CPointOrder::Point(theApp.m_location.X(), theApp.m_location.Y());
+    std::vector<CPointOrder::Point> points;
+    for (std::vector<CNCPoint>::iterator It = locations.begin(); It != locations.end(); It++)
+    {
+        points.push_back(CPointOrder::Point(It->X(), It->Y()));
+    }
+
+    bool same = (start.x == m_sorted_from.x && start.y == m_sorted_from.y && points.size() == m_sorted_points.size());
+    for(size_t i = 0; same && i < points.size(); i++)
+    {
+        same = (points[i].x == m_sorted_points[i].x && points[i].y == m_sorted_points[i].y);
+    }
+    if(!same)
+    {
+        m_sorted_from = start;
+        m_sorted_points = points;
+        CPointOrder::Order(start, points, m_sorted_order);
+    }
+    const std::vector<int> &order = m_sorted_order;
+
+    if(length_before_sorting)
+    {
+        std::vector<int> existing_order;
+        for(int i = 0; i < (int)points.size(); i++)existing_order.push_back(i);
+        *length_before_sorting = CPointOrder::Length(start, points, existing_order);
+    }
+    if(length_after_sorting)*length_after_sorting = CPointOrder::Length(start, points, order);
+
+    std::vector<CNCPoint> sorted;
+    for(std::vector<int>::const_iterator It = order.begin(); It != order.end(); It++)sorted.push_back(locations[*It]);
+    locations.swap(sorted);
+}
+
 /**
 	This method is called when the CAD operator presses the Python button.  This method generates
 	Python source code whose job will be to generate RS-274 GCode.  It's done in two steps so that
@@ -136,18 +197,29 @@ Python CDrilling::AppendTextToProgram()
 
     python << CDepthOp::AppendTextToProgram();   // Set any private fixtures and change tools (if necessary)
 
-    for (std::list<int>::iterator It = m_points.begin(); It != m_points.end(); It++)
+    double length_before_sorting = 0.0, length_after_sorting = 0.0;
+    std::vector<CNCPoint> locations;
+    GetLocations(locations, &length_before_sorting, &length_after_sorting);
+
+    double scale = Length::Conversion(theApp.m_program->m_units, UnitTypeMillimeter);
+    if(length_after_sorting < length_before_sorting)
     {
-        HeeksObj* object = heeksCAD->GetIDObject(PointType, *It);
-        if(object == NULL)continue;
-        double p[3];
-        if(object->GetEndPoint(p) == false)
-            continue;
-
-        double scale = Length::Conversion(theApp.m_program->m_units, UnitTypeMillimeter);
-        python << _T("drill(")
-                << _T("x=") << p[0] / scale << _T(", ")
-                << _T("y=") << p[1] / scale << _T(", ")
+        python << _T("# rapid distance between holes; ") << length_before_sorting / scale << _T(" in the given order, ") << length_after_sorting / scale << _T(" sorted\n");
+        wxLogMessage(_T("%s: rapid distance between holes %g mm in the given order, %g mm sorted"), GetTitle(), length_before_sorting, length_after_sorting);
+    }
+
+    // One drill call, in a loop over all the holes, is much less python than a call for each hole.
+    if(locations.size() > 0)
+    {
+        python << _T("for x, y in [\n");
+        for (std::vector<CNCPoint>::iterator It = locations.begin(); It != locations.end(); It++)
+        {
+            python << _T("    (") << It->X() / scale << _T(", ") << It->Y() / scale << _T("),\n");
+        }
+        python << _T("    ]:\n");
+        python << _T("    drill(")
+                << _T("x=x, ")
+                << _T("y=y, ")
                 << _T("dwell=") << m_params.m_dwell << _T(", ")
                 << _T("depthparams = depthparams, ")
                 << _T("retract_mode=") << m_params.m_retract_mode << _T(", ")
@@ -155,14 +227,44 @@ Python CDrilling::AppendTextToProgram()
                 << _T("internal_coolant_on=") << m_params.m_internal_coolant_on << _T(", ")
                 << _T("rapid_to_clearance=") << m_params.m_rapid_to_clearance
                 << _T(")\n");
-        theApp.m_location = make_point(p); // Remember where we are.
-	} // End for
+        theApp.m_location = locations.back(); // Remember where we are.
+        theApp.m_location_known = true;
+    } // End if - then
 
 	python << _T("end_canned_cycle()\n");
 
 	return(python);
 }
 
+void CDrilling::GetMachinedObjects(std::list<HeeksObj*> &objects)
+{
+    for (std::list<int>::iterator It = m_points.begin(); It != m_points.end(); It++)
+    {
+        HeeksObj* object = heeksCAD->GetIDObject(PointType, *It);
+        if(object != NULL)objects.push_back(object);
+    } // End for
+}
+
+void CDrilling::WriteNC(CNCCreator& creator)
+{
+    CDepthOp::WriteNC(creator);   // Set any private fixtures and change tools (if necessary)
+    CNCDepthParams depthparams = GetNCDepthParams();
+
+    std::vector<CNCPoint> locations;
+    GetLocations(locations);
+
+    double scale = Length::Conversion(theApp.m_program->m_units, UnitTypeMillimeter);
+    for (std::vector<CNCPoint>::iterator It = locations.begin(); It != locations.end(); It++)
+    {
+        creator.drill(PythonNumber(It->X() / scale), PythonNumber(It->Y() / scale), PythonNumber(m_params.m_dwell), depthparams,
+            (int)m_params.m_retract_mode, (int)m_params.m_spindle_mode, m_params.m_internal_coolant_on, m_params.m_rapid_to_clearance);
+        theApp.m_location = *It; // Remember where we are.
+        theApp.m_location_known = true;
+    } // End for
+
+    creator.end_canned_cycle();
+}
+
 
 /**
 	This routine generates a list of coordinates around the circumference of a circle.  It's just used
@@ -363,7 +465,7 @@ void CDrilling::CopyFrom(const HeeksObj* object)
 }
 
 CDrilling::CDrilling()
- : CDepthOp(0, DrillingType), m_params(this)
+ : CDepthOp(0, DrillingType), m_sorted_from(0.0, 0.0), m_params(this)
 {
 }
 
@@ -371,14 +473,14 @@ CDrilling::CDrilling()
 CDrilling::CDrilling(	const std::list<int> &points,
         const int tool_number,
         const double depth )
- : CDepthOp(tool_number, DrillingType), m_points(points), m_params(this)
+ : CDepthOp(tool_number, DrillingType), m_sorted_from(0.0, 0.0), m_points(points), m_params(this)
 {
     m_params.set_initial_values(depth, tool_number);
 }
 
 
 CDrilling::CDrilling( const CDrilling & rhs )
- : CDepthOp( rhs ), m_params(this)
+ : CDepthOp( rhs ), m_sorted_from(0.0, 0.0), m_params(this)
 {
     m_points = rhs.m_points;
 	m_params = rhs.m_params;
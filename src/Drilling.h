@@ -14,6 +14,7 @@
 #include <list>
 #include <vector>
 #include "CNCPoint.h"
+#include "PointOrder.h"
 
 class CDrilling;
 
@@ -61,6 +62,11 @@ public:
 	std::list< CNCPoint > PointsAround( const CNCPoint & origin, const double radius, const unsigned int numPoints ) const;
 	std::list< CNCPoint > DrillBitVertices( const CNCPoint & origin, const double radius, const double length ) const;
 
+	// the last sort, which is used again while the points and the start are the same, as the python program and the NC writer both want it
+	CPointOrder::Point m_sorted_from;
+	std::vector<CPointOrder::Point> m_sorted_points;
+	std::vector<int> m_sorted_order;
+
 public:
 
 	std::list<int> m_points;
@@ -91,6 +97,14 @@ public:
 	// program whose job is to generate RS-274 GCode.
 	Python AppendTextToProgram();
 
+	// The points to drill, with a copy for each position of the pattern, in the order to drill them. They are sorted, if m_sort_drilling_locations is set, to make the rapid moves short.
+	void GetLocations(std::vector<CNCPoint> &locations, double* length_before_sorting = NULL, double* length_after_sorting = NULL);
+	bool CanWriteNC(){return true;}
+	bool ExpandsPattern(){return true;}
+	bool SetsLocation(){return true;}
+	void WriteNC(CNCCreator& creator);
+	void GetMachinedObjects(std::list<HeeksObj*> &objects);
+
 	void AddPoint(int i){m_points.push_back(i);}
 
 	static HeeksObj* ReadFromXMLElement(TiXmlElement* pElem);
@@ -19,9 +19,16 @@
 #include "stdafx.h"
 #include "DropCutter.h"
 #include "GTri.h"
-
 
-Cutter::Cutter(double Rset, double rset)
+// the batch loops are written so the compiler can vectorize them; OpenMP 4 can be told to
+#if defined(_OPENMP) && _OPENMP >= 201307
+#define BATCH_LOOP _Pragma("omp simd")
+#else
+#define BATCH_LOOP
+#endif
+
+
+Cutter::Cutter(double Rset, double rset, double tolerance_set)
 {
 	if (Rset > 0)
 	{
@@ -29,7 +36,7 @@ Cutter::Cutter(double Rset, double rset)
 	}
 	else
 	{
-		wxMessageBox(_T("Cutter: ERROR R<0!"));
+		// bad values are corrected, rather than shown in a message box, as the tests can be run on worker threads
 		R = 1;
 	}
 
@@ -39,16 +46,16 @@ Cutter::Cutter(double Rset, double rset)
 	}
 	else
 	{
-		// ERROR!
-		// Throw an exception or something
-		wxMessageBox(_T("Cutter: ERROR r<0 or r>R!"));
 		r = 0;
 	}
+
+	tolerance = tolerance_set;
 }
 
 // static member functions
 double DropCutter::VertexTest(const Cutter &c, const double *e, const double *p)
 {
+	const double tolerance = c.tolerance;
 	// c.R and c.r define the cutter
 	// e.x and e.y is the xy-position of the cutter (e.z is ignored)
 	// p is the vertex tested against
@@ -56,12 +63,12 @@ double DropCutter::VertexTest(const Cutter &c, const double *e, const double *p)
 	// q is the distance along xy-plane from e to vertex
 	double q = sqrt(pow(e[0] - p[0], 2) + pow((e[1] - p[1]), 2));
 
-	if (q > c.R + heeksCAD->GetTolerance())
+	if (q > c.R + tolerance)
 	{
 		// vertex is outside cutter. no need to do anything!
 		return -10000000.0;
 	}
-	else if (q <= (c.R - c.r) + heeksCAD->GetTolerance())
+	else if (q <= (c.R - c.r) + tolerance)
 	{
 		// vertex is in the cylindical/flat part of the cutter
 		return p[2];
@@ -78,6 +85,7 @@ double DropCutter::VertexTest(const Cutter &c, const double *e, const double *p)
 
 double DropCutter::FacetTest(const Cutter &cu, const double *e, const GTri &t)
 {
+	const double tolerance = cu.tolerance;
 	// local copy of the surface normal
 
 	//t.calculate_normal(); // don't trust the pre-calculated normal! calculate it separately here.
@@ -105,7 +113,7 @@ double DropCutter::FacetTest(const Cutter &cu, const double *e, const GTri &t)
 
 	// the z-direction normal is a special case (?required?)
 	// in debug phase, see if this is a useful case!
-	if ((fabs(a) < heeksCAD->GetTolerance()) && (fabs(b) < heeksCAD->GetTolerance()))
+	if ((fabs(a) < tolerance) && (fabs(b) < tolerance))
 	{
 		// System.Console.WriteLine("facet-test:z-dir normal case!");
 		cc[0] = e[0];
@@ -155,23 +163,17 @@ double DropCutter::FacetTest(const Cutter &cu, const double *e, const GTri &t)
 
 	// check that CC lies in plane:
 	// a*rc(1)+b*rc(2)+c*rc(3)+d
-	double test = a * cc[0] + b * cc[1] + c * cc[2] + d;
-	if (test > 0.000001)
-		wxMessageBox(_T("FacetTest ERROR! CC point not in plane"));
+	// ( the tests are done on many threads at once, so they mustn't show message boxes )
 
 	if (isinside(t, cc))
 	{
-		if (fabs(zf) > 100000)
-		{
-			wxMessageBox(wxString::Format(_T("serious problem... at %lf,%lf"), e[0], e[1]));
-		}
 		return zf;
 	}
 	else
 		return -10000000.0;
 }
 
-static bool isinrange(double start, double end, double x)
+static bool isinrange(double start, double end, double x, double tolerance)
 {
 	// order input
 	double s_tmp = start;
@@ -182,7 +184,7 @@ static bool isinrange(double start, double end, double x)
 		end = s_tmp;
 	}
 
-	if ((x >= start - heeksCAD->GetTolerance()) && (x <= end + heeksCAD->GetTolerance()))
+	if ((x >= start - tolerance) && (x <= end + tolerance))
 		return true;
 	else
 		return false;
@@ -190,6 +192,7 @@ static bool isinrange(double start, double end, double x)
 
 double DropCutter::EdgeTest(const Cutter &cu, const double *e, const double *p1, const double *p2)
 {
+	const double tolerance = cu.tolerance;
 	// contact cutter against edge from p1 to p2
 
 	// translate segment so that cutter is at (0,0)
@@ -230,23 +233,21 @@ double DropCutter::EdgeTest(const Cutter &cu, const double *e, const double *p1,
 
 	if (fabs(start[1]-end[1])>0.0000000001)
 	{
-		wxMessageBox(wxString::Format(_T("EdgeTest ERROR! (start.y - end.y) = %lf"), start[1]-end[1]));
+		// EdgeTest ERROR! the rotated segment should be parallel to the X axis
 		return -10000000.0;
 	}
 
 	double l = -start[1]; // distance from cutter to edge
-	if (l < -heeksCAD->GetTolerance())
-		wxMessageBox(_T("EdgeTest ERROR! l<0 !"));
 
 	// System.Console.WriteLine("l=" + l+" start.y="+start.y+" end.y="+end.y);
 
 
 	// now we have two different algorithms depending on the cutter:
-	if (fabs(cu.r) < heeksCAD->GetTolerance())
+	if (fabs(cu.r) < tolerance)
 	{
 		// this is the flat endmill case
 		// it is easier and faster than the general case, so we handle it separately
-		if (l > cu.R + heeksCAD->GetTolerance()) // edge is outside of the cutter
+		if (l > cu.R + tolerance) // edge is outside of the cutter
 			return -10000000.0;
 		else // we are inside the cutter
 		{
@@ -272,9 +273,9 @@ double DropCutter::EdgeTest(const Cutter &cu, const double *e, const double *p1,
 			}
 
 			// now that we have a CC point, check if it's in the edge
-			if ((start[0] > xc + heeksCAD->GetTolerance()) && (xc + heeksCAD->GetTolerance()< end[0]))
+			if ((start[0] > xc + tolerance) && (xc + tolerance< end[0]))
 				return -10000000.0;
-			else if ((end[0] < xc - heeksCAD->GetTolerance()) && (xc + heeksCAD->GetTolerance() > start[0]))
+			else if ((end[0] < xc - tolerance) && (xc + tolerance > start[0]))
 				return -10000000.0;
 			else
 				return zc;
@@ -291,9 +292,9 @@ double DropCutter::EdgeTest(const Cutter &cu, const double *e, const double *p1,
 
 		double xd=0, w=0, h=0, xd1=0, xd2=0, xc=0 , ze=0, zc=0;
 
-		if (l > cu.R + heeksCAD->GetTolerance()) // edge is outside of the cutter
+		if (l > cu.R + tolerance) // edge is outside of the cutter
 			return -10000000.0;
-		else if (((cu.R-cu.r)<l - heeksCAD->GetTolerance())&&(l<=cu.R + heeksCAD->GetTolerance()))
+		else if (((cu.R-cu.r)<l - tolerance)&&(l<=cu.R + tolerance))
 		{    // toroidal case
 			xd=0; // center of ellipse
 			w=sqrt(pow(cu.R,2)-pow(l,2)); // width of ellipse
@@ -310,9 +311,9 @@ double DropCutter::EdgeTest(const Cutter &cu, const double *e, const double *p1,
 
 		// now there is a special case where the theta calculation will fail if
 		// the segment is horziontal, i.e. start.z==end.z  so we need to catch that here
-		if (fabs(start[2] - end[2]) < heeksCAD->GetTolerance())
+		if (fabs(start[2] - end[2]) < tolerance)
 		{
-			if ((cu.R-cu.r)<l - heeksCAD->GetTolerance())
+			if ((cu.R-cu.r)<l - tolerance)
 			{
 				// half-ellipse case
 				xc=0;
@@ -328,7 +329,7 @@ double DropCutter::EdgeTest(const Cutter &cu, const double *e, const double *p1,
 
 			// now we have a CC point
 			// so we need to check if the CC point is in the edge
-			if (isinrange(start[0], end[0], xc))
+			if (isinrange(start[0], end[0], xc, tolerance))
 				return ze;
 			else
 				return -10000000.0;
@@ -342,7 +343,7 @@ double DropCutter::EdgeTest(const Cutter &cu, const double *e, const double *p1,
 		if(fabs(end[0] - start[0]) < 0.000000001)return -10000000.0; // instead of maths error below
 
 		// based on this calculate the CC point
-		if (((cu.R - cu.r) < l - heeksCAD->GetTolerance()) && (cu.R <= l + heeksCAD->GetTolerance()))
+		if (((cu.R - cu.r) < l - tolerance) && (cu.R <= l + tolerance))
 		{
 			// half-ellipse case
 			double xc1 = xd + fabs(w * cos(theta));
@@ -386,7 +387,7 @@ double DropCutter::EdgeTest(const Cutter &cu, const double *e, const double *p1,
 		ze = zc + fabs(h * sin(theta)) - cu.r;
 
 		// finally, check that the CC point is in the edge
-		if (isinrange(start[0],end[0],xc))
+		if (isinrange(start[0],end[0],xc, tolerance))
 			return ze;
 		else
 			return -10000000.0;
@@ -398,7 +399,6 @@ double DropCutter::EdgeTest(const Cutter &cu, const double *e, const double *p1,
 
 
 	// if we ever get here it is probably a serious error!
-	wxMessageBox(_T("EdgeTest: ERROR: no case returned a valid ze!"));
 	return -10000000.0;
 }
 
@@ -453,11 +453,12 @@ bool DropCutter::isright(const double *p1, const double *p2, const double *p)
 
 double DropCutter::TriTest(const Cutter &cu, const double *e, const GTri &t, double minz)
 {
-	// does all the tests
-	if(e[0] + cu.R < t.m_box[0])return minz;
-	if(e[1] + cu.R < t.m_box[1])return minz;
-	if(e[0] - cu.R > t.m_box[2])return minz;
-	if(e[1] - cu.R > t.m_box[3])return minz;
+	// does all the tests; the tests count things within the tolerance of the cutter as touching it
+	double R = cu.R + cu.tolerance;
+	if(e[0] + R < t.m_box[0])return minz;
+	if(e[1] + R < t.m_box[1])return minz;
+	if(e[0] - R > t.m_box[2])return minz;
+	if(e[1] - R > t.m_box[3])return minz;
 
 	double z = minz;
 
@@ -493,3 +494,191 @@ double DropCutter::TriTest(const Cutter &cu, const double *e, const std::list<GT
 	return z;
 }
 
+
+// the batch tests
+// Each one works out every case for every triangle, then picks the right answer, instead of branching.
+
+static const double no_contact = -10000000.0;
+
+void DropCutter::VertexTest(const Cutter &c, const double *e, const double *px, const double *py, const double *pz, double *z)
+{
+	const double tolerance = c.tolerance;
+	BATCH_LOOP
+	for(int i = 0; i < GTriBatch::SIZE; i++)
+	{
+		double dx = e[0] - px[i];
+		double dy = e[1] - py[i];
+		double q = sqrt(dx * dx + dy * dy);
+
+		// toroidal part of the cutter
+		double qt = (q > c.R) ? c.R : q;
+		double h1 = c.r - sqrt(c.r * c.r - (qt - (c.R - c.r)) * (qt - (c.R - c.r)));
+
+		double temp_z = (q <= (c.R - c.r) + tolerance) ? pz[i] : (pz[i] - h1);
+		if(q > c.R + tolerance)temp_z = no_contact;
+		z[i] = (temp_z > z[i]) ? temp_z : z[i];
+	}
+}
+
+void DropCutter::FacetTest(const Cutter &cu, const double *e, const GTriBatch &t, double *z)
+{
+	const double tolerance = cu.tolerance;
+	BATCH_LOOP
+	for(int i = 0; i < GTriBatch::SIZE; i++)
+	{
+		// plane containing facet, with its normal pointing up
+		double flip = (t.m_n[2][i] < 0) ? -1.0 : 1.0;
+		double a = t.m_n[0][i] * flip;
+		double b = t.m_n[1][i] * flip;
+		double c = t.m_n[2][i] * flip;
+		double d = - a * t.m_x[0][i] - b * t.m_y[0][i] - c * t.m_z[0][i];
+		bool vertical = (c < 0.000000000001);
+		bool z_normal = (fabs(a) < tolerance) && (fabs(b) < tolerance);
+
+		// sin(theta) is c
+		double cos_theta = sqrt(1.0 - c * c);
+		double zf = -d/c - (a*e[0]+b*e[1])/c + (cu.R-cu.r)*cos_theta/c + cu.r/c - cu.r;
+		double k = (cu.R-cu.r)/cos_theta + cu.r;
+		double ccx = z_normal ? e[0] : (e[0] - k * a);
+		double ccy = z_normal ? e[1] : (e[1] - k * b);
+		double temp_z = z_normal ? t.m_z[0][i] : zf;
+
+		// is the CC point inside the triangle, projected onto the xy plane
+		double t1 = (t.m_y[1][i] - t.m_y[0][i]) * (ccx - t.m_x[0][i]) - (t.m_x[1][i] - t.m_x[0][i]) * (ccy - t.m_y[0][i]);
+		double t2 = (t.m_y[0][i] - t.m_y[2][i]) * (ccx - t.m_x[2][i]) - (t.m_x[0][i] - t.m_x[2][i]) * (ccy - t.m_y[2][i]);
+		double t3 = (t.m_y[2][i] - t.m_y[1][i]) * (ccx - t.m_x[1][i]) - (t.m_x[2][i] - t.m_x[1][i]) * (ccy - t.m_y[1][i]);
+		bool b1 = t1 > 0.00000000000001;
+		bool b2 = t2 > 0.00000000000001;
+		bool b3 = t3 > 0.00000000000001;
+		bool inside = (b1 & b2 & b3) | (!b1 & !b2 & !b3);
+
+		if(vertical | !inside)temp_z = no_contact;
+		z[i] = (temp_z > z[i]) ? temp_z : z[i];
+	}
+}
+
+void DropCutter::EdgeTest(const Cutter &cu, const double *e, const double *x1, const double *y1, const double *z1, const double *x2, const double *y2, const double *z2, double *z)
+{
+	const double tolerance = cu.tolerance;
+	bool flat = (fabs(cu.r) < tolerance);
+
+	BATCH_LOOP
+	for(int i = 0; i < GTriBatch::SIZE; i++)
+	{
+		// translate segment so that cutter is at (0,0)
+		double sx0 = x1[i] - e[0], sy0 = y1[i] - e[1], sz = z1[i];
+		double ex0 = x2[i] - e[0], ey0 = y2[i] - e[1], ez = z2[i];
+
+		// cos and sin of the angle between the segment and the X axis, between -90 and 90 degrees
+		double dx = ex0 - sx0;
+		double dy = ey0 - sy0;
+		double len = sqrt(dx * dx + dy * dy);
+		bool steep = !(fabs(dx) > 0.0000000000001);
+		double ca = steep ? 0.0 : (fabs(dx) / len);
+		double sa = steep ? 1.0 : (((dx > 0) ? dy : -dy) / len);
+
+		// rotate it to be parallel with the X axis, below the cutter
+		double sx = sx0 * ca + sy0 * sa;
+		double sy = -sx0 * sa + sy0 * ca;
+		double ex = ex0 * ca + ey0 * sa;
+		double ey = -ex0 * sa + ey0 * ca;
+		double turn = (sy > 0) ? -1.0 : 1.0;
+		sx *= turn;
+		sy *= turn;
+		ex *= turn;
+		ey *= turn;
+
+		double l = -sy; // distance from cutter to edge
+		bool miss = (fabs(sy - ey) > 0.0000000001) | (l > cu.R + tolerance);
+		bool zero_length = fabs(ex - sx) < 0.000000001;
+		double temp_z;
+
+		if(flat)
+		{
+			// the flat endmill case
+			double xc1 = sqrt(cu.R * cu.R - l * l);
+			double xc2 = -xc1;
+			double zc1 = ((xc1 - sx) / (ex - sx)) * (ez - sz) + sz;
+			double zc2 = ((xc2 - sx) / (ex - sx)) * (ez - sz) + sz;
+			bool first = zc1 > zc2;
+			double zc = first ? zc1 : zc2;
+			double xc = first ? xc1 : xc2;
+
+			// check if the CC point is in the edge
+			miss = miss | zero_length | ((sx > xc + tolerance) & (xc + tolerance < ex)) | ((ex < xc - tolerance) & (xc + tolerance > sx));
+			temp_z = zc;
+		}
+		else
+		{
+			// the ball-nose or bull-nose case
+			double Rr = cu.R - cu.r;
+			bool toroidal = (Rr < l - tolerance);
+			bool quarter = !toroidal && (Rr >= l);
+			double w_toroidal = sqrt(cu.R * cu.R - l * l);
+			double h_toroidal = sqrt(cu.r * cu.r - (l - Rr) * (l - Rr));
+			double xd1_quarter = sqrt(Rr * Rr - l * l);
+			double w = toroidal ? w_toroidal : (quarter ? (w_toroidal - xd1_quarter) : 0.0);
+			double h = toroidal ? h_toroidal : (quarter ? cu.r : 0.0);
+			double xd1 = quarter ? xd1_quarter : 0.0;
+
+			// cos and sin of theta, which is atan( h*(sx-ex)/(w*(sz-ez)) )
+			double num = h * (sx - ex);
+			double den = w * (sz - ez);
+			double hyp = sqrt(num * num + den * den);
+			double cos_theta = fabs(den) / hyp;
+			double sin_theta = fabs(num) / hyp;
+
+			double xc1 = xd1 + fabs(w * cos_theta);
+			double xc2 = -xd1 - fabs(w * cos_theta);
+			double zc1 = ((xc1 - sx) / (ex - sx)) * (ez - sz) + sz;
+			double zc2 = ((xc2 - sx) / (ex - sx)) * (ez - sz) + sz;
+			bool first = zc1 > zc2;
+			double zc = first ? zc1 : zc2;
+			double xc = first ? xc1 : xc2;
+			double ze = zc + fabs(h * sin_theta) - cu.r;
+
+			// horizontal edges, where theta can't be calculated, have their CC point at x = 0
+			bool horizontal = fabs(sz - ez) < tolerance;
+			double ze_horizontal = toroidal ? (sz + h_toroidal - cu.r) : sz;
+			if(horizontal)
+			{
+				xc = 0.0;
+				ze = ze_horizontal;
+			}
+			else
+			{
+				miss = miss | zero_length;
+			}
+
+			// check that the CC point is in the edge
+			double lo = (sx < ex) ? sx : ex;
+			double hi = (sx < ex) ? ex : sx;
+			miss = miss | !((xc >= lo - tolerance) & (xc <= hi + tolerance));
+			temp_z = ze;
+		}
+
+		if(miss)temp_z = no_contact;
+		z[i] = (temp_z > z[i]) ? temp_z : z[i];
+	}
+}
+
+double DropCutter::TriTest(const Cutter &cu, const double *e, const GTriBatch &t, double minz)
+{
+	double z[GTriBatch::SIZE];
+	for(int i = 0; i < GTriBatch::SIZE; i++)z[i] = minz;
+
+	FacetTest(cu, e, t, z);
+	EdgeTest(cu, e, t.m_x[0], t.m_y[0], t.m_z[0], t.m_x[1], t.m_y[1], t.m_z[1], z);
+	EdgeTest(cu, e, t.m_x[1], t.m_y[1], t.m_z[1], t.m_x[2], t.m_y[2], t.m_z[2], z);
+	EdgeTest(cu, e, t.m_x[2], t.m_y[2], t.m_z[2], t.m_x[0], t.m_y[0], t.m_z[0], z);
+	VertexTest(cu, e, t.m_x[0], t.m_y[0], t.m_z[0], z);
+	VertexTest(cu, e, t.m_x[1], t.m_y[1], t.m_z[1], z);
+	VertexTest(cu, e, t.m_x[2], t.m_y[2], t.m_z[2], z);
+
+	double max_z = minz;
+	for(int i = 0; i < GTriBatch::SIZE; i++)
+	{
+		if(z[i] > max_z)max_z = z[i];
+	}
+	return max_z;
+}
@@ -21,10 +21,12 @@ class Cutter{
 public:
 	double R; // shaft radius
 	double r; // corner radius
-	Cutter(double Rset, double rset);
+	double tolerance; // used by the tests, so they don't call HeeksCAD and can be run on many threads
+	Cutter(double Rset, double rset, double tolerance_set);
 };
 
 class GTri;
+class GTriBatch;
 
 class DropCutter
 {
@@ -40,5 +42,15 @@ public:
 
 	// This one does TriTest for a whole load of triangles
 	static double TriTest(const Cutter &cu, const double *e, const std::list<GTri> &tri_list, double minz);
+
+	// The same tests, for a batch of triangles at once. They have no branches which depend on the triangle,
+	// so the compiler can do all of the batch together with SIMD instructions.
+	// The results agree with the ones above to within rounding errors. Each z[i] is raised to the height of the cutter on triangle i.
+	static void VertexTest(const Cutter &c, const double *e, const double *px, const double *py, const double *pz, double *z);
+	static void FacetTest(const Cutter &cu, const double *e, const GTriBatch &t, double *z);
+	static void EdgeTest(const Cutter &cu, const double *e, const double *x1, const double *y1, const double *z1, const double *x2, const double *y2, const double *z2, double *z);
+
+	// This one does all the batch tests and returns the highest z, or minz
+	static double TriTest(const Cutter &cu, const double *e, const GTriBatch &t, double minz);
 };
 
@@ -0,0 +1,377 @@
+// DropCutterMesh.cpp
+/*
+ * Copyright (c) 2009, Dan Heeks
+ * This program is released under the BSD license. See the file COPYING for
+ * details.
+ */
+
+#include "stdafx.h"
+#include "DropCutterMesh.h"
+
+#include <algorithm>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+DropCutterMesh::DropCutterMesh(void): m_cell_size(1.0), m_nx(0), m_ny(0)
+{
+	for(int i = 0; i < 4; i++)m_box[i] = 0.0;
+}
+
+void DropCutterMesh::Clear(void)
+{
+	std::vector<GTri>().swap(m_tris);
+	std::vector<double>().swap(m_top);
+	std::vector<unsigned int>().swap(m_cell_start);
+	std::vector<unsigned int>().swap(m_cell_tris);
+	std::vector<double>().swap(m_cell_slope);
+	m_nx = 0;
+	m_ny = 0;
+}
+
+void DropCutterMesh::AddTriangle(const double* x)
+{
+	m_tris.push_back(GTri(x));
+}
+
+void DropCutterMesh::AddTriangles(const std::list<GTri> &tri_list)
+{
+	m_tris.reserve(m_tris.size() + tri_list.size());
+	for(std::list<GTri>::const_iterator It = tri_list.begin(); It != tri_list.end(); It++)
+	{
+		m_tris.push_back(*It);
+	}
+}
+
+bool DropCutterMesh::ReadSTLFile(const char* filepath)
+{
+	FILE* fp = fopen(filepath, "rb");
+	if(fp == NULL)return false;
+
+	// a binary file has an 80 byte header, then the number of triangles, then 50 bytes for each triangle
+	char header[80];
+	unsigned int number_of_triangles = 0;
+	bool binary = false;
+	if(fread(header, 1, 80, fp) == 80 && fread(&number_of_triangles, 4, 1, fp) == 1)
+	{
+		fseek(fp, 0, SEEK_END);
+		long size = ftell(fp);
+		binary = (size == 84 + 50 * (long)number_of_triangles);
+	}
+
+	bool ok = true;
+	if(binary)
+	{
+		fseek(fp, 84, SEEK_SET);
+		m_tris.reserve(m_tris.size() + number_of_triangles);
+		unsigned char record[50];
+		for(unsigned int t = 0; t < number_of_triangles; t++)
+		{
+			if(fread(record, 1, 50, fp) != 50){ ok = false; break; }
+			float f[9];
+			memcpy(f, record + 12, sizeof(f)); // after the normal
+			double x[9];
+			for(int i = 0; i < 9; i++)x[i] = f[i];
+			AddTriangle(x);
+		}
+	}
+	else
+	{
+		// ascii; only the vertices matter, three to a facet
+		fseek(fp, 0, SEEK_SET);
+		char word[256];
+		double x[9];
+		int number_of_coordinates = 0;
+		while(fscanf(fp, "%255s", word) == 1)
+		{
+			if(strcmp(word, "vertex") != 0)continue;
+			if(fscanf(fp, "%lf %lf %lf", &x[number_of_coordinates], &x[number_of_coordinates + 1], &x[number_of_coordinates + 2]) != 3){ ok = false; break; }
+			number_of_coordinates += 3;
+			if(number_of_coordinates == 9)
+			{
+				AddTriangle(x);
+				number_of_coordinates = 0;
+			}
+		}
+	}
+
+	fclose(fp);
+	return ok;
+}
+
+bool DropCutterMesh::WriteSTLFile(const char* filepath)const
+{
+	FILE* fp = fopen(filepath, "wb");
+	if(fp == NULL)return false;
+
+	// the header mustn't start with "solid", or readers take it for an ascii file
+	char header[80];
+	memset(header, 0, 80);
+	strcpy(header, "binary STL from HeeksCNC");
+	unsigned int number_of_triangles = (unsigned int)m_tris.size();
+	bool ok = (fwrite(header, 1, 80, fp) == 80 && fwrite(&number_of_triangles, 4, 1, fp) == 1);
+
+	unsigned char record[50];
+	memset(record, 0, 50);
+	for(size_t t = 0; ok && t < m_tris.size(); t++)
+	{
+		float f[12];
+		for(int i = 0; i < 3; i++)f[i] = (float)m_tris[t].m_n[i];
+		for(int i = 0; i < 9; i++)f[3 + i] = (float)m_tris[t].m_p[i];
+		memcpy(record, f, sizeof(f));
+		ok = (fwrite(record, 1, 50, fp) == 50);
+	}
+
+	if(fclose(fp) != 0)ok = false;
+	return ok;
+}
+
+int DropCutterMesh::CellX(double x)const
+{
+	int i = (int)floor((x - m_box[0]) / m_cell_size);
+	if(i < 0)return 0;
+	if(i >= m_nx)return m_nx - 1;
+	return i;
+}
+
+int DropCutterMesh::CellY(double y)const
+{
+	int i = (int)floor((y - m_box[1]) / m_cell_size);
+	if(i < 0)return 0;
+	if(i >= m_ny)return m_ny - 1;
+	return i;
+}
+
+class TopMore
+{
+	const std::vector<double> &m_top;
+public:
+	TopMore(const std::vector<double> &top): m_top(top) {}
+	bool operator()(unsigned int a, unsigned int b)const { return m_top[a] > m_top[b]; }
+};
+
+void DropCutterMesh::Build(void)
+{
+	std::vector<unsigned int>().swap(m_cell_start);
+	std::vector<unsigned int>().swap(m_cell_tris);
+	std::vector<double>().swap(m_cell_slope);
+	m_nx = 0;
+	m_ny = 0;
+	if(m_tris.empty())return;
+
+	m_top.resize(m_tris.size());
+	double area = 0.0;
+	for(size_t i = 0; i < m_tris.size(); i++)
+	{
+		const GTri &tri = m_tris[i];
+		m_top[i] = std::max(tri.m_p[2], std::max(tri.m_p[5], tri.m_p[8]));
+		for(int k = 0; k < 2; k++)
+		{
+			if(i == 0 || tri.m_box[k] < m_box[k])m_box[k] = tri.m_box[k];
+			if(i == 0 || tri.m_box[k + 2] > m_box[k + 2])m_box[k + 2] = tri.m_box[k + 2];
+		}
+		area += (tri.m_box[2] - tri.m_box[0]) * (tri.m_box[3] - tri.m_box[1]);
+	}
+
+	// cells about the size of the average triangle, but not many more cells than triangles
+	double width = m_box[2] - m_box[0];
+	double height = m_box[3] - m_box[1];
+	m_cell_size = sqrt(area / m_tris.size());
+	double min_cell_size = sqrt(width * height / (4.0 * m_tris.size()));
+	if(m_cell_size < min_cell_size)m_cell_size = min_cell_size;
+	if(m_cell_size < width / 4096)m_cell_size = width / 4096;
+	if(m_cell_size < height / 4096)m_cell_size = height / 4096;
+	if(m_cell_size <= 0.0)m_cell_size = 1.0;
+	m_nx = (int)(width / m_cell_size) + 1;
+	m_ny = (int)(height / m_cell_size) + 1;
+
+	// count the triangles in each cell, then fill them in
+	m_cell_start.assign(m_nx * m_ny + 1, 0);
+	for(size_t i = 0; i < m_tris.size(); i++)
+	{
+		const GTri &tri = m_tris[i];
+		int x0 = CellX(tri.m_box[0]), x1 = CellX(tri.m_box[2]);
+		int y0 = CellY(tri.m_box[1]), y1 = CellY(tri.m_box[3]);
+		for(int y = y0; y <= y1; y++)for(int x = x0; x <= x1; x++)m_cell_start[y * m_nx + x + 1]++;
+	}
+	for(size_t c = 1; c < m_cell_start.size(); c++)m_cell_start[c] += m_cell_start[c - 1];
+	m_cell_tris.resize(m_cell_start.back());
+	std::vector<unsigned int> fill(m_cell_start.begin(), m_cell_start.end() - 1);
+	for(size_t i = 0; i < m_tris.size(); i++)
+	{
+		const GTri &tri = m_tris[i];
+		int x0 = CellX(tri.m_box[0]), x1 = CellX(tri.m_box[2]);
+		int y0 = CellY(tri.m_box[1]), y1 = CellY(tri.m_box[3]);
+		for(int y = y0; y <= y1; y++)for(int x = x0; x <= x1; x++)m_cell_tris[fill[y * m_nx + x]++] = (unsigned int)i;
+	}
+
+	// highest triangles first, and the steepest slope in each cell
+	m_cell_slope.assign(m_nx * m_ny, 0.0);
+	for(size_t c = 0; c + 1 < m_cell_start.size(); c++)
+	{
+		std::sort(m_cell_tris.begin() + m_cell_start[c], m_cell_tris.begin() + m_cell_start[c + 1], TopMore(m_top));
+		for(unsigned int j = m_cell_start[c]; j < m_cell_start[c + 1]; j++)
+		{
+			const double* n = m_tris[m_cell_tris[j]].m_n;
+			double across = sqrt(n[0] * n[0] + n[1] * n[1]);
+			double slope = (fabs(n[2]) * 1.0e9 > across) ? across / fabs(n[2]) : 1.0e9;
+			if(slope > m_cell_slope[c])m_cell_slope[c] = slope;
+		}
+	}
+}
+
+double DropCutterMesh::Drop(const Cutter &cu, const double *e, double minz)const
+{
+	double z = minz;
+	if(m_nx == 0)return z;
+
+	// the tests count things within the tolerance of the cutter as touching it
+	double R = cu.R + cu.tolerance;
+	if(e[0] + R < m_box[0] || e[0] - R > m_box[2] || e[1] + R < m_box[1] || e[1] - R > m_box[3])return z;
+
+	GTriBatch batch;
+	int batch_size = 0;
+
+	double qx0 = e[0] - R, qy0 = e[1] - R;
+	int x0 = CellX(qx0), x1 = CellX(e[0] + R);
+	int y0 = CellY(qy0), y1 = CellY(e[1] + R);
+	for(int y = y0; y <= y1; y++)
+	{
+		for(int x = x0; x <= x1; x++)
+		{
+			int c = y * m_nx + x;
+
+			// the tests let the cutter touch a triangle up to the tolerance beyond its edges, so a sloping one can lift it above its top
+			double above_top = cu.tolerance * m_cell_slope[c];
+
+			for(unsigned int j = m_cell_start[c]; j < m_cell_start[c + 1]; j++)
+			{
+				unsigned int i = m_cell_tris[j];
+
+				// nothing lower in this cell can lift the cutter any higher
+				if(m_top[i] + above_top <= z)break;
+
+				// a triangle in more than one cell is only tested in the cell where it starts to overlap the cutter
+				const GTri &tri = m_tris[i];
+				if(CellX(std::max(tri.m_box[0], qx0)) != x || CellY(std::max(tri.m_box[1], qy0)) != y)continue;
+
+				if(e[0] + R < tri.m_box[0] || e[1] + R < tri.m_box[1] || e[0] - R > tri.m_box[2] || e[1] - R > tri.m_box[3])continue;
+
+				batch.set(batch_size++, tri);
+				if(batch_size == GTriBatch::SIZE)
+				{
+					z = DropCutter::TriTest(cu, e, batch, z);
+					batch_size = 0;
+				}
+			}
+		}
+	}
+
+	if(batch_size > 0)
+	{
+		batch.fill(batch_size);
+		z = DropCutter::TriTest(cu, e, batch, z);
+	}
+
+	return z;
+}
+
+void DropCutterMesh::Drop(const Cutter &cu, std::vector<double> &points, double minz)const
+{
+	int number_of_points = (int)(points.size() / 3);
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 64)
+#endif
+	for(int i = 0; i < number_of_points; i++)
+	{
+		double* e = &points[i * 3];
+		e[2] = Drop(cu, e, minz);
+	}
+}
+
+// the directions within angle of the unit vector cone are narrowed to those within r of the unit vector d too.
+// Where the two circles on the unit sphere overlap, it keeps the biggest circle which fits in both of them, so it never keeps a direction
+// which isn't in both, but may leave some out. An angle less than zero is no directions.
+static void NarrowCone(double* cone, double &angle, const double* d, double r)
+{
+	if(angle >= 3.1415926535897932)
+	{
+		// any direction, before
+		for(int k = 0; k < 3; k++)cone[k] = d[k];
+		angle = r;
+		return;
+	}
+
+	double c = cone[0] * d[0] + cone[1] * d[1] + cone[2] * d[2];
+	double between = acos(std::max(-1.0, std::min(1.0, c)));
+	if(between + r <= angle)
+	{
+		for(int k = 0; k < 3; k++)cone[k] = d[k];
+		angle = r;
+	}
+	else if(between + angle <= r)
+	{
+		// already inside
+	}
+	else if(between > angle + r)
+	{
+		angle = -1.0;
+	}
+	else
+	{
+		// the middle of where they overlap, along the great circle from cone to d
+		double move = (between + angle - r) * 0.5;
+		double u[3] = {d[0] - cone[0] * c, d[1] - cone[1] * c, d[2] - cone[2] * c};
+		double s = sin(between);
+		for(int k = 0; k < 3; k++)cone[k] = cone[k] * cos(move) + u[k] / s * sin(move);
+		angle = (angle + r - between) * 0.5;
+	}
+}
+
+void DropCutterMesh::Filter(std::vector<double> &points, double tolerance)
+{
+	size_t number_of_points = points.size() / 3;
+	if(number_of_points < 3)return;
+
+	size_t kept = 1; // the points kept are moved to the front
+	size_t start = 0; // the last point kept
+	double cone[3] = {0.0, 0.0, 1.0};
+	double angle = 3.1415926535897932; // any direction
+
+	for(size_t i = 1; i < number_of_points; i++)
+	{
+		for(int pass = 0; pass < 2; pass++)
+		{
+			const double* s = &points[start * 3];
+			const double* p = &points[i * 3];
+			double d[3] = {p[0] - s[0], p[1] - s[1], p[2] - s[2]};
+			double length = sqrt(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+			bool fits;
+			if(length > 0.0)
+			{
+				for(int k = 0; k < 3; k++)d[k] /= length;
+				double c = cone[0] * d[0] + cone[1] * d[1] + cone[2] * d[2];
+				fits = (angle >= 3.1415926535897932) || (angle >= 0.0 && acos(std::max(-1.0, std::min(1.0, c))) <= angle);
+			}
+			else fits = (angle >= 3.1415926535897932); // a line with no direction, only if there's nothing between
+
+			if(fits)
+			{
+				// the lines on past this point must pass within tolerance of it too
+				if(length > tolerance)NarrowCone(cone, angle, d, asin(tolerance / length));
+				break;
+			}
+
+			// the line can't end at this point, so the one before it is kept, and the lines start again from there
+			start = i - 1;
+			for(int k = 0; k < 3; k++)points[kept * 3 + k] = points[start * 3 + k];
+			kept++;
+			angle = 3.1415926535897932;
+		}
+	}
+
+	for(int k = 0; k < 3; k++)points[kept * 3 + k] = points[(number_of_points - 1) * 3 + k];
+	kept++;
+	points.resize(kept * 3);
+}
@@ -0,0 +1,70 @@
+// DropCutterMesh.h
+/*
+ * Copyright (c) 2009, Dan Heeks
+ * This program is released under the BSD license. See the file COPYING for
+ * details.
+ */
+
+// Drop cutter, for lots of cutter locations over lots of triangles.
+// The triangles are kept in one array, with a grid of cells over them, looking down Z, so each cutter location
+// only does DropCutter::TriTest with the triangles near it. Within a cell the triangles are sorted by their highest
+// point, so the tests stop as soon as no more triangles in the cell can lift the cutter.
+// The triangles which are tested are done in batches of GTriBatch::SIZE, with DropCutter's batch tests.
+// If the compiler has OpenMP, the cutter locations are shared between the threads.
+
+#pragma once
+
+#include "DropCutter.h"
+#include "GTri.h"
+
+#include <vector>
+#include <list>
+#include <cstddef>
+
+class DropCutterMesh
+{
+public:
+	DropCutterMesh(void);
+
+	void Clear(void);
+
+	// x is three points
+	void AddTriangle(const double* x);
+	void AddTriangles(const std::list<GTri> &tri_list);
+
+	// adds the triangles from an ascii or binary STL file; returns false if it couldn't be read
+	bool ReadSTLFile(const char* filepath);
+
+	// writes the triangles to a binary STL file, which is about a fifth of the size of an ascii one and much quicker to read;
+	// returns false if it couldn't be written
+	bool WriteSTLFile(const char* filepath)const;
+
+	// makes the grid; call this after adding the triangles and before dropping the cutter
+	void Build(void);
+
+	size_t NumberOfTriangles(void)const { return m_tris.size(); }
+
+	// returns the height of the tip of the cutter at e[0], e[1], or minz if it doesn't touch any triangle
+	double Drop(const Cutter &cu, const double *e, double minz)const;
+
+	// points are x, y, z for each cutter location; each z is set to the height of the cutter there
+	void Drop(const Cutter &cu, std::vector<double> &points, double minz)const;
+
+	// leaves out the points, x, y, z for each, which are within tolerance of the line through the points kept either side of them, like
+	// OpenCAMLib's LineCLFilter. It goes through the points once, keeping the directions from the last point kept which pass within
+	// tolerance of every point since; the first and last points are always kept.
+	static void Filter(std::vector<double> &points, double tolerance);
+
+private:
+	std::vector<GTri> m_tris;
+	std::vector<double> m_top; // the highest z of each triangle
+	double m_box[4]; // minx miny maxx maxy, of all the triangles
+	double m_cell_size;
+	int m_nx, m_ny;
+	std::vector<unsigned int> m_cell_start; // where each cell's triangles start in m_cell_tris, and one more for the end
+	std::vector<unsigned int> m_cell_tris;
+	std::vector<double> m_cell_slope; // the steepest slope, dz over dxy, of the triangles in each cell
+
+	int CellX(double x)const;
+	int CellY(double y)const;
+};
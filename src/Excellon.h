@@ -12,9 +12,11 @@ for isolation milling.
 #include <string>
 #include <list>
 #include <map>
+#include <vector>
 #include <algorithm>
 #include <iostream>
 
+#include "ExcellonReader.h"
 #include "Drilling.h"
 #include "CNCPoint.h"
 #include "CTool.h"
@@ -26,7 +28,7 @@ for isolation milling.
 #include <gp_Vec.hxx>
 
 
-class Excellon
+class Excellon : public ExcellonReader
 {
 	public:
 		Excellon();
@@ -34,54 +36,17 @@ class Excellon
 
 		bool Read( const char *p_szFileName, const bool force_mirror = false );
 
-	private:
-
-		char ReadChar( const char *data, int *pos, const int max_pos );
-		std::string ReadBlock( const char *data, int *pos, const int max_pos );
-		double special_strtod( const char *value, const char **end ) const;
-
-		bool ReadDataBlock( const std::string & data_block );
-
-		double InterpretCoord(	const char *coordinate,
-					const int digits_left_of_point,
-					const int digits_right_of_point,
-					const bool leading_zero_suppression,
-					const bool trailing_zero_suppression ) const;
-
-		int m_current_line;
-
-		double m_units;	// 1 = mm, 25.4 = inches
-		bool m_leadingZeroSuppression;
-		bool m_trailingZeroSuppression;
-		bool m_absoluteCoordinatesMode;
-
-		unsigned int m_XDigitsLeftOfPoint;
-		unsigned int m_XDigitsRightOfPoint;
-
-		unsigned int m_YDigitsLeftOfPoint;
-		unsigned int m_YDigitsRightOfPoint;
-
-		unsigned int m_active_tool_number;
-
-		bool m_mirror_image_x_axis;
-		bool m_mirror_image_y_axis;
-
-		double m_spindle_speed;
-		double m_feed_rate;
-
-		// Associates tool number in the Excellon file with tools in the Tools (plural) list.
-		typedef std::map< unsigned int, CTool::ToolNumber_t > ToolTableMap_t;
-		ToolTableMap_t	m_tool_table_map;
+	protected:
+		CTool::ToolNumber_t ToolNumber( const double diameter );
+		bool Hole( const int tool_number, const double x, const double y, const double z );
 
+	private:
 		typedef std::map< CTool::ToolNumber_t, std::list<int> > Holes_t;
 		Holes_t m_holes;
 
-		typedef std::map< CNCPoint, int > Points_t;
-		Points_t	m_existing_points;
+		PointLookup	m_existing_points;
 
 public:
 		static void GetOptions(std::list<Property *> *list);
 		static PropertyCheck s_allow_dummy_tool_definitions;
 };
-
-
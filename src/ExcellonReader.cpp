@@ -0,0 +1,833 @@
+// ExcellonReader.cpp
+// Copyright (c) 2009, David Nicholls, Perttu "celero55" Ahola
+// This program is released under the BSD license. See the file COPYING for details.
+
+#include "stdafx.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <string.h>
+
+#include "ExcellonReader.h"
+
+#include <fstream>
+#include <string>
+#include <algorithm>
+#include <map>
+#include <vector>
+
+ExcellonReader::ExcellonReader()
+{
+	m_units = 25.4;	// inches.
+	m_leadingZeroSuppression = false;
+	m_trailingZeroSuppression = false;
+	m_absoluteCoordinatesMode = true;
+
+	m_XDigitsLeftOfPoint = 2;
+	m_XDigitsRightOfPoint = 4;
+
+	m_YDigitsLeftOfPoint = 2;
+	m_YDigitsRightOfPoint = 4;
+
+	m_active_tool_number = 0;	// None selected yet.
+
+	m_mirror_image_x_axis = false;
+	m_mirror_image_y_axis = false;
+
+	m_allow_dummy_tool_definitions = true;
+
+	m_current_line = 0;
+
+	m_feed_rate = 50.0;
+	m_spindle_speed = 0.0;
+
+	m_x = 0.0;
+	m_y = 0.0;
+} // End constructor
+
+
+PointLookup::PointLookup()
+{
+	m_tolerance = 0.0;
+	m_cell_size = 0.0;
+	m_count = 0;
+	m_buckets.resize(1024);
+}
+
+// Points closer than tolerance are the same point.  This must be called before any are inserted.
+void PointLookup::SetTolerance( const double tolerance )
+{
+	m_tolerance = (tolerance > 0.0) ? tolerance : 1.0e-9;
+	m_cell_size = m_tolerance * 2.0;
+}
+
+long long PointLookup::Cell( const double coordinate ) const
+{
+	return((long long)floor(coordinate / m_cell_size));
+}
+
+size_t PointLookup::Hash( const long long ix, const long long iy, const long long iz ) const
+{
+	unsigned long long h = (unsigned long long)ix * 73856093ULL;
+	h ^= (unsigned long long)iy * 19349663ULL;
+	h ^= (unsigned long long)iz * 83492791ULL;
+	return((size_t)(h & (m_buckets.size() - 1)));	// the size is a power of two
+}
+
+// Returns the id of the nearest point which is within the tolerance of point, if there is one.
+// The cells are twice the tolerance, so, in each direction, only the cell on the nearer side of point's
+// cell can have points close enough in it; that's 8 cells to look in, rather than 27.
+bool PointLookup::Find( const double x, const double y, const double z, int *id ) const
+{
+	long long ix = Cell(x);
+	long long iy = Cell(y);
+	long long iz = Cell(z);
+
+	long long nx = ((x - ix * m_cell_size) < m_tolerance) ? -1 : 1;
+	long long ny = ((y - iy * m_cell_size) < m_tolerance) ? -1 : 1;
+	long long nz = ((z - iz * m_cell_size) < m_tolerance) ? -1 : 1;
+
+	bool found = false;
+	double best_distance = m_tolerance;
+
+	for (long long dx = 0; dx != 2 * nx; dx += nx)
+	{
+		for (long long dy = 0; dy != 2 * ny; dy += ny)
+		{
+			for (long long dz = 0; dz != 2 * nz; dz += nz)
+			{
+				const Bucket_t &bucket = m_buckets[Hash(ix + dx, iy + dy, iz + dz)];
+				for (Bucket_t::const_iterator l_itEntry = bucket.begin(); l_itEntry != bucket.end(); l_itEntry++)
+				{
+					if ((l_itEntry->ix != ix + dx) || (l_itEntry->iy != iy + dy) || (l_itEntry->iz != iz + dz)) continue;
+
+					double ex = l_itEntry->x - x;
+					double ey = l_itEntry->y - y;
+					double ez = l_itEntry->z - z;
+					double distance = sqrt(ex*ex + ey*ey + ez*ez);
+					if (distance < best_distance)
+					{
+						best_distance = distance;
+						*id = l_itEntry->id;
+						found = true;
+					}
+				} // End for
+			} // End for
+		} // End for
+	} // End for
+
+	return(found);
+}
+
+void PointLookup::Insert( const double x, const double y, const double z, const int id )
+{
+	if (m_count >= m_buckets.size() * 2) Grow();
+
+	Entry_t entry;
+	entry.ix = Cell(x);
+	entry.iy = Cell(y);
+	entry.iz = Cell(z);
+	entry.x = x;
+	entry.y = y;
+	entry.z = z;
+	entry.id = id;
+
+	m_buckets[Hash(entry.ix, entry.iy, entry.iz)].push_back(entry);
+	m_count++;
+}
+
+// Doubles the number of buckets, so that there are never many points in each one.
+void PointLookup::Grow()
+{
+	std::vector< Bucket_t > old_buckets;
+	old_buckets.swap(m_buckets);
+	m_buckets.resize(old_buckets.size() * 2);
+
+	for (std::vector< Bucket_t >::const_iterator l_itBucket = old_buckets.begin(); l_itBucket != old_buckets.end(); l_itBucket++)
+	{
+		for (Bucket_t::const_iterator l_itEntry = l_itBucket->begin(); l_itEntry != l_itBucket->end(); l_itEntry++)
+		{
+			m_buckets[Hash(l_itEntry->ix, l_itEntry->iy, l_itEntry->iz)].push_back(*l_itEntry);
+		} // End for
+	} // End for
+}
+
+
+/**
+	This routine is the same as the normal strtod() routine except that it
+	doesn't accept 'd' or 'D' as radix values.  Some locale configurations
+	use 'd' or 'D' as radix values just as 'e' or 'E' might be used.  This
+	confuses subsequent commands held on the same line as the coordinate.
+ */
+double ExcellonReader::special_strtod( const char *value, const char **end ) const
+{
+	// Copy just the characters which could be part of the number, stopping at 'd' or 'D'.
+	char number[64];
+	size_t length = 0;
+	while ((length < sizeof(number) - 1) && (value[length] != '\0') && (strchr("+-.0123456789eE", value[length]) != NULL))
+	{
+		number[length] = value[length];
+		length++;
+	}
+	number[length] = '\0';
+
+	char *_end = NULL;
+	double dval = strtod( number, &_end );
+	if (end)
+	{
+		*end = value + (_end - number);
+	}
+	return(dval);
+}
+
+void ExcellonReader::Ignore( const char *description )
+{
+	m_ignored[description]++;
+}
+
+bool ExcellonReader::ReadFile( const char *file_name )
+{
+	// Read the whole file at once, rather than a line at a time.  Panel files can be many megabytes.
+	std::ifstream input( file_name, std::ios::in | std::ios::binary );
+	if (! input.is_open())
+	{
+		// Couldn't read file.
+		printf("Could not open '%s' for reading\n", file_name );
+		return(false);
+	} // End if - then
+
+	input.seekg( 0, std::ios::end );
+	std::streamoff file_size = input.tellg();
+	input.seekg( 0, std::ios::beg );
+
+	std::vector<char> file_data;
+	if (file_size > 0)
+	{
+		file_data.resize( (size_t)file_size );
+		input.read( &file_data[0], file_size );
+		file_data.resize( (size_t)input.gcount() );
+	}
+
+	return(ReadData( file_data.empty() ? NULL : &file_data[0], file_data.size() ));
+} // End ReadFile() method
+
+// data is the whole file, which needn't end with a '\0'
+bool ExcellonReader::ReadData( const char *data, const size_t length )
+{
+	m_current_line = 0;
+
+	const char *data_end = data + length;
+
+	for (const char *line = data; line < data_end; )
+	{
+		m_current_line++;
+
+		// Copy the line into m_block without the characters which only separate the commands.
+		m_block.clear();
+		const char *c = line;
+		for (; (c < data_end) && (*c != '\n'); c++)
+		{
+			switch (*c)
+			{
+			case '%':
+			case '*':
+			case ',':
+			case ' ':
+			case '\t':
+			case '\r':
+			case '\0':
+				break;
+
+			default:
+				m_block.push_back(*c);
+			}
+		} // End for
+		line = c + 1;
+
+		if (m_block.empty()) continue;
+
+		if (! ReadDataBlock( m_block.c_str() ))
+		{
+			printf("Excellon::Read() failed at line %d\n", m_current_line );
+			return(false);
+		}
+	} // End for
+
+	for (Ignored_t::const_iterator l_itIgnored = m_ignored.begin(); l_itIgnored != m_ignored.end(); l_itIgnored++)
+	{
+		printf("Ignoring %s (%d times)\n", l_itIgnored->first, l_itIgnored->second );
+	} // End for
+
+	return(true);
+} // End ReadData() method
+
+
+// Adds up the digits from begin to end, as atof() would for a string of them.
+static double DigitsValue( const char *begin, const char *end )
+{
+	double value = 0.0;
+	for (const char *c = begin; (c < end) && (*c >= '0') && (*c <= '9'); c++)
+	{
+		value = (value * 10.0) + (*c - '0');
+	}
+	return(value);
+}
+
+double ExcellonReader::InterpretCoord(
+	const char *coordinate,
+	const char *coordinate_end,
+	const int digits_left_of_point,
+	const int digits_right_of_point,
+	const bool leading_zero_suppression,
+	const bool trailing_zero_suppression ) const
+{
+
+	double multiplier = m_units;
+	double result;
+	const char *digits = coordinate;
+
+	if ((digits < coordinate_end) && (*digits == '-'))
+	{
+		multiplier *= -1.0;
+		digits++;
+	} // End if - then
+
+	if ((digits < coordinate_end) && (*digits == '+'))
+	{
+		multiplier *= +1.0;
+		digits++;
+	} // End if - then
+
+	int num_digits = (int)(coordinate_end - digits);
+
+	if (leading_zero_suppression)
+	{
+		// use the end of the string as the reference point.  Missing digits on the left are zeros.
+		if (num_digits < digits_right_of_point)
+		{
+			result = DigitsValue( digits, coordinate_end ) / pow(10.0, digits_right_of_point);
+		}
+		else
+		{
+			result = DigitsValue( digits, coordinate_end - digits_right_of_point );
+			result += (DigitsValue( coordinate_end - digits_right_of_point, coordinate_end ) / pow(10.0, digits_right_of_point));
+		}
+	} // End if - then
+	else
+	{
+		// use the beginning of the string as the reference point.
+		if (num_digits < digits_left_of_point)
+		{
+			result = DigitsValue( digits, coordinate_end );
+			if (trailing_zero_suppression)
+			{
+				// Missing digits on the right are zeros.
+				result *= pow(10.0, digits_left_of_point - num_digits);
+			}
+		}
+		else
+		{
+			result = DigitsValue( digits, digits + digits_left_of_point );
+			result += (DigitsValue( digits + digits_left_of_point, coordinate_end ) / pow(10.0, num_digits - digits_left_of_point));
+		}
+	} // End if - else
+
+	result *= multiplier;
+
+	// printf("ExcellonReader::InterpretCoord(%s) = %lf\n", coordinate, result );
+	return(result);
+} // End InterpretCoord() method
+
+
+// Returns true, and moves data past the command, if data starts with command.
+static bool Command( const char * & data, const char *command )
+{
+	size_t length = strlen(command);
+	if (strncmp( data, command, length ) != 0) return(false);
+	data += length;
+	return(true);
+}
+
+bool ExcellonReader::ReadDataBlock( const char *data_block )
+{
+	const char *data = data_block;
+
+	bool position_has_been_set = false;
+
+	bool m02_found = false;
+	bool swap_axis = false;
+	bool mirror_image_x_axis = false;
+	unsigned int excellon_tool_number = 0;
+	double tool_diameter = 0.0;
+
+	while (*data != '\0')
+	{
+		// The coordinates first, as they are most of a drill file.  No other command starts with X or Y.
+		if (Command(data, "X"))
+		{
+			const char *end = NULL;
+
+			double x = special_strtod( data, &end );
+			if ((end == NULL) || (end == data))
+			{
+				printf("Expected number following 'X'\n");
+				return(false);
+			} // End if - then
+			const char *x_string = data;
+			data = end;
+
+            position_has_been_set = true;
+            if (std::find(x_string, end, '.') == end)
+            {
+
+                double x = InterpretCoord( x_string, end,
+                                m_XDigitsLeftOfPoint,
+                                m_XDigitsRightOfPoint,
+                                m_leadingZeroSuppression,
+                                m_trailingZeroSuppression );
+
+                if (m_absoluteCoordinatesMode)
+                {
+                    m_x = x;
+                }
+                else
+                {
+                    // Incremental position.
+                    m_x += x;
+                }
+            }
+            else
+            {
+                // The number had a decimal point explicitly defined within it.  Read it as a correctly
+                // represented number, in the file's units.
+                x *= m_units;
+                if (m_absoluteCoordinatesMode)
+                {
+                    m_x = x;
+                }
+                else
+                {
+                    // Incremental position.
+                    m_x += x;
+                }
+            }
+		}
+		else if (Command(data, "Y"))
+		{
+			const char *end = NULL;
+
+			double y = special_strtod( data, &end );
+			if ((end == NULL) || (end == data))
+			{
+				printf("Expected number following 'Y'\n");
+				return(false);
+			} // End if - then
+			const char *y_string = data;
+			data = end;
+
+            position_has_been_set = true;
+            if (std::find(y_string, end, '.') == end)
+            {
+                double y = InterpretCoord( y_string, end,
+                                m_YDigitsLeftOfPoint,
+                                m_YDigitsRightOfPoint,
+                                m_leadingZeroSuppression,
+                                m_trailingZeroSuppression );
+
+                if (m_absoluteCoordinatesMode)
+                {
+                    m_y = y;
+                }
+                else
+                {
+                    // Incremental position.
+                    m_y += y;
+                }
+            }
+            else
+            {
+                    // The number already has a decimal point explicitly defined within it, in the file's units.
+                    y *= m_units;
+
+                    if (m_absoluteCoordinatesMode)
+                    {
+                        m_y = y;
+                    }
+                    else
+                    {
+                        // Incremental position.
+                        m_y += y;
+                    }
+            }
+		}
+		else if (Command(data, "RT"))
+		{
+			// Reset Tool Data
+            m_tool_table_map.clear();
+            m_active_tool_number = 0;
+		}
+		else if (Command(data, "FMAT"))
+		{
+			// Ignore format
+			char *end = NULL;
+			unsigned long format = strtoul( data, &end, 10 );
+			data = end;
+			printf("Ignoring Format %ld command\n", format );
+		}
+		else if (Command(data, "AFS"))
+		{
+			// Ignore format
+			Ignore("Automatic Feeds and Speeds");
+		}
+		else if (Command(data, "CCW"))
+		{
+			Ignore("Counter-Clockwise routing");
+		}
+		else if (Command(data, "CP"))
+		{
+			Ignore("Cutter Compensation");
+		}
+		else if (Command(data, "DETECT"))
+		{
+			Ignore("Broken Tool Detection");
+		}
+        else if (Command(data, "DN"))
+		{
+			Ignore("Down Limit Set");
+		}
+		else if (Command(data, "DTMDIST"))
+		{
+			Ignore("Maximum Route Distance Before Tool Change");
+		}
+		else if (Command(data, "EXDA"))
+		{
+			Ignore("Extended Drill Area");
+		}
+		else if (Command(data, "FSB"))
+		{
+			Ignore("Feeds and Speeds Button OFF");
+		}
+		else if (Command(data, "HBCK"))
+		{
+			Ignore("Home Button Check");
+		}
+		else if (Command(data, "NCSL"))
+		{
+			Ignore("NC Slope Enable/Disable");
+		}
+		else if (Command(data, "OM48"))
+		{
+			Ignore("Override Part Program Header");
+		}
+		else if (Command(data, "OSTOP"))
+		{
+			Ignore("Optional Stop switch");
+		}
+		else if (Command(data, "OTCLMP"))
+		{
+			Ignore("Override Table Clamp");
+		}
+		else if (Command(data, "PCKPARAM"))
+		{
+			Ignore("Set up pecking tool,depth,infeed and retract parameters");
+		}
+        else if (Command(data, "PF"))
+		{
+			Ignore("Floating Pressure Foot Switch");
+		}
+		else if (Command(data, "PPR"))
+		{
+			Ignore("Programmable Plunge Rate Enable");
+		}
+		else if (Command(data, "PVS"))
+		{
+			Ignore("Pre-vacuum Shut-off Switch");
+		}
+		else if (Command(data, "RCP"))
+		{
+			Ignore("Reset Program Clocks");
+		}
+		else if (Command(data, "RCR"))
+		{
+			Ignore("Reset Run Clocks");
+		}
+		else if (Command(data, "RC"))
+		{
+			Ignore("Reset Clocks");
+		}
+		else if (Command(data, "RD"))
+		{
+			Ignore("Reset All Cutter Distances");
+		}
+		else if (Command(data, "RH"))
+		{
+			Ignore("Reset All Hit Counters");
+		}
+		else if (Command(data, "SBK"))
+		{
+			Ignore("Single Block Mode Switch");
+		}
+		else if (Command(data, "SG"))
+		{
+			Ignore("Spindle Group Mode");
+		}
+		else if (Command(data, "SIXM"))
+		{
+			Ignore("Input From External Source");
+		}
+		else if (Command(data, "UP"))
+		{
+			Ignore("Upper Limit Switch Set");
+		}
+		else if (Command(data, "ZA"))
+		{
+			Ignore("Auxiliary Zero");
+		}
+		else if (Command(data, "ZC"))
+		{
+			Ignore("Zero Correction");
+		}
+		else if (Command(data, "ZS"))
+		{
+			Ignore("Zero Preset");
+		}
+		else if (Command(data, "Z"))
+		{
+			Ignore("Zero Set");
+		}
+		else if (Command(data, "VER"))
+		{
+			// Ignore version
+			char *end = NULL;
+			unsigned long version = strtoul( data, &end, 10 );
+			data = end;
+			printf("Ignoring Version %ld command\n", version);
+		}
+		else if (Command(data, "TCSTON"))
+		{
+			// Tool Change Stop - ON
+			Ignore("Tool Change Stop - ON");
+		}
+		else if (Command(data, "TCSTOFF"))
+		{
+			// Tool Change Stop - OFF
+			Ignore("Tool Change Stop - OFF");
+		}
+		else if (Command(data, "ATCON"))
+		{
+			// Automatic Tool Change - ON
+			Ignore("Tool Change - ON");
+		}
+		else if (Command(data, "ATCOFF"))
+		{
+			// Automatic Tool Change - OFF
+			Ignore("Tool Change - OFF");
+		}
+		else if (Command(data, "M30"))
+		{
+			// End of program
+		}
+		else if (Command(data, ";"))
+		{
+			break;	// Ignore all subsequent comments until the end of line.
+		}
+		else if (Command(data, "INCH"))
+		{
+			m_units = 25.4;	// Imperial
+		}
+		else if (Command(data, "METRIC"))
+		{
+			m_units = 1.0;	// mm
+		}
+		else if (Command(data, "MM"))
+		{
+			m_units = 1.0;	// mm
+		}
+		else if (Command(data, "TZ"))
+		{
+			// In Excellon files, the TZ means that trailing zeroes are INCLUDED
+			// while in RS274X format, it means they're OMITTED
+			m_trailingZeroSuppression = false;
+		}
+		else if (Command(data, "LZ"))
+		{
+			// In Excellon files, the LZ means that leading zeroes are INCLUDED
+			// while in RS274X format, it means they're OMITTED
+			m_leadingZeroSuppression = false;
+		}
+		else if (Command(data, "T"))
+		{
+			char *end = NULL;
+			excellon_tool_number = strtoul( data, &end, 10 );
+			data = end;
+		}
+		else if (Command(data, "C"))
+		{
+			const char *end = NULL;
+			tool_diameter = special_strtod( data, &end );
+			data = end;
+		}
+		else if (Command(data, "M02"))
+		{
+			m02_found = true;
+		}
+		else if (Command(data, "M00"))
+		{
+			// End of program
+		}
+		else if ((Command(data, "M25")) ||
+			 (Command(data, "M31")) ||
+			 (Command(data, "M08")) ||
+			 (Command(data, "M01")))
+		{
+			// Beginning of pattern
+			printf("Pattern repetition is not yet supported\n");
+			return(false);
+		}
+		else if (Command(data, "R"))
+		{
+			printf("Pattern repetition is not yet supported\n");
+			return(false);
+
+			/*
+			char *end = NULL;
+			repetitions = strtoul( data, &end, 10 );
+			data = end;
+			*/
+		}
+		else if (Command(data, "M70"))
+		{
+			swap_axis = true;
+		}
+		else if (Command(data, "M80"))
+		{
+			mirror_image_x_axis = true;
+		}
+		else if (Command(data, "N"))
+		{
+			// Ignore block numbers
+			char *end = NULL;
+			strtoul( data, &end, 10 );
+			data = end;
+		}
+		else if (Command(data, "G05"))
+		{
+			Ignore("select drill mode (G05)");
+		}
+		else if (Command(data, "G81"))
+		{
+			Ignore("select drill mode (G81)");
+		}
+		else if (Command(data, "G04"))
+		{
+			Ignore("variable dwell (G04)");
+		}
+		else if (Command(data, "G90"))
+		{
+			m_absoluteCoordinatesMode = true; 	// It's the only mode we use anyway.
+		}
+        else if (Command(data, "ICIOFF"))
+		{
+			m_absoluteCoordinatesMode = true; 	// It's the only mode we use anyway.
+		}
+		else if (Command(data, "G91"))    // Incremental coordinates mode ON
+		{
+			m_absoluteCoordinatesMode = false;
+		}
+		else if (Command(data, "ICION"))    // Incremental coordinates mode ON
+		{
+			m_absoluteCoordinatesMode = false;
+		}
+		else if (Command(data, "G92"))
+		{
+			printf("Set zero (G92) is not yet supported\n");
+			return(false);
+		}
+		else if (Command(data, "G93"))
+		{
+			printf("Set zero (G93) is not yet supported\n");
+			return(false);
+		}
+		else if (Command(data, "M48"))
+		{
+			// Ignore 'Program Header to first "%"'
+		}
+		else if (Command(data, "M47"))
+		{
+			// Ignore 'Operator Message CRT Display'
+			break;	// Ignore the rest of the line.
+		}
+		else if (Command(data, "M71"))
+		{
+			m_units = 1.0;	// Metric
+		}
+		else if (Command(data, "M72"))
+		{
+			m_units = 25.4;	// Imperial
+		}
+		else if (Command(data, "S"))
+		{
+			const char *end = NULL;
+			m_spindle_speed = special_strtod( data, &end );
+			data = end;
+		}
+		else if (Command(data, "F"))
+		{
+			const char *end = NULL;
+			m_feed_rate = special_strtod( data, &end ) * m_units;
+			data = end;
+		}
+		else
+		{
+			printf("Unexpected command '%s'\n", data );
+			return(false);
+		} // End if - else
+	} // End while
+
+    if (excellon_tool_number > 0)
+	{
+		if ((tool_diameter <= 0.0) && m_allow_dummy_tool_definitions)
+		{
+			// The file doesn't define the tool's diameter.  Just convert the tool number into a value in thousanths
+			// of an inch and let it through.
+
+			tool_diameter = (excellon_tool_number * 0.001);
+		}
+
+		if (tool_diameter > 0.0)
+		{
+			// Keep a map of the tool numbers found in the Excellon file to those in our tool table.
+			m_tool_table_map.insert( std::make_pair( excellon_tool_number, ToolNumber( tool_diameter ) ));
+		}
+	} // End if - then
+
+	if (excellon_tool_number > 0)
+	{
+		// They may have selected a tool.
+		m_active_tool_number = m_tool_table_map[excellon_tool_number];
+	} // End if - then
+
+
+	if (position_has_been_set)
+	{
+		if (m_active_tool_number <= 0)
+		{
+			printf("Hole position defined without selecting a tool first\n");
+			return(false);
+		} // End if - then
+		else
+		{
+			double x = m_x;
+			double y = m_y;
+			if (m_mirror_image_x_axis) y *= -1.0; // mirror about X axis
+			if (m_mirror_image_y_axis) x *= -1.0; // mirror about Y axis
+
+			if (! Hole( m_active_tool_number, x, y, 0.0 )) return(false);
+		} // End if - else
+	} // End if - then
+
+
+
+	return(true);
+} // End ReadDataBlock() method
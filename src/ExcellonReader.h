@@ -0,0 +1,116 @@
+// ExcellonReader.h
+// Copyright (c) 2009, David Nicholls, Perttu "celero55" Ahola
+// This program is released under the BSD license. See the file COPYING for details.
+
+/*
+The part of the Excellon importer which reads the file.  It doesn't use HeeksCAD or OpenCASCADE,
+so that it can be timed on big panel files by test/excellon.cpp.  Excellon, in Excellon.h, makes
+the tools, points and drilling operations for what it reads.
+*/
+
+#pragma once
+
+#include <string>
+#include <map>
+#include <vector>
+
+// Finds the points which are already there, so that we don't duplicate them.  The points
+// are kept in a hash table of grid cells, twice as big as the tolerance, so that only the points in
+// the cells around a hole are compared with it, not all of them.
+class PointLookup
+{
+	public:
+		PointLookup();
+
+		void SetTolerance( const double tolerance );
+		bool Find( const double x, const double y, const double z, int *id ) const;
+		void Insert( const double x, const double y, const double z, const int id );
+
+	private:
+		typedef struct
+		{
+			long long ix, iy, iz;
+			double x, y, z;
+			int id;
+		} Entry_t;
+
+		typedef std::vector< Entry_t > Bucket_t;
+
+		double m_tolerance;
+		double m_cell_size;
+		std::vector< Bucket_t > m_buckets;
+		size_t m_count;
+
+		long long Cell( const double coordinate ) const;
+		size_t Hash( const long long ix, const long long iy, const long long iz ) const;
+		void Grow();
+};
+
+
+class ExcellonReader
+{
+	public:
+		ExcellonReader();
+		virtual ~ExcellonReader() { }
+
+		bool ReadFile( const char *file_name );
+		bool ReadData( const char *data, const size_t length );
+
+	protected:
+		// Returns our tool number for a drill of this diameter, in the file's units, adding one if there isn't one.
+		virtual int ToolNumber( const double diameter ) = 0;
+
+		// A hole, in mm, to be drilled with our tool number.
+		virtual bool Hole( const int tool_number, const double x, const double y, const double z ) = 0;
+
+		double m_units;	// 1 = mm, 25.4 = inches
+
+		bool m_mirror_image_x_axis;
+		bool m_mirror_image_y_axis;
+
+		bool m_allow_dummy_tool_definitions;
+
+		double m_spindle_speed;
+		double m_feed_rate;
+
+	private:
+
+		double special_strtod( const char *value, const char **end ) const;
+
+		// data_block is one line of the file, with the separators taken out, ending with a '\0'
+		bool ReadDataBlock( const char *data_block );
+
+		// counts a command which is ignored, to be listed once at the end, rather than for each line
+		void Ignore( const char *description );
+
+		double InterpretCoord(	const char *coordinate,
+					const char *coordinate_end,
+					const int digits_left_of_point,
+					const int digits_right_of_point,
+					const bool leading_zero_suppression,
+					const bool trailing_zero_suppression ) const;
+
+		int m_current_line;
+
+		bool m_leadingZeroSuppression;
+		bool m_trailingZeroSuppression;
+		bool m_absoluteCoordinatesMode;
+
+		unsigned int m_XDigitsLeftOfPoint;
+		unsigned int m_XDigitsRightOfPoint;
+
+		unsigned int m_YDigitsLeftOfPoint;
+		unsigned int m_YDigitsRightOfPoint;
+
+		int m_active_tool_number;
+
+		// Associates tool number in the Excellon file with our tool numbers.
+		typedef std::map< unsigned int, int > ToolTableMap_t;
+		ToolTableMap_t	m_tool_table_map;
+
+		double m_x, m_y;	// the position, before mirroring
+		std::string m_block;
+
+		typedef std::map< const char *, int > Ignored_t;	// keyed by the description's address; they are all literals
+		Ignored_t m_ignored;
+};
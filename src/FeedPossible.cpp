@@ -0,0 +1,107 @@
+// FeedPossible.cpp
+/*
+ * Copyright (c) 2009, Dan Heeks
+ * This program is released under the BSD license. See the file COPYING for
+ * details.
+ */
+
+#include "stdafx.h"
+#include "FeedPossible.h"
+
+#include <math.h>
+
+CFeedPossible::CFeedPossible(const std::vector<CCurve> &curves, double radius): m_radius(radius), m_min_x(0.0), m_min_y(0.0), m_cell_size(1.0), m_nx(0), m_ny(0), m_query(0)
+{
+	for(std::vector<CCurve>::const_iterator It = curves.begin(); It != curves.end(); It++)m_edges.AddCurve(*It);
+
+	double max_x, max_y;
+	if(!m_edges.GetBox(m_min_x, m_min_y, max_x, max_y))return;
+
+	// about one span to a cell
+	double width = max_x - m_min_x;
+	double height = max_y - m_min_y;
+	double size = (width > height) ? width : height;
+	m_cell_size = sqrt(width * height / m_edges.m_spans.size());
+	if(m_cell_size < size / 1000.0)m_cell_size = size / 1000.0; // all in a line
+	if(m_cell_size <= 0.0)m_cell_size = 1.0; // all in one place
+	m_nx = (int)(width / m_cell_size) + 1;
+	m_ny = (int)(height / m_cell_size) + 1;
+	m_cells.resize(m_nx * m_ny);
+	m_visited.resize(m_edges.m_spans.size(), 0);
+
+	for(int s = 0; s < (int)m_edges.m_spans.size(); s++)
+	{
+		double xmin, ymin, xmax, ymax;
+		m_edges.m_spans[s].GetBox(xmin, ymin, xmax, ymax);
+		int i0, j0, i1, j1;
+		CellRange(xmin, ymin, xmax, ymax, i0, j0, i1, j1);
+		for(int j = j0; j <= j1; j++)
+		{
+			for(int i = i0; i <= i1; i++)m_cells[j * m_nx + i].push_back(s);
+		}
+	}
+}
+
+void CFeedPossible::CellRange(double xmin, double ymin, double xmax, double ymax, int &i0, int &j0, int &i1, int &j1)const
+{
+	i0 = (int)floor((xmin - m_min_x) / m_cell_size);
+	j0 = (int)floor((ymin - m_min_y) / m_cell_size);
+	i1 = (int)floor((xmax - m_min_x) / m_cell_size);
+	j1 = (int)floor((ymax - m_min_y) / m_cell_size);
+	if(i0 < 0)i0 = 0;
+	if(j0 < 0)j0 = 0;
+	if(i1 >= m_nx)i1 = m_nx - 1;
+	if(j1 >= m_ny)j1 = m_ny - 1;
+}
+
+// counts the edges crossed by a line from x, y going in the x direction
+bool CFeedPossible::Inside(double x, double y)
+{
+	int j = (int)floor((y - m_min_y) / m_cell_size);
+	if(j < 0 || j >= m_ny)return false;
+	int i0 = (int)floor((x - m_min_x) / m_cell_size);
+	if(i0 >= m_nx)return false;
+	if(i0 < 0)i0 = 0;
+
+	m_query++;
+	bool inside = false;
+	for(int i = i0; i < m_nx; i++)
+	{
+		const std::vector<int> &cell = m_cells[j * m_nx + i];
+		for(std::vector<int>::const_iterator It = cell.begin(); It != cell.end(); It++)
+		{
+			if(m_visited[*It] == m_query)continue;
+			m_visited[*It] = m_query;
+			const CCurveSpan &span = m_edges.m_spans[*It];
+			if(span.Crosses(y) && span.X(y) > x)inside = !inside;
+		}
+	}
+	return inside;
+}
+
+bool CFeedPossible::Possible(double x0, double y0, double x1, double y1)
+{
+	if(x0 == x1 && y0 == y1)return true;
+	if(m_edges.m_spans.size() == 0)return false;
+
+	int i0, j0, i1, j1;
+	CellRange(((x0 < x1) ? x0 : x1) - m_radius, ((y0 < y1) ? y0 : y1) - m_radius, ((x0 > x1) ? x0 : x1) + m_radius, ((y0 > y1) ? y0 : y1) + m_radius, i0, j0, i1, j1);
+
+	m_query++;
+	for(int j = j0; j <= j1; j++)
+	{
+		for(int i = i0; i <= i1; i++)
+		{
+			const std::vector<int> &cell = m_cells[j * m_nx + i];
+			for(std::vector<int>::const_iterator It = cell.begin(); It != cell.end(); It++)
+			{
+				if(m_visited[*It] == m_query)continue;
+				m_visited[*It] = m_query;
+				if(m_edges.m_spans[*It].Distance(x0, y0, x1, y1) < m_radius)return false;
+			}
+		}
+	}
+
+	// it doesn't go near an edge, so it is all inside, or all outside
+	return Inside(x0, y0);
+}
@@ -0,0 +1,38 @@
+// FeedPossible.h
+/*
+ * Copyright (c) 2009, Dan Heeks
+ * This program is released under the BSD license. See the file COPYING for
+ * details.
+ */
+
+// Says whether the cutter can feed straight from one point to another without leaving an area, like feed_possible in area_funcs.py,
+// so it can stay down between the curves of a pocket. The cutter stays inside if the line it moves along is inside the area
+// and no nearer to any edge than its radius.
+// The edges are put in a grid when it is made, so each answer only looks at the edges near the move. One is made for each pocket
+// and used for all the moves at all the depths.
+// It has no wx or OpenCascade in it.
+
+#pragma once
+
+#include "CurveSpans.h"
+
+class CFeedPossible
+{
+	CCurveSpans m_edges;
+	double m_radius;
+	double m_min_x, m_min_y;
+	double m_cell_size;
+	int m_nx, m_ny;
+	std::vector< std::vector<int> > m_cells; // the spans in each cell
+	std::vector<int> m_visited; // the last query which looked at each span, so a span in more than one cell is only looked at once
+	int m_query;
+
+	void CellRange(double xmin, double ymin, double xmax, double ymax, int &i0, int &j0, int &i1, int &j1)const;
+	bool Inside(double x, double y);
+
+public:
+	// curves are the area, which are closed; the outsides and the islands, going either way round
+	CFeedPossible(const std::vector<CCurve> &curves, double radius);
+
+	bool Possible(double x0, double y0, double x1, double y1);
+};
@@ -1,5 +1,7 @@
 // GTri.h
 
+#pragma once
+
 // triangle used for Anders's DropCutter code
 // written by Dan Heeks starting on May 2nd 2008
 
@@ -42,18 +44,18 @@ public:
 		if(m_p[7] > m_box[3])m_box[3] = m_p[7];
 	}
 
-	static bool box_in_box(double *this_box, double *box){
-		if(this_box[0]<box[0]-heeksCAD->GetTolerance()){
+	static bool box_in_box(double *this_box, double *box, double tolerance){
+		if(this_box[0]<box[0]-tolerance){
 			// left of tri is left of box
-			if(this_box[2]<box[0]-heeksCAD->GetTolerance()){
+			if(this_box[2]<box[0]-tolerance){
 				// right of tri is left of box
 				return false;
 			}
-			else if(this_box[2]<box[2] + heeksCAD->GetTolerance()){
+			else if(this_box[2]<box[2] + tolerance){
 				// right of tri is in box
-				if(this_box[1]<box[1]-heeksCAD->GetTolerance()){
+				if(this_box[1]<box[1]-tolerance){
 					// bottom of tri is below box
-					if(this_box[3]<box[1]-heeksCAD->GetTolerance()){
+					if(this_box[3]<box[1]-tolerance){
 						// top of tri is below of box
 						return false;
 					}
@@ -62,7 +64,7 @@ public:
 						return true;
 					}
 				}
-				else if(this_box[1]<box[3]+heeksCAD->GetTolerance()){
+				else if(this_box[1]<box[3]+tolerance){
 					// bottom of tri is in box
 					return true;
 				}
@@ -73,7 +75,7 @@ public:
 			}
 			else{
 				// right of tri is right of box
-				if(this_box[1]>box[1]-heeksCAD->GetTolerance() && this_box[3]<box[3]+heeksCAD->GetTolerance()){
+				if(this_box[1]>box[1]-tolerance && this_box[3]<box[3]+tolerance){
 					// top and bottom within box
 					return true;
 				}
@@ -82,11 +84,11 @@ public:
 				}
 			}
 		}
-		else if(this_box[0]<box[2]+heeksCAD->GetTolerance()){
+		else if(this_box[0]<box[2]+tolerance){
 			// left of tri is within box
-			if(this_box[1]<box[1]-heeksCAD->GetTolerance()){
+			if(this_box[1]<box[1]-tolerance){
 				// bottom of tri is below box
-				if(this_box[3]<box[1]-heeksCAD->GetTolerance()){
+				if(this_box[3]<box[1]-tolerance){
 					// top of tri is below of box
 					return false;
 				}
@@ -95,7 +97,7 @@ public:
 					return true;
 				}
 			}
-			else if(this_box[1]<box[3]+heeksCAD->GetTolerance()){
+			else if(this_box[1]<box[3]+tolerance){
 				// bottom of tri is in box
 				return true;
 			}
@@ -111,3 +113,32 @@ public:
 	}
 };
 
+// a few triangles, with their coordinates in separate arrays, for DropCutter's batch tests
+class GTriBatch{
+public:
+	enum { SIZE = 4 }; // four doubles fit in an AVX register
+
+	double m_x[3][SIZE], m_y[3][SIZE], m_z[3][SIZE]; // the three points of each triangle
+	double m_n[3][SIZE]; // normals
+
+	void set(int i, const GTri &t){
+		for(int j = 0; j<3; j++){
+			m_x[j][i] = t.m_p[j * 3];
+			m_y[j][i] = t.m_p[j * 3 + 1];
+			m_z[j][i] = t.m_p[j * 3 + 2];
+			m_n[j][i] = t.m_n[j];
+		}
+	}
+
+	// fills the rest of the batch with copies of the first triangle, which don't change the result
+	void fill(int number_of_triangles){
+		for(int i = number_of_triangles; i<SIZE; i++){
+			for(int j = 0; j<3; j++){
+				m_x[j][i] = m_x[j][0];
+				m_y[j][i] = m_y[j][0];
+				m_z[j][i] = m_z[j][0];
+				m_n[j][i] = m_n[j][0];
+			}
+		}
+	}
+};
@@ -42,6 +42,7 @@
 #include "Surfaces.h"
 #include "Stock.h"
 #include "Stocks.h"
+#include "PythonInterpreter.h"
 
 #include <sstream>
 
@@ -62,6 +63,7 @@ CHeeksCNCApp::CHeeksCNCApp()
 	m_icon_texture_number = 0;
 	m_machining_hidden = false;
 	m_settings_restored = false;
+	m_location_known = true;
 }
 
 CHeeksCNCApp::~CHeeksCNCApp(){
@@ -76,6 +78,8 @@ void CHeeksCNCApp::OnDestroyDLL()
 	// save any settings
 	//config.Write("SolidSimWorkingDir", m_working_dir_for_solid_sim);
 
+	CPythonInterpreter::Finish();
+
 #if !defined WXUSINGDLL
 	wxUninitialize();
 #endif
@@ -480,6 +484,13 @@ static void PostProcessMenuCallback(wxCommandEvent &event)
 	// write the python program
 	theApp.m_program->RewritePythonProgram();
 
+	// write the NC code without python, if it can be done
+	if(theApp.m_program->WriteNC())
+	{
+		HeeksPyBackplot(theApp.m_program, theApp.m_program, theApp.m_program->GetOutputFileName());
+		return;
+	}
+
 	// run it
 	theApp.RunPythonScript();
 }
@@ -490,9 +501,16 @@ static void CancelMenuCallback(wxCommandEvent &event)
 }
 
 static void SimulateCallback(wxCommandEvent &event)
+{
+    RunDexelSimulation();
+}
+
+#ifdef WIN32
+static void VoxelcutSimulateCallback(wxCommandEvent &event)
 {
     RunVoxelcutSimulation();
 }
+#endif
 
 static void OpenNcFileMenuCallback(wxCommandEvent& event)
 {
@@ -882,8 +900,21 @@ class HeeksCADObserver: public Observer
 public:
     std::map<int, SketchBox> m_box_map;
 
+    static bool ContainsSolid(const std::list<HeeksObj*>* list)
+    {
+        if(list == NULL)return false;
+        for(std::list<HeeksObj*>::const_iterator It = list->begin(); It != list->end(); It++)
+        {
+            if((*It)->GetType() == SolidType)return true;
+        }
+        return false;
+    }
+
     void OnChanged(const std::list<HeeksObj*>* added, const std::list<HeeksObj*>* removed, const std::list<HeeksObj*>* modified)
     {
+        // the surfaces' stl files have to be checked again
+        if(ContainsSolid(added) || ContainsSolid(removed) || ContainsSolid(modified))CSurface::OnSolidsChanged();
+
         if(added)
         {
             for(std::list<HeeksObj*>::const_iterator It = added->begin(); It != added->end(); It++)
@@ -1104,6 +1135,9 @@ void CHeeksCNCApp::OnStartUp(CHeeksCADInterface* h, const wxString& dll_path)
 	heeksCAD->AddMenuItem(menuMachining, _("Run Python Script"), ToolImage(theApp.GetBitmapPath(_T("runpython")), true), RunScriptMenuCallback);
 	heeksCAD->AddMenuItem(menuMachining, _("Post-Process"), ToolImage(theApp.GetBitmapPath(_T("postprocess")), true), PostProcessMenuCallback);
 	heeksCAD->AddMenuItem(menuMachining, _("Simulate"), ToolImage(theApp.GetBitmapPath(_T("simulate")), true), SimulateCallback);
+#ifdef WIN32
+	heeksCAD->AddMenuItem(menuMachining, _("Simulate with VoxelCut"), ToolImage(theApp.GetBitmapPath(_T("simulate")), true), VoxelcutSimulateCallback);
+#endif
 	heeksCAD->AddMenuItem(menuMachining, _("Open NC File..."), ToolImage(theApp.GetBitmapPath(_T("opennc")), true), OpenNcFileMenuCallback);
 	heeksCAD->AddMenuItem(menuMachining, _("Save NC File as..."), ToolImage(theApp.GetBitmapPath(_T("savenc")), true), SaveNcFileMenuCallback);
 	heeksCAD->AddMenuItem(menuMachining, _("Send to Machine"), ToolImage(theApp.GetBitmapPath(_T("tomachine")), true), SendToMachineMenuCallback);
@@ -1137,6 +1171,11 @@ void CHeeksCNCApp::OnStartUp(CHeeksCADInterface* h, const wxString& dll_path)
 	CSendToMachine::ReadFromConfig();
 	config.Read(_T("UseClipperNotBoolean"), m_use_Clipper_not_Boolean, false);
 	config.Read(_T("UseDOSNotUnix"), m_use_DOS_not_Unix, false);
+	config.Read(_T("UseNativeNCReader"), m_use_native_nc_reader, true);
+	config.Read(_T("CacheOperationsNC"), m_cache_operations_nc, true);
+	config.Read(_T("PostOperationsInParallel"), m_post_operations_in_parallel, true);
+	config.Read(_T("UseEmbeddedPython"), m_use_embedded_python, true);
+	config.Read(_T("UseNativeNCWriter"), m_use_native_nc_writer, true);
 	aui_manager->GetPane(m_program_canvas).Show(program_visible);
 	aui_manager->GetPane(m_output_canvas).Show(output_visible);
 	aui_manager->GetPane(m_print_canvas).Show(output_visible);
@@ -1363,6 +1402,11 @@ void CHeeksCNCApp::InitializeProperties()
 
 	m_use_Clipper_not_Boolean.Initialize(_("Use Clipper not Boolean"), &machining_options);
 	m_use_DOS_not_Unix.Initialize(_("Use DOS Line Endings"), &machining_options);
+	m_use_native_nc_reader.Initialize(_("Use built-in NC reader for backplot"), &machining_options);
+	m_cache_operations_nc.Initialize(_("Only post operations which have changed"), &machining_options);
+	m_post_operations_in_parallel.Initialize(_("Post operations in parallel"), &machining_options);
+	m_use_embedded_python.Initialize(_("Post and backplot without starting python"), &machining_options);
+	m_use_native_nc_writer.Initialize(_("Use built-in NC writer for drilling on standard machines"), &machining_options);
 }
 
 void CHeeksCNCApp::GetProperties(std::list<Property *> *list)
@@ -1386,6 +1430,11 @@ void CHeeksCNCApp::OnFrameDelete()
 	CSendToMachine::WriteToConfig();
 	config.Write(_T("UseClipperNotBoolean"), m_use_Clipper_not_Boolean);
     config.Write(_T("UseDOSNotUnix"), m_use_DOS_not_Unix);
+	config.Write(_T("UseNativeNCReader"), m_use_native_nc_reader);
+	config.Write(_T("CacheOperationsNC"), m_cache_operations_nc);
+	config.Write(_T("PostOperationsInParallel"), m_post_operations_in_parallel);
+	config.Write(_T("UseEmbeddedPython"), m_use_embedded_python);
+	config.Write(_T("UseNativeNCWriter"), m_use_native_nc_writer);
 }
 
 Python CHeeksCNCApp::SetTool( const int new_tool )
@@ -1405,6 +1454,7 @@ Python CHeeksCNCApp::SetTool( const int new_tool )
         if(m_attached_to_surface)
         {
             python << _T("nc.creator.set_ocl_cutter(") << pTool->OCLDefinition(m_attached_to_surface) << _T(")\n");
+            python << _T("nc.creator.set_native_cutter(") << pTool->NativeCutterDefinition(m_attached_to_surface) << _T(")\n");
         }
     } // End if - then
 
@@ -45,11 +45,17 @@ public:
 	PropertyList text_colors;
 	PropertyCheck m_use_Clipper_not_Boolean;
 	PropertyCheck m_use_DOS_not_Unix;
+	PropertyCheck m_use_native_nc_reader;
+	PropertyCheck m_cache_operations_nc;
+	PropertyCheck m_post_operations_in_parallel;
+	PropertyCheck m_use_embedded_python;
+	PropertyCheck m_use_native_nc_writer;
 	PropertyList excellon_options;
 
 	CSurface* m_attached_to_surface;
 	int  m_tool_number;
 	CNCPoint m_location;
+	bool m_location_known; // false after an operation which doesn't set m_location, see COp::SetsLocation
 	bool m_settings_restored;
 
 	CHeeksCNCApp();
@@ -43,6 +43,7 @@ enum{
     SurfacesType,
     StockType,
     StocksType,
+    SimulatedStockType,
 
 	HeeksCNCMaximumType
 };
@@ -0,0 +1,923 @@
+// IsoCreator.cpp
+/*
+ * Copyright (c) 2009, Dan Heeks
+ * This program is released under the BSD license. See the file COPYING for
+ * details.
+ */
+
+#include "stdafx.h"
+#include "IsoCreator.h"
+
+#include <time.h>
+
+// what python 2's str() gives for a float
+static std::string PyStr(double value)
+{
+	char s[64];
+	sprintf(s, "%.12g", value);
+	std::string str(s);
+	if(str.find_first_of(".en") == std::string::npos)str += ".0";
+	return str;
+}
+
+static std::string IntStr(int i)
+{
+	char s[32];
+	sprintf(s, "%d", i);
+	return s;
+}
+
+// what python gets from the number in the program, see PythonString(const double)
+static std::string ProgramStr(double value)
+{
+	char s[64];
+	sprintf(s, "%.10g", value);
+	return s;
+}
+
+std::string CNCFormat::string(CNCValue number)const
+{
+	if(!number.m_set)return "None";
+
+	double f = number.m_value * pow(10.0, number_of_decimal_places);
+	std::string s = PyStr(f);
+
+	if(!round_down)
+	{
+		if(f < 0)f = f - .5;
+		else f = f + .5;
+		s = PyStr(number.m_value);
+	}
+
+	if(fabs(f) < 1.0)s = "0";
+
+	bool minus = false;
+	if(s[0] == '-')
+	{
+		minus = true;
+		if(no_minus)s = s.substr(1);
+	}
+
+	std::string before_dp, after_dp;
+	size_t dot = s.find('.');
+	if(dot == std::string::npos)
+	{
+		before_dp = s;
+	}
+	else
+	{
+		before_dp = s.substr(0, dot);
+		after_dp = s.substr(dot + 1, number_of_decimal_places);
+	}
+
+	while((int)before_dp.size() < add_leading_zeros)before_dp = "0" + before_dp;
+	if(add_trailing_zeros)
+	{
+		while((int)after_dp.size() < number_of_decimal_places)after_dp += "0";
+	}
+	else
+	{
+		size_t last = after_dp.find_last_not_of('0');
+		after_dp.erase((last == std::string::npos) ? 0 : last + 1);
+	}
+
+	s = "";
+	if(!minus && add_plus)s += "+";
+	s += before_dp;
+	if(after_dp.size() > 0)
+	{
+		if(dp_wanted)s += ".";
+		s += after_dp;
+	}
+
+	return s;
+}
+
+void CNCAddress::set(double n)
+{
+	str = text + fmt.string(n);
+	str_set = true;
+}
+
+void CNCAddress::write(CIsoCreator &writer)
+{
+	if(!str_set)return;
+	if(modal)
+	{
+		if(!previous_set || str != previous)
+		{
+			writer.write(str);
+			previous = str;
+			previous_set = true;
+		}
+	}
+	else
+	{
+		writer.write(str);
+	}
+	str_set = false;
+}
+
+void CNCAddressPlusMinus::set(double n, const std::string &text_plus, const std::string &text_minus)
+{
+	CNCAddress::set(n);
+	str2 = (n > 0.0) ? text_plus : text_minus;
+	str2_set = true;
+}
+
+void CNCAddressPlusMinus::write(CIsoCreator &writer)
+{
+	CNCAddress::write(writer);
+	if(!str2_set)return;
+	if(modal)
+	{
+		if(!previous2_set || str2 != previous2)
+		{
+			writer.write(writer.SPACE());
+			writer.write(str2);
+			previous2 = str2;
+			previous2_set = true;
+		}
+	}
+	else
+	{
+		writer.write(writer.SPACE());
+		writer.write(str2);
+	}
+	str2_set = false;
+}
+
+CIsoCreator::CIsoCreator(void)
+	: m_file(NULL), m_emc2b(false), m_f("F", CNCFormat(2)), m_fhv(false), m_g_plane("G", CNCFormat(0)), m_s("S", CNCFormat(2), false),
+	m_g0123_modal(false), m_drill_modal(false), m_absolute_flag(true), m_in_canned_cycle(false), m_first_drill_pos(true),
+	m_shift_x(0.0), m_shift_y(0.0), m_shift_z(0.0), m_start_of_line(false), m_g98_not_g99(-1),
+	m_arc_centre_absolute(false), m_drillExpanded(false), m_dwell_allowed_in_G83(false), m_output_block_numbers(true),
+	m_start_block_number(10), m_block_number_increment(10), m_output_tool_definitions(true), m_output_g43_on_tool_change_line(false),
+	m_output_g98_and_g99(true), m_output_g43_z_before_drilling_if_g98(false), m_output_comment_before_tool_change(true)
+{
+}
+
+CIsoCreator::~CIsoCreator(void)
+{
+	if(m_file)fclose(m_file);
+}
+
+//static
+CIsoCreator* CIsoCreator::New(const std::string &post)
+{
+	CIsoCreator* creator = NULL;
+	if(post == "iso")
+	{
+		creator = new CIsoCreator;
+	}
+	else if(post == "iso_modal" || post == "siegkx1" || post == "emc2b")
+	{
+		creator = new CIsoCreator;
+		creator->m_g0123_modal = true;
+		creator->m_drill_modal = true;
+		if(post == "siegkx1")
+		{
+			creator->m_output_tool_definitions = false;
+		}
+		else if(post == "emc2b")
+		{
+			creator->m_emc2b = true;
+			creator->m_space = " ";
+			creator->m_output_block_numbers = false;
+			creator->m_output_tool_definitions = false;
+			creator->m_output_g43_on_tool_change_line = true;
+		}
+	}
+	return creator;
+}
+
+bool CIsoCreator::file_open(const char* name)
+{
+	m_file = fopen(name, "w");
+	m_filename = name;
+	return m_file != NULL;
+}
+
+void CIsoCreator::write(const std::string &s)
+{
+	if(m_file)fputs(s.c_str(), m_file);
+	if(s.find('\n') != std::string::npos)m_start_of_line = (s[s.size() - 1] == '\n');
+}
+
+std::string CIsoCreator::SPACE(void)
+{
+	if(m_start_of_line)
+	{
+		m_start_of_line = false;
+		return "";
+	}
+	return m_space;
+}
+
+std::string CIsoCreator::TOOL(int id)
+{
+	std::string s = "T" + IntStr(id);
+	s += SPACE();
+	return s + "M06";
+}
+
+std::string CIsoCreator::DWELL(double dwell)
+{
+	std::string s = "G04";
+	s += SPACE();
+	return s + "P" + m_fmt.string(dwell);
+}
+
+std::string CIsoCreator::DRILL_WITH_DWELL(double dwell)
+{
+	std::string s = "G82";
+	s += SPACE();
+	return s + "P" + m_fmt.string(dwell);
+}
+
+std::string CIsoCreator::PECK_DEPTH(double depth)
+{
+	return "Q" + m_fmt.string(depth);
+}
+
+std::string CIsoCreator::RETRACT(double height)
+{
+	return "R" + m_fmt.string(height);
+}
+
+std::string CIsoCreator::PROGRAM_END(void)
+{
+	if(!m_emc2b)return "M02";
+	std::string s = "T0";
+	s += SPACE();
+	s += "M06";
+	s += SPACE();
+	return s + "M02";
+}
+
+void CIsoCreator::write_feedrate(void)
+{
+	write(SPACE());
+	m_f.write(*this);
+}
+
+void CIsoCreator::write_preps(void)
+{
+	if(m_g_plane.str_set && m_g_plane.str.size() > 0)write(SPACE());
+	m_g_plane.write(*this);
+	for(size_t i = 0; i < m_g_list.size(); i++)
+	{
+		std::string s = SPACE();
+		write(s + m_g_list[i]);
+	}
+	m_g_list.clear();
+}
+
+void CIsoCreator::write_misc(void)
+{
+	if(m_m.size() > 0)
+	{
+		write(SPACE());
+		write(m_m.back());
+		m_m.pop_back();
+	}
+}
+
+void CIsoCreator::write_spindle(void)
+{
+	write(SPACE());
+	m_s.write(*this);
+}
+
+void CIsoCreator::program_begin(int id, const std::string &name)
+{
+	if(m_emc2b)
+	{
+		time_t now = time(NULL);
+		char date[64];
+		strftime(date, sizeof(date), "%Y/%m/%d %H:%M", localtime(&now));
+		write(std::string("(Created with emc2b post processor ") + date + ")" + "\n");
+		return;
+	}
+
+	std::string s = "O" + IntStr(id);
+	s += SPACE();
+	write(s + "(" + name + ")");
+	write("\n");
+}
+
+void CIsoCreator::program_end(void)
+{
+	std::string s = SPACE();
+	s += PROGRAM_END();
+	write(s + "\n");
+
+	if(m_file)fclose(m_file);
+	m_file = NULL;
+
+	// number every line of the file afterwards
+	if(m_output_block_numbers)number_file();
+}
+
+void CIsoCreator::number_file(void)
+{
+	FILE* f = fopen(m_filename.c_str(), "r");
+	if(f == NULL)return;
+	std::vector<std::string> lines;
+	std::string line;
+	char buffer[1024];
+	while(fgets(buffer, sizeof(buffer), f))
+	{
+		line += buffer;
+		if(line[line.size() - 1] == '\n')
+		{
+			lines.push_back(line);
+			line.clear();
+		}
+	}
+	if(line.size() > 0)lines.push_back(line);
+	fclose(f);
+
+	f = fopen(m_filename.c_str(), "w");
+	if(f == NULL)return;
+	int n = m_start_block_number;
+	for(size_t i = 0; i < lines.size(); i++)
+	{
+		fprintf(f, "N%d%s", n, lines[i].c_str());
+		n += m_block_number_increment;
+	}
+	fclose(f);
+}
+
+void CIsoCreator::flush_nc(void)
+{
+	if(m_g_list.size() == 0 && m_m.size() == 0)return;
+	write_preps();
+	write_misc();
+	write("\n");
+}
+
+void CIsoCreator::imperial(void)
+{
+	m_g_list.push_back("G20");
+	m_fmt.number_of_decimal_places = 4;
+}
+
+void CIsoCreator::metric(void)
+{
+	m_g_list.push_back("G21");
+	m_fmt.number_of_decimal_places = 3;
+}
+
+void CIsoCreator::absolute(void)
+{
+	m_g_list.push_back("G90");
+	m_absolute_flag = true;
+}
+
+void CIsoCreator::incremental(void)
+{
+	m_g_list.push_back("G91");
+	m_absolute_flag = false;
+}
+
+void CIsoCreator::set_plane(int plane)
+{
+	if(plane >= 0 && plane <= 2)m_g_plane.set(17 + plane);
+}
+
+void CIsoCreator::tool_defn(int id, const std::string &name, const CNCToolParams &params)
+{
+	m_tool_defn_params[id] = params;
+	if(m_output_tool_definitions)
+	{
+		std::string s = SPACE();
+		s += "G10";
+		s += SPACE();
+		write(s + "L1");
+		s = SPACE();
+		write(s + "P" + IntStr(id) + " ");
+
+		char value[64];
+		if(params.diameter.m_set)
+		{
+			s = SPACE();
+			sprintf(value, "R%.3f", params.diameter.m_value / 2);
+			write(s + value);
+		}
+
+		if(params.cutting_edge_height.m_set)
+		{
+			s = SPACE();
+			sprintf(value, "Z%.3f", params.cutting_edge_height.m_value);
+			write(s + value);
+		}
+
+		write("\n");
+	}
+}
+
+void CIsoCreator::tool_change(int id)
+{
+	if(m_output_comment_before_tool_change)comment("tool change to " + m_tool_defn_params[id].name);
+
+	std::string s = SPACE();
+	write(s + TOOL(id));
+	if(m_output_g43_on_tool_change_line)
+	{
+		s = SPACE();
+		write(s + "G43");
+	}
+	write("\n");
+	m_t = id;
+}
+
+void CIsoCreator::workplane(int id)
+{
+	if(id >= 1 && id <= 6)m_g_list.push_back("G" + IntStr(id + 53));
+	if(id >= 7 && id <= 9)m_g_list.push_back("G59." + IntStr(id - 6));
+}
+
+void CIsoCreator::feedrate(double f)
+{
+	m_f.set(f);
+	m_fhv = false;
+}
+
+void CIsoCreator::feedrate_slot(double fslot)
+{
+	m_fslot = fslot;
+}
+
+void CIsoCreator::feedrate_hv(double fh, double fv)
+{
+	m_fh = fh;
+	m_fv = fv;
+	m_fhv = true;
+}
+
+void CIsoCreator::calc_feedrate_hv(double h, double v, double slot_ratio)
+{
+	if(fabs(v) > fabs(h * 2))
+	{
+		// not much, if any horizontal component, so use the vertical feed rate
+		m_f.set(m_fv.m_value);
+	}
+	else
+	{
+		// some horizontal, so it should be fine to use the horizontal feed rate
+		m_f.set(m_fslot.m_value * slot_ratio + m_fh.m_value * (1.0 - slot_ratio));
+	}
+}
+
+void CIsoCreator::spindle(double s, bool clockwise)
+{
+	if(clockwise)m_s.set(s, "M03", "M04");
+	else m_s.set(s, "M04", "M03");
+}
+
+void CIsoCreator::coolant(int mode)
+{
+	if(mode <= 0)m_m.push_back("M09");
+	else if(mode == 1)m_m.push_back("M07");
+	else if(mode == 2)m_m.push_back("M08");
+}
+
+void CIsoCreator::set_path_control_mode(int mode, double motion_blending_tolerance, double naive_cam_tolerance)
+{
+	if(mode == 0)write("G61\n");
+	if(mode == 1)write("G61.1\n");
+	if(mode == 2)
+	{
+		std::string statement = "G64";
+		if(motion_blending_tolerance > 0)statement += " P " + ProgramStr(motion_blending_tolerance);
+		if(naive_cam_tolerance > 0)statement += " Q " + ProgramStr(naive_cam_tolerance);
+		write(statement + "\n");
+	}
+}
+
+bool CIsoCreator::same_xyz(CNCValue x, CNCValue y, CNCValue z)
+{
+	if(x.m_set && m_fmt.string(x.m_value + m_shift_x) != m_fmt.string(m_x))return false;
+	if(y.m_set && m_fmt.string(y.m_value + m_shift_y) != m_fmt.string(m_y))return false;
+	if(z.m_set && m_fmt.string(z.m_value + m_shift_z) != m_fmt.string(m_z))return false;
+	return true;
+}
+
+void CIsoCreator::rapid(CNCValue x, CNCValue y, CNCValue z)
+{
+	if(same_xyz(x, y, z))return;
+
+	std::string s;
+	if(m_g0123_modal)
+	{
+		if(m_prev_g0123 != "G00")
+		{
+			s = SPACE();
+			write(s + "G00");
+			m_prev_g0123 = "G00";
+		}
+	}
+	else
+	{
+		s = SPACE();
+		write(s + "G00");
+	}
+	write_preps();
+
+	if(x.m_set)
+	{
+		s = SPACE();
+		write(s + "X" + m_fmt.string(m_absolute_flag ? (x.m_value + m_shift_x) : (x.m_value - m_x.m_value)));
+		m_x = x;
+	}
+	if(y.m_set)
+	{
+		s = SPACE();
+		write(s + "Y" + m_fmt.string(m_absolute_flag ? (y.m_value + m_shift_y) : (y.m_value - m_y.m_value)));
+		m_y = y;
+	}
+	if(z.m_set)
+	{
+		s = SPACE();
+		write(s + "Z" + m_fmt.string(m_absolute_flag ? (z.m_value + m_shift_z) : (z.m_value - m_z.m_value)));
+		m_z = z;
+	}
+
+	write_spindle();
+	write_misc();
+	write("\n");
+}
+
+void CIsoCreator::feed(double slot_ratio, CNCValue x, CNCValue y, CNCValue z)
+{
+	if(same_xyz(x, y, z))return;
+
+	std::string s;
+	if(m_g0123_modal)
+	{
+		if(m_prev_g0123 != "G01")
+		{
+			s = SPACE();
+			write(s + "G01");
+			m_prev_g0123 = "G01";
+		}
+	}
+	else
+	{
+		write("G01");
+	}
+	write_preps();
+
+	double dx = 0.0, dy = 0.0, dz = 0.0;
+	if(x.m_set)
+	{
+		dx = x.m_value - m_x.m_value;
+		s = SPACE();
+		write(s + "X" + m_fmt.string(m_absolute_flag ? (x.m_value + m_shift_x) : dx));
+		m_x = x;
+	}
+	if(y.m_set)
+	{
+		dy = y.m_value - m_y.m_value;
+		s = SPACE();
+		write(s + "Y" + m_fmt.string(m_absolute_flag ? (y.m_value + m_shift_y) : dy));
+		m_y = y;
+	}
+	if(z.m_set)
+	{
+		dz = z.m_value - m_z.m_value;
+		s = SPACE();
+		write(s + "Z" + m_fmt.string(m_absolute_flag ? (z.m_value + m_shift_z) : dz));
+		m_z = z;
+	}
+
+	if(m_fhv)calc_feedrate_hv(sqrt(dx * dx + dy * dy), fabs(dz), slot_ratio);
+	write_feedrate();
+	write_spindle();
+	write_misc();
+	write("\n");
+}
+
+void CIsoCreator::arc(bool cw, double slot_ratio, CNCValue x, CNCValue y, CNCValue z, CNCValue i, CNCValue j, CNCValue k, CNCValue r)
+{
+	// none of these posts split helical arcs or arcs into quadrants
+	if(same_xyz(x, y, z))return;
+
+	std::string arc_g_code = cw ? "G02" : "G03";
+	std::string s;
+	if(m_g0123_modal)
+	{
+		if(m_prev_g0123 != arc_g_code)
+		{
+			s = SPACE();
+			write(s + arc_g_code);
+			m_prev_g0123 = arc_g_code;
+		}
+	}
+	else
+	{
+		write(arc_g_code);
+	}
+	write_preps();
+
+	if(x.m_set)
+	{
+		s = SPACE();
+		write(s + "X" + m_fmt.string(m_absolute_flag ? (x.m_value + m_shift_x) : (x.m_value - m_x.m_value)));
+	}
+	if(y.m_set)
+	{
+		s = SPACE();
+		write(s + "Y" + m_fmt.string(m_absolute_flag ? (y.m_value + m_shift_y) : (y.m_value - m_y.m_value)));
+	}
+	if(z.m_set)
+	{
+		s = SPACE();
+		write(s + "Z" + m_fmt.string(m_absolute_flag ? (z.m_value + m_shift_z) : (z.m_value - m_z.m_value)));
+	}
+	if(i.m_set)
+	{
+		if(!m_arc_centre_absolute)i.m_value -= m_x.m_value;
+		s = SPACE();
+		write(s + "I" + m_fmt.string(i));
+	}
+	if(j.m_set)
+	{
+		if(!m_arc_centre_absolute)j.m_value -= m_y.m_value;
+		s = SPACE();
+		write(s + "J" + m_fmt.string(j));
+	}
+	if(k.m_set)
+	{
+		if(!m_arc_centre_absolute)k.m_value -= m_z.m_value;
+		s = SPACE();
+		write(s + "K" + m_fmt.string(k));
+	}
+	if(r.m_set)
+	{
+		s = SPACE();
+		write(s + "R" + m_fmt.string(r));
+	}
+
+	// use horizontal feed rate
+	if(m_fhv)calc_feedrate_hv(1, 0, slot_ratio);
+	write_feedrate();
+	write_spindle();
+	write_misc();
+	write("\n");
+
+	if(x.m_set)m_x = x;
+	if(y.m_set)m_y = y;
+	if(z.m_set)m_z = z;
+}
+
+void CIsoCreator::arc_cw(double slot_ratio, CNCValue x, CNCValue y, CNCValue z, CNCValue i, CNCValue j, CNCValue k, CNCValue r)
+{
+	arc(true, slot_ratio, x, y, z, i, j, k, r);
+}
+
+void CIsoCreator::arc_ccw(double slot_ratio, CNCValue x, CNCValue y, CNCValue z, CNCValue i, CNCValue j, CNCValue k, CNCValue r)
+{
+	arc(false, slot_ratio, x, y, z, i, j, k, r);
+}
+
+void CIsoCreator::dwell(double t)
+{
+	write_preps();
+	std::string s = SPACE();
+	write(s + DWELL(t));
+	write_misc();
+	write("\n");
+}
+
+void CIsoCreator::drill(CNCValue x, CNCValue y, double dwell, const CNCDepthParams &depthparams, int retract_mode, int spindle_mode, bool internal_coolant_on, bool rapid_to_clearance)
+{
+	bool drillExpanded = m_drillExpanded;
+	if(depthparams.step_down != 0 && dwell != 0)
+	{
+		// pecking and dwell together
+		if(!m_dwell_allowed_in_G83)drillExpanded = true;
+	}
+
+	if(drillExpanded)
+	{
+		// for machines which don't understand G81, G82 etc.
+		double peck_depth = depthparams.step_down;
+		double current_z = depthparams.start_depth;
+		rapid(x, y);
+
+		bool first = true;
+		bool last_cut = false;
+
+		while(true)
+		{
+			double next_z = current_z - peck_depth;
+			if(next_z < (depthparams.final_depth + 0.001))
+			{
+				next_z = depthparams.final_depth;
+				last_cut = true;
+			}
+			if(next_z >= current_z)break;
+			if(first)rapid(CNCValue(), CNCValue(), depthparams.start_depth + depthparams.rapid_safety_space);
+			else rapid(CNCValue(), CNCValue(), current_z);
+			feed(0.0, CNCValue(), CNCValue(), next_z);
+			if(dwell != 0 && last_cut)this->dwell(dwell);
+			if(last_cut || rapid_to_clearance)rapid(CNCValue(), CNCValue(), depthparams.clearance_height);
+			else rapid(CNCValue(), CNCValue(), depthparams.start_depth + depthparams.rapid_safety_space);
+			current_z = next_z;
+			first = false;
+		}
+
+		m_first_drill_pos = false;
+		return;
+	}
+
+	std::string s;
+	if(m_output_g98_and_g99)
+	{
+		if(rapid_to_clearance && m_output_g43_z_before_drilling_if_g98)
+		{
+			if(m_fmt.string(depthparams.clearance_height) != m_z_for_g43)
+			{
+				m_z_for_g43 = m_fmt.string(depthparams.clearance_height);
+				s = SPACE();
+				s += "G43";
+				s += SPACE();
+				write(s + "Z" + m_z_for_g43 + "\n");
+			}
+		}
+
+		if(m_first_drill_pos && rapid_to_clearance)
+		{
+			rapid(x, y);
+			rapid(CNCValue(), CNCValue(), depthparams.clearance_height);
+		}
+	}
+
+	m_in_canned_cycle = true;
+	write_preps();
+
+	if(depthparams.step_down != 0)
+	{
+		// G83 peck drilling
+		if(m_drill_modal)
+		{
+			if("G83" + PECK_DEPTH(depthparams.step_down) != m_prev_drill)
+			{
+				s = SPACE();
+				s += "G83";
+				s += SPACE();
+				write(s + PECK_DEPTH(depthparams.step_down));
+				m_prev_drill = "G83" + PECK_DEPTH(depthparams.step_down);
+			}
+		}
+		else
+		{
+			write("G83" + PECK_DEPTH(depthparams.step_down));
+		}
+
+		if(m_dwell_allowed_in_G83)
+		{
+			s = SPACE();
+			write(s + "P" + m_fmt.string(dwell));
+		}
+	}
+	else
+	{
+		// We're either just drilling or drilling with dwell.
+		if(dwell == 0)
+		{
+			// We're just drilling.
+			if(m_drill_modal)
+			{
+				if(m_prev_drill != "G81")
+				{
+					s = SPACE();
+					write(s + "G81");
+					m_prev_drill = "G81";
+				}
+			}
+			else
+			{
+				s = SPACE();
+				write(s + "G81");
+			}
+		}
+		else
+		{
+			// We're drilling with dwell.
+			if(m_drill_modal)
+			{
+				if(DRILL_WITH_DWELL(dwell) != m_prev_drill)
+				{
+					s = SPACE();
+					write(s + DRILL_WITH_DWELL(dwell));
+					m_prev_drill = DRILL_WITH_DWELL(dwell);
+				}
+			}
+			else
+			{
+				s = SPACE();
+				write(s + DRILL_WITH_DWELL(dwell));
+			}
+		}
+	}
+
+	if(m_output_g98_and_g99)
+	{
+		if(rapid_to_clearance)
+		{
+			if(m_g98_not_g99 != 1)
+			{
+				s = SPACE();
+				write(s + "G98");
+				m_g98_not_g99 = 1;
+			}
+		}
+		else
+		{
+			if(m_g98_not_g99 != 0)
+			{
+				s = SPACE();
+				write(s + "G99");
+				m_g98_not_g99 = 0;
+			}
+		}
+	}
+
+	// Set the retraction point to the 'standoff' distance above the starting z height.
+	double retract_height = depthparams.start_depth + depthparams.rapid_safety_space;
+	if(x.m_set)
+	{
+		s = SPACE();
+		write(s + "X" + m_fmt.string(x.m_value + m_shift_x));
+		m_x = x;
+	}
+
+	if(y.m_set)
+	{
+		s = SPACE();
+		write(s + "Y" + m_fmt.string(y.m_value + m_shift_y));
+		m_y = y;
+	}
+
+	if(m_drill_modal)
+	{
+		if(!m_prev_z.m_set || depthparams.start_depth != m_prev_z.m_value)
+		{
+			s = SPACE();
+			write(s + "Z" + m_fmt.string(depthparams.final_depth));
+			m_prev_z = depthparams.start_depth;
+		}
+	}
+	else
+	{
+		// This is the 'z' value for the bottom of the hole.
+		s = SPACE();
+		write(s + "Z" + m_fmt.string(depthparams.final_depth));
+		// We want to remember where z is at the end (at the top of the hole)
+		m_z = depthparams.start_depth + depthparams.rapid_safety_space;
+	}
+
+	if(m_drill_modal)
+	{
+		if(m_prev_retract != RETRACT(retract_height))
+		{
+			s = SPACE();
+			write(s + RETRACT(retract_height));
+			m_prev_retract = RETRACT(retract_height);
+		}
+	}
+	else
+	{
+		s = SPACE();
+		write(s + RETRACT(retract_height));
+	}
+
+	if(m_fv.m_set && m_fv.m_value != 0)m_f.set(m_fv.m_value);
+
+	write_feedrate();
+	write_spindle();
+	write_misc();
+	write("\n");
+	m_first_drill_pos = false;
+}
+
+void CIsoCreator::end_canned_cycle(void)
+{
+	if(!m_in_canned_cycle)return;
+	std::string s = SPACE();
+	write(s + "G80" + "\n");
+	m_prev_drill = "";
+	m_prev_g0123 = "";
+	m_prev_z = CNCValue();
+	m_prev_retract = "";
+	m_in_canned_cycle = false;
+	m_first_drill_pos = true;
+}
+
+void CIsoCreator::comment(const std::string &text)
+{
+	write("(" + text + ")\n");
+}
@@ -0,0 +1,185 @@
+// IsoCreator.h
+/*
+ * Copyright (c) 2009, Dan Heeks
+ * This program is released under the BSD license. See the file COPYING for
+ * details.
+ */
+
+// Writes ISO NC code, as nc/iso.py does, without python.
+// It can be any of the posts that are just iso.py with different settings; iso, iso_modal, siegkx1 and emc2b.
+// The NC code is the same as those posts write, character for character, so the order in which the python
+// calls SPACE() is kept, because SPACE() changes start_of_line.
+// It has no wx or OpenCascade in it.
+// Only drilling gives its moves to it, so far; see COp::CanWriteNC. Programs with any other operation are posted by python.
+
+#pragma once
+
+#include "NCCreator.h"
+
+#include <stdio.h>
+#include <vector>
+#include <map>
+
+// like Format in nc/format.py
+class CNCFormat
+{
+public:
+	int number_of_decimal_places;
+	int add_leading_zeros;
+	bool add_trailing_zeros;
+	bool dp_wanted;
+	bool add_plus;
+	bool no_minus;
+	bool round_down;
+
+	CNCFormat(int number_of_decimal_places_ = 3): number_of_decimal_places(number_of_decimal_places_), add_leading_zeros(1), add_trailing_zeros(false), dp_wanted(true), add_plus(false), no_minus(false), round_down(false) {}
+
+	std::string string(CNCValue number)const;
+};
+
+class CIsoCreator;
+
+// like Address in nc/format.py
+class CNCAddress
+{
+public:
+	std::string text;
+	CNCFormat fmt;
+	bool modal;
+	bool str_set; // str is None if this is false
+	std::string str;
+	bool previous_set;
+	std::string previous;
+
+	CNCAddress(const std::string &text_, const CNCFormat &fmt_, bool modal_ = true): text(text_), fmt(fmt_), modal(modal_), str_set(false), previous_set(false) {}
+
+	void set(double n);
+	void write(CIsoCreator &writer);
+};
+
+// like AddressPlusMinus in nc/format.py
+class CNCAddressPlusMinus : public CNCAddress
+{
+public:
+	bool str2_set;
+	std::string str2;
+	bool previous2_set;
+	std::string previous2;
+
+	CNCAddressPlusMinus(const std::string &text_, const CNCFormat &fmt_, bool modal_ = true): CNCAddress(text_, fmt_, modal_), str2_set(false), previous2_set(false) {}
+
+	void set(double n, const std::string &text_plus, const std::string &text_minus);
+	void write(CIsoCreator &writer);
+};
+
+class CIsoCreator : public CNCCreator
+{
+public:
+	// returns NULL if post isn't one of the posts this can do
+	static CIsoCreator* New(const std::string &post);
+
+	~CIsoCreator(void);
+
+	bool file_open(const char* name);
+
+	void program_begin(int id, const std::string &name);
+	void program_end(void);
+	void flush_nc(void);
+
+	void imperial(void);
+	void metric(void);
+	void absolute(void);
+	void incremental(void);
+	void set_plane(int plane);
+
+	void tool_defn(int id, const std::string &name, const CNCToolParams &params);
+	void tool_change(int id);
+
+	void workplane(int id);
+
+	void feedrate(double f);
+	void feedrate_slot(double fslot);
+	void feedrate_hv(double fh, double fv);
+	void spindle(double s, bool clockwise = true);
+	void coolant(int mode = 0);
+	void set_path_control_mode(int mode, double motion_blending_tolerance, double naive_cam_tolerance);
+
+	void rapid(CNCValue x = CNCValue(), CNCValue y = CNCValue(), CNCValue z = CNCValue());
+	void feed(double slot_ratio = 0.0, CNCValue x = CNCValue(), CNCValue y = CNCValue(), CNCValue z = CNCValue());
+	void arc_cw(double slot_ratio = 0.0, CNCValue x = CNCValue(), CNCValue y = CNCValue(), CNCValue z = CNCValue(), CNCValue i = CNCValue(), CNCValue j = CNCValue(), CNCValue k = CNCValue(), CNCValue r = CNCValue());
+	void arc_ccw(double slot_ratio = 0.0, CNCValue x = CNCValue(), CNCValue y = CNCValue(), CNCValue z = CNCValue(), CNCValue i = CNCValue(), CNCValue j = CNCValue(), CNCValue k = CNCValue(), CNCValue r = CNCValue());
+	void dwell(double t);
+
+	void drill(CNCValue x, CNCValue y, double dwell, const CNCDepthParams &depthparams, int retract_mode, int spindle_mode, bool internal_coolant_on, bool rapid_to_clearance);
+	void end_canned_cycle(void);
+
+	void comment(const std::string &text);
+
+	void write(const std::string &s);
+	std::string SPACE(void);
+
+private:
+	CIsoCreator(void);
+
+	FILE* m_file;
+	std::string m_filename;
+
+	// the differences between the posts
+	std::string m_space; // what SPACE() returns, when not at the start of a line
+	bool m_emc2b;
+
+	// internal variables
+	CNCValue m_x, m_y, m_z;
+	CNCAddress m_f;
+	CNCValue m_fslot, m_fh, m_fv;
+	bool m_fhv;
+	CNCAddress m_g_plane;
+	std::vector<std::string> m_g_list;
+	std::vector<std::string> m_m;
+	CNCAddressPlusMinus m_s;
+	CNCValue m_t;
+	bool m_g0123_modal;
+	bool m_drill_modal;
+	std::string m_prev_g0123;
+	std::string m_prev_drill;
+	std::string m_prev_retract;
+	CNCValue m_prev_z;
+	CNCFormat m_fmt;
+	bool m_absolute_flag;
+	bool m_in_canned_cycle;
+	bool m_first_drill_pos;
+	double m_shift_x, m_shift_y, m_shift_z;
+	bool m_start_of_line;
+	int m_g98_not_g99; // 1 for G98, 0 for G99, -1 for None
+	std::string m_z_for_g43;
+	std::map<int, CNCToolParams> m_tool_defn_params;
+
+	// optional settings
+	bool m_arc_centre_absolute;
+	bool m_drillExpanded;
+	bool m_dwell_allowed_in_G83;
+	bool m_output_block_numbers;
+	int m_start_block_number;
+	int m_block_number_increment;
+	bool m_output_tool_definitions;
+	bool m_output_g43_on_tool_change_line;
+	bool m_output_g98_and_g99;
+	bool m_output_g43_z_before_drilling_if_g98;
+	bool m_output_comment_before_tool_change;
+
+	std::string TOOL(int id);
+	std::string DWELL(double dwell);
+	std::string DRILL_WITH_DWELL(double dwell);
+	std::string PECK_DEPTH(double depth);
+	std::string RETRACT(double height);
+	std::string PROGRAM_END(void);
+
+	void write_feedrate(void);
+	void write_preps(void);
+	void write_misc(void);
+	void write_spindle(void);
+	void calc_feedrate_hv(double h, double v, double slot_ratio);
+	bool same_xyz(CNCValue x, CNCValue y, CNCValue z);
+	void arc(bool cw, double slot_ratio, CNCValue x, CNCValue y, CNCValue z, CNCValue i, CNCValue j, CNCValue k, CNCValue r);
+	void number_file(void);
+};
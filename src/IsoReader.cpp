@@ -0,0 +1,508 @@
+// IsoReader.cpp
+/*
+ * Copyright (c) 2009, Dan Heeks
+ * This program is released under the BSD license. See the file COPYING for
+ * details.
+ */
+
+#include "stdafx.h"
+#include "IsoReader.h"
+
+#include <wx/ffile.h>
+
+#include <string.h>
+
+CIsoReader::CIsoReader(CNCCode* nc_code)
+	: m_nc_code(nc_code), m_pos(0), m_multiplier(1.0), m_absolute(true), m_path_col(ColorRapidType), m_arc(0), m_tool_number(0),
+	m_drilling(false), m_drilling_uses_clearance(false), m_drilling_clearance_height_set(false), m_drilling_clearance_height(0.0),
+	m_r_set(false), m_r(0.0), m_drillz_set(false), m_drillz(0.0)
+{
+	// carry on from any blocks that are already there
+	if(!m_nc_code->m_blocks.empty())m_pos = m_nc_code->m_blocks.back()->m_to_pos;
+}
+
+// static
+bool CIsoReader::CanRead(const wxString& reader)
+{
+	return reader == _T("iso_read");
+}
+
+bool CIsoReader::ReadFile(const wxString& filepath)
+{
+	wxFFile file(filepath, _T("rb"));
+	if(!file.IsOpened())return false;
+
+	// guess at about 25 bytes per line, to save growing the vectors too often
+	wxFileOffset length = file.Length();
+	if(length > 0)
+	{
+		m_nc_code->m_blocks.reserve(m_nc_code->m_blocks.size() + (size_t)(length / 25));
+		m_nc_code->m_moves.Reserve(m_nc_code->m_moves.size() + (size_t)(length / 25));
+	}
+
+	const size_t chunk_size = 1 << 20;
+	std::vector<char> buffer(chunk_size);
+
+	while(!file.Eof())
+	{
+		size_t n = file.Read(&buffer[0], chunk_size);
+		if(n == 0)break;
+		ReadData(&buffer[0], n);
+	}
+
+	Finish();
+
+	return !file.Error();
+}
+
+void CIsoReader::ReadData(const char* data, size_t length)
+{
+	const char* p = data;
+	const char* end = data + length;
+	while(p < end)
+	{
+		const char* eol = (const char*)memchr(p, '\n', end - p);
+		if(eol == NULL)
+		{
+			// the rest of this line is still to come
+			m_partial_line.append(p, end - p);
+			break;
+		}
+
+		if(m_partial_line.empty())
+		{
+			ReadLine(p, eol - p);
+		}
+		else
+		{
+			m_partial_line.append(p, eol - p);
+			ReadLine(m_partial_line.c_str(), m_partial_line.size());
+			m_partial_line.clear();
+		}
+		p = eol + 1;
+	}
+}
+
+void CIsoReader::Finish()
+{
+	if(!m_partial_line.empty())
+	{
+		ReadLine(m_partial_line.c_str(), m_partial_line.size());
+		m_partial_line.clear();
+	}
+}
+
+static bool IsSpace(char c)
+{
+	return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\f' || c == '\v';
+}
+
+static bool IsDigit(char c)
+{
+	return c >= '0' && c <= '9';
+}
+
+static bool IsWordStart(char c)
+{
+	return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || IsDigit(c) || c == '_' || c == ':';
+}
+
+/**
+	Reads the number after a word's letter. This doesn't use strtod, because that
+	depends on the locale's decimal point and would also read exponents.
+ */
+static bool ParseNumber(const char* s, size_t length, double &value)
+{
+	const char* end = s + length;
+	bool negative = false;
+	if(s < end && (*s == '+' || *s == '-'))
+	{
+		negative = (*s == '-');
+		s++;
+	}
+
+	bool digits = false;
+	double v = 0.0;
+	for(; s < end && IsDigit(*s); s++)
+	{
+		v = v * 10.0 + (*s - '0');
+		digits = true;
+	}
+
+	if(s < end && *s == '.')
+	{
+		s++;
+		double scale = 0.1;
+		for(; s < end && IsDigit(*s); s++)
+		{
+			v += (*s - '0') * scale;
+			scale *= 0.1;
+			digits = true;
+		}
+	}
+
+	if(!digits)return false;
+	value = negative ? -v : v;
+	return true;
+}
+
+void CIsoReader::ReadLine(const char* line, size_t length)
+{
+	// like rstrip() in nc_read.py
+	while(length > 0 && IsSpace(line[length - 1]))length--;
+
+	for(int i = 0; i < 3; i++)m_x_set[i] = false;
+	m_ijk_set = false;
+	m_ijk[0] = m_ijk[1] = m_ijk[2] = 0.0;
+	m_r_on_line = false;
+	m_move = false;
+	m_height_offset = false;
+	m_drill = false;
+	m_drill_off = false;
+	m_no_move = false;
+
+	int block_index = (int)m_nc_code->m_blocks.size();
+	CNCCodeBlock* block = new CNCCodeBlock(m_nc_code);
+	block->m_from_pos = m_pos;
+	block->m_first_move = m_nc_code->m_moves.size();
+
+	// split the line into words, the same way as pattern_main in iso_read.py
+	const char* p = line;
+	const char* end = line + length;
+	while(p < end)
+	{
+		const char* start = p;
+		ColorEnum color_type = ColorDefaultType;
+
+		if(*p == '(' || *p == '!' || *p == ';')
+		{
+			// a comment goes to the end of the line
+			p = end;
+			color_type = ColorCommentType;
+		}
+		else if(IsSpace(*p))
+		{
+			while(p < end && IsSpace(*p))p++;
+		}
+		else if(IsWordStart(*p))
+		{
+			p++;
+			if(p < end && (*p == '+' || *p == '-'))p++;
+			while(p < end && IsDigit(*p))p++;
+			if(p < end && *p == '.')
+			{
+				p++;
+				while(p < end && IsDigit(*p))p++;
+			}
+			color_type = ParseWord(start, p - start);
+		}
+		else if(*p == '#')
+		{
+			// #1=2.5
+			const char* q = p + 1;
+			while(q < end && IsDigit(*q))q++;
+			if(q == p + 1 || q >= end || *q != '=')
+			{
+				// not a word, skip it
+				p++;
+				continue;
+			}
+			q++;
+			if(q < end && (*q == '+' || *q == '-'))q++;
+			while(q < end && IsDigit(*q))q++;
+			if(q < end && *q == '.')
+			{
+				q++;
+				while(q < end && IsDigit(*q))q++;
+			}
+			p = q;
+			color_type = ColorVariableType;
+		}
+		else
+		{
+			// not a word, skip it
+			p++;
+			continue;
+		}
+
+		ColouredText text;
+		text.m_str = wxString::From8BitData(start, p - start);
+		text.m_color_type = color_type;
+		block->m_text.push_back(text);
+		m_pos += (long)(p - start);
+	}
+
+	AddMoves(block_index);
+
+	if(block->m_text.size() > 0)m_pos++;
+	block->m_to_pos = m_pos;
+	block->m_number_of_moves = m_nc_code->m_moves.size() - block->m_first_move;
+	m_nc_code->m_blocks.push_back(block);
+}
+
+ColorEnum CIsoReader::ParseWord(const char* word, size_t length)
+{
+	char letter = word[0];
+	if(letter >= 'a' && letter <= 'z')letter += 'A' - 'a';
+
+	double value = 0.0;
+	bool has_value = ParseNumber(word + 1, length - 1, value);
+
+	switch(letter)
+	{
+	case 'A':
+	case 'B':
+	case 'C':
+	case 'H':
+		m_move = true;
+		return ColorAxisType;
+
+	case 'F':
+	case 'S':
+		return ColorAxisType;
+
+	case 'X':
+	case 'Y':
+	case 'Z':
+		if(has_value)
+		{
+			m_x_set[letter - 'X'] = true;
+			m_x[letter - 'X'] = value;
+		}
+		m_move = true;
+		return ColorAxisType;
+
+	case 'I':
+	case 'J':
+	case 'K':
+		if(has_value)
+		{
+			m_ijk_set = true;
+			m_ijk[letter - 'I'] = value;
+		}
+		m_move = true;
+		return ColorAxisType;
+
+	case 'P':
+	case 'Q':
+		if(m_no_move)return ColorDefaultType;
+		m_move = true;
+		return ColorAxisType;
+
+	case 'R':
+		if(has_value)
+		{
+			m_r_set = true;
+			m_r = value;
+			m_r_on_line = true;
+		}
+		m_move = true;
+		return ColorAxisType;
+
+	case 'T':
+		if(has_value)m_tool_number = (int)value;
+		return ColorToolType;
+
+	case 'M':
+		return ColorMiscType;
+
+	case 'N':
+	case ':':
+		return ColorBlockType;
+
+	case 'O':
+		return ColorProgramType;
+
+	case 'L':
+		if(length == 2 && word[1] == '1')m_no_move = true;
+		return ColorDefaultType;
+
+	case 'G':
+		break;
+
+	default:
+		return ColorDefaultType;
+	}
+
+	// G codes
+	char code[16];
+	if(length >= sizeof(code))return ColorPrepType;
+	memcpy(code, word + 1, length - 1);
+	code[length - 1] = 0;
+
+	if(!strcmp(code, "0") || !strcmp(code, "00"))
+	{
+		m_path_col = ColorRapidType;
+		m_arc = 0;
+		return ColorRapidType;
+	}
+	if(!strcmp(code, "1") || !strcmp(code, "01"))
+	{
+		m_path_col = ColorFeedType;
+		m_arc = 0;
+		return ColorFeedType;
+	}
+	if(!strcmp(code, "2") || !strcmp(code, "02") || !strcmp(code, "12"))
+	{
+		m_path_col = ColorFeedType;
+		m_arc = -1;
+		return ColorFeedType;
+	}
+	if(!strcmp(code, "3") || !strcmp(code, "03") || !strcmp(code, "13"))
+	{
+		m_path_col = ColorFeedType;
+		m_arc = 1;
+		return ColorFeedType;
+	}
+	if(!strcmp(code, "4") || !strcmp(code, "04"))
+	{
+		// a dwell; its P is the time, not a move
+		m_no_move = true;
+		return ColorPrepType;
+	}
+	if(!strcmp(code, "10") || !strcmp(code, "53") || !strcmp(code, "61.1") || !strcmp(code, "61") || !strcmp(code, "64"))
+	{
+		m_no_move = true;
+		return ColorDefaultType;
+	}
+	if(!strcmp(code, "20") || !strcmp(code, "70"))
+	{
+		m_multiplier = 25.4;
+		return ColorPrepType;
+	}
+	if(!strcmp(code, "21") || !strcmp(code, "71"))
+	{
+		m_multiplier = 1.0;
+		return ColorPrepType;
+	}
+	if(!strcmp(code, "43"))
+	{
+		// drawn as a rapid, even after an arc
+		m_height_offset = true;
+		m_move = true;
+		m_path_col = ColorRapidType;
+		m_arc = 0;
+		return ColorRapidType;
+	}
+	if(!strcmp(code, "80"))
+	{
+		m_drill_off = true;
+		return ColorDefaultType;
+	}
+	if(!strcmp(code, "81") || !strcmp(code, "82") || !strcmp(code, "83"))
+	{
+		m_drill = true;
+		m_no_move = true;
+		m_path_col = ColorFeedType;
+		return ColorFeedType;
+	}
+	if(!strcmp(code, "90"))
+	{
+		m_absolute = true;
+		return ColorDefaultType;
+	}
+	if(!strcmp(code, "91"))
+	{
+		m_absolute = false;
+		return ColorDefaultType;
+	}
+	if(!strcmp(code, "98"))
+	{
+		m_drilling_uses_clearance = true;
+		return ColorDefaultType;
+	}
+	if(!strcmp(code, "99"))
+	{
+		m_drilling_uses_clearance = false;
+		return ColorDefaultType;
+	}
+
+	return ColorPrepType;
+}
+
+void CIsoReader::AddMove(const bool* x_set, const double* x, ColorEnum color_type, int block)
+{
+	CNCMoveBuffer &moves = m_nc_code->m_moves;
+	double p[3] = {0.0, 0.0, 0.0};
+	if(!moves.empty())memcpy(p, moves.EndPoint(moves.size() - 1), 3*sizeof(double));
+	for(int i = 0; i < 3; i++)
+	{
+		if(x_set[i])p[i] = x[i];
+	}
+	moves.AddLine(p, m_tool_number, color_type, block);
+}
+
+void CIsoReader::AddMoves(int block)
+{
+	if(m_height_offset && m_x_set[2])
+	{
+		m_drilling_clearance_height = m_x[2];
+		m_drilling_clearance_height_set = true;
+	}
+
+	if(m_drill)m_drilling = true;
+	if(m_drill_off)m_drilling = false;
+
+	if(m_drilling)
+	{
+		// a whole canned cycle for each hole
+		if(!m_move)return;
+
+		bool rapid_z_set = m_r_set;
+		double rapid_z = m_r;
+		if(m_drilling_uses_clearance && m_drilling_clearance_height_set)
+		{
+			rapid_z_set = true;
+			rapid_z = m_drilling_clearance_height;
+		}
+		if(m_x_set[2])
+		{
+			m_drillz_set = true;
+			m_drillz = m_x[2];
+		}
+
+		bool x_set[3] = {m_x_set[0], m_x_set[1], rapid_z_set};
+		double x[3] = {m_x[0] * m_multiplier, m_x[1] * m_multiplier, rapid_z * m_multiplier};
+		AddMove(x_set, x, ColorRapidType, block);
+
+		x_set[2] = m_drillz_set;
+		x[2] = m_drillz * m_multiplier;
+		AddMove(x_set, x, ColorFeedType, block);
+
+		x_set[2] = rapid_z_set;
+		x[2] = rapid_z * m_multiplier;
+		AddMove(x_set, x, ColorFeedType, block);
+		return;
+	}
+
+	if(!m_move || m_no_move)return;
+
+	CNCMoveBuffer &moves = m_nc_code->m_moves;
+	double current[3] = {0.0, 0.0, 0.0};
+	if(!moves.empty())memcpy(current, moves.EndPoint(moves.size() - 1), 3*sizeof(double));
+
+	double x[3];
+	for(int i = 0; i < 3; i++)
+	{
+		if(!m_x_set[i])x[i] = current[i];
+		else if(m_absolute)x[i] = m_x[i] * m_multiplier;
+		else x[i] = current[i] + m_x[i] * m_multiplier;
+	}
+
+	if(m_arc == 0)
+	{
+		// don't add a move for lines like "G43 H1", which don't go anywhere
+		if(!m_x_set[0] && !m_x_set[1] && !m_x_set[2])return;
+		moves.AddLine(x, m_tool_number, m_path_col, block);
+	}
+	else if(m_r_on_line && !m_ijk_set)
+	{
+		moves.AddArcFromRadius(x, m_r * m_multiplier, m_arc, m_tool_number, ColorFeedType, block);
+	}
+	else
+	{
+		// I, J and K are relative to the start point
+		double c[3] = {m_ijk[0] * m_multiplier, m_ijk[1] * m_multiplier, m_ijk[2] * m_multiplier};
+		moves.AddArc(x, c, m_arc, m_tool_number, ColorFeedType, block);
+	}
+}
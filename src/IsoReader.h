@@ -0,0 +1,71 @@
+// IsoReader.h
+/*
+ * Copyright (c) 2009, Dan Heeks
+ * This program is released under the BSD license. See the file COPYING for
+ * details.
+ */
+
+// Reads ISO ( RS274 ) NC code, like the files written by the emc2b and siegkx1 posts, straight into a CNCCode object.
+// This does the same job as backplot.py with nc/iso_read.py, but without starting python, writing backplot.xml
+// and then reading that back in with TinyXML. The python readers are still used for the other dialects.
+
+#pragma once
+
+#include "NCCode.h"
+
+class CIsoReader
+{
+public:
+	CIsoReader(CNCCode* nc_code);
+
+	// true if this class can be used instead of the given python reader ( the machine's "reader" attribute )
+	static bool CanRead(const wxString& reader);
+
+	// appends the file's blocks and moves to the CNCCode object, a chunk at a time
+	bool ReadFile(const wxString& filepath);
+
+	// reads the whole lines in data, keeping any part line for the next call; for reading a file as it is written
+	void ReadData(const char* data, size_t length);
+
+	// reads the last line, if it had no line ending
+	void Finish();
+
+	// reads one line of NC code, without its line ending, into a new CNCCodeBlock
+	void ReadLine(const char* line, size_t length);
+
+private:
+	CNCCode* m_nc_code;
+	long m_pos; // position in the text ctrl
+	std::string m_partial_line;
+
+	// modal state, kept from one line to the next
+	double m_multiplier;
+	bool m_absolute;
+	ColorEnum m_path_col;
+	int m_arc; // 0 - not an arc, 1 - anti-clockwise, -1 - clockwise
+	int m_tool_number;
+	bool m_drilling;
+	bool m_drilling_uses_clearance;
+	bool m_drilling_clearance_height_set;
+	double m_drilling_clearance_height;
+	bool m_r_set;
+	double m_r;
+	bool m_drillz_set;
+	double m_drillz;
+
+	// the words found on the current line
+	bool m_x_set[3];
+	double m_x[3];
+	bool m_ijk_set;
+	double m_ijk[3];
+	bool m_r_on_line;
+	bool m_move;
+	bool m_height_offset;
+	bool m_drill;
+	bool m_drill_off;
+	bool m_no_move;
+
+	ColorEnum ParseWord(const char* word, size_t length);
+	void AddMoves(int block);
+	void AddMove(const bool* x_set, const double* x, ColorEnum color_type, int block);
+};
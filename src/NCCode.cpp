@@ -16,23 +16,15 @@
 #include "CNCConfig.h"
 #include "CTool.h"
 #include "Program.h"
+#include "Simulate.h"
 
-#include <TopoDS_Shape.hxx>
-#include <TopoDS_Solid.hxx>
-#include <TopoDS_Compound.hxx>
-#include <BRep_Builder.hxx>
-#include <BRepBuilderAPI_Transform.hxx>
-#include <BRepAlgoAPI_Fuse.hxx>
-#include <BRepAlgoAPI_Cut.hxx>
-#include <Standard_Failure.hxx>
-#include <StdFail_NotDone.hxx>
 #include "tinyxml/tinyxml.h"
 
-#include <wx/progdlg.h>
-
 #include <memory>
+#include <algorithm>
 #include <sstream>
 
+HeeksColor CNCCode::highlight_color(255, 0, 255);
 int CNCCode::s_arc_interpolation_count = 20;
 
 
@@ -64,337 +56,106 @@ void ColouredText::ReadFromXMLElement(TiXmlElement* element)
 	    m_str = _(" ");     // Assume a single space that xml trimmed.
 }
 
-// static
-double PathObject::m_current_x[3] = {0, 0, 0};
-double PathObject::m_prev_x[3] = {0, 0, 0};
-
-void PathObject::WriteBaseXML(TiXmlElement *pElem)
-{
-	pElem->SetAttribute("tool_number", m_tool_number);
-
-	pElem->SetDoubleAttribute("x", m_x[0]);
-	pElem->SetDoubleAttribute("y", m_x[1]);
-	pElem->SetDoubleAttribute("z", m_x[2]);
-
-} // End WriteXML() method
+// the tool number given by the last <tool> element, while reading
+static int current_tool_number = 0;
 
-void PathObject::ReadFromXMLElement(TiXmlElement* pElem)
+static void ReadPathFromXMLElement(TiXmlElement* element, CNCCode* nc_code, int block)
 {
-	memcpy(m_prev_x, m_current_x, 3*sizeof(double));
+	CNCMoveBuffer &moves = nc_code->m_moves;
 
-	double x;
-	if(pElem->Attribute("x", &x))m_current_x[0] = x * CNCCodeBlock::multiplier;
-	if(pElem->Attribute("y", &x))m_current_x[1] = x * CNCCodeBlock::multiplier;
-	if(pElem->Attribute("z", &x))m_current_x[2] = x * CNCCodeBlock::multiplier;
-
-	memcpy(m_x, m_current_x, 3*sizeof(double));
+	// get the attributes
+	ColorEnum color_type = CNCCode::GetColor(element->Attribute("col"), ColorRapidType);
 
-	if (pElem->Attribute("tool_number"))
-	{
-		pElem->Attribute("tool_number", &m_tool_number);
-	} // End if - then
-	else
+	// loop through all the objects
+	for(TiXmlElement* pElem = heeksCAD->FirstXMLChildElement( element ) ; pElem; pElem = pElem->NextSiblingElement())
 	{
-		m_tool_number = 0;	// No tool selected.
-	} // End if - else
-}
-
-void PathLine::WriteXML(TiXmlNode *root)
-{
-	TiXmlElement * element;
-	element = heeksCAD->NewXMLElement( "line" );
-	heeksCAD->LinkXMLEndChild( root,  element );
-
-	PathObject::WriteBaseXML(element);
-}
-
-void PathLine::ReadFromXMLElement(TiXmlElement* pElem)
-{
-	PathObject::ReadFromXMLElement(pElem);
-}
-
-void PathLine::glVertices(const PathObject* prev_po)
-{
-	if(prev_po)glVertex3dv(prev_po->m_x);
-	glVertex3dv(m_x);
-}
-
-void PathArc::GetBox(CBox &box,const PathObject* prev_po)
-{
-	PathObject::GetBox(box,prev_po);
-
-	if(IsIncluded(gp_Pnt(0,1,0),prev_po))
-		box.Insert(prev_po->m_x[0]+m_c[0],prev_po->m_x[1]+m_c[1]+m_radius,0);
-	if(IsIncluded(gp_Pnt(0,-1,0),prev_po))
-		box.Insert(prev_po->m_x[0]+m_c[0],prev_po->m_x[1]+m_c[1]-m_radius,0);
-	if(IsIncluded(gp_Pnt(1,0,0),prev_po))
-		box.Insert(prev_po->m_x[0]+m_c[0]+m_radius,prev_po->m_x[1]+m_c[1],0);
-	if(IsIncluded(gp_Pnt(-1,0,0),prev_po))
-		box.Insert(prev_po->m_x[0]+m_c[0]-m_radius,prev_po->m_x[1]+m_c[1],0);
-
-}
-
-bool PathArc::IsIncluded(gp_Pnt pnt,const PathObject* prev_po)
-{
-	double sx = -m_c[0];
-	double sy = -m_c[1];
-	// e = cs + se = -c + e - s
-	double ex = -m_c[0] + m_x[0] - prev_po->m_x[0];
-	double ey = -m_c[1] + m_x[1] - prev_po->m_x[1];
-	double rs = sqrt(sx * sx + sy * sy);
-	// double re = sqrt(ex * ex + ey * ey);
-	m_radius = rs;
-
-	double start_angle = atan2(sy, sx);
-	double end_angle = atan2(ey, ex);
-
-	if(m_dir == 1){
-		if(end_angle < start_angle)end_angle += 6.283185307179;
-	}
-	else{
-		if(start_angle < end_angle)start_angle += 6.283185307179;
-	}
-
-	// double angle_step = 0;
-
-	if (start_angle == end_angle)
-		// It's a full circle.
-		return true;
-
-	double the_angle = atan2(pnt.Y(),pnt.X());
-	double the_angle2 = the_angle + 2*PI;
-	return (the_angle >= start_angle && the_angle <= end_angle) || (the_angle2 >= start_angle && the_angle2 <= end_angle);
-}
-
-void PathArc::WriteXML(TiXmlNode *root)
-{
-	TiXmlElement * element = heeksCAD->NewXMLElement( "arc" );
-	heeksCAD->LinkXMLEndChild( root,  element );
+		std::string name(pElem->Value());
+		bool is_line = (name == "line");
+		if(!is_line && name != "arc")continue;
 
-	element->SetDoubleAttribute( "i", m_c[0]);
-	element->SetDoubleAttribute( "j", m_c[1]);
-	element->SetDoubleAttribute( "k", m_c[2]);
-	element->SetDoubleAttribute( "d", m_dir);
+		// missing coordinates stay where they were
+		double x[3] = {0.0, 0.0, 0.0};
+		if(!moves.empty())memcpy(x, moves.EndPoint(moves.size() - 1), 3*sizeof(double));
 
-	PathObject::WriteBaseXML(element);
-}
+		double value;
+		if(pElem->Attribute("x", &value))x[0] = value * CNCCodeBlock::multiplier;
+		if(pElem->Attribute("y", &value))x[1] = value * CNCCodeBlock::multiplier;
+		if(pElem->Attribute("z", &value))x[2] = value * CNCCodeBlock::multiplier;
 
-void PathArc::ReadFromXMLElement(TiXmlElement* pElem)
-{
-	// get the attributes
-	bool radius_set = false;
-	if (pElem->Attribute("r"))
-	{
-		pElem->Attribute("r", &m_radius);
-		m_radius *= CNCCodeBlock::multiplier;
-		radius_set = true;
-	}
-	else
-	{
-		if (pElem->Attribute("i")) pElem->Attribute("i", &m_c[0]);
-		if (pElem->Attribute("j")) pElem->Attribute("j", &m_c[1]);
-		if (pElem->Attribute("k")) pElem->Attribute("k", &m_c[2]);
-		if (pElem->Attribute("d")) pElem->Attribute("d", &m_dir);
-
-		m_c[0] *= CNCCodeBlock::multiplier;
-		m_c[1] *= CNCCodeBlock::multiplier;
-		m_c[2] *= CNCCodeBlock::multiplier;
-	}
+		int tool_number = current_tool_number;
+		if (pElem->Attribute("tool_number"))pElem->Attribute("tool_number", &tool_number);
 
-	PathObject::ReadFromXMLElement(pElem);
+		if(is_line)
+		{
+			moves.AddLine(x, tool_number, color_type, block);
+			continue;
+		}
 
-	if(radius_set)
-	{
-		// set ij and direction from radius
-		SetFromRadius();
-	}
-}
+		int dir = 1;
+		if (pElem->Attribute("d")) pElem->Attribute("d", &dir);
 
-void PathArc::SetFromRadius()
-{
-	// make a circle at start point and end point
-	gp_Pnt ps(m_prev_x[0], m_prev_x[1], m_prev_x[2]);
-	gp_Pnt pe(m_x[0], m_x[1], m_x[2]);
-	double r = fabs(m_radius);
-	gp_Circ c1(gp_Ax2(ps, gp_Dir(0, 0, 1)), r);
-	gp_Circ c2(gp_Ax2(pe, gp_Dir(0, 0, 1)), r);
-	std::list<gp_Pnt> plist;
-	intersect(c1, c2, plist);
-	if(plist.size() == 2)
-	{
-		gp_Pnt p1 = plist.front();
-		gp_Pnt p2 = plist.back();
-		gp_Vec along(ps, pe);
-		gp_Vec right = gp_Vec(0, 0, 1).Crossed(along);
-		gp_Vec vc(p1, p2);
-		bool left = vc.Dot(right) < 0;
-		if((m_radius < 0) == left)
+		if (pElem->Attribute("r"))
 		{
-			extract(gp_Vec(ps, p1), this->m_c);
-			this->m_dir = 1;
+			double radius = 0.0;
+			pElem->Attribute("r", &radius);
+			moves.AddArcFromRadius(x, radius * CNCCodeBlock::multiplier, dir, tool_number, color_type, block);
 		}
 		else
 		{
-			extract(gp_Vec(ps, p2), this->m_c);
-			this->m_dir = -1;
-		}
-		m_radius = r;
-	}
-}
+			double c[3] = {0.0, 0.0, 0.0};
+			if (pElem->Attribute("i")) pElem->Attribute("i", &c[0]);
+			if (pElem->Attribute("j")) pElem->Attribute("j", &c[1]);
+			if (pElem->Attribute("k")) pElem->Attribute("k", &c[2]);
 
-void PathArc::glVertices(const PathObject* prev_po)
-{
-	if (prev_po == NULL) return;
+			c[0] *= CNCCodeBlock::multiplier;
+			c[1] *= CNCCodeBlock::multiplier;
+			c[2] *= CNCCodeBlock::multiplier;
 
-	std::list<gp_Pnt> vertices = Interpolate( prev_po, CNCCode::s_arc_interpolation_count );
-	glVertex3dv(prev_po->m_x);
-	for (std::list<gp_Pnt>::const_iterator l_itVertex = vertices.begin(); l_itVertex != vertices.end(); l_itVertex++)
-	{
-		glVertex3d(l_itVertex->X(), l_itVertex->Y(), l_itVertex->Z());
-	} // End for
-}
-
-std::list<gp_Pnt> PathArc::Interpolate( const PathObject *prev_po, const unsigned int number_of_points ) const
-{
-	std::list<gp_Pnt> points;
-
-	double sx = -m_c[0];
-	double sy = -m_c[1];
-	// e = cs + se = -c + e - s
-	double ex = -m_c[0] + m_x[0] - prev_po->m_x[0];
-	double ey = -m_c[1] + m_x[1] - prev_po->m_x[1];
-	double rs = sqrt(sx * sx + sy * sy);
-	double re = sqrt(ex * ex + ey * ey);
-
-	double start_angle = atan2(sy, sx);
-	double end_angle = atan2(ey, ex);
-
-	if(m_dir == 1){
-		if(end_angle < start_angle)end_angle += 6.283185307179;
-	}
-	else{
-		if(start_angle < end_angle)start_angle += 6.283185307179;
-	}
-
-	double angle_step = 0;
-
-	if (start_angle == end_angle)
-	{
-		// It's a full circle.
-		angle_step = (2 * PI) / number_of_points;
-		if (m_dir == -1)
-		{
-			angle_step = -angle_step; // fix preview of full cw arcs
+			moves.AddArc(x, c, dir, tool_number, color_type, block);
 		}
-	} // End if - then
-	else
-	{
-		// It's an arc.
-		angle_step = (end_angle - start_angle) / number_of_points;
-	} // End if - else
-
-	points.push_back( gp_Pnt( prev_po->m_x[0], prev_po->m_x[1], prev_po->m_x[2] ) );
-
-	for(unsigned int i = 0; i< number_of_points; i++)
-	{
-		double angle = start_angle + angle_step * (i + 1);
-		double r = rs + ((re - rs) * (i + 1)) /number_of_points;
-		double x = prev_po->m_x[0] + m_c[0] + r * cos(angle);
-		double y = prev_po->m_x[1] + m_c[1] + r * sin(angle);
-		double z = prev_po->m_x[2] + ((m_x[2] - prev_po->m_x[2]) * (i+1))/number_of_points;
-
-		points.push_back( gp_Pnt( x, y, z ) );
-	}
-
-	return(points);
-}
-
-ColouredPath::ColouredPath(const ColouredPath& c)
-{
-	operator=(c);
-}
-
-const ColouredPath &ColouredPath::operator=(const ColouredPath& c)
-{
-	Clear();
-	m_color_type = c.m_color_type;
-	for(std::list< PathObject* >::const_iterator It = c.m_points.begin(); It != c.m_points.end(); It++)
-	{
-		PathObject* object = *It;
-		m_points.push_back(object->MakeACopy());
 	}
-	return *this;
 }
 
-void ColouredPath::Clear()
+static void WriteMovesXML(TiXmlNode *root, const CNCMoveBuffer &moves, size_t first, size_t count)
 {
-	for(std::list< PathObject* >::iterator It = m_points.begin(); It != m_points.end(); It++)
-	{
-		PathObject* object = *It;
-		delete object;
-	}
-	m_points.clear();
-}
+	// one path element for each run of moves of the same colour
+	TiXmlElement * path = NULL;
+	int color_type = -1;
 
-void ColouredPath::glCommands()
-{
-	CNCCode::Color(m_color_type).glColor();
-	glBegin(GL_LINE_STRIP);
-	for(std::list< PathObject* >::iterator It = m_points.begin(); It != m_points.end(); It++)
+	for(size_t i = first; i < first + count; i++)
 	{
-		PathObject* po = *It;
-		po->glVertices(CNCCode::prev_po);
-		CNCCode::prev_po = po;
-	}
-	glEnd();
-
-}
-
-void ColouredPath::GetBox(CBox &box)
-{
-	for(std::list< PathObject* >::iterator It = m_points.begin(); It != m_points.end(); It++)
-	{
-		PathObject* po= *It;
-		po->GetBox(box,CNCCode::prev_po);
-		CNCCode::prev_po = po;
-	}
-}
-
-void ColouredPath::WriteXML(TiXmlNode *root)
-{
-	TiXmlElement * element;
-	element = heeksCAD->NewXMLElement( "path" );
-	heeksCAD->LinkXMLEndChild( root,  element );
-
-	element->SetAttribute( "col", CNCCode::GetColor(m_color_type));
-	for(std::list< PathObject* >::iterator It = m_points.begin(); It != m_points.end(); It++)
-	{
-		PathObject* po = *It;
-		po->WriteXML(element);
-	}
-}
-
-void ColouredPath::ReadFromXMLElement(TiXmlElement* element)
-{
-	// get the attributes
-	m_color_type = CNCCode::GetColor(element->Attribute("col"), ColorRapidType);
+		if(path == NULL || moves.m_color[i] != color_type)
+		{
+			color_type = moves.m_color[i];
+			path = heeksCAD->NewXMLElement( "path" );
+			heeksCAD->LinkXMLEndChild( root,  path );
+			path->SetAttribute( "col", CNCCode::GetColor((ColorEnum)color_type));
+		}
 
-	// loop through all the objects
-	for(TiXmlElement* pElem = heeksCAD->FirstXMLChildElement( element ) ; pElem; pElem = pElem->NextSiblingElement())
-	{
-		std::string name(pElem->Value());
-		if(name == "line")
+		TiXmlElement * element;
+		if(moves.Type(i) == CNCMoveBuffer::eArc)
 		{
-			PathLine *new_object = new PathLine;
-			new_object->ReadFromXMLElement(pElem);
-			m_points.push_back(new_object);
+			element = heeksCAD->NewXMLElement( "arc" );
+			heeksCAD->LinkXMLEndChild( path,  element );
+
+			const double* c = moves.ArcCentre(i);
+			element->SetDoubleAttribute( "i", c[0]);
+			element->SetDoubleAttribute( "j", c[1]);
+			element->SetDoubleAttribute( "k", c[2]);
+			element->SetDoubleAttribute( "d", moves.ArcDir(i));
 		}
-		else if(name == "arc")
+		else
 		{
-			PathArc *new_object = new PathArc;
-			new_object->ReadFromXMLElement(pElem);
-			m_points.push_back(new_object);
+			element = heeksCAD->NewXMLElement( "line" );
+			heeksCAD->LinkXMLEndChild( path,  element );
 		}
+
+		element->SetAttribute("tool_number", moves.m_tool_number[i]);
+
+		const double* x = moves.EndPoint(i);
+		element->SetDoubleAttribute("x", x[0]);
+		element->SetDoubleAttribute("y", x[1]);
+		element->SetDoubleAttribute("z", x[2]);
 	}
 }
 
@@ -448,24 +209,33 @@ void CNCCodeBlock::WriteNCCode(wxTextFile &f, double ox, double oy)
 
 void CNCCodeBlock::glCommands(bool select, bool marked, bool no_color)
 {
-	if(marked)glLineWidth(3);
+	if(m_nc_code == NULL || m_number_of_moves == 0)return;
 
-	for(std::list<ColouredPath>::iterator It = m_line_strips.begin(); It != m_line_strips.end(); It++)
+	m_nc_code->MakeVertices();
+
+	if(marked)
 	{
-		ColouredPath& line_strip = *It;
-		line_strip.glCommands();
+		// thicker, in a colour of its own, so it can be told from the path it is drawn over
+		glLineWidth(3);
+		glColor3ub(CNCCode::highlight_color.red, CNCCode::highlight_color.green, CNCCode::highlight_color.blue);
+		m_nc_code->DrawVertices(m_first_vertex, m_number_of_vertices, false);
+		glLineWidth(1);
+	}
+	else
+	{
+		m_nc_code->DrawVertices(m_first_vertex, m_number_of_vertices, !no_color);
 	}
-
-	if(marked)glLineWidth(1);
-
 }
 
 void CNCCodeBlock::GetBox(CBox &box)
 {
-	for(std::list<ColouredPath>::iterator It = m_line_strips.begin(); It != m_line_strips.end(); It++)
+	if(m_nc_code == NULL)return;
+
+	double extents[6];
+	if(m_nc_code->m_moves.GetExtents(m_first_move, m_number_of_moves, extents))
 	{
-		ColouredPath& line_strip = *It;
-		line_strip.GetBox(box);
+		box.Insert(extents);
+		box.Insert(&extents[3]);
 	}
 }
 
@@ -481,20 +251,18 @@ void CNCCodeBlock::WriteXML(TiXmlNode *root)
 		text.WriteXML(element);
 	}
 
-	for(std::list<ColouredPath>::iterator It = m_line_strips.begin(); It != m_line_strips.end(); It++)
-	{
-		ColouredPath &line_strip = *It;
-		line_strip.WriteXML(element);
-	}
+	if(m_nc_code)WriteMovesXML(element, m_nc_code->m_moves, m_first_move, m_number_of_moves);
 
 	WriteBaseXML(element);
 }
 
 // static
-HeeksObj* CNCCodeBlock::ReadFromXMLElement(TiXmlElement* element)
+HeeksObj* CNCCodeBlock::ReadFromXMLElement(TiXmlElement* element, CNCCode* nc_code)
 {
-	CNCCodeBlock* new_object = new CNCCodeBlock;
+	CNCCodeBlock* new_object = new CNCCodeBlock(nc_code);
 	new_object->m_from_pos = CNCCode::pos;
+	new_object->m_first_move = nc_code->m_moves.size();
+	int block_index = (int)nc_code->m_blocks.size();
 
 	// loop through all the objects
 	for(TiXmlElement* pElem = heeksCAD->FirstXMLChildElement( element ) ; pElem; pElem = pElem->NextSiblingElement())
@@ -509,20 +277,23 @@ HeeksObj* CNCCodeBlock::ReadFromXMLElement(TiXmlElement* element)
 		}
 		else if(name == "path")
 		{
-			ColouredPath l;
-			l.ReadFromXMLElement(pElem);
-			new_object->m_line_strips.push_back(l);
+			ReadPathFromXMLElement(pElem, nc_code, block_index);
 		}
 		else if(name == "mode")
 		{
 			const char* units = pElem->Attribute("units");
 			if(units)pElem->Attribute("units", &CNCCodeBlock::multiplier);
 		}
+		else if(name == "tool")
+		{
+			if(pElem->Attribute("number"))pElem->Attribute("number", &current_tool_number);
+		}
 	}
 
 	if(new_object->m_text.size() > 0)CNCCode::pos++;
 
 	new_object->m_to_pos = CNCCode::pos;
+	new_object->m_number_of_moves = nc_code->m_moves.size() - new_object->m_first_move;
 
 	new_object->ReadBaseXML(element);
 
@@ -557,8 +328,6 @@ void CNCCodeBlock::FormatText(COutputTextCtrl *textCtrl)
 }
 
 long CNCCode::pos = 0;
-// static
-PathObject* CNCCode::prev_po = NULL;
 
 std::map<std::string,ColorEnum> CNCCode::m_colors_s_i;
 std::map<ColorEnum,std::string> CNCCode::m_colors_i_s;
@@ -688,7 +457,7 @@ void CNCCode::WriteColorsToConfig()
 }
 
 CNCCode::CNCCode()
- : HeeksObj(ObjType), m_gl_list(0), m_highlighted_block(NULL), m_user_edited(false)
+ : HeeksObj(ObjType), m_blocks_with_vertices(0), m_highlighted_block(NULL), m_user_edited(false)
 {
 	CNCConfig config(ConfigScope());
 	config.Read(_T("CNCCode_ArcInterpolationCount"), &CNCCode::s_arc_interpolation_count, 20);
@@ -703,10 +472,13 @@ const CNCCode &CNCCode::operator=(const CNCCode &rhs)
 {
 	HeeksObj::operator =(rhs);
 	Clear();
-	for(std::list<CNCCodeBlock*>::const_iterator It = rhs.m_blocks.begin(); It != rhs.m_blocks.end(); It++)
+	m_moves = rhs.m_moves;
+	m_blocks.reserve(rhs.m_blocks.size());
+	for(std::vector<CNCCodeBlock*>::const_iterator It = rhs.m_blocks.begin(); It != rhs.m_blocks.end(); It++)
 	{
 		CNCCodeBlock* block = *It;
 		CNCCodeBlock* new_block = new CNCCodeBlock(*block);
+		new_block->m_nc_code = this;
 		m_blocks.push_back(new_block);
 	}
 	return *this;
@@ -714,50 +486,123 @@ const CNCCode &CNCCode::operator=(const CNCCode &rhs)
 
 void CNCCode::Clear()
 {
-	for(std::list<CNCCodeBlock*>::iterator It = m_blocks.begin(); It != m_blocks.end(); It++)
+	for(std::vector<CNCCodeBlock*>::iterator It = m_blocks.begin(); It != m_blocks.end(); It++)
 	{
 		CNCCodeBlock* block = *It;
 		delete block;
 	}
 	m_blocks.clear();
+	m_moves.Clear();
 	DestroyGLLists();
+	std::vector<float>().swap(m_vertices);
+	std::vector<unsigned char>().swap(m_vertex_colors);
+	m_blocks_with_vertices = 0;
+	m_lod.Clear();
+	m_bvh.Clear();
 	m_box = CBox();
 	m_highlighted_block = NULL;
 }
 
-void CNCCode::glCommands(bool select, bool marked, bool no_color)
+void CNCCode::MakeVertices(void)
 {
-	if(m_gl_list)
+	// start again, if the colours have been changed
+	bool colors_changed = (m_vertex_colors_used.size() != m_colors.size());
+	for(size_t i = 0; !colors_changed && i < m_colors.size(); i++)colors_changed = (m_vertex_colors_used[i] != m_colors[i].COLORREF_color());
+	if(colors_changed)
 	{
-		glCallList(m_gl_list);
+		m_vertex_colors_used.clear();
+		for(size_t i = 0; i < m_colors.size(); i++)m_vertex_colors_used.push_back(m_colors[i].COLORREF_color());
+		m_vertices.clear();
+		m_vertex_colors.clear();
+		m_blocks_with_vertices = 0;
+		m_lod.Clear();
+		m_bvh.Clear();
 	}
-	else{
-		m_gl_list = glGenLists(1);
-		glNewList(m_gl_list, GL_COMPILE_AND_EXECUTE);
 
-		// render all the blocks
-		CNCCode::prev_po = NULL;
+	if(m_blocks_with_vertices == m_blocks.size())return;
 
-		for(std::list<CNCCodeBlock*>::iterator It = m_blocks.begin(); It != m_blocks.end(); It++)
+	std::vector<double> arc_points;
+	for(; m_blocks_with_vertices < m_blocks.size(); m_blocks_with_vertices++)
+	{
+		CNCCodeBlock* block = m_blocks[m_blocks_with_vertices];
+		block->m_first_vertex = m_vertices.size() / 3;
+		size_t end = block->m_first_move + block->m_number_of_moves;
+		for(size_t i = block->m_first_move; i < end; i++)
 		{
-			CNCCodeBlock* block = *It;
-			glPushName(block->GetIndex());
-			block->glCommands(true, block == m_highlighted_block, false);
-			glPopName();
+			const double* start = m_moves.StartPoint(i);
+			if(start == NULL)continue; // the first move only gives the start point
+
+			arc_points.clear();
+			if(m_moves.Type(i) == CNCMoveBuffer::eArc)m_moves.ArcPoints(i, s_arc_interpolation_count, arc_points);
+			else arc_points.insert(arc_points.end(), m_moves.EndPoint(i), m_moves.EndPoint(i) + 3);
+
+			const HeeksColor &col = Color((ColorEnum)m_moves.m_color[i]);
+			const double* p0 = start;
+			for(size_t j = 0; j < arc_points.size(); j += 3)
+			{
+				const double* p1 = &arc_points[j];
+				for(int k = 0; k < 3; k++)m_vertices.push_back((float)p0[k]);
+				for(int k = 0; k < 3; k++)m_vertices.push_back((float)p1[k]);
+				for(int v = 0; v < 2; v++)
+				{
+					m_vertex_colors.push_back(col.red);
+					m_vertex_colors.push_back(col.green);
+					m_vertex_colors.push_back(col.blue);
+				}
+				p0 = p1;
+			}
 		}
+		block->m_number_of_vertices = m_vertices.size() / 3 - block->m_first_vertex;
+	}
+}
+
+void CNCCode::DrawVertices(size_t first, size_t count, bool use_colors)const
+{
+	if(count == 0)return;
+
+	glEnableClientState(GL_VERTEX_ARRAY);
+	if(use_colors)glEnableClientState(GL_COLOR_ARRAY);
+	glVertexPointer(3, GL_FLOAT, 0, &m_vertices[0]);
+	if(use_colors)glColorPointer(3, GL_UNSIGNED_BYTE, 0, &m_vertex_colors[0]);
+	glDrawArrays(GL_LINES, (GLint)first, (GLsizei)count);
+	if(use_colors)glDisableClientState(GL_COLOR_ARRAY);
+	glDisableClientState(GL_VERTEX_ARRAY);
+}
+
+void CNCCode::glCommands(bool select, bool marked, bool no_color)
+{
+	MakeVertices();
 
-		glEndList();
+	// only the parts on the screen, only in as much detail as can be seen
+	m_lod.Update(m_vertices, m_vertex_colors);
+
+	if(m_highlighted_block == NULL)
+	{
+		m_lod.glCommands(m_vertices, m_vertex_colors);
+		return;
 	}
+
+	// The highlighted block is drawn again, on top, so the display lists don't have to be made again when a different block is highlighted.
+	// Its lines are at the same depths as the ones under them, so the path is pushed back a little, and the block brought forward
+	// a little, with the depth range; glPolygonOffset doesn't work for lines.
+	const double depth_offset = 1.0 / 4096;
+	glDepthRange(depth_offset, 1.0);
+	m_lod.glCommands(m_vertices, m_vertex_colors);
+	glDepthRange(0.0, 1.0 - depth_offset);
+	m_highlighted_block->glCommands(false, true, false);
+	glDepthRange(0.0, 1.0);
 }
 
 void CNCCode::GetBox(CBox &box)
 {
 	if(!m_box.m_valid)
 	{
-		for(std::list<CNCCodeBlock*>::iterator It = m_blocks.begin(); It != m_blocks.end(); It++)
+		// one pass over all the moves
+		double extents[6];
+		if(m_moves.GetExtents(0, m_moves.size(), extents))
 		{
-			CNCCodeBlock* block = *It;
-			block->GetBox(m_box);
+			m_box.Insert(extents);
+			m_box.Insert(&extents[3]);
 		}
 	}
 
@@ -780,159 +625,15 @@ void CNCCode::GetProperties(std::list<Property *> *list)
 
 /**
 	Define an 'apply' button class so that we can apply a combination
-	of the tools and the GCode paths into a solid and use it
-	to remove sections of the solids in the data model.
+	of the tools and the GCode paths to the stock solids.
  */
 
 class ApplyNCCode: public Tool{
 	// Tool's virtual functions
-	const wxChar* GetTitle(){return _("Apply NC Code to solids. NOTE: This is not ready yet.");}
+	const wxChar* GetTitle(){return _("Apply NC Code to stock");}
 	void Run()
 	{
-		try {
-			// Aggregate a list of solid objects.  The Cut code re-arranges some of these
-			// objects so we don't want to traverse the same list we're changing.  Get our
-			// own list to traverse here first.
-			typedef std::map<int, HeeksObj *> Solids_t;
-			Solids_t solids;
-
-			typedef std::list<std::pair<int, TopoDS_Shape> > Shapes_t;
-			Shapes_t shapes;
-
-			for(HeeksObj* object = heeksCAD->GetFirstObject(); object; object = heeksCAD->GetNextObject())
-			{
-				if (object->GetType() == SolidType)
-				    solids.insert(std::make_pair(object->GetID(), object));
-				if (! object->GetShape().IsNull())
-				    shapes.push_back( std::make_pair(object->GetID(), TopoDS_Shape( object->GetShape() ) ) );
-
-			} // End for
-
-			std::map<int, TopoDS_Shape> tools;
-
-			std::list< std::pair<PathObject *, CTool *> > paths = theApp.m_program->NCCode()->GetPaths();
-			std::list< std::pair<PathObject *, CTool *> >::const_iterator l_itPath;
-
-			// This stuff takes a long time.  Give the user something to look at in the meantime.
-			int progress = 1;
-			std::auto_ptr<wxProgressDialog> pProgressBar = std::auto_ptr<wxProgressDialog>(new wxProgressDialog(	wxString(_T("Apply")),
-							wxString(_T("Applying NC operations to solid")),
-							paths.size(),
-							NULL,
-							wxPD_APP_MODAL | wxPD_ELAPSED_TIME | wxPD_ESTIMATED_TIME | wxPD_REMAINING_TIME | wxPD_AUTO_HIDE ));
-
-
-			PathObject *pPreviousPoint = NULL;
-			for (l_itPath = paths.begin(); l_itPath != paths.end(); l_itPath++)
-			{
-				pProgressBar->Update( ++progress );
-				if (pPreviousPoint == NULL)
-				{
-					pPreviousPoint = l_itPath->first;
-				} // End if - then
-				else
-				{
-					if (tools.find( l_itPath->first->m_tool_number ) == tools.end())
-					{
-						try {
-							tools.insert( std::make_pair( l_itPath->first->m_tool_number, l_itPath->second->GetShape() ) );
-						} catch(...)
-						{
-							// There must be something wrong with the parameters that describe
-							// the tool.  Just skip this one.
-							continue;
-						}
-					} // End if - then
-
-					gp_Pnt previous_point(pPreviousPoint->m_x[0], pPreviousPoint->m_x[1], pPreviousPoint->m_x[2] );
-					gp_Pnt this_point(l_itPath->first->m_x[0], l_itPath->first->m_x[1], l_itPath->first->m_x[2] );
-					pPreviousPoint = l_itPath->first;
-
-					// Just put some values here for now.  The feed_rate and spindle_rpm will eventually come from
-					// the GCode.  The number_of_cutting_edges will come from the CTool class.
-
-					double feed_rate = 100.0;
-					double spindle_rpm = 50;
-					unsigned int number_of_cutting_edges = 2;
-
-					std::list<gp_Pnt> interpolated_points;
-					switch (l_itPath->first->GetType())
-					{
-						case PathObject::eArc:
-							interpolated_points = ((PathArc *) l_itPath->first)->Interpolate(pPreviousPoint, feed_rate, spindle_rpm, number_of_cutting_edges );
-							break;
-
-						case PathObject::eLine:
-						default:
-							interpolated_points = ((PathLine *) l_itPath->first)->Interpolate(previous_point, this_point, feed_rate, spindle_rpm, number_of_cutting_edges );
-							break;
-
-					} // End switch
-
-
-					for (std::list<gp_Pnt>::const_iterator l_itPnt = interpolated_points.begin(); l_itPnt != interpolated_points.end(); l_itPnt++)
-					{
-						// Now move the tool to this point's location.
-						gp_Trsf move;
-						move.SetTranslation( gp_Pnt(0,0,0), *l_itPnt );
-						TopoDS_Shape tool = BRepBuilderAPI_Transform( tools[ l_itPath->first->m_tool_number ], move, true );
-
-						Shapes_t::iterator l_itShape;
-						for (l_itShape = shapes.begin(); l_itShape != shapes.end(); l_itShape++)
-						{
-							try {
-								l_itShape->second = BRepAlgoAPI_Cut(l_itShape->second, tool);
-							} // End try
-							catch(StdFail_NotDone) {
-								// There are exceptions that are thrown by the OpenCascade library when
-								// the two shape objects don't intersect.  We just want to ignore such
-								// problems.
-							} // End catch
-						} // End for
-					} // End for
-
-				} // End if - else
-			} // End for
-
-
-			progress = 1;
-			pProgressBar = std::auto_ptr<wxProgressDialog>(new wxProgressDialog(	wxString(_T("Apply")),
-							wxString(_T("Replacing solids in model")),
-							shapes.size(),
-							NULL,
-							wxPD_APP_MODAL | wxPD_ELAPSED_TIME | wxPD_ESTIMATED_TIME | wxPD_REMAINING_TIME | wxPD_AUTO_HIDE ));
-			for (Shapes_t::iterator l_itShape = shapes.begin(); l_itShape != shapes.end(); l_itShape++)
-			{
-				pProgressBar->Update( ++progress );
-
-#ifdef UNICODE
-				std::wostringstream l_ossTitle;
-#else
-				std::ostringstream l_ossTitle;
-#endif
-				HeeksObj * solid = solids[ l_itShape->first ];
-				l_ossTitle << "Machined " << solid->GetTitle();
-				HeeksObj *pNewSolid = heeksCAD->NewSolid( *((TopoDS_Solid *) &(l_itShape->second)), l_ossTitle.str().c_str(), HeeksColor(234, 123, 89) );
-				if (pNewSolid != NULL)
-				{
-					heeksCAD->Add( pNewSolid, NULL );		// Add the machined solid
-					heeksCAD->Remove( solid );	// Delete the original.
-				} // End if - then
-			} // End for
-
-
-			heeksCAD->Repaint();
-		} // End try
-		catch(Standard_ConstructionError) { }
-		catch(Standard_DomainError)
-		{
-			wxMessageBox(_T("Standard_DomainError thrown during shape operations\n"));
-		}
-		catch(...)
-		{
-			// Let's not kill everything just because I can't write clean code.
-			wxMessageBox(_T("Unexpected exception thrown during shape operations\n"));
-		}
+		RunDexelSimulation();
 	}
 	wxString BitmapPath(){ return theApp.GetResFolder() + _T("/bitmaps/setinactive.png"); }
 };
@@ -942,7 +643,7 @@ static ApplyNCCode apply_nc_code;
 
 void CNCCode::GetTools(std::list<Tool*>* t_list, const wxPoint* p)
 {
-	// t_list->push_back(&apply_nc_code);	// It's not ready yet.
+	t_list->push_back(&apply_nc_code);
 
 	HeeksObj::GetTools(t_list, p);
 }
@@ -957,7 +658,7 @@ void CNCCode::WriteXML(TiXmlNode *root)
 	element = heeksCAD->NewXMLElement( "nccode" );
 	heeksCAD->LinkXMLEndChild( root,  element );
 
-	for(std::list<CNCCodeBlock*>::iterator It = m_blocks.begin(); It != m_blocks.end(); It++)
+	for(std::vector<CNCCodeBlock*>::iterator It = m_blocks.begin(); It != m_blocks.end(); It++)
 	{
 		CNCCodeBlock* block = *It;
 		block->WriteXML(element);
@@ -980,26 +681,38 @@ bool CNCCode::CanAddTo(HeeksObj* owner)
 
 void CNCCode::SetClickMarkPoint(MarkedObject* marked_object, const double* ray_start, const double* ray_direction)
 {
-	if(marked_object->m_map.size() > 0)
-	{
-		MarkedObject* sub_marked_object = marked_object->m_map.begin()->second;
-		if(sub_marked_object)
-		{
-			if(sub_marked_object->m_map.size() > 0)
-			{
-				HeeksObj* object = sub_marked_object->m_map.begin()->first;
-				if(object && object->GetType() == NCCodeBlockType)
-				{
-					m_highlighted_block = (CNCCodeBlock*)object;
-					int from_pos = m_highlighted_block->m_from_pos;
-					int to_pos = m_highlighted_block->m_to_pos;
-					DestroyGLLists();
-					theApp.m_output_canvas->m_textCtrl->ShowPosition(from_pos);
-					theApp.m_output_canvas->m_textCtrl->SetSelection(from_pos, to_pos);
-				}
-			}
-		}
-	}
+	CNCCodeBlock* block = BlockFromRay(ray_start, ray_direction);
+	if(block == NULL)return;
+
+	m_highlighted_block = block;
+	int from_pos = m_highlighted_block->m_from_pos;
+	int to_pos = m_highlighted_block->m_to_pos;
+	theApp.m_output_canvas->m_textCtrl->ShowPosition(from_pos);
+	theApp.m_output_canvas->m_textCtrl->SetSelection(from_pos, to_pos);
+}
+
+CNCCodeBlock* CNCCode::BlockFromRay(const double* ray_start, const double* ray_direction)
+{
+	MakeVertices();
+	m_bvh.Update(m_vertices);
+
+	long line = m_bvh.Nearest(ray_start, ray_direction, m_vertices);
+	if(line < 0)return NULL;
+	return BlockFromVertex(line * 2);
+}
+
+static bool FirstVertexLess(size_t vertex, const CNCCodeBlock* block)
+{
+	return vertex < block->m_first_vertex;
+}
+
+CNCCodeBlock* CNCCode::BlockFromVertex(size_t vertex)
+{
+	// the last block starting at or before the vertex
+	std::vector<CNCCodeBlock*>::iterator end = m_blocks.begin() + m_blocks_with_vertices;
+	std::vector<CNCCodeBlock*>::iterator It = std::upper_bound(m_blocks.begin(), end, vertex, FirstVertexLess);
+	if(It == m_blocks.begin())return NULL;
+	return *(--It);
 }
 
 //static
@@ -1009,7 +722,7 @@ HeeksObj* CNCCode::ReadFromXMLElement(TiXmlElement* element)
 	pos = 0;
 
 	CNCCodeBlock::multiplier = 1.0;
-	PathObject::m_current_x[0] = PathObject::m_current_x[1] = PathObject::m_current_x[2]  = 0.0;
+	current_tool_number = 0;
 
 	// loop through all the objects
 	for(TiXmlElement* pElem = heeksCAD->FirstXMLChildElement( element ); pElem; pElem = pElem->NextSiblingElement())
@@ -1017,7 +730,7 @@ HeeksObj* CNCCode::ReadFromXMLElement(TiXmlElement* element)
 		std::string name(pElem->Value());
 		if(name == "ncblock")
 		{
-			HeeksObj* object = CNCCodeBlock::ReadFromXMLElement(pElem);
+			HeeksObj* object = CNCCodeBlock::ReadFromXMLElement(pElem, new_object);
 			new_object->m_blocks.push_back((CNCCodeBlock*)object);
 		}
 	}
@@ -1036,11 +749,7 @@ HeeksObj* CNCCode::ReadFromXMLElement(TiXmlElement* element)
 
 void CNCCode::DestroyGLLists(void)
 {
-	if (m_gl_list)
-	{
-		glDeleteLists(m_gl_list, 1);
-		m_gl_list = 0;
-	}
+	m_lod.DestroyGLLists();
 }
 
 void CNCCode::SetTextCtrlStyles(COutputTextCtrl *textCtrl)
@@ -1062,14 +771,14 @@ void CNCCode::SetTextCtrl(COutputTextCtrl *textCtrl)
 	textCtrl->Freeze();
 	SetTextCtrlStyles(textCtrl);
 	wxString str;
-	for(std::list<CNCCodeBlock*>::iterator It = m_blocks.begin(); It != m_blocks.end(); It++)
+	for(std::vector<CNCCodeBlock*>::iterator It = m_blocks.begin(); It != m_blocks.end(); It++)
 	{
 		CNCCodeBlock* block = *It;
 		block->AppendText(str);
 	}
 	textCtrl->SetValue(str);
 
-	for(std::list<CNCCodeBlock*>::iterator It = m_blocks.begin(); It != m_blocks.end(); It++)
+	for(std::vector<CNCCodeBlock*>::iterator It = m_blocks.begin(); It != m_blocks.end(); It++)
 	{
 		CNCCodeBlock* block = *It;
 		block->FormatText(textCtrl);
@@ -1078,11 +787,33 @@ void CNCCode::SetTextCtrl(COutputTextCtrl *textCtrl)
 	textCtrl->Thaw();
 }
 
+void CNCCode::OnBlocksAdded(COutputTextCtrl *textCtrl, size_t first_block)
+{
+	if(first_block >= m_blocks.size())return;
+
+	textCtrl->Freeze();
+	if(first_block == 0)
+	{
+		textCtrl->Clear();
+		SetTextCtrlStyles(textCtrl);
+	}
+
+	wxString str;
+	for(size_t i = first_block; i < m_blocks.size(); i++)m_blocks[i]->AppendText(str);
+	textCtrl->AppendText(str);
+
+	for(size_t i = first_block; i < m_blocks.size(); i++)m_blocks[i]->FormatText(textCtrl);
+	textCtrl->Thaw();
+
+	// the new moves are added to the vertices, and the box is made again, on the next repaint
+	m_box = CBox();
+}
+
 void CNCCode::FormatBlocks(COutputTextCtrl *textCtrl, int i0, int i1)
 {
 	textCtrl->Freeze();
 	SetTextCtrlStyles(textCtrl);
-	for(std::list<CNCCodeBlock*>::iterator It = m_blocks.begin(); It != m_blocks.end(); It++)
+	for(std::vector<CNCCodeBlock*>::iterator It = m_blocks.begin(); It != m_blocks.end(); It++)
 	{
 		CNCCodeBlock* block = *It;
 		if (i0 <= block->m_from_pos && block->m_from_pos <= i1)
@@ -1091,116 +822,43 @@ void CNCCode::FormatBlocks(COutputTextCtrl *textCtrl, int i0, int i1)
 	textCtrl->Thaw();
 }
 
+static bool ToPosLess(long pos, const CNCCodeBlock* block)
+{
+	return pos < block->m_to_pos;
+}
+
 void CNCCode::HighlightBlock(long pos)
 {
 	m_highlighted_block = NULL;
 
-	for(std::list<CNCCodeBlock*>::iterator It = m_blocks.begin(); It != m_blocks.end(); It++)
-	{
-		CNCCodeBlock* block = *It;
-		if(pos < block->m_to_pos)
-		{
-			m_highlighted_block = block;
-			break;
-		}
-	}
-	DestroyGLLists();
+	// the blocks are in text order, so the first one ending after pos is found with a binary search
+	std::vector<CNCCodeBlock*>::iterator It = std::upper_bound(m_blocks.begin(), m_blocks.end(), pos, ToPosLess);
+	if(It != m_blocks.end())m_highlighted_block = *It;
 }
 
 
 
-static double Distance( const gp_Pnt start, const gp_Pnt end )
-{
-	double x_squared = (start.X() - end.X()) * (start.X() - end.X());
-	double y_squared = (start.Y() - end.Y()) * (start.Y() - end.Y());
-	double z_squared = (start.Z() - end.Z()) * (start.Z() - end.Z());
-
-	return( sqrt( x_squared + y_squared + z_squared ) );
-} // End Distance() routine
-
-
-/**
-	Generate as many points as is necessary such that the tool turns to the next
-	cutting edge and, in that time (based on the spindle speed) advances at the
-	feed rate.  We want to calculate material removal rate on a per-cutting edge
-	basis.
- */
-std::list<gp_Pnt> PathLine::Interpolate(
-	const gp_Pnt & start_point,
-	const gp_Pnt & end_point,
-	const double feed_rate,
-	const double spindle_rpm,
-	const unsigned int number_of_cutting_edges) const
+std::vector< std::pair<size_t, CTool *> > CNCCode::GetPaths() const
 {
-	std::list<gp_Pnt> points;
-
-	double spindle_rps = spindle_rpm / 60.0;	// Revolutions Per Second.
-	double time_between_cutting_edges = (1 / spindle_rps) / number_of_cutting_edges;
+	std::vector< std::pair<size_t, CTool *> > paths;
+	paths.reserve(m_moves.size());
 
-	double advance_distance = (feed_rate / 60.0) * time_between_cutting_edges;
-	double number_of_interpolated_points = Distance( start_point, end_point ) / advance_distance;
+	// look up each tool once, rather than once per move
+	std::map<int, CTool *> tools;
 
-	points.push_back( start_point );
-
-	for ( int i=0; i < int(floor(number_of_interpolated_points)); i++)
+	for (size_t i = 0; i < m_moves.size(); i++)
 	{
-		double x = (((start_point.X() - end_point.X()) / number_of_interpolated_points) * i) + start_point.X();
-		double y = (((start_point.Y() - end_point.Y()) / number_of_interpolated_points) * i) + start_point.Y();
-		double z = (((start_point.Z() - end_point.Z()) / number_of_interpolated_points) * i) + start_point.Z();
-
-		points.push_back( gp_Pnt( x, y, z ) );
-	} // End for
-
-	points.push_back( end_point );
-
-	return(points);
-} // End Interpolate() method
-
-
-std::list<gp_Pnt> PathArc::Interpolate(
-	const PathObject *previous_point,
-	const double feed_rate,
-	const double spindle_rpm,
-	const unsigned int number_of_cutting_edges) const
-{
-	std::list<gp_Pnt> points;
-
-	double spindle_rps = spindle_rpm / 60.0;	// Revolutions Per Second.
-	double time_between_cutting_edges = (1 / spindle_rps) / number_of_cutting_edges;
-
-	double advance_distance = (feed_rate / 60.0) * time_between_cutting_edges;
-
-	// This distance is wrong for arcs.  We're doing a straight line distance but we really want a distance
-	// around the arc.  TODO Fix this.
-	double number_of_interpolated_points = Distance( gp_Pnt( previous_point->m_x[0], previous_point->m_x[1], previous_point->m_x[2] ),
-							gp_Pnt( m_x[0], m_x[1], m_x[2] ) ) / advance_distance;
-
-	points = Interpolate( previous_point, (unsigned int) (floor(number_of_interpolated_points)) );
-
-	return(points);
-
-} // End Interpolate() method
-
-
-std::list< std::pair<PathObject *, CTool *> > CNCCode::GetPaths() const
-{
-	std::list< std::pair<PathObject *, CTool *> > paths;
+		int tool_number = m_moves.m_tool_number[i];
+		std::map<int, CTool *>::iterator l_itTool = tools.find( tool_number );
+		if (l_itTool == tools.end())
+		{
+			l_itTool = tools.insert( std::make_pair( tool_number, CTool::Find( tool_number ) ) ).first;
+		} // End if - then
 
-	for(std::list<CNCCodeBlock*>::const_iterator l_itCodeBlock = m_blocks.begin(); l_itCodeBlock != m_blocks.end(); l_itCodeBlock++)
-	{
-		for (std::list<ColouredPath>::const_iterator l_itColouredPath = (*l_itCodeBlock)->m_line_strips.begin();
-			l_itColouredPath != (*l_itCodeBlock)->m_line_strips.end(); l_itColouredPath++)
+		if (l_itTool->second != NULL)
 		{
-			for (std::list< PathObject* >::const_iterator l_itPoint = l_itColouredPath->m_points.begin();
-				l_itPoint != l_itColouredPath->m_points.end(); l_itPoint++)
-			{
-				CTool *pTool = CTool::Find( (*l_itPoint)->m_tool_number );
-				if (pTool != NULL)
-				{
-					paths.push_back( std::make_pair( *l_itPoint, pTool ) );
-				} // End if - then
-			} // End for
-		} // End for
+			paths.push_back( std::make_pair( i, l_itTool->second ) );
+		} // End if - then
 	} // End for
 
 	return(paths);
@@ -16,6 +16,9 @@
 #include "HeeksCNCTypes.h"
 #include "CTool.h"
 #include "OutputCanvas.h"
+#include "NCMoveBuffer.h"
+#include "ToolpathLOD.h"
+#include "ToolpathBVH.h"
 #include <TopoDS_Shape.hxx>
 #include <gp_Pnt.hxx>
 
@@ -47,89 +50,7 @@ public:
 	void ReadFromXMLElement(TiXmlElement* pElem);
 };
 
-class PathObject{
-public:
-	typedef enum {
-		eLine = 0,
-		eArc
-	} eType_t;
-
-public:
-	static double m_current_x[3];
-	static double m_prev_x[3];
-	double m_x[3];
-	int m_tool_number;
-	PathObject(){m_x[0] = m_x[1] = m_x[2] = 0.0;}
-	virtual int GetType() = 0; // 0 - line, 1 - arc
-	virtual void GetBox(CBox &box,const PathObject* prev_po){box.Insert(m_x);}
-
-	void WriteBaseXML(TiXmlElement *element);
-
-	virtual void WriteXML(TiXmlNode *root) = 0;
-	virtual void ReadFromXMLElement(TiXmlElement* pElem) = 0;
-	virtual void glVertices(const PathObject* prev_po){}
-	virtual PathObject *MakeACopy(void)const = 0;
-};
-
-class PathLine : public PathObject{
-public:
-	int GetType(){return int(PathObject::eLine);}
-	void WriteXML(TiXmlNode *root);
-	void ReadFromXMLElement(TiXmlElement* pElem);
-	void glVertices(const PathObject* prev_po);
-	PathObject *MakeACopy(void)const{return new PathLine(*this);}
-
-	std::list<gp_Pnt> Interpolate( const gp_Pnt & start_point,
-					const gp_Pnt & end_point,
-					const double feed_rate,
-					const double spindle_rpm,
-					const unsigned int number_of_cutting_edges) const;
-
-};
-
-class PathArc : public PathObject{
-private:
-	double m_c[3]; // defined relative to previous point ( span start point )
-	double m_radius;
-	int m_dir; // 1 - anti-clockwise, -1 - clockwise
-
-public:
-	PathArc(){m_c[0] = m_c[1] = m_c[2] = 0.0; m_dir = 1;}
-	int GetType(){return int(PathObject::eArc);}
-	void WriteXML(TiXmlNode *root);
-	void ReadFromXMLElement(TiXmlElement* pElem);
-	void glVertices(const PathObject* prev_po);
-	std::list<gp_Pnt> Interpolate( const PathObject *prev_po, const unsigned int number_of_points ) const;
-
-	PathObject *MakeACopy(void)const{return new PathArc(*this);}
-
-	void GetBox(CBox &box,const PathObject* prev_po);
-	bool IsIncluded(gp_Pnt pnt,const PathObject* prev_po);
-
-	std::list<gp_Pnt> Interpolate( const PathObject *previous_object,
-					const double feed_rate,
-					const double spindle_rpm,
-					const unsigned int number_of_cutting_edges) const;
-	void SetFromRadius();
-};
-
-class ColouredPath
-{
-public:
-	ColorEnum m_color_type;
-	std::list< PathObject* > m_points;
-	ColouredPath():m_color_type(ColorRapidType){}
-	ColouredPath(const ColouredPath& c);
-	~ColouredPath(){Clear();}
-
-	const ColouredPath &operator=(const ColouredPath& c);
-
-	void Clear();
-	void glCommands();
-	void GetBox(CBox &box);
-	void WriteXML(TiXmlNode *root);
-	void ReadFromXMLElement(TiXmlElement* pElem);
-};
+class CNCCode;
 
 class CNCCodeBlock : public HeeksObj
 {
@@ -139,12 +60,14 @@ public:
 
 
 	std::list<ColouredText> m_text;
-	std::list<ColouredPath> m_line_strips;
+	CNCCode* m_nc_code; // the owner of the moves
+	size_t m_first_move, m_number_of_moves; // range of this block's moves in m_nc_code->m_moves
+	size_t m_first_vertex, m_number_of_vertices; // range of this block's lines in m_nc_code->m_vertices
 	long m_from_pos, m_to_pos; // position of block in text ctrl
 	bool m_formatted;
 	static double multiplier;
 
-	CNCCodeBlock() : HeeksObj(ObjType), m_from_pos(-1), m_to_pos(-1), m_formatted(false) {}
+	CNCCodeBlock(CNCCode* nc_code = NULL) : HeeksObj(ObjType), m_nc_code(nc_code), m_first_move(0), m_number_of_moves(0), m_first_vertex(0), m_number_of_vertices(0), m_from_pos(-1), m_to_pos(-1), m_formatted(false) {}
 
 	void WriteNCCode(wxTextFile &f, double ox, double oy);
 
@@ -154,7 +77,8 @@ public:
 	void GetBox(CBox &box);
 	void WriteXML(TiXmlNode *root);
 
-	static HeeksObj* ReadFromXMLElement(TiXmlElement* pElem);
+	// reads the block's moves straight into nc_code->m_moves
+	static HeeksObj* ReadFromXMLElement(TiXmlElement* pElem, CNCCode* nc_code);
 	void AppendText(wxString& str);
 	void FormatText(COutputTextCtrl *textCtrl);
 };
@@ -181,16 +105,25 @@ public:
 	static int ColorCount(void) { return m_colors.size(); }
 	static const HeeksColor& Color(ColorEnum i) { return m_colors[i]; }
 
-	std::list<CNCCodeBlock*> m_blocks;
-	int m_gl_list;
+	std::vector<CNCCodeBlock*> m_blocks;
+	CNCMoveBuffer m_moves; // all the moves of all the blocks, in order
+	// The moves as GL_LINES, with arcs split up, made when they are first drawn and kept until the moves are cleared.
+	// m_lod draws them, and a highlighted block is drawn again, on top, from its range of them.
+	std::vector<float> m_vertices;
+	std::vector<unsigned char> m_vertex_colors;
+	size_t m_blocks_with_vertices;
+	std::vector<long> m_vertex_colors_used; // to spot when the colours are changed
+	CToolpathLOD m_lod;
+	CToolpathBVH m_bvh; // for clicking on the lines, made the first time it's needed
+
 	CBox m_box;
 	CNCCodeBlock* m_highlighted_block;
 	bool m_user_edited; // set, if the user has edited the nc code
-	static PathObject* prev_po;
 	static int s_arc_interpolation_count;	// How many lines to represent an arc for the glCommands() method?
+	static HeeksColor highlight_color; // for the block picked in the output window or on the screen
 
 	CNCCode();
-	CNCCode(const CNCCode &p): HeeksObj(p), m_gl_list(0), m_highlighted_block(NULL) {operator=(p);}
+	CNCCode(const CNCCode &p): HeeksObj(p), m_blocks_with_vertices(0), m_highlighted_block(NULL) {operator=(p);}
 	virtual ~CNCCode();
 
 	const CNCCode &operator=(const CNCCode &p);
@@ -216,10 +149,16 @@ public:
 	static wxString ConfigScope() { return(_T("NC Code")); }
 
 	void DestroyGLLists(void); // not void KillGLLists(void), because I don't want the display list recreated on the Redraw button
+	void MakeVertices(void); // adds the vertices for any blocks which don't have them yet
+	void DrawVertices(size_t first, size_t count, bool use_colors = true)const;
 	void SetTextCtrlStyles(COutputTextCtrl *textCtrl);
 	void SetTextCtrl(COutputTextCtrl *textCtrl);
+	void OnBlocksAdded(COutputTextCtrl *textCtrl, size_t first_block); // for blocks added while reading a file that's still being written
 	void FormatBlocks(COutputTextCtrl *textCtrl, int i0, int i1);
 	void HighlightBlock(long pos);
+	CNCCodeBlock* BlockFromRay(const double* ray_start, const double* ray_direction);
+	CNCCodeBlock* BlockFromVertex(size_t vertex);
 
-	std::list< std::pair<PathObject *, CTool *> > GetPaths() const;
+	// indexes into m_moves, with the tool used for each move
+	std::vector< std::pair<size_t, CTool *> > GetPaths() const;
 };
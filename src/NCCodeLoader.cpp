@@ -0,0 +1,326 @@
+// NCCodeLoader.cpp
+/*
+ * Copyright (c) 2009, Dan Heeks
+ * This program is released under the BSD license. See the file COPYING for
+ * details.
+ */
+
+#include "stdafx.h"
+#include "NCCodeLoader.h"
+
+#include <wx/ffile.h>
+
+#include <string.h>
+
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// must match nc/hbin_writer.py
+static const int hbin_version = 1;
+
+enum
+{
+	REC_BLOCK_BEGIN = 1,
+	REC_BLOCK_END,
+	REC_COLOR,
+	REC_TEXT,
+	REC_UNITS,
+	REC_TOOL,
+	REC_LINE,
+	REC_ARC
+};
+
+static const unsigned char NO_COLOR = 255;
+
+CNCCodeLoader::CNCCodeLoader(CNCCode* nc_code)
+	: m_nc_code(nc_code), m_block(NULL), m_header_read(false), m_failed(false), m_pos(0), m_multiplier(1.0), m_tool_number(0), m_number_of_blocks_read(0)
+{
+	m_last[0] = m_last[1] = m_last[2] = 0;
+
+	// carry on from any blocks that are already there
+	if(!m_nc_code->m_blocks.empty())m_pos = m_nc_code->m_blocks.back()->m_to_pos;
+}
+
+CNCCodeLoader::~CNCCodeLoader()
+{
+	Finish();
+}
+
+void CNCCodeLoader::Finish()
+{
+	if(m_block)EndBlock();
+}
+
+// reads an unsigned varint, returns false if it runs off the end
+static bool ReadVarint(const unsigned char* &p, const unsigned char* end, unsigned long long &value)
+{
+	value = 0;
+	int shift = 0;
+	while(p < end)
+	{
+		unsigned char c = *p++;
+		value |= ((unsigned long long)(c & 127)) << shift;
+		if((c & 128) == 0)return true;
+		shift += 7;
+		if(shift > 63)return false;
+	}
+	return false;
+}
+
+static bool ReadZigzag(const unsigned char* &p, const unsigned char* end, long long &value)
+{
+	unsigned long long u;
+	if(!ReadVarint(p, end, u))return false;
+	value = (long long)(u >> 1) ^ -(long long)(u & 1);
+	return true;
+}
+
+size_t CNCCodeLoader::Decode(const char* data, size_t length)
+{
+	const unsigned char* start = (const unsigned char*)data;
+	const unsigned char* p = start;
+	const unsigned char* end = start + length;
+
+	if(m_failed)return length;
+
+	if(!m_header_read)
+	{
+		if(length < 5)return 0;
+		if(memcmp(p, "HNCB", 4) != 0 || p[4] > hbin_version)
+		{
+			m_failed = true;
+			return length;
+		}
+		p += 5;
+		m_header_read = true;
+	}
+
+	while(p < end)
+	{
+		const unsigned char* record = p;
+		int type = *p++;
+		unsigned long long payload_length;
+		if(!ReadVarint(p, end, payload_length) || payload_length > (unsigned long long)(end - p))
+		{
+			// wait for the rest of the record
+			return record - start;
+		}
+
+		// unknown record types, from later versions, are skipped
+		DecodeRecord(type, p, (size_t)payload_length);
+		p += payload_length;
+	}
+
+	return p - start;
+}
+
+ColorEnum CNCCodeLoader::Color(unsigned char id)const
+{
+	if(id == NO_COLOR || id >= m_colors.size())return ColorDefaultType;
+	return m_colors[id];
+}
+
+void CNCCodeLoader::EndBlock()
+{
+	if(m_block->m_text.size() > 0)m_pos++;
+	m_block->m_to_pos = m_pos;
+	m_block->m_number_of_moves = m_nc_code->m_moves.size() - m_block->m_first_move;
+	m_nc_code->m_blocks.push_back(m_block);
+	m_block = NULL;
+	m_number_of_blocks_read++;
+}
+
+void CNCCodeLoader::DecodeRecord(int type, const unsigned char* payload, size_t length)
+{
+	const unsigned char* p = payload;
+	const unsigned char* end = payload + length;
+
+	switch(type)
+	{
+	case REC_BLOCK_BEGIN:
+		if(m_block)EndBlock();
+		m_block = new CNCCodeBlock(m_nc_code);
+		m_block->m_from_pos = m_pos;
+		m_block->m_first_move = m_nc_code->m_moves.size();
+		break;
+
+	case REC_BLOCK_END:
+		if(m_block)EndBlock();
+		break;
+
+	case REC_COLOR:
+		if(length >= 1)
+		{
+			unsigned char id = p[0];
+			if(id >= m_colors.size())m_colors.resize(id + 1, ColorDefaultType);
+			std::string name((const char*)p + 1, length - 1);
+			m_colors[id] = CNCCode::GetColor(name.c_str());
+		}
+		break;
+
+	case REC_TEXT:
+		if(m_block && length >= 1)
+		{
+			ColouredText text;
+			text.m_color_type = Color(p[0]);
+			text.m_str = wxString((const char*)p + 1, wxConvUTF8, length - 1);
+			m_block->m_text.push_back(text);
+			m_pos += text.m_str.Len();
+		}
+		break;
+
+	case REC_UNITS:
+		if(length >= 8)
+		{
+			// little endian double
+			unsigned long long bits = 0;
+			for(int i = 7; i >= 0; i--)bits = (bits << 8) | p[i];
+			memcpy(&m_multiplier, &bits, sizeof(double));
+		}
+		break;
+
+	case REC_TOOL:
+		{
+			long long tool_number;
+			if(ReadZigzag(p, end, tool_number))m_tool_number = (int)tool_number;
+		}
+		break;
+
+	case REC_LINE:
+	case REC_ARC:
+		{
+			if(m_block == NULL)break;
+			int header_length = (type == REC_ARC) ? 3 : 2;
+			if(length < (size_t)header_length)break;
+
+			ColorEnum color_type = Color(p[0]);
+			int dir = (type == REC_ARC) ? (signed char)p[1] : 0;
+			unsigned char flags = p[header_length - 1];
+			p += header_length;
+
+			CNCMoveBuffer &moves = m_nc_code->m_moves;
+			double x[3] = {0.0, 0.0, 0.0};
+			if(!moves.empty())memcpy(x, moves.EndPoint(moves.size() - 1), 3*sizeof(double));
+
+			for(int i = 0; i < 3; i++)
+			{
+				if(flags & (1 << i))
+				{
+					long long delta;
+					if(!ReadZigzag(p, end, delta))return;
+					m_last[i] += delta;
+					x[i] = m_last[i] * 0.000001 * m_multiplier;
+				}
+			}
+
+			int block_index = (int)m_nc_code->m_blocks.size();
+
+			if(type == REC_LINE)
+			{
+				moves.AddLine(x, m_tool_number, color_type, block_index);
+				break;
+			}
+
+			double c[3] = {0.0, 0.0, 0.0};
+			for(int i = 0; i < 3; i++)
+			{
+				if(flags & (8 << i))
+				{
+					long long v;
+					if(!ReadZigzag(p, end, v))return;
+					c[i] = v * 0.000001 * m_multiplier;
+				}
+			}
+
+			if(flags & 64)
+			{
+				long long r;
+				if(!ReadZigzag(p, end, r))return;
+				moves.AddArcFromRadius(x, r * 0.000001 * m_multiplier, dir, m_tool_number, color_type, block_index);
+			}
+			else
+			{
+				moves.AddArc(x, c, dir, m_tool_number, color_type, block_index);
+			}
+		}
+		break;
+	}
+}
+
+bool CNCCodeLoader::LoadFile(const wxString& filepath)
+{
+	bool mapped = false;
+
+#ifdef WIN32
+	HANDLE file = ::CreateFile(filepath.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if(file != INVALID_HANDLE_VALUE)
+	{
+		LARGE_INTEGER size;
+		if(::GetFileSizeEx(file, &size) && size.QuadPart > 0)
+		{
+			HANDLE mapping = ::CreateFileMapping(file, NULL, PAGE_READONLY, 0, 0, NULL);
+			if(mapping != NULL)
+			{
+				const char* data = (const char*)::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+				if(data != NULL)
+				{
+					Decode(data, (size_t)size.QuadPart);
+					::UnmapViewOfFile(data);
+					mapped = true;
+				}
+				::CloseHandle(mapping);
+			}
+		}
+		::CloseHandle(file);
+	}
+#else
+	int fd = open(filepath.mb_str(wxConvFile), O_RDONLY);
+	if(fd >= 0)
+	{
+		struct stat st;
+		if(fstat(fd, &st) == 0 && st.st_size > 0)
+		{
+			void* data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+			if(data != MAP_FAILED)
+			{
+				madvise(data, st.st_size, MADV_SEQUENTIAL);
+				Decode((const char*)data, st.st_size);
+				munmap(data, st.st_size);
+				mapped = true;
+			}
+		}
+		close(fd);
+	}
+#endif
+
+	if(!mapped)
+	{
+		// read it a chunk at a time instead
+		wxFFile file(filepath, _T("rb"));
+		if(!file.IsOpened())return false;
+
+		const size_t chunk_size = 1 << 20;
+		std::vector<char> buffer(chunk_size);
+		size_t kept = 0;
+		while(!file.Eof())
+		{
+			if(kept == buffer.size())buffer.resize(buffer.size() * 2); // a very long record
+			size_t n = file.Read(&buffer[kept], buffer.size() - kept);
+			if(n == 0)break;
+			size_t available = kept + n;
+			size_t used = Decode(&buffer[0], available);
+			kept = available - used;
+			if(kept > 0)memmove(&buffer[0], &buffer[used], kept);
+		}
+	}
+
+	Finish();
+
+	return !m_failed;
+}
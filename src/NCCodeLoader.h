@@ -0,0 +1,52 @@
+// NCCodeLoader.h
+/*
+ * Copyright (c) 2009, Dan Heeks
+ * This program is released under the BSD license. See the file COPYING for
+ * details.
+ */
+
+// Reads the binary backplot stream written by nc/hbin_writer.py into a CNCCode object.
+// See hbin_writer.py for the layout. The records are decoded as they arrive, so the
+// same object can read a whole memory mapped file or a stream that comes in pieces.
+
+#pragma once
+
+#include "NCCode.h"
+
+#include <vector>
+
+class CNCCodeLoader
+{
+public:
+	CNCCodeLoader(CNCCode* nc_code);
+	~CNCCodeLoader();
+
+	// reads the whole file, memory mapped if possible
+	bool LoadFile(const wxString& filepath);
+
+	// Decodes as many whole records as there are in data and returns how many bytes it used.
+	// Call it again with the unused bytes at the start of the next lot of data.
+	size_t Decode(const char* data, size_t length);
+
+	// adds the last block, if the stream ended part way through it
+	void Finish();
+
+	bool Failed()const{return m_failed;}
+	size_t NumberOfBlocksRead()const{return m_number_of_blocks_read;}
+
+private:
+	CNCCode* m_nc_code;
+	CNCCodeBlock* m_block; // the block being read
+	bool m_header_read;
+	bool m_failed;
+	long m_pos; // position in the text ctrl
+	double m_multiplier;
+	int m_tool_number;
+	long long m_last[3]; // last x, y and z, in millionths
+	std::vector<ColorEnum> m_colors; // the writer's colour ids
+	size_t m_number_of_blocks_read;
+
+	void DecodeRecord(int type, const unsigned char* payload, size_t length);
+	ColorEnum Color(unsigned char id)const;
+	void EndBlock();
+};
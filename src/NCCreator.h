@@ -0,0 +1,102 @@
+// NCCreator.h
+/*
+ * Copyright (c) 2009, Dan Heeks
+ * This program is released under the BSD license. See the file COPYING for
+ * details.
+ */
+
+// The C++ version of the Creator class in nc/nc.py, which the operations can give their moves to, to post without python.
+// The methods have the same names and arguments as the python ones, so they can be compared.
+// Like nc.Creator, it does nothing; see CIsoCreator for one which writes NC code.
+
+#pragma once
+
+#include <string>
+#include <math.h>
+
+// a number, or None
+class CNCValue
+{
+public:
+	bool m_set;
+	double m_value;
+
+	CNCValue(void): m_set(false), m_value(0.0) {}
+	CNCValue(double value): m_set(true), m_value(value) {}
+};
+
+// like depth_params.py
+class CNCDepthParams
+{
+public:
+	double clearance_height;
+	double rapid_safety_space;
+	double start_depth;
+	double step_down;
+	double z_finish_depth;
+	double z_thru_depth;
+	double final_depth;
+
+	CNCDepthParams(double clearance_height_, double rapid_safety_space_, double start_depth_, double step_down_, double z_finish_depth_, double z_thru_depth_, double final_depth_)
+		: clearance_height(clearance_height_), rapid_safety_space(fabs(rapid_safety_space_)), start_depth(start_depth_), step_down(fabs(step_down_)),
+		z_finish_depth(fabs(z_finish_depth_)), z_thru_depth(fabs(z_thru_depth_)), final_depth(final_depth_) {}
+};
+
+// the parameters given to tool_defn, which nc/iso.py uses
+class CNCToolParams
+{
+public:
+	CNCValue diameter;
+	CNCValue cutting_edge_height;
+	std::string name;
+};
+
+class CNCCreator
+{
+public:
+	virtual ~CNCCreator(void) {}
+
+	// returns false if the file couldn't be opened
+	virtual bool file_open(const char* name) { return true; }
+
+	// programs
+	virtual void program_begin(int id, const std::string &name) {}
+	virtual void program_end(void) {}
+	virtual void flush_nc(void) {}
+
+	// settings
+	virtual void imperial(void) {}
+	virtual void metric(void) {}
+	virtual void absolute(void) {}
+	virtual void incremental(void) {}
+	virtual void set_plane(int plane) {}
+
+	// tools
+	virtual void tool_defn(int id, const std::string &name, const CNCToolParams &params) {}
+	virtual void tool_change(int id) {}
+
+	// datums
+	virtual void workplane(int id) {}
+
+	// rates and modes
+	virtual void feedrate(double f) {}
+	virtual void feedrate_slot(double fslot) {}
+	virtual void feedrate_hv(double fh, double fv) {}
+	virtual void spindle(double s, bool clockwise = true) {}
+	virtual void coolant(int mode = 0) {}
+	virtual void set_path_control_mode(int mode, double motion_blending_tolerance, double naive_cam_tolerance) {}
+
+	// moves
+	virtual void rapid(CNCValue x = CNCValue(), CNCValue y = CNCValue(), CNCValue z = CNCValue()) {}
+	virtual void feed(double slot_ratio = 0.0, CNCValue x = CNCValue(), CNCValue y = CNCValue(), CNCValue z = CNCValue()) {}
+	virtual void arc_cw(double slot_ratio = 0.0, CNCValue x = CNCValue(), CNCValue y = CNCValue(), CNCValue z = CNCValue(), CNCValue i = CNCValue(), CNCValue j = CNCValue(), CNCValue k = CNCValue(), CNCValue r = CNCValue()) {}
+	virtual void arc_ccw(double slot_ratio = 0.0, CNCValue x = CNCValue(), CNCValue y = CNCValue(), CNCValue z = CNCValue(), CNCValue i = CNCValue(), CNCValue j = CNCValue(), CNCValue k = CNCValue(), CNCValue r = CNCValue()) {}
+	virtual void dwell(double t) {}
+
+	// cycles
+	virtual void drill(CNCValue x, CNCValue y, double dwell, const CNCDepthParams &depthparams, int retract_mode, int spindle_mode, bool internal_coolant_on, bool rapid_to_clearance) {}
+	virtual void end_canned_cycle(void) {}
+
+	// misc
+	virtual void comment(const std::string &text) {}
+};
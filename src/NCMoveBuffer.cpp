@@ -0,0 +1,233 @@
+// NCMoveBuffer.cpp
+/*
+ * Copyright (c) 2009, Dan Heeks
+ * This program is released under the BSD license. See the file COPYING for
+ * details.
+ */
+
+#include "stdafx.h"
+#include "NCMoveBuffer.h"
+
+#include <math.h>
+
+static const double origin[3] = {0.0, 0.0, 0.0};
+
+void CNCMoveBuffer::Clear()
+{
+	// swap with empties, so the memory really is given back
+	std::vector<double>().swap(m_x);
+	std::vector<int>().swap(m_arc);
+	std::vector<int>().swap(m_tool_number);
+	std::vector<unsigned char>().swap(m_color);
+	std::vector<int>().swap(m_block);
+	std::vector<double>().swap(m_arc_c);
+	std::vector<signed char>().swap(m_arc_dir);
+}
+
+void CNCMoveBuffer::Reserve(size_t number_of_moves, size_t number_of_arcs)
+{
+	m_x.reserve(number_of_moves * 3);
+	m_arc.reserve(number_of_moves);
+	m_tool_number.reserve(number_of_moves);
+	m_color.reserve(number_of_moves);
+	m_block.reserve(number_of_moves);
+	m_arc_c.reserve(number_of_arcs * 3);
+	m_arc_dir.reserve(number_of_arcs);
+}
+
+size_t CNCMoveBuffer::AddLine(const double* x, int tool_number, int color, int block)
+{
+	m_x.insert(m_x.end(), x, x + 3);
+	m_arc.push_back(-1);
+	m_tool_number.push_back(tool_number);
+	m_color.push_back((unsigned char)color);
+	m_block.push_back(block);
+	return size() - 1;
+}
+
+size_t CNCMoveBuffer::AddArc(const double* x, const double* c, int dir, int tool_number, int color, int block)
+{
+	m_arc.push_back((int)m_arc_dir.size());
+	m_arc_c.insert(m_arc_c.end(), c, c + 3);
+	m_arc_dir.push_back((dir < 0) ? -1 : 1);
+
+	m_x.insert(m_x.end(), x, x + 3);
+	m_tool_number.push_back(tool_number);
+	m_color.push_back((unsigned char)color);
+	m_block.push_back(block);
+	return size() - 1;
+}
+
+/**
+	Adds an arc given in the RS274 "R" form. A positive radius means the arc is less than
+	half a circle, a negative radius means it is more than half a circle.
+	If the radius is too small to span the two points, a straight line is added instead.
+ */
+size_t CNCMoveBuffer::AddArcFromRadius(const double* x, double radius, int dir, int tool_number, int color, int block)
+{
+	const double* s = empty() ? origin : EndPoint(size() - 1);
+	double dx = x[0] - s[0];
+	double dy = x[1] - s[1];
+	double d = sqrt(dx * dx + dy * dy);
+	double r = fabs(radius);
+	if(d < 0.000000001 || d > 2 * r)return AddLine(x, tool_number, color, block);
+
+	double h = sqrt(r * r - d * d / 4);
+
+	// the centre is to the left of the chord for a short anti-clockwise arc or a long clockwise arc
+	bool left = ((dir < 0) == (radius < 0));
+	double side = left ? h / d : -h / d;
+	double c[3] = {dx / 2 - dy * side, dy / 2 + dx * side, 0.0};
+
+	return AddArc(x, c, dir, tool_number, color, block);
+}
+
+void CNCMoveBuffer::Append(const CNCMoveBuffer& rhs, int block_offset)
+{
+	int arc_offset = (int)m_arc_dir.size();
+
+	m_x.insert(m_x.end(), rhs.m_x.begin(), rhs.m_x.end());
+	m_tool_number.insert(m_tool_number.end(), rhs.m_tool_number.begin(), rhs.m_tool_number.end());
+	m_color.insert(m_color.end(), rhs.m_color.begin(), rhs.m_color.end());
+	m_arc_c.insert(m_arc_c.end(), rhs.m_arc_c.begin(), rhs.m_arc_c.end());
+	m_arc_dir.insert(m_arc_dir.end(), rhs.m_arc_dir.begin(), rhs.m_arc_dir.end());
+
+	m_arc.reserve(m_arc.size() + rhs.m_arc.size());
+	for(std::vector<int>::const_iterator It = rhs.m_arc.begin(); It != rhs.m_arc.end(); It++)
+	{
+		m_arc.push_back((*It < 0) ? -1 : (*It + arc_offset));
+	}
+
+	m_block.reserve(m_block.size() + rhs.m_block.size());
+	for(std::vector<int>::const_iterator It = rhs.m_block.begin(); It != rhs.m_block.end(); It++)
+	{
+		m_block.push_back(*It + block_offset);
+	}
+}
+
+void CNCMoveBuffer::ArcPoints(size_t i, unsigned int number_of_points, std::vector<double> &points)const
+{
+	if(number_of_points == 0)return;
+
+	const double* s = (i == 0) ? origin : StartPoint(i);
+	const double* e = EndPoint(i);
+	const double* c = ArcCentre(i);
+	int dir = ArcDir(i);
+
+	double sx = -c[0];
+	double sy = -c[1];
+	// e = cs + se = -c + e - s
+	double ex = -c[0] + e[0] - s[0];
+	double ey = -c[1] + e[1] - s[1];
+	double rs = sqrt(sx * sx + sy * sy);
+	double re = sqrt(ex * ex + ey * ey);
+
+	double start_angle = atan2(sy, sx);
+	double end_angle = atan2(ey, ex);
+
+	if(dir == 1){
+		if(end_angle < start_angle)end_angle += 6.283185307179;
+	}
+	else{
+		if(start_angle < end_angle)start_angle += 6.283185307179;
+	}
+
+	double angle_step = 0;
+
+	if (start_angle == end_angle)
+	{
+		// It's a full circle.
+		angle_step = 6.283185307179 / number_of_points;
+		if (dir == -1)
+		{
+			angle_step = -angle_step; // fix preview of full cw arcs
+		}
+	} // End if - then
+	else
+	{
+		// It's an arc.
+		angle_step = (end_angle - start_angle) / number_of_points;
+	} // End if - else
+
+	points.reserve(points.size() + number_of_points * 3);
+	for(unsigned int j = 0; j < number_of_points; j++)
+	{
+		double angle = start_angle + angle_step * (j + 1);
+		double r = rs + ((re - rs) * (j + 1)) / number_of_points;
+		points.push_back(s[0] + c[0] + r * cos(angle));
+		points.push_back(s[1] + c[1] + r * sin(angle));
+		points.push_back(s[2] + ((e[2] - s[2]) * (j + 1)) / number_of_points);
+	}
+}
+
+static void InsertPoint(double* extents, double x, double y, double z)
+{
+	if(x < extents[0])extents[0] = x;
+	if(y < extents[1])extents[1] = y;
+	if(z < extents[2])extents[2] = z;
+	if(x > extents[3])extents[3] = x;
+	if(y > extents[4])extents[4] = y;
+	if(z > extents[5])extents[5] = z;
+}
+
+static bool AngleIsIncluded(double the_angle, double start_angle, double end_angle)
+{
+	double the_angle2 = the_angle + 6.283185307179;
+	return (the_angle >= start_angle && the_angle <= end_angle) || (the_angle2 >= start_angle && the_angle2 <= end_angle);
+}
+
+void CNCMoveBuffer::InsertInExtents(size_t i, double* extents)const
+{
+	const double* e = EndPoint(i);
+	InsertPoint(extents, e[0], e[1], e[2]);
+
+	if(m_arc[i] < 0)return;
+
+	// add the extreme points of the circle that the arc passes through
+	const double* s = (i == 0) ? origin : StartPoint(i);
+	const double* c = ArcCentre(i);
+	double sx = -c[0];
+	double sy = -c[1];
+	double ex = -c[0] + e[0] - s[0];
+	double ey = -c[1] + e[1] - s[1];
+	double radius = sqrt(sx * sx + sy * sy);
+
+	double start_angle = atan2(sy, sx);
+	double end_angle = atan2(ey, ex);
+
+	if(ArcDir(i) == 1){
+		if(end_angle < start_angle)end_angle += 6.283185307179;
+	}
+	else{
+		if(start_angle < end_angle)start_angle += 6.283185307179;
+		// sweep the same range, but anti-clockwise
+		double temp = start_angle;
+		start_angle = end_angle;
+		end_angle = temp;
+	}
+
+	bool full_circle = (start_angle == end_angle);
+	double cx = s[0] + c[0];
+	double cy = s[1] + c[1];
+
+	if(full_circle || AngleIsIncluded(1.5707963267949, start_angle, end_angle))InsertPoint(extents, cx, cy + radius, e[2]);
+	if(full_circle || AngleIsIncluded(-1.5707963267949, start_angle, end_angle))InsertPoint(extents, cx, cy - radius, e[2]);
+	if(full_circle || AngleIsIncluded(0.0, start_angle, end_angle))InsertPoint(extents, cx + radius, cy, e[2]);
+	if(full_circle || AngleIsIncluded(3.14159265358979, start_angle, end_angle))InsertPoint(extents, cx - radius, cy, e[2]);
+}
+
+bool CNCMoveBuffer::GetExtents(size_t first, size_t count, double* extents)const
+{
+	if(count == 0)return false;
+
+	extents[0] = extents[1] = extents[2] = 1.0e100;
+	extents[3] = extents[4] = extents[5] = -1.0e100;
+
+	size_t end = first + count;
+	for(size_t i = first; i < end; i++)
+	{
+		InsertInExtents(i, extents);
+	}
+
+	return true;
+}
@@ -0,0 +1,63 @@
+// NCMoveBuffer.h
+/*
+ * Copyright (c) 2009, Dan Heeks
+ * This program is released under the BSD license. See the file COPYING for
+ * details.
+ */
+
+// The backplot moves of a CNCCode object, stored as a structure of arrays.
+// Every move is a line or an arc from the end of the previous move to its own end point.
+// The CNCCodeBlock objects refer to contiguous ranges of moves in here, so loading,
+// bounding box and rendering are all linear scans over a handful of vectors, instead of
+// walking millions of little heap allocated objects.
+
+#pragma once
+
+#include <vector>
+#include <cstddef>
+
+class CNCMoveBuffer
+{
+public:
+	typedef enum {
+		eLine = 0,
+		eArc
+	} eType_t;
+
+	// one entry per move
+	std::vector<double> m_x;			// end point, three doubles per move
+	std::vector<int> m_arc;				// index into the arc arrays, -1 for a line
+	std::vector<int> m_tool_number;
+	std::vector<unsigned char> m_color;	// ColorEnum
+	std::vector<int> m_block;			// index of the CNCCodeBlock that the move came from
+
+	// one entry per arc
+	std::vector<double> m_arc_c;		// centre, relative to the arc's start point, three doubles per arc
+	std::vector<signed char> m_arc_dir;	// 1 - anti-clockwise, -1 - clockwise
+
+	void Clear();
+	void Reserve(size_t number_of_moves, size_t number_of_arcs = 0);
+	size_t size()const{return m_tool_number.size();}
+	bool empty()const{return m_tool_number.empty();}
+
+	size_t AddLine(const double* x, int tool_number, int color, int block);
+	size_t AddArc(const double* x, const double* c, int dir, int tool_number, int color, int block);
+	size_t AddArcFromRadius(const double* x, double radius, int dir, int tool_number, int color, int block);
+	void Append(const CNCMoveBuffer& rhs, int block_offset);
+
+	eType_t Type(size_t i)const{return (m_arc[i] < 0) ? eLine : eArc;}
+	const double* EndPoint(size_t i)const{return &m_x[i * 3];}
+	// The very first move has no start point
+	const double* StartPoint(size_t i)const{return (i == 0) ? NULL : &m_x[(i - 1) * 3];}
+	const double* ArcCentre(size_t i)const{return &m_arc_c[m_arc[i] * 3];}
+	int ArcDir(size_t i)const{return m_arc_dir[m_arc[i]];}
+
+	// Appends x, y, z triplets for the points along arc i, not including its start point
+	void ArcPoints(size_t i, unsigned int number_of_points, std::vector<double> &points)const;
+
+	// extents are minx, miny, minz, maxx, maxy, maxz; returns false if there was nothing to add
+	bool GetExtents(size_t first, size_t count, double* extents)const;
+
+private:
+	void InsertInExtents(size_t i, double* extents)const;
+};
@@ -15,6 +15,7 @@
 #include "PythonStuff.h"
 #include "CNCConfig.h"
 #include "Program.h"
+#include "NCCreator.h"
 
 #define FIND_FIRST_TOOL CTool::FindFirstByType
 #define FIND_ALL_TOOLS CTool::FindAllTools
@@ -31,7 +32,7 @@ const wxBitmap& COp::GetInactiveIcon()
 
 COp::COp(int obj_type, const int tool_number, const int operation_type)
  : IdNamedObjList(obj_type), m_active(true), m_tool_number(tool_number),
-   m_operation_type(operation_type), m_pattern(1), m_surface(0)
+   m_operation_type(operation_type), m_pattern(1), m_surface(0), m_after(0)
 {
     InitializeProperties();
     ReadDefaultValues();
@@ -56,6 +57,7 @@ COp & COp::operator= ( const COp & rhs )
             m_operation_type = rhs.m_operation_type;
             m_pattern = rhs.m_pattern;
             m_surface = rhs.m_surface;
+            m_after = rhs.m_after;
     }
 
     return(*this);
@@ -68,6 +70,7 @@ void COp::InitializeProperties()
     m_tool_number_choice.Initialize(_("tool"), this);
     m_pattern.Initialize(_("pattern"), this);
     m_surface.Initialize(_("surface"), this);
+    m_after.Initialize(_("do after operation"), this);
 }
 
 void COp::OnPropertySet(Property& prop)
@@ -201,6 +204,26 @@ Python COp::AppendTextToProgram()
     return(python);
 }
 
+void COp::WriteNC(CNCCreator& creator)
+{
+    wxString comment = m_comment;
+
+    if(comment.Len() > 0)
+    {
+            creator.comment((const char*)comment.mb_str(wxConvUTF8));
+    }
+
+    if(UsesTool())
+    {
+        // like CHeeksCNCApp::SetTool
+        if(CTool::Find(m_tool_number) != NULL && theApp.m_tool_number != m_tool_number)
+        {
+            creator.tool_change(m_tool_number);
+        }
+        theApp.m_tool_number = m_tool_number;
+    }
+}
+
 void COp::GetTools(std::list<Tool*>* t_list, const wxPoint* p)
 {
     IdNamedObjList::GetTools( t_list, p );
@@ -14,6 +14,7 @@
 
 class CFixture;	// Forward declaration.
 class CMachineState;
+class CNCCreator;
 
 class COp : public IdNamedObjList
 {
@@ -25,6 +26,7 @@ public:
 	int m_operation_type;                 // Type of operation (because GetType() overloading does not allow this class to call the parent's method)
     PropertyInt m_pattern;
     PropertyInt m_surface;                // use OpenCamLib to drop the cutter on to this surface
+    PropertyInt m_after;                  // the ID of an operation which must be done before this one, when the operations are scheduled
 
 	COp ( int obj_type, const int tool_number = 0, const int operation_type = UnknownType );
     COp ( const COp & rhs );
@@ -46,8 +48,25 @@ public:
 
 	virtual Python AppendTextToProgram();
 
+	// Operations which can give their moves straight to a CNCCreator, instead of writing python, return true.
+	// WriteNC must do the same as the python from AppendTextToProgram would; test/iso_backends.py checks the NC code is the same.
+	// So far only CDrilling does, so the C++ backend is only used for programs which are all drilling.
+	virtual bool CanWriteNC(){return false;}
+	virtual void WriteNC(CNCCreator& creator);
+
 	virtual bool UsesTool(){return true;} // some operations don't use the tool number
 
+	// Operations which set theApp.m_location to where they finish return true. For the others, where they finish
+	// isn't known until python has made the toolpath, so the next drilling doesn't start sorting from there.
+	virtual bool SetsLocation(){return false;}
+
+	// Operations which make the copies of their pattern themselves return true; the others are copied by transform.py, in the python.
+	virtual bool ExpandsPattern(){return false;}
+
+	// The objects this operation machines, like its sketch or its points.  When the operations are scheduled,
+	// operations which machine the same object are kept in the order they are in.
+	virtual void GetMachinedObjects(std::list<HeeksObj*> &objects){}
+
 	void ReloadPointers() { ObjList::ReloadPointers(); }
 
 	// The DesignRulesAdjustment() method is the opportunity for all Operations objects to
@@ -0,0 +1,213 @@
+// OpScheduler.cpp
+/*
+ * Copyright (c) 2009, Dan Heeks
+ * This program is released under the BSD license. See the file COPYING for
+ * details.
+ */
+
+#include "stdafx.h"
+#include "OpScheduler.h"
+
+#include <math.h>
+#include <map>
+#include <set>
+
+// the operations which each operation must follow, as described in OpScheduler.h
+static void GetPredecessors(const std::vector<COpScheduler::Op> &ops, std::vector< std::set<int> > &predecessors)
+{
+	int n = (int)ops.size();
+	predecessors.clear();
+	predecessors.resize(n);
+
+	std::map< std::pair<int, int>, int > last_to_machine;
+	int last_barrier = -1;
+
+	for(int i = 0; i < n; i++)
+	{
+		const COpScheduler::Op &op = ops[i];
+
+		for(std::vector<int>::const_iterator It = op.after.begin(); It != op.after.end(); It++)
+		{
+			if(*It >= 0 && *It < n && *It != i)predecessors[i].insert(*It);
+		}
+
+		for(std::vector< std::pair<int, int> >::const_iterator It = op.objects.begin(); It != op.objects.end(); It++)
+		{
+			std::map< std::pair<int, int>, int >::iterator FindIt = last_to_machine.find(*It);
+			if(FindIt != last_to_machine.end())predecessors[i].insert(FindIt->second);
+			last_to_machine[*It] = i;
+		}
+
+		if(op.barrier)
+		{
+			// from the last barrier itself, for when there's nothing between them
+			for(int j = (last_barrier < 0) ? 0 : last_barrier; j < i; j++)predecessors[i].insert(j);
+			last_barrier = i;
+		}
+		else if(last_barrier >= 0)
+		{
+			predecessors[i].insert(last_barrier);
+		}
+	}
+}
+
+static double Distance(const COpScheduler::Op &op, bool has_position, double x, double y)
+{
+	if(!op.has_location || !has_position)return 0.0;
+	double dx = op.x - x;
+	double dy = op.y - y;
+	return sqrt(dx * dx + dy * dy);
+}
+
+class COpSchedule
+{
+	const std::vector<COpScheduler::Op> &m_ops;
+	std::vector< std::vector<int> > m_successors;
+	std::vector<int> m_waiting_for; // how many predecessors aren't done yet
+	std::vector<bool> m_done;
+
+public:
+	int m_tool;
+	bool m_has_position;
+	double m_x, m_y;
+
+	COpSchedule(const std::vector<COpScheduler::Op> &ops, const std::vector< std::set<int> > &predecessors):m_ops(ops), m_tool(0), m_has_position(false), m_x(0.0), m_y(0.0)
+	{
+		int n = (int)ops.size();
+		m_successors.resize(n);
+		m_waiting_for.resize(n, 0);
+		m_done.resize(n, false);
+		for(int i = 0; i < n; i++)
+		{
+			for(std::set<int>::const_iterator It = predecessors[i].begin(); It != predecessors[i].end(); It++)
+			{
+				m_successors[*It].push_back(i);
+				m_waiting_for[i]++;
+			}
+		}
+	}
+
+	bool Ready(int i)const{return !m_done[i] && m_waiting_for[i] == 0;}
+
+	void Do(int i)
+	{
+		m_done[i] = true;
+		for(std::vector<int>::const_iterator It = m_successors[i].begin(); It != m_successors[i].end(); It++)m_waiting_for[*It]--;
+		m_tool = m_ops[i].tool;
+		if(m_ops[i].has_location)
+		{
+			m_x = m_ops[i].x;
+			m_y = m_ops[i].y;
+			m_has_position = true;
+		}
+	}
+
+	// the nearest ready operation which uses tool, or -1
+	int Nearest(int tool)const
+	{
+		int best = -1;
+		double best_distance = 0.0;
+		for(int i = 0; i < (int)m_ops.size(); i++)
+		{
+			if(!Ready(i) || m_ops[i].tool != tool)continue;
+			double d = Distance(m_ops[i], m_has_position, m_x, m_y);
+			if(best == -1 || d < best_distance)
+			{
+				best = i;
+				best_distance = d;
+			}
+		}
+		return best;
+	}
+
+	// the first operation not done, whether it's ready or not; only needed if the dependencies go round in a circle
+	int FirstNotDone()const
+	{
+		for(int i = 0; i < (int)m_ops.size(); i++)
+		{
+			if(!m_done[i])return i;
+		}
+		return -1;
+	}
+};
+
+// how many operations could be done, one after another, with tool, from this schedule
+static int RunLength(COpSchedule schedule, int tool)
+{
+	int count = 0;
+	for(int i = schedule.Nearest(tool); i != -1; i = schedule.Nearest(tool))
+	{
+		schedule.Do(i);
+		count++;
+	}
+	return count;
+}
+
+void COpScheduler::Schedule(const std::vector<Op> &ops, std::vector<int> &order)
+{
+	order.clear();
+
+	std::vector< std::set<int> > predecessors;
+	GetPredecessors(ops, predecessors);
+	COpSchedule schedule(ops, predecessors);
+
+	while(order.size() < ops.size())
+	{
+		// carry on with the same tool, if it can
+		int next = schedule.Nearest(schedule.m_tool);
+
+		if(next == -1)
+		{
+			// change to the tool which can do the most operations before the next change
+			int best_run = 0;
+			std::set<int> tools_tried;
+			for(int i = 0; i < (int)ops.size(); i++)
+			{
+				if(!schedule.Ready(i))continue;
+				if(!tools_tried.insert(ops[i].tool).second)continue;
+				int run = RunLength(schedule, ops[i].tool);
+				if(run > best_run)
+				{
+					best_run = run;
+					next = schedule.Nearest(ops[i].tool);
+				}
+			}
+		}
+
+		if(next == -1)next = schedule.FirstNotDone();
+
+		schedule.Do(next);
+		order.push_back(next);
+	}
+}
+
+int COpScheduler::ToolChanges(const std::vector<Op> &ops, const std::vector<int> &order)
+{
+	int changes = 0;
+	int tool = 0;
+	for(std::vector<int>::const_iterator It = order.begin(); It != order.end(); It++)
+	{
+		if(ops[*It].tool != tool)changes++;
+		tool = ops[*It].tool;
+	}
+	return changes;
+}
+
+double COpScheduler::Travel(const std::vector<Op> &ops, const std::vector<int> &order)
+{
+	double travel = 0.0;
+	bool has_position = false;
+	double x = 0.0, y = 0.0;
+	for(std::vector<int>::const_iterator It = order.begin(); It != order.end(); It++)
+	{
+		const Op &op = ops[*It];
+		travel += Distance(op, has_position, x, y);
+		if(op.has_location)
+		{
+			x = op.x;
+			y = op.y;
+			has_position = true;
+		}
+	}
+	return travel;
+}
@@ -0,0 +1,42 @@
+// OpScheduler.h
+/*
+ * Copyright (c) 2009, Dan Heeks
+ * This program is released under the BSD license. See the file COPYING for
+ * details.
+ */
+
+// Finds an order to do the operations in which needs fewer tool changes and less rapid travel between them.
+// An operation is never moved in front of one it depends on; those are
+//   the ones it has been told to follow, which, for a rest machining pocket, are the earlier ones whose cuts it leaves out,
+//   the earlier ones which machine any of the same objects, like roughing before finishing the same sketch, or drilling before tapping the same points,
+//   and every earlier one, for an operation which can do anything, like a script operation, which also stays in front of all the later ones.
+// It has no wx or OpenCascade in it.
+
+#pragma once
+
+#include <vector>
+#include <utility>
+
+class COpScheduler
+{
+public:
+	class Op
+	{
+	public:
+		int tool;
+		bool barrier; // nothing moves past it either way
+		bool has_location;
+		double x, y; // roughly where it machines, for the rapid move to it
+		std::vector< std::pair<int, int> > objects; // the type and ID of each object it machines
+		std::vector<int> after; // the indices of the operations which must be done before it
+
+		Op(): tool(0), barrier(false), has_location(false), x(0.0), y(0.0) {}
+	};
+
+	// sets order to the indices of ops, in the order to do them
+	static void Schedule(const std::vector<Op> &ops, std::vector<int> &order);
+
+	// for comparing orders; the number of tool changes, counting the first tool, and the rapid travel from one operation to the next
+	static int ToolChanges(const std::vector<Op> &ops, const std::vector<int> &order);
+	static double Travel(const std::vector<Op> &ops, const std::vector<int> &order);
+};
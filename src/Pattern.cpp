@@ -21,6 +21,7 @@ CPattern::CPattern()
 	m_copies2 = 1;
 	m_x_shift2 = 0;
 	m_y_shift2 = 50;
+	m_use_subroutine = false;
 }
 
 CPattern::CPattern(int copies1, double x_shift1, double y_shift1, int copies2, double x_shift2, double y_shift2)
@@ -29,6 +30,7 @@ CPattern::CPattern(int copies1, double x_shift1, double y_shift1, int copies2, d
    m_copies2(copies2), m_x_shift2(x_shift2), m_y_shift2(y_shift2)
 {
     InitializeProperties();
+	m_use_subroutine = false;
 }
 
 HeeksObj *CPattern::MakeACopy(void) const
@@ -52,6 +54,7 @@ void CPattern::InitializeProperties()
     m_copies2.Initialize(_("number of copies 2"), this);
     m_x_shift2.Initialize(_("x shift 2"), this);
     m_y_shift2.Initialize(_("y shift 2"), this);
+    m_use_subroutine.Initialize(_("call a subroutine for each copy"), this);
 }
 
 void CPattern::CopyFrom(const HeeksObj* object)
@@ -23,6 +23,7 @@ public:
 	PropertyInt m_copies2;
 	PropertyDouble m_x_shift2;
 	PropertyDouble m_y_shift2;
+	PropertyCheck m_use_subroutine; // the python makes a subroutine of the first copy and calls it for the others, instead of writing them all out
 
 	//	Constructors.
 	CPattern();
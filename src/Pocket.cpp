@@ -16,6 +16,10 @@
 #include "CNCPoint.h"
 #include "Reselect.h"
 #include "PocketDlg.h"
+#include "Pattern.h"
+#include "Profile.h"
+#include "Drilling.h"
+#include "PythonInterpreter.h"
 
 #include <sstream>
 
@@ -31,6 +35,7 @@ CPocketParams::CPocketParams(CPocket* parent)
 	m_post_processor.SetValue ( CPocketParams::eTrochoidal );
 	m_zig_angle = 0.0;
 	m_entry_move = ePlunge;
+	m_rest_machining = false;
 }
 
 void CPocketParams::set_initial_values(const CTool::ToolNumber_t tool_number)
@@ -64,13 +69,26 @@ void CPocketParams::InitializeProperties()
 	m_post_processor.m_choices.push_back(_("ZigZag Unidirectional"));
 	m_post_processor.m_choices.push_back(_("Offsets"));
 	m_post_processor.m_choices.push_back(_("Trochodial"));
+	m_post_processor.m_choices.push_back(_("Adaptive"));
 
 	m_zig_angle.Initialize(_("zig angle"), parent);
+
+	m_rest_machining.Initialize(_("rest machining"), parent);
 }
 
 void CPocketParams::GetProperties(std::list<Property *> *list)
 {
     m_zig_angle.SetVisible(IsZigZag());
+
+    // adaptive is only offered where it can be done, but a pocket which is already adaptive keeps it
+    if(m_post_processor.m_choices.size() > eAdaptive)m_post_processor.m_choices.pop_back();
+    if(AdaptiveAvailable() || m_post_processor == eAdaptive)m_post_processor.m_choices.push_back(_("Adaptive"));
+}
+
+// adaptive's paths are made by the C++ in HeeksCNC's own python; postprocessor/adaptive.py raises an error without it
+bool CPocketParams::AdaptiveAvailable()
+{
+    return CPythonInterpreter::BuiltIn() && theApp.m_use_embedded_python;
 }
 
 static wxString WriteSketchDefn(HeeksObj* sketch)
@@ -233,35 +251,44 @@ void CPocket::WritePocketPython(Python &python)
     python << _T(", ");
     python << (m_pocket_params.m_post_processor == CPocketParams::eZigZag ? _T("'zigzag'") :
                m_pocket_params.m_post_processor == CPocketParams::eZigZagUnidirectional ? _T("'zigzag-unidirectional'") :
-               m_pocket_params.m_post_processor == CPocketParams::eOffsets ? _T("'offsets'") : _T("'trochoidal'"));
+               m_pocket_params.m_post_processor == CPocketParams::eOffsets ? _T("'offsets'") :
+               m_pocket_params.m_post_processor == CPocketParams::eAdaptive ? _T("'adaptive'") : _T("'trochoidal'"));
     python << _T(", ") << m_pocket_params.m_zig_angle;
     python << _T(", None, "); // start point
     python << ((m_pocket_params.m_cut_mode == CPocketParams::eClimb) ? _T("'climb'") : _T("'conventional'"));
+    if(m_pocket_params.m_rest_machining)python << _T(", rest_areas");
+
+    // the pattern's copies, which are only moved, so the curves are made once, rather than once for each copy by transform.py
+    CPattern* pattern = (m_pattern == 0) ? NULL : (CPattern*)heeksCAD->GetIDObject(PatternType, m_pattern);
+    if(pattern)
+    {
+        std::list<gp_Trsf> matrices;
+        pattern->GetMatrices(matrices);
+        python << _T(", shifts = [");
+        for(std::list<gp_Trsf>::iterator It = matrices.begin(); It != matrices.end(); It++)
+        {
+            gp_XYZ shift = It->TranslationPart();
+            if(It != matrices.begin())python << _T(", ");
+            python << _T("(") << shift.X() / scale << _T(", ") << shift.Y() / scale << _T(")");
+        }
+        python << _T("]");
+    }
+    if(m_pocket_params.m_post_processor == CPocketParams::eAdaptive)python << _T(", name = ") << PythonString(GetTitle());
     python << _T(")\n");
 
     // rapid back up to clearance plane
     python << _T("rapid(z = depthparams.clearance_height)\n");
 }
 
-Python CPocket::AppendTextToProgram()
+// writes the python which makes "a", the area to pocket, from the sketch
+// Returns false if it can't; with show_errors, after saying why.
+bool CPocket::WriteAreaPython(Python &python, bool show_errors)
 {
-	Python python;
-
-	CTool *pTool = CTool::Find( m_tool_number );
-	if (pTool == NULL)
-	{
-		wxMessageBox(_T("Cannot generate GCode for pocket without a tool assigned"));
-		return(python);
-	} // End if - then
-
-
-	python << CSketchOp::AppendTextToProgram();
-
     HeeksObj* object = heeksCAD->GetIDObject(SketchType, m_sketch);
 
     if(object == NULL) {
-        wxMessageBox(wxString::Format(_("Pocket operation - Sketch doesn't exist")));
-        return python;
+        if(show_errors)wxMessageBox(wxString::Format(_("Pocket operation - Sketch doesn't exist")));
+        return false;
     }
 
     int type = object->GetType();
@@ -274,7 +301,7 @@ Python CPocket::AppendTextToProgram()
         case AreaType:
             {
                 heeksCAD->ObjectAreaString(object, python);
-                WritePocketPython(python);
+                return true;
             }
             break;
         }
@@ -286,8 +313,8 @@ Python CPocket::AppendTextToProgram()
         python << _T("entry_moves = []\n");
 
         if (object->GetNumChildren() == 0){
-            wxMessageBox(wxString::Format(_("Pocket operation - Sketch %d has no children"), object->GetID()));
-            return python;
+            if(show_errors)wxMessageBox(wxString::Format(_("Pocket operation - Sketch %d has no children"), object->GetID()));
+            return false;
         }
 
         HeeksObj* re_ordered_sketch = NULL;
@@ -310,17 +337,17 @@ Python CPocket::AppendTextToProgram()
                 {
                 case SketchOrderTypeOpen:
                     {
-                        wxMessageBox(wxString::Format(_("Pocket operation - Sketch must be a closed shape - sketch %d"), object->GetID()));
+                        if(show_errors)wxMessageBox(wxString::Format(_("Pocket operation - Sketch must be a closed shape - sketch %d"), object->GetID()));
                         delete re_ordered_sketch;
-                        return python;
+                        return false;
                     }
                     break;
 
                 default:
                     {
-                        wxMessageBox(wxString::Format(_("Pocket operation - Badly ordered sketch - sketch %d"), object->GetID()));
+                        if(show_errors)wxMessageBox(wxString::Format(_("Pocket operation - Badly ordered sketch - sketch %d"), object->GetID()));
                         delete re_ordered_sketch;
-                        return python;
+                        return false;
                     }
                     break;
                 }
@@ -339,6 +366,169 @@ Python CPocket::AppendTextToProgram()
 
     } // End for
 
+    return(type == SketchType);
+}
+
+// true for the operations whose cuts a rest machining pocket after them leaves out; pockets, profiles and drilling.
+// Ones copied by a pattern, except drilling, which moves its holes, or on a surface, are left out, because what they cut isn't where their sketch is.
+// Profiles with tags, or with a start or end given, are left out too, as they don't cut all the way round at every depth.
+bool CPocket::CountsForRestMachining(COp* op)
+{
+    if(op->m_surface != 0 || CTool::Find(op->m_tool_number) == NULL)return false;
+
+    switch(op->GetType())
+    {
+    case PocketType:
+        return op->m_pattern == 0;
+
+    case ProfileType:
+        {
+            CProfile* profile = (CProfile*)op;
+            return op->m_pattern == 0 && CTool::IsMillingToolType(CTool::FindToolType(op->m_tool_number)) && profile->Tags()->GetFirstChild() == NULL
+                && !profile->m_profile_params.m_start_given && !profile->m_profile_params.m_end_given;
+        }
+
+    case DrillingType:
+        return true;
+    }
+
+    return false;
+}
+
+// writes the python which makes "a" with the curves of a profile's sketch, open or closed, each going the way it goes in the sketch
+static bool WriteProfileCurvesPython(CProfile* profile, Python &python)
+{
+    HeeksObj* object = heeksCAD->GetIDObject(SketchType, profile->m_sketch);
+    if(object == NULL)return false;
+
+    switch(object->GetType())
+    {
+    case CircleType:
+    case AreaType:
+        heeksCAD->ObjectAreaString(object, python);
+        return true;
+
+    case SketchType:
+        break;
+
+    default:
+        return false;
+    }
+
+    HeeksObj* re_ordered_sketch = NULL;
+    SketchOrderType order = heeksCAD->GetSketchOrder(object);
+    if(     (order != SketchOrderTypeOpen) &&
+        (order != SketchOrderTypeCloseCW) &&
+        (order != SketchOrderTypeCloseCCW) &&
+        (order != SketchOrderTypeMultipleCurves) &&
+        (order != SketchOrderHasCircles))
+    {
+        re_ordered_sketch = object->MakeACopy();
+        heeksCAD->ReOrderSketch(re_ordered_sketch, SketchOrderTypeReOrder);
+        object = re_ordered_sketch;
+        order = heeksCAD->GetSketchOrder(object);
+    }
+
+    bool written = ((order == SketchOrderTypeOpen) ||
+        (order == SketchOrderTypeCloseCW) ||
+        (order == SketchOrderTypeCloseCCW) ||
+        (order == SketchOrderTypeMultipleCurves) ||
+        (order == SketchOrderHasCircles));
+    if(written)
+    {
+        python << _T("a = area.Area()\n");
+        python << WriteSketchDefn(object);
+    }
+
+    delete re_ordered_sketch;
+    return written;
+}
+
+// Writes "rest_areas", a list of what the operations before this one in the program cut, for area_funcs.pocket to leave out.
+// Each is (area, start depth, final depth); the areas are made by area_funcs.pocket_cleared, profile_cleared and holes_cleared.
+void CPocket::WriteRestAreasPython(Python &python)
+{
+    double scale = Length::Conversion(theApp.m_program->m_units, UnitTypeMillimeter);
+
+    python << _T("rest_areas = []\n");
+
+    // the order the program is being written in, or, if this pocket is written on its own, the order it would be
+    std::vector<COp*> operations = theApp.m_program->m_operations_in_order;
+    if(operations.size() == 0)theApp.m_program->GetOperationsInOrder(operations);
+    for(std::vector<COp*>::iterator It = operations.begin(); It != operations.end(); It++)
+    {
+        COp* op = *It;
+        if(op == this)break;
+        if(!CountsForRestMachining(op))continue;
+
+        CDepthOp* depth_op = (CDepthOp*)op;
+        double tool_radius = CTool::Find(op->m_tool_number)->CuttingRadius(true);
+        double final_depth = depth_op->m_depth_op_params.m_final_depth / scale;
+
+        switch(op->GetType())
+        {
+        case PocketType:
+            {
+                CPocket* pocket = (CPocket*)op;
+                if(!pocket->WriteAreaPython(python, false))continue;
+                python << _T("a.Reorder()\n");
+                python << _T("a = area_funcs.pocket_cleared(a, ") << tool_radius;
+                python << _T(", ") << pocket->m_pocket_params.m_material_allowance / scale << _T(")\n");
+            }
+            break;
+
+        case ProfileType:
+            {
+                CProfile* profile = (CProfile*)op;
+                if(!WriteProfileCurvesPython(profile, python))continue;
+                // the finishing pass takes off the extra offset the roughing passes leave
+                double extra_offset = profile->m_profile_params.m_do_finishing_pass ? 0.0 : profile->m_profile_params.m_offset_extra / scale;
+                python << _T("a = area_funcs.profile_cleared(a, ") << (int)profile->m_profile_params.m_tool_on_side;
+                python << _T(", ") << tool_radius << _T(", ") << extra_offset << _T(")\n");
+            }
+            break;
+
+        case DrillingType:
+            {
+                std::vector<CNCPoint> locations;
+                ((CDrilling*)op)->GetLocations(locations);
+                if(locations.size() == 0)continue;
+                python << _T("a = area_funcs.holes_cleared([");
+                for(std::vector<CNCPoint>::iterator LIt = locations.begin(); LIt != locations.end(); LIt++)
+                {
+                    if(LIt != locations.begin())python << _T(", ");
+                    python << _T("(") << LIt->X() / scale << _T(", ") << LIt->Y() / scale << _T(")");
+                }
+                python << _T("], ") << tool_radius << _T(")\n");
+                // only as deep as the drill's point goes is the hole the drill's full width
+                final_depth += tool_radius;
+            }
+            break;
+        }
+
+        python << _T("rest_areas.append((a, ") << depth_op->m_depth_op_params.m_start_depth / scale;
+        python << _T(", ") << final_depth << _T("))\n");
+    }
+}
+
+Python CPocket::AppendTextToProgram()
+{
+	Python python;
+
+	CTool *pTool = CTool::Find( m_tool_number );
+	if (pTool == NULL)
+	{
+		wxMessageBox(_T("Cannot generate GCode for pocket without a tool assigned"));
+		return(python);
+	} // End if - then
+
+
+	python << CSketchOp::AppendTextToProgram();
+
+    if(m_pocket_params.m_rest_machining)WriteRestAreasPython(python);
+
+    if(!WriteAreaPython(python, true))return python;
+
     // reorder the area, the outside curves must be made anti-clockwise and the insides clockwise
     python << _T("a.Reorder()\n");
 
@@ -360,6 +550,7 @@ void CPocket::WriteDefaultValues()
 	config.Write(_T("PostProcessor"), m_pocket_params.m_post_processor);
 	config.Write(_T("ZigAngle"), m_pocket_params.m_zig_angle);
 	config.Write(_T("DecentStrategy"), m_pocket_params.m_entry_move);
+	config.Write(_T("RestMachining"), m_pocket_params.m_rest_machining);
 }
 
 void CPocket::ReadDefaultValues()
@@ -375,6 +566,7 @@ void CPocket::ReadDefaultValues()
 	int int_for_entry_move = CPocketParams::ePlunge;
 	config.Read(_T("DecentStrategy"), &int_for_entry_move);
 	m_pocket_params.m_entry_move = (CPocketParams::eEntryStyle) int_for_entry_move;
+	config.Read(_T("RestMachining"), m_pocket_params.m_rest_machining, false);
 }
 
 // static member function
@@ -461,6 +653,7 @@ bool CPocketParams::operator==(const CPocketParams & rhs) const
 	if (m_post_processor != rhs.m_post_processor) return(false);
 	if (m_zig_angle != rhs.m_zig_angle) return(false);
 	if (m_entry_move != rhs.m_entry_move) return(false);
+	if (m_rest_machining != rhs.m_rest_machining) return(false);
 
 	return(true);
 }
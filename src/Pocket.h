@@ -24,11 +24,14 @@ public:
         eZigZag = 0,
         eZigZagUnidirectional,
         eOffsets,
-        eTrochoidal
+        eTrochoidal,
+        eAdaptive
 
     } ePostProcessor;
     PropertyChoice m_post_processor;
 
+    static bool AdaptiveAvailable();
+
     bool IsZigZag() const {
         return ( m_post_processor == CPocketParams::eZigZag ||
                  m_post_processor == CPocketParams::eZigZagUnidirectional );
@@ -50,6 +53,8 @@ public:
 	} eEntryStyle;
 	PropertyChoice m_entry_move;
 
+	PropertyCheck m_rest_machining; // only cut the material the pockets, profiles and drilling before it in the program have left
+
 	CPocketParams(CPocket* parent);
 
 	void InitializeProperties();
@@ -92,10 +97,14 @@ public:
 	Python AppendTextToProgram();
 	void WriteDefaultValues();
 	void ReadDefaultValues();
+	bool ExpandsPattern(){return true;} // area_funcs.pocket cuts the same curves at each copy
 
 	static HeeksObj* ReadFromXMLElement(TiXmlElement* pElem);
 
     void WritePocketPython(Python &python);
+    bool WriteAreaPython(Python &python, bool show_errors);
+    void WriteRestAreasPython(Python &python);
+    static bool CountsForRestMachining(COp* op);
 
     static void GetOptions(std::list<Property *> *list);
 	static void ReadFromConfig();
@@ -11,6 +11,7 @@ BEGIN_EVENT_TABLE(PocketDlg, SketchOpDlg)
     EVT_COMBOBOX(ID_STARTING_PLACE,HeeksObjDlg::OnComboOrCheck)
     EVT_COMBOBOX(ID_CUT_MODE,HeeksObjDlg::OnComboOrCheck)
     EVT_COMBOBOX(ID_POST_PROCESSOR,PocketDlg::OnPostProcessor)
+    EVT_CHECKBOX(ID_REST_MACHINING, HeeksObjDlg::OnComboOrCheck)
     EVT_BUTTON(wxID_HELP, PocketDlg::OnHelp)
 END_EVENT_TABLE()
 
@@ -30,10 +31,13 @@ PocketDlg::PocketDlg(wxWindow *parent, CPocket* object, const wxString& title, b
 	wxString cut_mode_choices[] = {_("Conventional"), _("Climb")};
 	leftControls.push_back(MakeLabelAndControl(_("Cut Mode"), m_cmbCutMode = new wxComboBox(this, ID_CUT_MODE, _T(""), wxDefaultPosition, wxDefaultSize, 2, cut_mode_choices)));
 
-    wxString post_processor_choices[] = {_("ZigZag"), _("ZigZag Unidirectional"), _("Offsets"), _("Trochoidal")};
-    leftControls.push_back(MakeLabelAndControl(_("Post-Processor"), m_cmbPostProcessor = new wxComboBox(this, ID_POST_PROCESSOR, _T(""), wxDefaultPosition, wxDefaultSize, 4, post_processor_choices)));
+    // adaptive needs HeeksCNC's own python, so it is left out without it; a pocket which is already adaptive still shows as it
+    wxString post_processor_choices[] = {_("ZigZag"), _("ZigZag Unidirectional"), _("Offsets"), _("Trochoidal"), _("Adaptive")};
+    int number_of_post_processors = CPocketParams::AdaptiveAvailable() ? 5 : 4;
+    leftControls.push_back(MakeLabelAndControl(_("Post-Processor"), m_cmbPostProcessor = new wxComboBox(this, ID_POST_PROCESSOR, _T(""), wxDefaultPosition, wxDefaultSize, number_of_post_processors, post_processor_choices)));
 
 	leftControls.push_back(MakeLabelAndControl(_("Zig Zag Angle"), m_dblZigAngle = new CDoubleCtrl(this)));
+	leftControls.push_back( HControl( m_chkRestMachining = new wxCheckBox( this, ID_REST_MACHINING, _("Rest Machining") ), wxALL ));
 
 	for(std::list<HControl>::iterator It = save_leftControls.begin(); It != save_leftControls.end(); It++)
 	{
@@ -68,10 +72,14 @@ void PocketDlg::GetDataRaw(HeeksObj* object)
     else if ( value.Cmp(_("Trochoidal")) == 0 ) {
         pocket->m_pocket_params.m_post_processor = CPocketParams::eTrochoidal;
     }
+    else if ( value.Cmp(_("Adaptive")) == 0 ) {
+        pocket->m_pocket_params.m_post_processor = CPocketParams::eAdaptive;
+    }
 
 	if(pocket->m_pocket_params.IsZigZag()) {
 	    pocket->m_pocket_params.m_zig_angle = m_dblZigAngle->GetValueAsDouble();
 	}
+	pocket->m_pocket_params.m_rest_machining = m_chkRestMachining->GetValue();
 
 	SketchOpDlg::GetDataRaw(object);
 }
@@ -97,12 +105,16 @@ void PocketDlg::SetFromDataRaw(HeeksObj* object)
     case CPocketParams::eTrochoidal:
         m_cmbPostProcessor->SetValue(_("Trochoidal"));
         break;
+    case CPocketParams::eAdaptive:
+        m_cmbPostProcessor->SetValue(_("Adaptive"));
+        break;
     }
 
     m_dblZigAngle->SetValueFromDouble(pocket->m_pocket_params.m_zig_angle);
     if ( pocket->m_pocket_params.IsZigZag() ) {
         EnableZigZagControls();
     }
+	m_chkRestMachining->SetValue(pocket->m_pocket_params.m_rest_machining);
 
 	SketchOpDlg::SetFromDataRaw(object);
 }
@@ -147,11 +159,18 @@ void PocketDlg::SetPictureByWindow(wxWindow* w)
         else if ( value.Cmp(_("Trochoidal")) == 0 ) {
             SetPicture(_T("general"));
         }
+        else if ( value.Cmp(_("Adaptive")) == 0 ) {
+            SetPicture(_T("general"));
+        }
 	}
 	else if(w == m_dblZigAngle)
 	{
 	    SetPicture(_T("zig angle"));
 	}
+	else if(w == m_chkRestMachining)
+	{
+	    SetPicture(_T("general"));
+	}
 	else SketchOpDlg::SetPictureByWindow(w);
 }
 
@@ -16,7 +16,8 @@ class PocketDlg : public SketchOpDlg
 	{
 		ID_STARTING_PLACE = ID_SKETCH_ENUM_MAX,
 		ID_CUT_MODE,
-		ID_POST_PROCESSOR
+		ID_POST_PROCESSOR,
+		ID_REST_MACHINING
 	};
 
 	CLengthCtrl *m_lgthStepOver;
@@ -26,6 +27,7 @@ class PocketDlg : public SketchOpDlg
 	wxComboBox *m_cmbEntryMove;
 	wxComboBox *m_cmbPostProcessor;
 	CDoubleCtrl *m_dblZigAngle;
+	wxCheckBox *m_chkRestMachining;
 
 	void EnableZigZagControls();
 
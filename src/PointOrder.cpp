@@ -0,0 +1,430 @@
+// PointOrder.cpp
+/*
+ * Copyright (c) 2009, Dan Heeks
+ * This program is released under the BSD license. See the file COPYING for
+ * details.
+ */
+
+#include "stdafx.h"
+#include "PointOrder.h"
+
+#include <math.h>
+#include <algorithm>
+
+// how many near points each point looks at for 2-opt and Or-opt moves
+static const int number_of_neighbours = 8;
+
+// the most times to go round the improvement loop
+static const int max_improvement_passes = 50;
+
+// the longest piece of the path which Or-opt moves
+static const int max_segment_length = 3;
+
+// improvements smaller than this are ignored, so it can't go on forever
+static const double tiny_improvement = 1.0e-9;
+
+// points nearer together than this are counted as the same point
+static const double same_point = 1.0e-6;
+
+// node 0 is the start point; nodes 1 to n are the points
+class CPointOrderNodes
+{
+public:
+	std::vector<CPointOrder::Point> m_nodes;
+
+	double Distance(int a, int b)const
+	{
+		double dx = m_nodes[a].x - m_nodes[b].x;
+		double dy = m_nodes[a].y - m_nodes[b].y;
+		return sqrt(dx * dx + dy * dy);
+	}
+};
+
+// the nodes, sorted into square cells, for finding the near ones
+class CPointGrid
+{
+	const CPointOrderNodes& m_nodes;
+	double m_min_x, m_min_y;
+	double m_cell_size;
+	int m_nx, m_ny;
+	std::vector< std::vector<int> > m_cells;
+	std::vector<int> m_slot; // where each node is in its cell
+
+public:
+	CPointGrid(const CPointOrderNodes& nodes):m_nodes(nodes)
+	{
+		double max_x = nodes.m_nodes[0].x, max_y = nodes.m_nodes[0].y;
+		m_min_x = max_x;
+		m_min_y = max_y;
+		for(size_t i = 1; i < nodes.m_nodes.size(); i++)
+		{
+			const CPointOrder::Point& p = nodes.m_nodes[i];
+			if(p.x < m_min_x)m_min_x = p.x;
+			if(p.y < m_min_y)m_min_y = p.y;
+			if(p.x > max_x)max_x = p.x;
+			if(p.y > max_y)max_y = p.y;
+		}
+
+		// about two nodes to a cell
+		double width = max_x - m_min_x;
+		double height = max_y - m_min_y;
+		double size = (width > height) ? width : height;
+		m_cell_size = sqrt(width * height * 2.0 / nodes.m_nodes.size());
+		if(m_cell_size < size / 1000.0)m_cell_size = size / 1000.0; // all in a line
+		if(m_cell_size <= 0.0)m_cell_size = 1.0; // all in one place
+		m_nx = (int)(width / m_cell_size) + 1;
+		m_ny = (int)(height / m_cell_size) + 1;
+		m_cells.resize(m_nx * m_ny);
+		m_slot.resize(nodes.m_nodes.size(), -1);
+	}
+
+	void Add(int node)
+	{
+		std::vector<int> &cell = m_cells[CellIndex(node)];
+		m_slot[node] = (int)cell.size();
+		cell.push_back(node);
+	}
+
+	void Remove(int node)
+	{
+		std::vector<int> &cell = m_cells[CellIndex(node)];
+		int last = cell.back();
+		cell[m_slot[node]] = last;
+		m_slot[last] = m_slot[node];
+		cell.pop_back();
+		m_slot[node] = -1;
+	}
+
+	// the nearest node still in the grid, or -1 if there are none
+	int Nearest(int node)const
+	{
+		int ix, iy;
+		CellOf(node, ix, iy);
+		int best = -1;
+		double best_distance = 0.0;
+		int max_ring = (m_nx > m_ny) ? m_nx : m_ny;
+		for(int ring = 0; ring <= max_ring; ring++)
+		{
+			for(int x = ix - ring; x <= ix + ring; x++)
+			{
+				if(x < 0 || x >= m_nx)continue;
+				int step = (x == ix - ring || x == ix + ring) ? 1 : ring * 2;
+				if(step == 0)step = 1;
+				for(int y = iy - ring; y <= iy + ring; y += step)
+				{
+					if(y < 0 || y >= m_ny)continue;
+					const std::vector<int> &cell = m_cells[x * m_ny + y];
+					for(size_t i = 0; i < cell.size(); i++)
+					{
+						double d = m_nodes.Distance(node, cell[i]);
+						if(best == -1 || d < best_distance)
+						{
+							best = cell[i];
+							best_distance = d;
+						}
+					}
+				}
+			}
+
+			// nodes in the next ring are at least this far away
+			if(best != -1 && best_distance <= ring * m_cell_size)break;
+		}
+		return best;
+	}
+
+	// the nearest k nodes, nearest first
+	void Nearest(int node, int k, std::vector<int> &near_nodes)const
+	{
+		int ix, iy;
+		CellOf(node, ix, iy);
+		std::vector< std::pair<double, int> > found;
+		int max_ring = (m_nx > m_ny) ? m_nx : m_ny;
+		for(int ring = 0; ring <= max_ring; ring++)
+		{
+			for(int x = ix - ring; x <= ix + ring; x++)
+			{
+				if(x < 0 || x >= m_nx)continue;
+				int step = (x == ix - ring || x == ix + ring) ? 1 : ring * 2;
+				if(step == 0)step = 1;
+				for(int y = iy - ring; y <= iy + ring; y += step)
+				{
+					if(y < 0 || y >= m_ny)continue;
+					const std::vector<int> &cell = m_cells[x * m_ny + y];
+					for(size_t i = 0; i < cell.size(); i++)
+					{
+						if(cell[i] != node)found.push_back(std::make_pair(m_nodes.Distance(node, cell[i]), cell[i]));
+					}
+				}
+			}
+
+			if((int)found.size() >= k)
+			{
+				std::nth_element(found.begin(), found.begin() + (k - 1), found.end());
+				found.resize(k);
+				if(found[k - 1].first <= ring * m_cell_size)break;
+			}
+		}
+
+		std::sort(found.begin(), found.end());
+		near_nodes.clear();
+		for(size_t i = 0; i < found.size(); i++)near_nodes.push_back(found[i].second);
+	}
+
+private:
+	void CellOf(int node, int &ix, int &iy)const
+	{
+		ix = (int)((m_nodes.m_nodes[node].x - m_min_x) / m_cell_size);
+		iy = (int)((m_nodes.m_nodes[node].y - m_min_y) / m_cell_size);
+		if(ix >= m_nx)ix = m_nx - 1;
+		if(iy >= m_ny)iy = m_ny - 1;
+	}
+
+	int CellIndex(int node)const
+	{
+		int ix, iy;
+		CellOf(node, ix, iy);
+		return ix * m_ny + iy;
+	}
+};
+
+// an open path, which always starts at node 0
+class CPointPath
+{
+	const CPointOrderNodes& m_nodes;
+	std::vector< std::vector<int> > m_near;
+
+public:
+	std::vector<int> m_order;
+	std::vector<int> m_position;
+
+	CPointPath(const CPointOrderNodes& nodes):m_nodes(nodes){}
+
+	void NearestNeighbour()
+	{
+		CPointGrid grid(m_nodes);
+		int n = (int)m_nodes.m_nodes.size();
+		for(int i = 1; i < n; i++)grid.Add(i);
+
+		m_near.resize(n);
+		for(int i = 0; i < n; i++)grid.Nearest(i, number_of_neighbours, m_near[i]);
+
+		m_order.clear();
+		m_order.push_back(0);
+		int current = 0;
+		for(int i = 1; i < n; i++)
+		{
+			current = grid.Nearest(current);
+			grid.Remove(current);
+			m_order.push_back(current);
+		}
+
+		m_position.resize(n);
+		SetPositions(0, n - 1);
+	}
+
+	// returns true if it made the path shorter
+	bool TwoOpt()
+	{
+		bool improved = false;
+		int n = (int)m_order.size();
+		for(int i = 0; i < n; i++)
+		{
+			int a = m_order[i];
+			int b = (i + 1 < n) ? m_order[i + 1] : -1; // -1 if a is the end of the path
+			double ab = (b == -1) ? 0.0 : m_nodes.Distance(a, b);
+			const std::vector<int> &near_nodes = m_near[a];
+			for(size_t k = 0; k < near_nodes.size(); k++)
+			{
+				int c = near_nodes[k];
+				double ac = m_nodes.Distance(a, c);
+				if(b != -1 && ac >= ab)break; // the new edge has to be shorter than the old one
+				int j = m_position[c];
+				if(j > i + 1)
+				{
+					// replace a-b and c-d with a-c and b-d, by reversing b to c
+					double change = ac - ab;
+					if(j + 1 < n)
+					{
+						int d = m_order[j + 1];
+						change += m_nodes.Distance(b, d) - m_nodes.Distance(c, d);
+					}
+					if(change < -tiny_improvement)
+					{
+						Reverse(i + 1, j);
+						improved = true;
+						break;
+					}
+				}
+				else if(j < i - 1)
+				{
+					// replace c-d and a-b with c-a and d-b, by reversing d to a
+					int d = m_order[j + 1];
+					double change = ac - m_nodes.Distance(c, d);
+					if(b != -1)change += m_nodes.Distance(d, b) - ab;
+					if(change < -tiny_improvement)
+					{
+						Reverse(j + 1, i);
+						improved = true;
+						break;
+					}
+				}
+			}
+		}
+		return improved;
+	}
+
+	// moves short pieces of the path to between other near points; returns true if it made the path shorter
+	bool OrOpt()
+	{
+		bool improved = false;
+		int n = (int)m_order.size();
+		for(int length = 1; length <= max_segment_length; length++)
+		{
+			for(int i = 1; i + length - 1 < n; i++)
+			{
+				int first = m_order[i];
+				int last = m_order[i + length - 1];
+				int before = m_order[i - 1];
+				int after = (i + length < n) ? m_order[i + length] : -1;
+
+				// what taking the piece out saves
+				double saving = m_nodes.Distance(before, first);
+				if(after != -1)saving += m_nodes.Distance(last, after) - m_nodes.Distance(before, after);
+
+				bool moved = false;
+				for(int end = 0; end < 2 && !moved; end++)
+				{
+					const std::vector<int> &near_nodes = m_near[end == 0 ? first : last];
+					for(size_t k = 0; k < near_nodes.size(); k++)
+					{
+						int c = near_nodes[k];
+						int j = m_position[c];
+						if(j >= i - 1 && j <= i + length - 1)continue; // in the piece, or already before it
+						int d = (j + 1 < n) ? m_order[j + 1] : -1;
+
+						// put it between c and d, either way round
+						double cd = (d == -1) ? 0.0 : m_nodes.Distance(c, d);
+						double forwards = m_nodes.Distance(c, first) + ((d == -1) ? 0.0 : m_nodes.Distance(last, d)) - cd;
+						double backwards = m_nodes.Distance(c, last) + ((d == -1) ? 0.0 : m_nodes.Distance(first, d)) - cd;
+						bool reverse = backwards < forwards;
+						double cost = reverse ? backwards : forwards;
+						if(cost - saving < -tiny_improvement)
+						{
+							Move(i, length, j, reverse);
+							improved = true;
+							moved = true;
+							break;
+						}
+					}
+				}
+			}
+		}
+		return improved;
+	}
+
+private:
+	void SetPositions(int from, int to)
+	{
+		for(int i = from; i <= to; i++)m_position[m_order[i]] = i;
+	}
+
+	void Reverse(int from, int to)
+	{
+		std::reverse(m_order.begin() + from, m_order.begin() + to + 1);
+		SetPositions(from, to);
+	}
+
+	// moves the piece of the path from i, of length, to after position j
+	void Move(int i, int length, int j, bool reverse)
+	{
+		int start;
+		if(j > i)
+		{
+			std::rotate(m_order.begin() + i, m_order.begin() + i + length, m_order.begin() + j + 1);
+			start = j - length + 1;
+			SetPositions(i, j);
+		}
+		else
+		{
+			std::rotate(m_order.begin() + j + 1, m_order.begin() + i, m_order.begin() + i + length);
+			start = j + 1;
+			SetPositions(j + 1, i + length - 1);
+		}
+		if(reverse)Reverse(start, start + length - 1);
+	}
+};
+
+// for sorting the points by where they are, to find the ones in the same place
+class CPointKey
+{
+public:
+	double m_x, m_y;
+	int m_index;
+
+	CPointKey(const CPointOrder::Point &p, int index): m_x(floor(p.x / same_point + 0.5)), m_y(floor(p.y / same_point + 0.5)), m_index(index) {}
+
+	bool operator<(const CPointKey &k)const
+	{
+		if(m_x != k.m_x)return m_x < k.m_x;
+		if(m_y != k.m_y)return m_y < k.m_y;
+		return m_index < k.m_index;
+	}
+	bool SamePlace(const CPointKey &k)const { return m_x == k.m_x && m_y == k.m_y; }
+};
+
+//static
+void CPointOrder::Order(const Point &start, const std::vector<Point> &points, std::vector<int> &order)
+{
+	order.clear();
+	if(points.size() == 0)return;
+
+	// Points in the same place, like a hole in two sketches, or where copies of a pattern overlap, are visited one after the other, in the given order.
+	// Each place is only one node, because a lot of nodes in one cell of the grid would make finding the nearest ones take the square of the time.
+	std::vector<CPointKey> keys;
+	for(size_t i = 0; i < points.size(); i++)keys.push_back(CPointKey(points[i], (int)i));
+	std::sort(keys.begin(), keys.end());
+
+	CPointOrderNodes nodes;
+	nodes.m_nodes.push_back(start);
+	std::vector<size_t> first_key; // for each node, its first point in keys
+	first_key.push_back(0);
+	for(size_t i = 0; i < keys.size(); i++)
+	{
+		if(i > 0 && keys[i].SamePlace(keys[i - 1]))continue;
+		nodes.m_nodes.push_back(points[keys[i].m_index]);
+		first_key.push_back(i);
+	}
+	first_key.push_back(keys.size());
+
+	CPointPath path(nodes);
+	path.NearestNeighbour();
+
+	for(int pass = 0; pass < max_improvement_passes; pass++)
+	{
+		bool improved = path.TwoOpt();
+		if(path.OrOpt())improved = true;
+		if(!improved)break;
+	}
+
+	for(size_t i = 1; i < path.m_order.size(); i++)
+	{
+		int node = path.m_order[i];
+		for(size_t k = first_key[node]; k < first_key[node + 1]; k++)order.push_back(keys[k].m_index);
+	}
+}
+
+//static
+double CPointOrder::Length(const Point &start, const std::vector<Point> &points, const std::vector<int> &order)
+{
+	double length = 0.0;
+	Point previous = start;
+	for(size_t i = 0; i < order.size(); i++)
+	{
+		const Point &p = points[order[i]];
+		double dx = p.x - previous.x;
+		double dy = p.y - previous.y;
+		length += sqrt(dx * dx + dy * dy);
+		previous = p;
+	}
+	return length;
+}
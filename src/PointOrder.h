@@ -0,0 +1,33 @@
+// PointOrder.h
+/*
+ * Copyright (c) 2009, Dan Heeks
+ * This program is released under the BSD license. See the file COPYING for
+ * details.
+ */
+
+// Finds a short order to visit a lot of points in, like the holes of a drilling operation, where the tool rapids from one to the next.
+// It starts with the nearest neighbour from the start point, then improves that with 2-opt and Or-opt moves.
+// A grid of the points is used to find the near ones, so it's fast enough for many thousands of points.
+// Points in the same place are kept together, in the given order, and only counted once; see test/point_order.cpp for the timings.
+// Only x and y are used. It has no wx or OpenCascade in it.
+
+#pragma once
+
+#include <vector>
+
+class CPointOrder
+{
+public:
+	class Point
+	{
+	public:
+		double x, y;
+		Point(double x_, double y_): x(x_), y(y_) {}
+	};
+
+	// sets order to the indices of points, in the order to visit them, starting from start
+	static void Order(const Point &start, const std::vector<Point> &points, std::vector<int> &order);
+
+	// the length of the path from start through the points, in the given order
+	static double Length(const Point &start, const std::vector<Point> &points, const std::vector<int> &order);
+};
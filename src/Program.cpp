@@ -29,11 +29,14 @@
 #include "Surface.h"
 #include "Stock.h"
 #include "ProgramDlg.h"
+#include "IsoCreator.h"
+#include "OpScheduler.h"
 
 #include <wx/stdpaths.h>
 #include <wx/filename.h>
 
 #include <vector>
+#include <map>
 #include <algorithm>
 #include <fstream>
 #include <memory>
@@ -74,6 +77,9 @@ CProgram::CProgram( const CProgram & rhs )
 	m_path_control_mode = rhs.m_path_control_mode;
 	m_motion_blending_tolerance = rhs.m_motion_blending_tolerance;
 	m_naive_cam_tolerance = rhs.m_naive_cam_tolerance;
+	m_schedule_operations = rhs.m_schedule_operations;
+	m_tool_change_time = rhs.m_tool_change_time;
+	m_rapid_rate = rhs.m_rapid_rate;
 
     ReloadPointers();
     AddMissingChildren();
@@ -161,6 +167,9 @@ void CProgram::CopyFrom(const HeeksObj* object)
 		m_path_control_mode = rhs->m_path_control_mode;
 		m_motion_blending_tolerance = rhs->m_motion_blending_tolerance;
 		m_naive_cam_tolerance = rhs->m_naive_cam_tolerance;
+		m_schedule_operations = rhs->m_schedule_operations;
+		m_tool_change_time = rhs->m_tool_change_time;
+		m_rapid_rate = rhs->m_rapid_rate;
 	}
 }
 
@@ -198,6 +207,9 @@ CProgram & CProgram::operator= ( const CProgram & rhs )
 		m_path_control_mode = rhs.m_path_control_mode;
 		m_motion_blending_tolerance = rhs.m_motion_blending_tolerance;
 		m_naive_cam_tolerance = rhs.m_naive_cam_tolerance;
+		m_schedule_operations = rhs.m_schedule_operations;
+		m_tool_change_time = rhs.m_tool_change_time;
+		m_rapid_rate = rhs.m_rapid_rate;
 	}
 
 	return(*this);
@@ -263,6 +275,10 @@ void CProgram::InitializeProperties()
 
     m_motion_blending_tolerance.Initialize( _("Motion Blending Tolerance"), this);
     m_naive_cam_tolerance.Initialize( _("Naive CAM Tolerance"), this);
+
+    m_schedule_operations.Initialize( _("schedule operations for fewer tool changes"), this);
+    m_tool_change_time.Initialize( _("tool change time (seconds)"), this);
+    m_rapid_rate.Initialize( _("rapid rate (per minute)"), this);
 }
 
 void CProgram::GetProperties(std::list<Property *> *list)
@@ -346,6 +362,9 @@ void CProgram::WriteXML(TiXmlNode *root)
 	element->SetAttribute( "ProgramPathControlMode", (int)m_path_control_mode);
 	element->SetDoubleAttribute( "ProgramMotionBlendingTolerance", m_motion_blending_tolerance);
 	element->SetDoubleAttribute( "ProgramNaiveCamTolerance", m_naive_cam_tolerance);
+	element->SetAttribute( "ScheduleOperations", (int) (m_schedule_operations?1:0));
+	element->SetDoubleAttribute( "ToolChangeTime", m_tool_change_time);
+	element->SetDoubleAttribute( "RapidRate", m_rapid_rate);
 
 	m_machine.WriteBaseXML(element);
 	WriteBaseXML(element);
@@ -425,6 +444,9 @@ HeeksObj* CProgram::ReadFromXMLElement(TiXmlElement* pElem)
 		else if(name == "ProgramPathControlMode"){new_object->m_path_control_mode = ePathControlMode_t(atoi(a->Value()));}
 		else if(name == "ProgramMotionBlendingTolerance"){new_object->m_motion_blending_tolerance = a->DoubleValue();}
 		else if(name == "ProgramNaiveCamTolerance"){new_object->m_naive_cam_tolerance = a->DoubleValue();}
+		else if(name == "ScheduleOperations"){new_object->m_schedule_operations = (atoi(a->Value()) != 0);}
+		else if(name == "ToolChangeTime"){new_object->m_tool_change_time = a->DoubleValue();}
+		else if(name == "RapidRate"){new_object->m_rapid_rate = a->DoubleValue();}
 	}
 
 	new_object->ReadBaseXML(pElem);
@@ -444,7 +466,8 @@ void CMachine::ReadBaseXML(TiXmlElement* element)
 {
 } // End ReadBaseXML() method
 
-void ApplyPatternToText(Python &python, int p, std::set<int> &patterns_written)
+// definitions get the pattern's matrices, the first time it is used
+void ApplyPatternToText(Python &definitions, Python &python, int p, std::set<int> &patterns_written)
 {
 	CPattern* pattern = (CPattern*)heeksCAD->GetIDObject(PatternType, p);
 	if(pattern)
@@ -453,78 +476,208 @@ void ApplyPatternToText(Python &python, int p, std::set<int> &patterns_written)
 		if(patterns_written.find(p) == patterns_written.end())
 		{
 			// write a pattern definition
-			python << _T("pattern") << p << _T(" = [");
+			definitions << _T("pattern") << p << _T(" = [");
 			std::list<gp_Trsf> matrices;
 			pattern->GetMatrices(matrices);
 			for(std::list<gp_Trsf>::iterator It = matrices.begin(); It != matrices.end(); It++)
 			{
-				if(It != matrices.begin())python << _T(", ");
+				if(It != matrices.begin())definitions << _T(", ");
 				gp_Trsf &mat = *It;
-				python << _T("area.Matrix([");
+				definitions << _T("area.Matrix([");
 				double m[16];
 				extract(mat, m);
 				for(int i = 0; i<16; i++)
 				{
-					if(i>0)python<<_T(", ");
-					python<<m[i];
+					if(i>0)definitions<<_T(", ");
+					definitions<<m[i];
 				}
-				python << _T("])");
+				definitions << _T("])");
 			}
-			python<<_T("]\n");
+			definitions<<_T("]\n");
 
 			patterns_written.insert(p);
 		}
 
 		// write a transform redirector
-		python << _T("transform.transform_begin(pattern") << p << _T(")\n");
+		python << _T("transform.transform_begin(pattern") << p << (pattern->m_use_subroutine ? _T(", True") : _T(", False")) << _T(")\n");
 	}
 }
 
-void ApplySurfaceToText(Python &python, CSurface* surface, std::set<CSurface*> &surfaces_written)
+// definitions get the surface's stl, the first time it is used
+void ApplySurfaceToText(Python &definitions, Python &python, CSurface* surface, std::set<CSurface*> &surfaces_written)
 {
 	if(surfaces_written.find(surface) == surfaces_written.end())
 	{
 		surfaces_written.insert(surface);
-		// get the solids list
-		std::list<HeeksObj*> solids;
-		for (std::list<int>::iterator It = surface->m_solids.begin(); It != surface->m_solids.end(); It++)
-		{
-			HeeksObj* object = heeksCAD->GetIDObject(SolidType, *It);
-			if (object != NULL)solids.push_back(object);
-		} // End for
-
-#if wxCHECK_VERSION(3, 0, 0)
-		wxStandardPaths& standard_paths = wxStandardPaths::Get();
-#else
-		wxStandardPaths standard_paths;
-#endif
-		wxFileName filepath(standard_paths.GetTempDir().c_str(), wxString::Format(_T("surface%d.stl"), CSurface::number_for_stl_file).c_str());
-		CSurface::number_for_stl_file++;
 
-		//write stl file
-		heeksCAD->SaveSTLFile(solids, filepath.GetFullPath(), 0.01);
+		// the stl file is only written again if the solids have changed
+		wxString filepath = surface->GetSTLFilePath();
 
-		python << _T("stl") << (int)(surface->GetID()) << _T(" = ocl_funcs.STLSurfFromFile(") << PythonString(filepath.GetFullPath()) << _T(")\n");
+		definitions << _T("stl") << (int)(surface->GetID()) << _T(" = ocl_funcs.STLSurfFromFile(") << PythonString(filepath) << _T(")\n");
 	}
 
 	double scale = Length::Conversion(theApp.m_program->m_units, UnitTypeMillimeter);
 	python << _T("attach.units = ") << scale << _T("\n");
 	python << _T("attach.attach_begin()\n");
 	python << _T("nc.creator.stl = stl") << (int)(surface->GetID()) << _T("\n");
+	python << _T("nc.creator.stl_file = ") << PythonString(surface->GetSTLFilePath()) << _T("\n");
+	python << _T("nc.creator.tolerance = ") << heeksCAD->GetTolerance() << _T("\n");
 	python << _T("nc.creator.minz = -10000.0\n");
 	python << _T("nc.creator.material_allowance = ") << surface->m_material_allowance << _T("\n");
 
 	theApp.m_attached_to_surface = surface;
 }
 
+// FNV-1a, of the text as UTF-8, so the hash is the same for unicode and ansi builds
+static void AddToHash(wxUint64 &hash, const wxString &text)
+{
+	const wxCharBuffer buffer = text.mb_str(wxConvUTF8);
+	const unsigned char* bytes = (const unsigned char*)buffer.data();
+	size_t size = strlen(buffer.data());
+	for(size_t i = 0; i < size; i++)
+	{
+		hash ^= bytes[i];
+		hash *= wxULL(1099511628211);
+	}
+}
+
+static wxString GetOperationsCacheDir()
+{
+#if wxCHECK_VERSION(3, 0, 0)
+	wxStandardPaths& standard_paths = wxStandardPaths::Get();
+#else
+	wxStandardPaths standard_paths;
+#endif
+	wxFileName dir(standard_paths.GetUserDataDir(), _T(""));
+	dir.AppendDir(_T("nc_cache"));
+	return dir.GetPath();
+}
+
+// python can't be indented if it has strings over more than one line
+static bool CanBeIndented(const wxString &text)
+{
+	return !text.Contains(_T("\"\"\"")) && !text.Contains(_T("'''"));
+}
+
+static Python IndentedPython(const wxString &text)
+{
+	Python python;
+	bool start_of_line = true;
+	bool empty = true;
+	for(size_t i = 0; i < text.Len(); i++)
+	{
+		wxChar c = text[i];
+		if(start_of_line && c != _T('\n'))python << _T("    ");
+		start_of_line = (c == _T('\n'));
+		if(c != _T(' ') && c != _T('\t') && c != _T('\n'))empty = false;
+		python.Append(c);
+	}
+	if(!start_of_line)python << _T("\n");
+	if(empty)python << _T("    pass\n");
+	return python;
+}
+
+static void WriteRunOps(Python &python, Python &ops_to_run, bool parallel)
+{
+	if(ops_to_run.Len() == 0)return;
+	python << _T("op_cache.run_ops([\n") << ops_to_run << _T("], ") << (parallel ? _T("True") : _T("False")) << _T(")\n");
+	python << _T("\n");
+	ops_to_run.Clear();
+}
+
+// The active operations, in the order they are in, or, if m_schedule_operations is set, in the order
+// COpScheduler finds, which needs fewer tool changes and less rapid travel between them.
+// log_savings is for once in each post, not for each time the order is needed.
+void CProgram::GetOperationsInOrder(std::vector<COp*> &operations, bool log_savings)
+{
+	operations.clear();
+	if(m_operations == NULL)return;
+
+	for(HeeksObj* object = m_operations->GetFirstChild(); object; object = m_operations->GetNextChild())
+	{
+		if(!COperations::IsAnOperation(object->GetType()))continue;
+		COp* op = (COp*)object;
+		if(op->m_active)operations.push_back(op);
+	}
+
+	if(!m_schedule_operations || operations.size() < 2)return;
+
+	std::map<int, int> index_of_id;
+	for(unsigned int i = 0; i < operations.size(); i++)index_of_id[operations[i]->GetID()] = i;
+
+	std::vector<COpScheduler::Op> ops(operations.size());
+	std::vector<int> tree_order;
+	for(unsigned int i = 0; i < operations.size(); i++)
+	{
+		COp* op = operations[i];
+		COpScheduler::Op &scheduler_op = ops[i];
+		scheduler_op.tool = op->UsesTool() ? op->m_tool_number : 0;
+		scheduler_op.barrier = (op->GetType() == ScriptOpType); // script operations can do anything
+
+		std::list<HeeksObj*> objects;
+		op->GetMachinedObjects(objects);
+		CBox box;
+		for(std::list<HeeksObj*>::iterator It = objects.begin(); It != objects.end(); It++)
+		{
+			HeeksObj* object = *It;
+			scheduler_op.objects.push_back(std::make_pair(object->GetType(), object->GetID()));
+			object->GetBox(box);
+		}
+		if(box.m_valid)
+		{
+			double centre[3];
+			box.Centre(centre);
+			scheduler_op.has_location = true;
+			scheduler_op.x = centre[0];
+			scheduler_op.y = centre[1];
+		}
+
+		if(op->m_after != 0)
+		{
+			std::map<int, int>::iterator FindIt = index_of_id.find(op->m_after);
+			if(FindIt != index_of_id.end())scheduler_op.after.push_back(FindIt->second);
+		}
+
+		// a rest machining pocket only cuts what the ones before it have left, so they stay before it
+		if(op->GetType() == PocketType && ((CPocket*)op)->m_pocket_params.m_rest_machining)
+		{
+			for(unsigned int j = 0; j < i; j++)
+			{
+				if(CPocket::CountsForRestMachining(operations[j]))scheduler_op.after.push_back(j);
+			}
+		}
+
+		tree_order.push_back(i);
+	}
+
+	std::vector<int> order;
+	COpScheduler::Schedule(ops, order);
+
+	std::vector<COp*> scheduled;
+	for(std::vector<int>::iterator It = order.begin(); It != order.end(); It++)scheduled.push_back(operations[*It]);
+	operations = scheduled;
+
+	if(!log_savings)return;
+
+	int tool_changes_before = COpScheduler::ToolChanges(ops, tree_order);
+	int tool_changes_after = COpScheduler::ToolChanges(ops, order);
+	double travel_before = COpScheduler::Travel(ops, tree_order);
+	double travel_after = COpScheduler::Travel(ops, order);
+	double seconds_saved = (tool_changes_before - tool_changes_after) * m_tool_change_time;
+	if(m_rapid_rate > 0.0)seconds_saved += (travel_before - travel_after) / m_rapid_rate * 60.0;
+	wxLogMessage(_T("scheduled operations: %d tool changes instead of %d, %g mm of rapid travel between operations instead of %g, about %g seconds saved"),
+		tool_changes_after, tool_changes_before, travel_after, travel_before, seconds_saved);
+}
+
 Python CProgram::RewritePythonProgram()
 {
 	Python python;
 
 	theApp.m_program_canvas->m_textCtrl->Clear();
 	theApp.m_attached_to_surface = NULL;
-	CSurface::number_for_stl_file = 1;
 	theApp.m_tool_number = 0;
+	theApp.m_location = CNCPoint(0, 0, 0); // where the drilling starts sorting from
+	theApp.m_location_known = true;
 
 	// call any OnRewritePython functions from other plugins
 	for(std::list< void(*)() >::iterator It = theApp.m_OnRewritePython_list.begin(); It != theApp.m_OnRewritePython_list.end(); It++)
@@ -542,9 +695,6 @@ Python CProgram::RewritePythonProgram()
 	bool transform_module_needed = false;
 	bool depths_needed = false;
 
-	typedef std::vector< COp * > OperationsMap_t;
-	OperationsMap_t operations;
-
 	if (m_operations == NULL)
 	{
 		// If there are no operations then there is no GCode.
@@ -554,11 +704,9 @@ Python CProgram::RewritePythonProgram()
 
 	for(HeeksObj* object = m_operations->GetFirstChild(); object; object = m_operations->GetNextChild())
 	{
-		operations.push_back( (COp *) object );
-
 		if(((COp*)object)->m_active)
 		{
-			if(((COp*)object)->m_pattern != 0)transform_module_needed = true;
+			if(((COp*)object)->m_pattern != 0 && !((COp*)object)->ExpandsPattern())transform_module_needed = true;
 			if(((COp*)object)->m_surface != 0){nc_attach_needed = true; ocl_module_needed = true; ocl_funcs_needed = true;}
 
 			switch(object->GetType())
@@ -806,9 +954,31 @@ Python CProgram::RewritePythonProgram()
 
 	// Write all the operations
 
+	// Each operation can be put in a function, for op_cache.run_ops, which skips the ones whose NC code is in the cache
+	// and makes the others in parallel. The cache is keyed by a hash of each operation's python and the definitions it might use.
+	bool cache_operations = theApp.m_cache_operations_nc;
+	// With the python inside HeeksCNC, op_cache's worker processes are forks of HeeksCAD, made from the thread running python.
+	// They only run python, without the GIL being held by any other thread, and leave with os._exit, so none of HeeksCAD is run in them.
+	bool parallel_operations = theApp.m_post_operations_in_parallel;
+	bool run_ops = cache_operations || parallel_operations;
+	if(run_ops)
+	{
+		python << _T("import nc.op_cache as op_cache\n");
+		if(cache_operations)python << _T("op_cache.cache_begin(") << PythonString(GetOperationsCacheDir()) << _T(")\n");
+		python << _T("\n");
+	}
+	wxUint64 definitions_hash = wxULL(14695981039346656037);
+	Python ops_to_run;
+	int number_of_op_functions = 0;
+
 	std::set<CSurface*> surfaces_written;
 	std::set<int> patterns_written;
 
+	typedef std::vector< COp * > OperationsMap_t;
+	OperationsMap_t operations;
+	GetOperationsInOrder(operations, true);
+	m_operations_in_order = operations; // for the rest machining pockets to find the operations before them
+
 	for (OperationsMap_t::const_iterator l_itOperation = operations.begin(); l_itOperation != operations.end(); l_itOperation++)
 	{
 		HeeksObj *object = (HeeksObj *) *l_itOperation;
@@ -819,22 +989,54 @@ Python CProgram::RewritePythonProgram()
 			COp* op = (COp*)object;
 			if(op->m_active)
 			{
+				Python definitions;
+				Python op_python;
 				CSurface* surface = (CSurface*)heeksCAD->GetIDObject(SurfaceType, op->m_surface);
-				if(surface && !surface->m_same_for_each_pattern_position)ApplySurfaceToText(python, surface, surfaces_written);
-				ApplyPatternToText(python, op->m_pattern, patterns_written);
-				if(surface && surface->m_same_for_each_pattern_position)ApplySurfaceToText(python, surface, surfaces_written);
+				if(surface && !surface->m_same_for_each_pattern_position)ApplySurfaceToText(definitions, op_python, surface, surfaces_written);
+				bool transformed = (op->m_pattern != 0) && !op->ExpandsPattern();
+				if(transformed)ApplyPatternToText(definitions, op_python, op->m_pattern, patterns_written);
+				if(surface && surface->m_same_for_each_pattern_position)ApplySurfaceToText(definitions, op_python, surface, surfaces_written);
 
-				python << op->AppendTextToProgram();
+				op_python << op->AppendTextToProgram();
+				if(transformed || !op->SetsLocation())theApp.m_location_known = false;
 
 				// end surface attach
-				if(surface && surface->m_same_for_each_pattern_position)python << _T("attach.attach_end()\n");
-				if(op->m_pattern != 0)python << _T("transform.transform_end()\n");
-				if(surface && !surface->m_same_for_each_pattern_position)python << _T("attach.attach_end()\n");
+				if(surface && surface->m_same_for_each_pattern_position)op_python << _T("attach.attach_end()\n");
+				if(transformed)op_python << _T("transform.transform_end()\n");
+				if(surface && !surface->m_same_for_each_pattern_position)op_python << _T("attach.attach_end()\n");
 				theApp.m_attached_to_surface = NULL;
+
+				python << definitions;
+				AddToHash(definitions_hash, definitions);
+
+				// script operations can do anything, so they are always run, in their place in the program
+				if(run_ops && object->GetType() != ScriptOpType && CanBeIndented(op_python))
+				{
+					wxUint64 key = definitions_hash;
+					AddToHash(key, op_python);
+					number_of_op_functions++;
+					wxString function_name = wxString::Format(_T("op%d"), number_of_op_functions);
+					python << _T("def ") << function_name << _T("():\n");
+					python << IndentedPython(op_python);
+					python << _T("\n");
+
+					// operations copied by transform.py, or on a surface, depend on where the previous operation finished
+					bool independent = !transformed && (surface == NULL);
+					ops_to_run << _T("    ('") << wxString::Format(_T("%08x%08x"), (unsigned int)(key >> 32), (unsigned int)(key & 0xffffffff)) << _T("', ") << function_name << _T(", ") << (independent ? _T("True") : _T("False")) << _T("),\n");
+				}
+				else
+				{
+					WriteRunOps(python, ops_to_run, parallel_operations);
+					python << op_python;
+				}
 			}
 		}
 	} // End for - operation
 
+	m_operations_in_order.clear();
+
+	WriteRunOps(python, ops_to_run, parallel_operations);
+	if(cache_operations)python << _T("op_cache.cache_end()\n");
 	python << _T("program_end()\n");
 	m_python_program = python;
 	theApp.m_program_canvas->m_textCtrl->AppendText(python);
@@ -862,6 +1064,98 @@ Python CProgram::RewritePythonProgram()
 	return(python);
 }
 
+// For the standard ISO machines, the operations which can do it give their moves straight to a CIsoCreator,
+// which writes the same NC code as the python from RewritePythonProgram would.
+// Only drilling can do it, so far, so this is only for programs which are all drilling.
+// Anything else, including machines with their own python parameters, is left to python.
+bool CProgram::WriteNC()
+{
+#ifdef FREE_VERSION
+	return false;
+#else
+	if(!theApp.m_use_native_nc_writer)return false;
+	if(m_operations == NULL)return false;
+	if(m_machine.py_params.size() > 0)return false;
+
+	for(HeeksObj* object = m_operations->GetFirstChild(); object; object = m_operations->GetNextChild())
+	{
+		if(!COperations::IsAnOperation(object->GetType()))continue;
+		COp* op = (COp*)object;
+		if(!op->m_active)continue;
+		if((op->m_pattern != 0 && !op->ExpandsPattern()) || op->m_surface != 0 || !op->CanWriteNC())
+		{
+			wxLogMessage(_T("the NC code is written by python, as the built-in NC writer only does drilling, without a surface; \"%s\" can't be written by it"), op->GetTitle());
+			return false;
+		}
+	}
+
+	CIsoCreator* creator = CIsoCreator::New(std::string(Ttc(m_machine.post.c_str())));
+	if(creator == NULL)return false;
+
+	wxStopWatch stop_watch;
+	if(!creator->file_open((const char*)GetOutputFileName().mb_str(wxConvFile)))
+	{
+		wxMessageBox(wxString(_("couldn't write ")) + GetOutputFileName());
+		delete creator;
+		return false;
+	}
+
+	theApp.m_attached_to_surface = NULL;
+	theApp.m_tool_number = 0;
+	theApp.m_location = CNCPoint(0, 0, 0); // where the drilling starts sorting from
+	theApp.m_location_known = true;
+
+	// begin program
+	creator->program_begin(GetID(), (const char*)GetTitle().mb_str(wxConvUTF8));
+
+	creator->absolute();
+	if(m_units == UnitTypeInch)
+	{
+		creator->imperial();
+	}
+	else
+	{
+		creator->metric();
+	}
+	creator->set_plane(0);
+
+	if (m_path_control_mode != ePathControlUndefined)
+	{
+		creator->set_path_control_mode((int) m_path_control_mode, PythonNumber(m_motion_blending_tolerance), PythonNumber(m_naive_cam_tolerance));
+	}
+
+	// the tools, like CTool::AppendTextToProgram
+	if (m_tools != NULL)
+	{
+		for(HeeksObj* object = m_tools->GetFirstChild(); object; object = m_tools->GetNextChild())
+		{
+			if(object->GetType() != ToolType)continue;
+			CTool* tool = (CTool*)object;
+			CNCToolParams params;
+			params.diameter = PythonNumber(tool->m_params.m_diameter);
+			params.cutting_edge_height = PythonNumber(tool->m_params.m_cutting_edge_height);
+			params.name = (const char*)tool->GetMeaningfulName(m_units).mb_str(wxConvUTF8);
+			creator->tool_defn((int)tool->m_tool_number, (const char*)tool->GetTitle().mb_str(wxConvUTF8), params);
+		}
+	}
+
+	// the operations, in the same order as the python program, which has already said what the scheduling saved
+	std::vector<COp*> operations;
+	GetOperationsInOrder(operations);
+	for(std::vector<COp*>::iterator It = operations.begin(); It != operations.end(); It++)
+	{
+		(*It)->WriteNC(*creator);
+		if(!(*It)->SetsLocation())theApp.m_location_known = false;
+	}
+
+	creator->program_end();
+	delete creator;
+	wxLogMessage(_T("wrote NC code in %ld ms"), stop_watch.Time());
+
+	return true;
+#endif
+}
+
 ProgramUserType CProgram::GetUserType()
 {
 	if((m_nc_code != NULL) && (m_nc_code->m_user_edited)) return ProgramUserTypeNC;
@@ -1042,13 +1336,13 @@ wxString CProgram::GetOutputFileName() const
 
 wxString CProgram::GetBackplotFilePath() const
 {
-	// The xml file is created in the temporary folder
+	// The binary backplot file ( see nc/hbin_writer.py ) is created in the temporary folder
 #if wxCHECK_VERSION(3, 0, 0)
 	wxStandardPaths& standard_paths = wxStandardPaths::Get();
 #else
 	wxStandardPaths standard_paths;
 #endif
-	wxFileName file_str(standard_paths.GetTempDir().c_str(), _T("backplot.xml"));
+	wxFileName file_str(standard_paths.GetTempDir().c_str(), _T("backplot.hbin"));
 	return file_str.GetFullPath();
 }
 
@@ -1153,6 +1447,9 @@ void CProgram::WriteDefaultValues()
 	config.Write(_T("ProgramPathControlMode"), (int) m_path_control_mode );
 	config.Write(_T("ProgramMotionBlendingTolerance"), m_motion_blending_tolerance );
 	config.Write(_T("ProgramNaiveCamTolerance"), m_naive_cam_tolerance );
+	config.Write(_T("ProgramScheduleOperations"), m_schedule_operations );
+	config.Write(_T("ProgramToolChangeTime"), m_tool_change_time );
+	config.Write(_T("ProgramRapidRate"), m_rapid_rate );
 }
 
 wxString CProgram::GetDefaultOutputFilePath()const
@@ -1181,6 +1478,9 @@ void CProgram::ReadDefaultValues()
 	config.Read(_("ProgramPathControlMode"), m_path_control_mode, (int) ePathControlUndefined );
 	config.Read(_("ProgramMotionBlendingTolerance"), m_motion_blending_tolerance, 0.0001);
 	config.Read(_("ProgramNaiveCamTolerance"), m_naive_cam_tolerance, 0.0001);
+	config.Read(_T("ProgramScheduleOperations"), m_schedule_operations, false);
+	config.Read(_T("ProgramToolChangeTime"), m_tool_change_time, 10.0);
+	config.Read(_T("ProgramRapidRate"), m_rapid_rate, 5000.0);
 }
 
 static bool OnEdit(HeeksObj* object)
@@ -17,6 +17,7 @@ class CTools;
 class CPatterns;
 class CSurfaces;
 class CStocks;
+class COp;
 
 enum ProgramUserType{
 	ProgramUserTypeUnkown,
@@ -102,6 +103,10 @@ public:
 	PropertyLength m_motion_blending_tolerance;	// Only valid if m_path_control_mode == eBestPossibleSpeed
 	PropertyLength m_naive_cam_tolerance;		// Only valid if m_path_control_mode == eBestPossibleSpeed
 
+	PropertyCheck m_schedule_operations;	// reorder the operations for fewer tool changes, rather than doing them in the order they are in
+	PropertyDouble m_tool_change_time;		// seconds, for estimating the time saved by scheduling
+	PropertyLength m_rapid_rate;			// per minute, for estimating the time saved by scheduling
+
 public:
 	static wxString alternative_machines_file;
 	PropertyChoice m_machine_choice;
@@ -161,7 +166,10 @@ public:
 	void GetOnEdit(bool(**callback)(HeeksObj*));
 	void Clear();
 
+	void GetOperationsInOrder(std::vector<COp*> &operations, bool log_savings = false);
+	std::vector<COp*> m_operations_in_order; // while RewritePythonProgram writes the operations, the order it writes them in
 	Python RewritePythonProgram();
+	bool WriteNC(); // writes the NC file without python, returns false if it can't
 	ProgramUserType GetUserType();
 	void UpdateFromUserType();
 
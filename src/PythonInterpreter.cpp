@@ -0,0 +1,666 @@
+// PythonInterpreter.cpp
+/*
+ * Copyright (c) 2009, Dan Heeks
+ * This program is released under the BSD license. See the file COPYING for
+ * details.
+ */
+
+#include "stdafx.h"
+#include "PythonInterpreter.h"
+
+CPythonInterpreter* CPythonInterpreter::m_object = NULL;
+bool CPythonInterpreter::m_failed = false;
+
+#ifdef HEEKSCNC_EMBEDDED_PYTHON
+
+#include <Python.h>
+#include <wx/log.h>
+#include <wx/thread.h>
+#include <wx/progdlg.h>
+#include <wx/stopwatch.h>
+#include "PythonString.h"
+#include "ZigZag.h"
+#include "FeedPossible.h"
+#include "Adaptive.h"
+#include "DropCutterMesh.h"
+
+extern CHeeksCADInterface* heeksCAD;
+
+static wxString output_text;
+static wxString error_text;
+// the backplot records, from the thread running python, until RunInThread gives them to the callback
+static wxMutex backplot_mutex;
+static std::vector<char> backplot_data;
+static bool backplot_wanted = false;
+
+static PyObject* heekscnc_output(PyObject* self, PyObject* args)
+{
+	const char* s;
+	int length;
+	if(!PyArg_ParseTuple(args, "s#", &s, &length))return NULL;
+	output_text += wxString::From8BitData(s, length);
+	Py_RETURN_NONE;
+}
+
+static PyObject* heekscnc_error(PyObject* self, PyObject* args)
+{
+	const char* s;
+	int length;
+	if(!PyArg_ParseTuple(args, "s#", &s, &length))return NULL;
+	error_text += wxString::From8BitData(s, length);
+	Py_RETURN_NONE;
+}
+
+static PyObject* heekscnc_backplot(PyObject* self, PyObject* args)
+{
+	const char* data;
+	int length;
+	if(!PyArg_ParseTuple(args, "s#", &data, &length))return NULL;
+	wxMutexLocker lock(backplot_mutex);
+	if(backplot_wanted)backplot_data.insert(backplot_data.end(), data, data + length);
+	Py_RETURN_NONE;
+}
+
+// reads curves given as lists of (type, x, y, cx, cy), like area.Vertex
+static bool GetCurves(PyObject* curves_object, std::vector<CCurve> &curves)
+{
+	PyObject* curves_sequence = PySequence_Fast(curves_object, "curves must be a list");
+	if(curves_sequence == NULL)return false;
+	Py_ssize_t num_curves = PySequence_Fast_GET_SIZE(curves_sequence);
+	for(Py_ssize_t i = 0; i < num_curves; i++)
+	{
+		PyObject* vertices = PySequence_Fast(PySequence_Fast_GET_ITEM(curves_sequence, i), "each curve must be a list");
+		if(vertices == NULL)
+		{
+			Py_DECREF(curves_sequence);
+			return false;
+		}
+		curves.push_back(CCurve());
+		Py_ssize_t num_vertices = PySequence_Fast_GET_SIZE(vertices);
+		for(Py_ssize_t j = 0; j < num_vertices; j++)
+		{
+			int type;
+			double x, y, cx, cy;
+			if(!PyArg_ParseTuple(PySequence_Fast_GET_ITEM(vertices, j), "idddd", &type, &x, &y, &cx, &cy))
+			{
+				Py_DECREF(vertices);
+				Py_DECREF(curves_sequence);
+				return false;
+			}
+			curves.back().push_back(CCurveVertex(type, x, y, cx, cy));
+		}
+		Py_DECREF(vertices);
+	}
+	Py_DECREF(curves_sequence);
+	return true;
+}
+
+// makes a list of lists of (type, x, y, cx, cy) from the curves
+static PyObject* CurvesToList(const std::vector<CCurve> &curves)
+{
+	PyObject* result = PyList_New(curves.size());
+	if(result == NULL)return NULL;
+	for(size_t i = 0; i < curves.size(); i++)
+	{
+		const CCurve &curve = curves[i];
+		PyObject* vertices = PyList_New(curve.size());
+		if(vertices == NULL)
+		{
+			Py_DECREF(result);
+			return NULL;
+		}
+		for(size_t j = 0; j < curve.size(); j++)
+		{
+			const CCurveVertex &v = curve[j];
+			PyList_SET_ITEM(vertices, j, Py_BuildValue("(idddd)", v.type, v.x, v.y, v.cx, v.cy));
+		}
+		PyList_SET_ITEM(result, i, vertices);
+	}
+	return result;
+}
+
+// zigzag(curves, stepover, unidirectional, angle, start_offset, tolerance), for postprocessor/zigzag.py
+// It returns the zigs as lists of (type, x, y, cx, cy), like the curves.
+static PyObject* heekscnc_zigzag(PyObject* self, PyObject* args)
+{
+	PyObject* curves_object;
+	double stepover, angle, start_offset, tolerance;
+	int unidirectional;
+	if(!PyArg_ParseTuple(args, "Odiddd", &curves_object, &stepover, &unidirectional, &angle, &start_offset, &tolerance))return NULL;
+	if(stepover <= 0.0)
+	{
+		PyErr_SetString(PyExc_ValueError, "stepover must be more than zero");
+		return NULL;
+	}
+
+	std::vector<CCurve> curves;
+	if(!GetCurves(curves_object, curves))return NULL;
+
+	std::vector<CCurve> zigs;
+	CZigZag::Make(curves, stepover, unidirectional != 0, angle, start_offset, tolerance, zigs);
+	return CurvesToList(zigs);
+}
+
+// adaptive(material_curves, boundary_curves, tool_radius, stepover, climb), for postprocessor/adaptive.py
+// It returns the paths of the centre of the cutter as lists of (type, x, y, cx, cy), like the curves, or None if the pocket is too big for it.
+static PyObject* heekscnc_adaptive(PyObject* self, PyObject* args)
+{
+	PyObject* material_object;
+	PyObject* boundary_object;
+	double tool_radius, stepover;
+	int climb;
+	if(!PyArg_ParseTuple(args, "OOddi", &material_object, &boundary_object, &tool_radius, &stepover, &climb))return NULL;
+	if(tool_radius <= 0.0 || stepover <= 0.0)
+	{
+		PyErr_SetString(PyExc_ValueError, "tool radius and stepover must be more than zero");
+		return NULL;
+	}
+
+	std::vector<CCurve> material_curves, boundary_curves;
+	if(!GetCurves(material_object, material_curves))return NULL;
+	if(!GetCurves(boundary_object, boundary_curves))return NULL;
+
+	std::vector<CCurve> paths;
+	if(!CAdaptive::Make(material_curves, boundary_curves, tool_radius, stepover, climb != 0, paths))Py_RETURN_NONE;
+	return CurvesToList(paths);
+}
+
+static const char* feed_possible_capsule_name = "heekscnc.FeedPossible";
+
+static void heekscnc_delete_feed_possible(PyObject* capsule)
+{
+	delete (CFeedPossible*)PyCapsule_GetPointer(capsule, feed_possible_capsule_name);
+}
+
+// feed_possible_area(curves, tool_radius), for area_funcs.py; makes the area to give to feed_possible
+static PyObject* heekscnc_feed_possible_area(PyObject* self, PyObject* args)
+{
+	PyObject* curves_object;
+	double tool_radius;
+	if(!PyArg_ParseTuple(args, "Od", &curves_object, &tool_radius))return NULL;
+
+	std::vector<CCurve> curves;
+	if(!GetCurves(curves_object, curves))return NULL;
+
+	CFeedPossible* feed_possible = new CFeedPossible(curves, tool_radius);
+	PyObject* capsule = PyCapsule_New(feed_possible, feed_possible_capsule_name, heekscnc_delete_feed_possible);
+	if(capsule == NULL)delete feed_possible;
+	return capsule;
+}
+
+// feed_possible(area, x0, y0, x1, y1)
+static PyObject* heekscnc_feed_possible(PyObject* self, PyObject* args)
+{
+	PyObject* capsule;
+	double x0, y0, x1, y1;
+	if(!PyArg_ParseTuple(args, "Odddd", &capsule, &x0, &y0, &x1, &y1))return NULL;
+	CFeedPossible* feed_possible = (CFeedPossible*)PyCapsule_GetPointer(capsule, feed_possible_capsule_name);
+	if(feed_possible == NULL)return NULL;
+	return PyBool_FromLong(feed_possible->Possible(x0, y0, x1, y1));
+}
+
+static const char* drop_cutter_mesh_capsule_name = "heekscnc.DropCutterMesh";
+
+static void heekscnc_delete_drop_cutter_mesh(PyObject* capsule)
+{
+	delete (DropCutterMesh*)PyCapsule_GetPointer(capsule, drop_cutter_mesh_capsule_name);
+}
+
+// drop_cutter_mesh(stl_file), for nc/attach.py; reads the triangles to give to drop_cutter
+static PyObject* heekscnc_drop_cutter_mesh(PyObject* self, PyObject* args)
+{
+	const char* filepath;
+	if(!PyArg_ParseTuple(args, "s", &filepath))return NULL;
+
+	DropCutterMesh* mesh = new DropCutterMesh;
+	if(!mesh->ReadSTLFile(filepath))
+	{
+		delete mesh;
+		PyErr_SetFromErrnoWithFilename(PyExc_IOError, (char*)filepath);
+		return NULL;
+	}
+	mesh->Build();
+
+	PyObject* capsule = PyCapsule_New(mesh, drop_cutter_mesh_capsule_name, heekscnc_delete_drop_cutter_mesh);
+	if(capsule == NULL)delete mesh;
+	return capsule;
+}
+
+// drop_cutter(mesh, radius, corner_radius, tolerance, minz, points, filter_tolerance = None)
+// points is a list of (x, y); it returns a list of the heights of the tip of the cutter at them, no lower than minz.
+// With filter_tolerance, it returns a list of (x, y, z) instead, leaving out the ones within filter_tolerance of the line past them
+static PyObject* heekscnc_drop_cutter(PyObject* self, PyObject* args)
+{
+	PyObject* capsule;
+	PyObject* points_object;
+	double radius, corner_radius, tolerance, minz;
+	PyObject* filter_object = Py_None;
+	if(!PyArg_ParseTuple(args, "OddddO|O", &capsule, &radius, &corner_radius, &tolerance, &minz, &points_object, &filter_object))return NULL;
+	double filter_tolerance = 0.0;
+	if(filter_object != Py_None)
+	{
+		filter_tolerance = PyFloat_AsDouble(filter_object);
+		if(PyErr_Occurred())return NULL;
+	}
+	DropCutterMesh* mesh = (DropCutterMesh*)PyCapsule_GetPointer(capsule, drop_cutter_mesh_capsule_name);
+	if(mesh == NULL)return NULL;
+	if(radius <= 0.0 || corner_radius < 0.0 || corner_radius > radius)
+	{
+		PyErr_SetString(PyExc_ValueError, "the radius must be more than zero, and the corner radius no more than the radius");
+		return NULL;
+	}
+
+	PyObject* points_sequence = PySequence_Fast(points_object, "points must be a list");
+	if(points_sequence == NULL)return NULL;
+	Py_ssize_t num_points = PySequence_Fast_GET_SIZE(points_sequence);
+	std::vector<double> points(num_points * 3);
+	for(Py_ssize_t i = 0; i < num_points; i++)
+	{
+		if(!PyArg_ParseTuple(PySequence_Fast_GET_ITEM(points_sequence, i), "dd", &points[i * 3], &points[i * 3 + 1]))
+		{
+			Py_DECREF(points_sequence);
+			return NULL;
+		}
+	}
+	Py_DECREF(points_sequence);
+
+	mesh->Drop(Cutter(radius, corner_radius, tolerance), points, minz);
+
+	if(filter_object != Py_None)
+	{
+		DropCutterMesh::Filter(points, filter_tolerance);
+		Py_ssize_t num_kept = (Py_ssize_t)(points.size() / 3);
+		PyObject* result = PyList_New(num_kept);
+		if(result == NULL)return NULL;
+		for(Py_ssize_t i = 0; i < num_kept; i++)PyList_SET_ITEM(result, i, Py_BuildValue("(ddd)", points[i * 3], points[i * 3 + 1], points[i * 3 + 2]));
+		return result;
+	}
+
+	PyObject* result = PyList_New(num_points);
+	if(result == NULL)return NULL;
+	for(Py_ssize_t i = 0; i < num_points; i++)PyList_SET_ITEM(result, i, PyFloat_FromDouble(points[i * 3 + 2]));
+	return result;
+}
+
+static PyMethodDef heekscnc_methods[] = {
+	{"output", heekscnc_output, METH_VARARGS, "writes to the output window"},
+	{"error", heekscnc_error, METH_VARARGS, "writes to the output window, as an error"},
+	{"backplot", heekscnc_backplot, METH_VARARGS, "gives some of the binary backplot to HeeksCNC"},
+	{"zigzag", heekscnc_zigzag, METH_VARARGS, "makes the zig zag paths for a pocket"},
+	{"feed_possible_area", heekscnc_feed_possible_area, METH_VARARGS, "makes an area for feed_possible"},
+	{"feed_possible", heekscnc_feed_possible, METH_VARARGS, "true if the cutter can feed from one point to another without leaving the area"},
+	{"adaptive", heekscnc_adaptive, METH_VARARGS, "makes the adaptive clearing paths for a pocket"},
+	{"drop_cutter_mesh", heekscnc_drop_cutter_mesh, METH_VARARGS, "reads the triangles of an STL file for drop_cutter"},
+	{"drop_cutter", heekscnc_drop_cutter, METH_VARARGS, "gives the heights of the cutter dropped onto the triangles at some points"},
+	{NULL, NULL, 0, NULL}
+};
+
+// the python part of the heekscnc module
+static const char* heekscnc_python =
+	"import sys\n"
+	"import os\n"
+	"\n"
+	"class Output:\n"
+	"    # stands in for sys.stdout and sys.stderr\n"
+	"    def __init__(self, write):\n"
+	"        self.write = write\n"
+	"    def flush(self):\n"
+	"        pass\n"
+	"\n"
+	"class BackplotFile:\n"
+	"    # stands in for the file that HbinWriter writes to\n"
+	"    def write(self, s):\n"
+	"        backplot(s)\n"
+	"    def flush(self):\n"
+	"        pass\n"
+	"    def close(self):\n"
+	"        pass\n"
+	"\n"
+	"def run_begin():\n"
+	"    sys.stdout = Output(output)\n"
+	"    sys.stderr = Output(error)\n"
+	"    sys.argv = ['']\n"
+	"    return (list(sys.path), set(sys.modules.keys()))\n"
+	"\n"
+	"def run_end(state):\n"
+	"    old_path, old_modules = state\n"
+	"    # forget the python modules from the folders which the program added to sys.path\n"
+	"    folders = []\n"
+	"    for p in sys.path:\n"
+	"        if p not in old_path:\n"
+	"            folders.append(os.path.join(os.path.abspath(p), ''))\n"
+	"    for name in list(sys.modules.keys()):\n"
+	"        if name in old_modules:\n"
+	"            continue\n"
+	"        module = sys.modules[name]\n"
+	"        if module == None:\n"
+	"            del sys.modules[name]\n"
+	"            continue\n"
+	"        f = getattr(module, '__file__', None)\n"
+	"        if f == None or os.path.splitext(f)[1] not in ['.py', '.pyc', '.pyo']:\n"
+	"            continue\n"
+	"        f = os.path.abspath(f)\n"
+	"        for folder in folders:\n"
+	"            if f.startswith(folder):\n"
+	"                del sys.modules[name]\n"
+	"                break\n"
+	"    sys.path[:] = old_path\n"
+	"    sys.stdout = sys.__stdout__\n"
+	"    sys.stderr = sys.__stderr__\n";
+
+// makes the heekscnc module, or returns NULL
+static PyObject* StartHeeksCNCModule(void)
+{
+	PyObject* module = Py_InitModule("heekscnc", heekscnc_methods);
+	if(module == NULL)return NULL;
+	PyObject* dict = PyModule_GetDict(module);
+	PyDict_SetItemString(dict, "__builtins__", PyEval_GetBuiltins());
+	PyObject* result = PyRun_String(heekscnc_python, Py_file_input, dict, dict);
+	if(result == NULL)
+	{
+		PyErr_Print();
+		return NULL;
+	}
+	Py_DECREF(result);
+	Py_INCREF(module);
+
+	// these take the longest to import, so import them now, if they can be found
+	const char* slow_modules[] = {"area", "ocl", NULL};
+	for(int i = 0; slow_modules[i]; i++)
+	{
+		PyObject* m = PyImport_ImportModule(slow_modules[i]);
+		if(m)Py_DECREF(m);
+		else PyErr_Clear();
+	}
+
+	return module;
+}
+
+CPythonInterpreter::CPythonInterpreter(void): m_started(false), m_heekscnc_module(NULL), m_thread_state(NULL), m_run_thread_id(0), m_running(false)
+{
+	static char program_name[] = "heekscnc";
+	Py_SetProgramName(program_name);
+	Py_InitializeEx(0); // leave the signals to HeeksCAD
+	if(!Py_IsInitialized())return;
+	m_started = true;
+
+	// the programs are run on another thread, so HeeksCAD can be redrawn, and the program cancelled, while they run
+	PyEval_InitThreads();
+	m_heekscnc_module = StartHeeksCNCModule();
+	m_thread_state = PyEval_SaveThread();
+}
+
+CPythonInterpreter::~CPythonInterpreter(void)
+{
+	if(!m_started)return;
+	PyEval_RestoreThread((PyThreadState*)m_thread_state);
+	if(m_heekscnc_module)Py_DECREF((PyObject*)m_heekscnc_module);
+	Py_Finalize();
+}
+
+//static
+CPythonInterpreter* CPythonInterpreter::Get(void)
+{
+	if(m_object == NULL && !m_failed)
+	{
+		m_object = new CPythonInterpreter;
+		if(m_object->m_heekscnc_module == NULL)
+		{
+			wxLogMessage(_T("couldn't start the python interpreter"));
+			m_failed = true;
+		}
+	}
+	return m_failed ? NULL : m_object;
+}
+
+//static
+bool CPythonInterpreter::BuiltIn(void)
+{
+	return true;
+}
+
+//static
+void CPythonInterpreter::Finish(void)
+{
+	delete m_object;
+	m_object = NULL;
+}
+
+static void LogOutput(void)
+{
+	if(output_text.Length() > 0)wxLogMessage(_T("> %s"), output_text.c_str());
+	if(error_text.Length() > 0)wxLogMessage(_T("! %s"), error_text.c_str());
+	output_text.Clear();
+	error_text.Clear();
+}
+
+bool CPythonInterpreter::Run(const wxString& python, const wxString& filename)
+{
+	PyGILState_STATE gil_state = PyGILState_Ensure();
+	m_run_thread_id = PyThreadState_Get()->thread_id;
+	bool success = RunWithGIL(python, filename);
+	m_run_thread_id = 0;
+	PyGILState_Release(gil_state);
+	return success;
+}
+
+bool CPythonInterpreter::RunWithGIL(const wxString& python, const wxString& filename)
+{
+	PyObject* state = PyObject_CallMethod((PyObject*)m_heekscnc_module, (char*)"run_begin", NULL);
+	if(state == NULL)
+	{
+		PyErr_Print();
+		return false;
+	}
+
+	// a new __main__ for each program, so nothing is left from the last one
+	PyObject* main_module = PyModule_New("__main__");
+	PyObject* globals = PyModule_GetDict(main_module);
+	PyDict_SetItemString(globals, "__builtins__", PyEval_GetBuiltins());
+	PyDict_SetItemString(PyImport_GetModuleDict(), "__main__", main_module);
+
+	const wxCharBuffer python_buffer = python.mb_str(wxConvUTF8);
+	const wxCharBuffer filename_buffer = filename.mb_str(wxConvUTF8);
+	bool success = false;
+	PyObject* code = Py_CompileString(python_buffer.data(), filename_buffer.data(), Py_file_input);
+	if(code)
+	{
+		PyObject* result = PyEval_EvalCode((PyCodeObject*)code, globals, globals);
+		if(result)
+		{
+			success = true;
+			Py_DECREF(result);
+		}
+		Py_DECREF(code);
+	}
+	if(!success)
+	{
+		// PyErr_Print would exit HeeksCAD for SystemExit
+		if(PyErr_ExceptionMatches(PyExc_SystemExit))
+		{
+			PyErr_Clear();
+			success = true;
+		}
+		else if(PyErr_ExceptionMatches(PyExc_KeyboardInterrupt))
+		{
+			// from Cancel
+			PyErr_Clear();
+			error_text += _T("cancelled\n");
+		}
+		else PyErr_Print();
+	}
+
+	// closes the files which the program left open
+	PyObject* empty_main = PyModule_New("__main__");
+	PyDict_SetItemString(PyImport_GetModuleDict(), "__main__", empty_main);
+	Py_DECREF(empty_main);
+	Py_DECREF(main_module);
+
+	PyObject* result = PyObject_CallMethod((PyObject*)m_heekscnc_module, (char*)"run_end", (char*)"(O)", state);
+	if(result)Py_DECREF(result);
+	else PyErr_Print();
+	Py_DECREF(state);
+
+	return success;
+}
+
+// runs a program on a thread of its own
+class CPythonThread : public wxThread
+{
+	CPythonInterpreter* m_interpreter;
+	const wxString& m_python;
+	const wxString& m_filename;
+
+public:
+	volatile bool m_finished;
+	bool m_success;
+
+	CPythonThread(CPythonInterpreter* interpreter, const wxString& python, const wxString& filename)
+		: wxThread(wxTHREAD_JOINABLE), m_interpreter(interpreter), m_python(python), m_filename(filename), m_finished(false), m_success(false) {}
+
+	ExitCode Entry()
+	{
+		m_success = m_interpreter->Run(m_python, m_filename);
+		m_finished = true;
+		return 0;
+	}
+};
+
+// gives the backplot records which have come from python to the callback
+static void GiveBackplotData(CPythonInterpreter::DataCallback callback, void* user_data)
+{
+	std::vector<char> data;
+	{
+		wxMutexLocker lock(backplot_mutex);
+		data.swap(backplot_data);
+	}
+	if(callback && data.size() > 0)(*callback)(&data[0], data.size(), user_data);
+}
+
+bool CPythonInterpreter::RunInThread(const wxString& python, const wxString& filename, const wxString& title, PollCallback poll, DataCallback data_callback, void* user_data)
+{
+	if(m_running)
+	{
+		wxLogMessage(_T("python is already running a program"));
+		return false;
+	}
+	m_running = true;
+
+	CPythonThread thread(this, python, filename);
+	if(thread.Create() != wxTHREAD_NO_ERROR || thread.Run() != wxTHREAD_NO_ERROR)
+	{
+		wxLogMessage(_T("couldn't start a thread for python"));
+		m_running = false;
+		return false;
+	}
+
+	// the dialog is only shown for programs which take a while
+	wxProgressDialog* dialog = NULL;
+	wxStopWatch stop_watch;
+	bool cancelled = false;
+	while(!thread.m_finished)
+	{
+		wxMilliSleep(50);
+		if(dialog == NULL && stop_watch.Time() > 500)
+		{
+			dialog = new wxProgressDialog(title, _("Running python"), 100, heeksCAD->GetMainFrame(), wxPD_APP_MODAL | wxPD_CAN_ABORT | wxPD_ELAPSED_TIME);
+		}
+		if(dialog && !dialog->Pulse() && !cancelled)
+		{
+			Cancel();
+			cancelled = true;
+		}
+		GiveBackplotData(data_callback, user_data);
+		if(poll)(*poll)(user_data);
+	}
+	thread.Wait();
+	delete dialog;
+
+	GiveBackplotData(data_callback, user_data);
+	LogOutput();
+	m_running = false;
+
+	return thread.m_success;
+}
+
+void CPythonInterpreter::Cancel(void)
+{
+	// raises KeyboardInterrupt in the program, the next time it runs some python
+	PyGILState_STATE gil_state = PyGILState_Ensure();
+	if(m_run_thread_id)PyThreadState_SetAsyncExc(m_run_thread_id, PyExc_KeyboardInterrupt);
+	PyGILState_Release(gil_state);
+}
+
+bool CPythonInterpreter::Backplot(const wxString& nc_folder, const wxString& reader, const wxString& nc_file, DataCallback callback, void* user_data)
+{
+	Python python;
+	python << _T("import sys\n");
+	python << _T("sys.path.insert(0, ") << PythonString(nc_folder) << _T(")\n");
+	python << _T("import heekscnc\n");
+	python << _T("from nc.hbin_writer import HbinWriter\n");
+	python << _T("machine_module = __import__('nc.' + ") << PythonString(reader) << _T(", fromlist = ['dummy'])\n");
+	python << _T("parser = machine_module.Parser(HbinWriter(heekscnc.BackplotFile()))\n");
+	python << _T("parser.Parse(") << PythonString(nc_file) << _T(")\n");
+
+	{
+		wxMutexLocker lock(backplot_mutex);
+		backplot_data.clear();
+		backplot_wanted = true;
+	}
+	bool success = RunInThread(python, _T("<backplot>"), _("Backplotting"), NULL, callback, user_data);
+	{
+		wxMutexLocker lock(backplot_mutex);
+		backplot_wanted = false;
+		backplot_data.clear();
+	}
+
+	return success;
+}
+
+#else
+
+CPythonInterpreter::CPythonInterpreter(void): m_started(false), m_heekscnc_module(NULL)
+{
+}
+
+CPythonInterpreter::~CPythonInterpreter(void)
+{
+}
+
+//static
+CPythonInterpreter* CPythonInterpreter::Get(void)
+{
+	return NULL;
+}
+
+//static
+bool CPythonInterpreter::BuiltIn(void)
+{
+	return false;
+}
+
+//static
+void CPythonInterpreter::Finish(void)
+{
+}
+
+bool CPythonInterpreter::Run(const wxString& python, const wxString& filename)
+{
+	return false;
+}
+
+bool CPythonInterpreter::RunInThread(const wxString& python, const wxString& filename, const wxString& title, PollCallback poll, DataCallback data_callback, void* user_data)
+{
+	return false;
+}
+
+void CPythonInterpreter::Cancel(void)
+{
+}
+
+bool CPythonInterpreter::Backplot(const wxString& nc_folder, const wxString& reader, const wxString& nc_file, DataCallback callback, void* user_data)
+{
+	return false;
+}
+
+#endif
@@ -0,0 +1,64 @@
+// PythonInterpreter.h
+/*
+ * Copyright (c) 2009, Dan Heeks
+ * This program is released under the BSD license. See the file COPYING for
+ * details.
+ */
+
+// A python interpreter inside HeeksCNC, for posting and backplotting without starting a new python process each time.
+// It is started the first time it is needed and kept until HeeksCNC is unloaded, so extension modules, like area and ocl,
+// are only imported once. The python modules from the HeeksCNC folders, like the nc package, are imported again for each
+// program, so each program starts with a new nc.creator.
+// It is only built in if CMake finds the python libraries, which defines HEEKSCNC_EMBEDDED_PYTHON.
+
+#pragma once
+
+#include <cstddef>
+
+class CPythonInterpreter
+{
+public:
+	typedef void (*DataCallback)(const char* data, size_t length, void* user_data);
+	typedef void (*PollCallback)(void* user_data);
+
+	// returns NULL if HeeksCNC was built without python, or python couldn't be started
+	static CPythonInterpreter* Get(void);
+
+	// true if HeeksCNC was built with python, without starting it
+	static bool BuiltIn(void);
+
+	// stops python, if it was started
+	static void Finish(void);
+
+	// Runs a python program, like post.py, in a new __main__ module, on the thread it is called from.
+	// sys.path is put back afterwards, and the python modules imported from the folders it added are forgotten.
+	bool Run(const wxString& python, const wxString& filename);
+
+	// Runs the program with Run on a thread of its own, and waits for it, showing a dialog with a Cancel button if it takes a while.
+	// poll is called about every 50 ms while it waits, on the thread RunInThread was called from; data_callback gets what
+	// the program gave to heekscnc.backplot, on that thread, too. What the program printed goes to the log afterwards.
+	// Returns false, without running it, if another program is running.
+	bool RunInThread(const wxString& python, const wxString& filename, const wxString& title, PollCallback poll = NULL, DataCallback data_callback = NULL, void* user_data = NULL);
+
+	// stops the program which RunInThread is running, with a KeyboardInterrupt
+	void Cancel(void);
+
+	// Runs the backplot, like backplot.py does, with nc/hbin_writer.py, but gives the binary records to callback, instead of writing them to a file.
+	// nc_folder is the folder with the nc package in it.
+	bool Backplot(const wxString& nc_folder, const wxString& reader, const wxString& nc_file, DataCallback callback, void* user_data);
+
+private:
+	CPythonInterpreter(void);
+	~CPythonInterpreter(void);
+
+	bool RunWithGIL(const wxString& python, const wxString& filename);
+
+	bool m_started;
+	void* m_heekscnc_module; // PyObject*
+	void* m_thread_state; // PyThreadState* of the main thread, while it hasn't got the GIL
+	long m_run_thread_id; // the python thread id of the thread in Run, for Cancel
+	bool m_running; // in RunInThread
+
+	static CPythonInterpreter* m_object;
+	static bool m_failed;
+};
@@ -0,0 +1,126 @@
+// PythonNumber.cpp
+// Copyright (c) 2010, Dan Heeks
+// This program is released under the BSD license. See the file COPYING for details.
+#include "stdafx.h"
+#include "PythonNumber.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/**
+	Finds the 10 digits, and the exponent, which sprintf's "%.9e" would give, without sprintf, for the numbers
+	from 0.0001 up to 10000000000, which are nearly all the numbers in a program.
+	value * 10^(9 - exponent) is within a millionth of the exact value, as the power of ten is exact, so the
+	rounding to a whole number is the same, unless it is nearly half way; false is returned for those.
+ */
+static bool FastDigits( const double value, char* digits, int &exponent )
+{
+	static const double powers[] = {1e-4, 1e-3, 1e-2, 1e-1, 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13};
+	const double* power_of_one = powers + 4;
+
+	double a = fabs(value);
+	if(a < 1e-4 || a >= 1e10)return false;
+
+	// the nearest doubles to the powers of ten sort the doubles the same way as the exact powers do
+	exponent = 9;
+	while(a < power_of_one[exponent])exponent--;
+
+	double scaled = a * power_of_one[9 - exponent];
+	double whole = floor(scaled);
+	double fraction = scaled - whole;
+	if(fabs(fraction - 0.5) < 1e-5)return false;
+	if(fraction > 0.5)whole += 1.0;
+	if(whole >= 1e10)
+	{
+		// rounded up to the next power of ten
+		whole = 1e9;
+		exponent++;
+	}
+
+	long long n = (long long)whole;
+	for(int i = 9; i >= 0; i--)
+	{
+		digits[i] = (char)('0' + n % 10);
+		n /= 10;
+	}
+	return true;
+}
+
+/**
+	Writes value as std::ostream does with std::setprecision(10) in the "C" locale, like "%.10g",
+	but without making a stream and a locale for each number. Programs have a lot of numbers.
+	FastDigits does the rounding, or sprintf's "%.9e", whose decimal point, for the current locale, is skipped.
+	Returns the number of characters written; text needs room for 24.
+ */
+int FormatNumber( const double value, char* text )
+{
+	if(value != value || value - value != value - value)
+	{
+		// nan or inf
+		return sprintf(text, "%g", value);
+	}
+
+	bool minus = (value < 0.0 || (value == 0.0 && 1.0 / value < 0.0));
+	char digits[10];
+	int number_of_digits = 10;
+	int exponent = 0;
+	if(!FastDigits(value, digits, exponent))
+	{
+		char e[32];
+		sprintf(e, "%.9e", value);
+
+		// read the 10 digits and the exponent
+		const char* c = e;
+		if(*c == '-')c++;
+		number_of_digits = 0;
+		for(; *c && *c != 'e' && *c != 'E'; c++)
+		{
+			if(*c >= '0' && *c <= '9' && number_of_digits < 10)digits[number_of_digits++] = *c;
+		}
+		exponent = (*c) ? atoi(c + 1) : 0;
+	}
+
+	// leave out the trailing zeros
+	while(number_of_digits > 1 && digits[number_of_digits - 1] == '0')number_of_digits--;
+
+	char* t = text;
+	if(minus)*t++ = '-';
+
+	if(exponent < -4 || exponent >= 10)
+	{
+		*t++ = digits[0];
+		if(number_of_digits > 1)
+		{
+			*t++ = '.';
+			for(int i = 1; i < number_of_digits; i++)*t++ = digits[i];
+		}
+		t += sprintf(t, "e%c%02d", (exponent < 0) ? '-' : '+', abs(exponent));
+	}
+	else if(exponent < 0)
+	{
+		*t++ = '0';
+		*t++ = '.';
+		for(int i = -1; i > exponent; i--)*t++ = '0';
+		for(int i = 0; i < number_of_digits; i++)*t++ = digits[i];
+	}
+	else
+	{
+		for(int i = 0; i <= exponent; i++)*t++ = (i < number_of_digits) ? digits[i] : '0';
+		if(number_of_digits > exponent + 1)
+		{
+			*t++ = '.';
+			for(int i = exponent + 1; i < number_of_digits; i++)*t++ = digits[i];
+		}
+	}
+
+	*t = 0;
+	return (int)(t - text);
+}
+
+double PythonNumber( const double value )
+{
+	// sprintf and strtod use the same decimal point
+	char e[32];
+	sprintf(e, "%.9e", value);
+	return(strtod(e, NULL));
+}
@@ -0,0 +1,10 @@
+// PythonNumber.h
+// Copyright (c) 2010, Dan Heeks
+// This program is released under the BSD license. See the file COPYING for details.
+
+// The numbers written in the python programs. They are apart from PythonString.h, without wx, so test/python_text.cpp can check and time them.
+
+#pragma once
+
+int FormatNumber( const double value, char* text ); // like "%.10g" in the "C" locale; text needs room for 24 characters; returns the length
+double PythonNumber( const double value ); // the number python gets from PythonString( value )
@@ -42,26 +42,35 @@ wxString PythonString( const wxString value )
 
 wxString PythonString( const double value )
 {
-	#ifdef UNICODE
-        std::wostringstream _value;
-    #else
-        std::ostringstream _value;
-    #endif
-        _value.imbue(std::locale("C"));
-        _value<<std::setprecision(10);
-        _value << value;
-
-        return(_value.str().c_str());
+	char text[32];
+	FormatNumber(value, text);
+	return(wxString::FromAscii(text));
+}
+
+// Programs are built from a lot of small pieces, so, when there isn't room, room is made for as much again,
+// whichever way the wxString being used grows, so the text isn't copied for each piece.
+void Python::Reserve( const size_t more )
+{
+	size_t needed = Len() + more;
+	if(needed > capacity())Alloc(needed * 2);
 }
 
 Python & Python::operator<<( const double value )
 {
-	wxString::operator<<(PythonString(value));
+	char text[32];
+	int length = FormatNumber(value, text);
+
+	// the characters are all ASCII
+	wxChar characters[32];
+	for(int i = 0; i <= length; i++)characters[i] = text[i];
+	Reserve(length);
+	Append(characters, length);
 	return(*this);
 }
 
 Python & Python::operator<< ( const Python & value )
 {
+	Reserve(value.Len());
 	wxString::operator<<(value);
 	return(*this);
 }
@@ -69,6 +78,7 @@ Python & Python::operator<< ( const Python & value )
 
 Python & Python::operator<< ( const wxChar *value )
 {
+	Reserve(wxStrlen(value));
 	wxString::operator<<(value);
 	return(*this);
 }
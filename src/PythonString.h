@@ -2,6 +2,8 @@
 
 #pragma once
 
+#include "PythonNumber.h"
+
 wxString PythonString( const wxString value );
 wxString PythonString( const double value );
 
@@ -14,5 +16,8 @@ public:
 	Python & operator<< ( const wxChar *value );
 	Python & operator<< ( const int value );
 
+private:
+	void Reserve( const size_t more );
+
 }; // End Python class definition
 
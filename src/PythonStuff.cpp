@@ -4,16 +4,22 @@
 
 #include "stdafx.h"
 #include <wx/file.h>
+#include <wx/ffile.h>
 #include <wx/mimetype.h>
 #include <wx/stdpaths.h>
 #include <wx/filename.h>
 #include <wx/txtstrm.h>
 #include <wx/log.h>
+#include <wx/stopwatch.h>
 #include "PythonStuff.h"
 #include "ProgramCanvas.h"
 #include "OutputCanvas.h"
 #include "Program.h"
 #include "CNCConfig.h"
+#include "NCCode.h"
+#include "IsoReader.h"
+#include "NCCodeLoader.h"
+#include "PythonInterpreter.h"
 
 //static
 bool CPyProcess::redirect = false;
@@ -21,6 +27,7 @@ bool CPyProcess::redirect = false;
 CPyProcess::CPyProcess(void)
 {
   m_pid = 0;
+  m_poll = false;
   wxProcess(heeksCAD->GetMainFrame());
   Connect(wxEVT_TIMER, wxTimerEventHandler(CPyProcess::OnTimer));
   m_timer.SetOwner(this);
@@ -29,7 +36,8 @@ CPyProcess::CPyProcess(void)
 
 void CPyProcess::OnTimer(wxTimerEvent& event)
 {
-  HandleInput();
+  if (redirect) HandleInput();
+  if (m_poll) Poll();
 }
 
 void CPyProcess::HandleInput(void) {
@@ -74,7 +82,7 @@ void CPyProcess::Execute(const wxChar* cmd)
 	} else {
 	  wxLogMessage(_T("starting '%s' (%d)"),cmd,m_pid);
 	}
-	if (redirect) {
+	if (redirect || m_poll) {
 		m_timer.Start(100);   //msec
 	}
 }
@@ -117,8 +125,10 @@ void CPyProcess::OnTerminate(int pid, int status)
 {
 	if (pid == m_pid)
 	{
-	  if (redirect) {
+	  if (redirect || m_poll) {
 		  m_timer.Stop();
+	  }
+	  if (redirect) {
 		  HandleInput();   // anything left?
 	  }
 	  if (status) {
@@ -134,6 +144,249 @@ void CPyProcess::OnTerminate(int pid, int status)
 
 ////////////////////////////////////////////////////////
 
+// every way of backplotting logs its time like this, so they can be compared on the same file
+static void LogBackplotTime(const CNCCode* nc_code, const wxChar* how, long ms)
+{
+	wxLogMessage(_T("backplotted %u NC blocks, %u moves, %s, in %ld ms"), (unsigned int)nc_code->m_blocks.size(), (unsigned int)nc_code->m_moves.size(), how, ms);
+}
+
+// Reads the NC file straight into the program's NC code, without running python, if the
+// machine's reader is one that CIsoReader can stand in for. Returns false if it can't.
+static bool NativeBackplot(const CProgram* program, HeeksObj* into, const wxString &filepath)
+{
+	if (!theApp.m_use_native_nc_reader) return false;
+	if (!CIsoReader::CanRead(program->m_machine.reader)) return false;
+	if ((into == NULL) || (into->GetType() != ProgramType)) return false;
+
+	CNCCode* nc_code = ((CProgram*)into)->NCCode();
+	if (nc_code == NULL) return false;
+
+	wxBusyCursor wait;
+	wxStopWatch stop_watch;
+
+	nc_code->Clear();
+	nc_code->m_user_edited = false;
+
+	CIsoReader reader(nc_code);
+	if (!reader.ReadFile(filepath))
+	{
+		wxMessageBox(wxString(_("Couldn't open file")) + _T(" - ") + filepath);
+	}
+
+	LogBackplotTime(nc_code, _T("with the built-in reader"), stop_watch.Time());
+
+	nc_code->SetTextCtrl(theApp.m_output_canvas->m_textCtrl);
+	heeksCAD->Repaint();
+
+	return true;
+}
+
+// the folder with backplot.py and the nc package in it
+static wxString BackplotFolder(void)
+{
+#ifdef WIN32
+	return theApp.GetDllFolder() + _T("\\");
+#else
+	#ifdef RUNINPLACE
+		return theApp.GetDllFolder() +_T("/");
+	#else
+		#ifdef CMAKE_UNIX
+			return _T("/usr/local/lib/heekscnc/");
+		#else
+			return theApp.GetDllFolder() + _T("/../heekscnc/");
+		#endif
+	#endif
+#endif
+}
+
+// the binary records from the embedded interpreter, which can come in pieces of any size
+class CEmbeddedBackplotData
+{
+public:
+	CNCCodeLoader m_loader;
+	std::vector<char> m_kept; // the start of a record which hasn't all been given yet
+
+	CEmbeddedBackplotData(CNCCode* nc_code): m_loader(nc_code) {}
+
+	static void Callback(const char* data, size_t length, void* user_data)
+	{
+		CEmbeddedBackplotData* d = (CEmbeddedBackplotData*)user_data;
+		d->m_kept.insert(d->m_kept.end(), data, data + length);
+		size_t used = d->m_loader.Decode(&d->m_kept[0], d->m_kept.size());
+		d->m_kept.erase(d->m_kept.begin(), d->m_kept.begin() + used);
+	}
+};
+
+// Backplots with the python interpreter inside HeeksCNC, with the binary records going straight to a CNCCodeLoader.
+// Returns false if there isn't an interpreter, or it failed, so the backplot can be done by a python process instead.
+static bool EmbeddedBackplot(const CProgram* program, HeeksObj* into, const wxString &filepath)
+{
+	if (!theApp.m_use_embedded_python) return false;
+	if (program->m_machine.reader == _T("not found")) return false;
+	CPythonInterpreter* interpreter = CPythonInterpreter::Get();
+	if (interpreter == NULL) return false;
+
+	CNCCode* nc_code = NULL;
+	if((into != NULL) && (into->GetType() == ProgramType))nc_code = ((CProgram*)into)->NCCode();
+	bool added = (nc_code != NULL);
+	if(!added)nc_code = new CNCCode;
+
+	wxBusyCursor wait;
+	wxStopWatch stop_watch;
+
+	nc_code->Clear();
+	nc_code->m_user_edited = false;
+
+	bool success;
+	{
+		CEmbeddedBackplotData data(nc_code);
+		success = interpreter->Backplot(BackplotFolder(), program->m_machine.reader, filepath, CEmbeddedBackplotData::Callback, &data);
+		data.m_loader.Finish();
+		if(data.m_loader.Failed())success = false;
+	}
+
+	if(!success)
+	{
+		if(added)nc_code->Clear();
+		else delete nc_code;
+		return false;
+	}
+
+	LogBackplotTime(nc_code, _T("with the embedded python"), stop_watch.Time());
+
+	if(!added)heeksCAD->Add(nc_code, into);
+	nc_code->SetTextCtrl(theApp.m_output_canvas->m_textCtrl);
+	heeksCAD->Repaint();
+
+	return true;
+}
+
+// Reads a backplot file while the process writing it is still running, adding the new blocks to the
+// NC code and showing them every half a second, so the start of the toolpath can be looked at before
+// the end of it has been written. The file is either NC code, read by CIsoReader, or the binary file
+// from nc/hbin_writer.py, read by CNCCodeLoader.
+class CBackplotTail
+{
+	CNCCode* m_nc_code;
+	HeeksObj* m_add_to; // where to add m_nc_code, when it has some blocks, if it isn't already in the document
+	bool m_added;
+	wxString m_filepath;
+	bool m_iso;
+	bool m_old_file; // there was a file there before the process started, which mustn't be read
+	time_t m_old_file_time;
+	wxULongLong m_old_file_size;
+	wxFileOffset m_offset;
+	std::vector<char> m_kept; // the start of a record which hasn't all been written yet
+	CIsoReader* m_iso_reader;
+	CNCCodeLoader* m_loader;
+	size_t m_blocks_shown;
+	wxStopWatch m_since_shown;
+
+	void Start(void)
+	{
+		delete m_iso_reader;
+		delete m_loader;
+		m_nc_code->Clear();
+		m_nc_code->m_user_edited = false;
+		m_iso_reader = m_iso ? new CIsoReader(m_nc_code) : NULL;
+		m_loader = m_iso ? NULL : new CNCCodeLoader(m_nc_code);
+		m_offset = 0;
+		m_kept.clear();
+		m_blocks_shown = 0;
+	}
+
+	void Read(const char* data, size_t length)
+	{
+		if(m_iso_reader)
+		{
+			m_iso_reader->ReadData(data, length);
+			return;
+		}
+
+		m_kept.insert(m_kept.end(), data, data + length);
+		size_t used = m_loader->Decode(&m_kept[0], m_kept.size());
+		m_kept.erase(m_kept.begin(), m_kept.begin() + used);
+	}
+
+public:
+	CBackplotTail(CNCCode* nc_code, HeeksObj* add_to, bool added, const wxString& filepath, bool iso)
+		: m_nc_code(nc_code), m_add_to(add_to), m_added(added), m_filepath(filepath), m_iso(iso), m_old_file(false), m_old_file_time(0), m_iso_reader(NULL), m_loader(NULL)
+	{
+		if(wxFileExists(m_filepath))
+		{
+			m_old_file = true;
+			m_old_file_time = wxFileModificationTime(m_filepath);
+			m_old_file_size = wxFileName::GetSize(m_filepath);
+		}
+		Start();
+	}
+
+	~CBackplotTail(void)
+	{
+		delete m_iso_reader;
+		delete m_loader;
+		if(!m_added)delete m_nc_code;
+	}
+
+	bool Failed(void)const { return m_loader && m_loader->Failed(); }
+	CNCCode* NCCode(void) { return m_nc_code; }
+
+	// reads what has been added to the file since the last call; finished means the process has ended
+	void Poll(bool finished)
+	{
+		if(!wxFileExists(m_filepath))return;
+
+		if(m_old_file && !finished)
+		{
+			// Wait until the process starts writing the file again.
+			// The time is only to the second, so a file started in the same second as the old one was written is seen by its size changing.
+			if(wxFileModificationTime(m_filepath) == m_old_file_time && wxFileName::GetSize(m_filepath) == m_old_file_size)return;
+			m_old_file = false;
+		}
+
+		wxFFile file(m_filepath, _T("rb"));
+		if(!file.IsOpened())return;
+
+		wxFileOffset length = file.Length();
+		if(length < m_offset)Start(); // it has been started again
+
+		if(length > m_offset && file.Seek(m_offset))
+		{
+			// don't hold up the user interface for too long, while the process is running
+			const size_t chunk_size = 1 << 20;
+			size_t chunks_left = finished ? (size_t)-1 : 4;
+			std::vector<char> buffer(chunk_size);
+			while(chunks_left-- > 0 && !file.Eof())
+			{
+				size_t n = file.Read(&buffer[0], chunk_size);
+				if(n == 0)break;
+				Read(&buffer[0], n);
+				m_offset += n;
+			}
+		}
+
+		if(finished)
+		{
+			if(m_iso_reader)m_iso_reader->Finish();
+			if(m_loader)m_loader->Finish();
+		}
+
+		size_t blocks = m_nc_code->m_blocks.size();
+		if(blocks > m_blocks_shown && (finished || m_blocks_shown == 0 || m_since_shown.Time() > 500))
+		{
+			if(!m_added)
+			{
+				heeksCAD->Add(m_nc_code, m_add_to);
+				m_added = true;
+			}
+			m_nc_code->OnBlocksAdded(theApp.m_output_canvas->m_textCtrl, m_blocks_shown);
+			m_blocks_shown = blocks;
+			heeksCAD->Repaint();
+			m_since_shown.Start();
+		}
+	}
+};
+
 class CPyBackPlot : public CPyProcess
 {
 protected:
@@ -141,12 +394,14 @@ protected:
 	HeeksObj* m_into;
 	wxString m_filename;
 	wxBusyCursor *m_busy_cursor;
+	CBackplotTail* m_tail;
+	wxStopWatch m_stop_watch; // from starting python to reading the last of its backplot file
 
 	static CPyBackPlot* m_object;
 
 public:
-	CPyBackPlot(const CProgram* program, HeeksObj* into, const wxChar* filename): m_program(program), m_into(into),m_filename(filename),m_busy_cursor(NULL) { m_object = this; }
-	~CPyBackPlot(void) { m_object = NULL; }
+	CPyBackPlot(const CProgram* program, HeeksObj* into, const wxChar* filename): m_program(program), m_into(into),m_filename(filename),m_busy_cursor(NULL),m_tail(NULL) { m_object = this; }
+	~CPyBackPlot(void) { delete m_tail; m_object = NULL; }
 
 	static void StaticCancel(void) { if (m_object) m_object->Cancel(); }
 
@@ -160,37 +415,51 @@ public:
 		} // End if - then
 		else
 		{
+			// don't read an old backplot file, if python fails
+			wxString backplot_file_str = theApp.m_program->GetBackplotFilePath();
+			if(wxFileExists(backplot_file_str))wxRemoveFile(backplot_file_str);
+
+			// read the blocks into the program's NC code, or into a new NC code object, as they are written
+			CNCCode* nc_code = NULL;
+			if((m_into != NULL) && (m_into->GetType() == ProgramType))nc_code = ((CProgram*)m_into)->NCCode();
+			bool added = (nc_code != NULL);
+			if(!added)nc_code = new CNCCode;
+			m_tail = new CBackplotTail(nc_code, m_into, added, backplot_file_str, false);
+			m_poll = true;
+			m_stop_watch.Start();
+
 			#ifdef WIN32
-				Execute(wxString(_T("\"")) + theApp.GetDllFolder() + _T("\\nc_read.bat\" ") + m_program->m_machine.file_name + _T(" \"") + m_filename + _T("\""));
+				Execute(wxString(_T("\"")) + theApp.GetDllFolder() + _T("\\nc_read.bat\" ") + m_program->m_machine.file_name + _T(" \"") + m_filename + _T("\" hbin"));
 			#else
-				#ifdef RUNINPLACE
-					wxString path(theApp.GetDllFolder() +_T("/"));
-				#else
-					#ifdef CMAKE_UNIX
-						wxString path(_T("/usr/local/lib/heekscnc/"));
-					#else
-						wxString path(theApp.GetDllFolder() + _T("/../heekscnc/"));
-					#endif
-				#endif
-
-				Execute(wxString(_T("python \"")) + path + wxString(_T("backplot.py\" \"")) + m_program->m_machine.reader + wxString(_T("\" \"")) + m_filename + wxString(_T("\"")) );
+				Execute(wxString(_T("python \"")) + BackplotFolder() + wxString(_T("backplot.py\" \"")) + m_program->m_machine.reader + wxString(_T("\" \"")) + m_filename + wxString(_T("\" hbin")) );
 			#endif
 		} // End if - else
 	}
+	void Poll(void)
+	{
+		if(m_tail)m_tail->Poll(false);
+	}
 	void ThenDo(void)
 	{
-		// there should now be an xml file written
-		wxString xml_file_str = theApp.m_program->GetBackplotFilePath();
-		wxFile ofs(xml_file_str.c_str());
-		if(!ofs.IsOpened())
+		// there should now be a binary backplot file written, see nc/hbin_writer.py
+		wxString backplot_file_str = theApp.m_program->GetBackplotFilePath();
+		if(!wxFileExists(backplot_file_str))
 		{
-			wxMessageBox(wxString(_("Couldn't open file")) + _T(" - ") + xml_file_str);
+			wxMessageBox(wxString(_("Couldn't open file")) + _T(" - ") + backplot_file_str);
+			delete m_busy_cursor;
+			m_busy_cursor = NULL;
 			return;
 		}
 
-		// read the xml file, just like paste, into the program
-		heeksCAD->OpenXMLFile(xml_file_str, m_into);
-		heeksCAD->Repaint();
+		// read the rest of it
+		if(m_tail)
+		{
+			m_tail->Poll(true);
+			if(m_tail->Failed())wxMessageBox(wxString(_("Invalid backplot file")) + _T(" - ") + backplot_file_str);
+			else LogBackplotTime(m_tail->NCCode(), _T("with a python process"), m_stop_watch.Time());
+			delete m_tail;
+			m_tail = NULL;
+		}
 
 		// in Windows, at least, executing the bat file was making HeeksCAD change it's Z order
 		heeksCAD->GetMainFrame()->Raise();
@@ -208,6 +477,8 @@ protected:
 	const CProgram* m_program;
 	wxString m_filename;
 	bool m_include_backplot_processing;
+	CBackplotTail* m_tail; // for reading the NC file as it is written
+	wxStopWatch m_stop_watch;
 
 	static CPyPostProcess* m_object;
 
@@ -215,12 +486,12 @@ public:
 	CPyPostProcess(const CProgram* program,
 			const wxChar* filename,
 			const bool include_backplot_processing = true ) :
-		m_program(program), m_filename(filename), m_include_backplot_processing(include_backplot_processing)
+		m_program(program), m_filename(filename), m_include_backplot_processing(include_backplot_processing), m_tail(NULL)
 	{
 		m_object = this;
 	}
 
-	~CPyPostProcess(void) { m_object = NULL; }
+	~CPyPostProcess(void) { delete m_tail; m_object = NULL; }
 
 	static void StaticCancel(void) { if (m_object) m_object->Cancel(); }
 
@@ -230,6 +501,14 @@ public:
 		wxStandardPaths& standard_paths = wxStandardPaths::Get();
 		wxFileName path( standard_paths.GetTempDir().c_str(), _T("post.py"));
 
+		// if the NC file can be read without python, show it as it is written
+		if (m_include_backplot_processing && theApp.m_use_native_nc_reader && CIsoReader::CanRead(m_program->m_machine.reader) && m_program->NCCode())
+		{
+			m_tail = new CBackplotTail(m_program->NCCode(), NULL, true, m_filename, true);
+			m_poll = true;
+			m_stop_watch.Start();
+		}
+
 #ifdef WIN32
         Execute(wxString(_T("\"")) + theApp.GetDllFolder() + wxString(_T("\\post.bat\" \"")) + path.GetFullPath() + wxString(_T("\"")));
 #else
@@ -238,17 +517,37 @@ public:
 		Execute(post_path);
 #endif
 	}
+	void Poll(void)
+	{
+		if (m_tail) m_tail->Poll(false);
+	}
 	void ThenDo(void)
 	{
-		if (m_include_backplot_processing)
+		if (m_tail)
 		{
-			(new CPyBackPlot(m_program, (HeeksObj*)m_program, m_filename))->Do();
+			m_tail->Poll(true);
+			CNCCode* nc_code = m_tail->NCCode();
+			LogBackplotTime(nc_code, _T("with the built-in reader, while post-processing"), m_stop_watch.Time());
+			delete m_tail;
+			m_tail = NULL;
+		}
+		else if (m_include_backplot_processing)
+		{
+			if (!NativeBackplot(m_program, (HeeksObj*)m_program, m_filename) && !EmbeddedBackplot(m_program, (HeeksObj*)m_program, m_filename))
+			{
+				(new CPyBackPlot(m_program, (HeeksObj*)m_program, m_filename))->Do();
+			}
 		}
 	}
 };
 
 CPyPostProcess* CPyPostProcess::m_object = NULL;
 
+static void PollTail(void* user_data)
+{
+	((CBackplotTail*)user_data)->Poll(false);
+}
+
 ////////////////////////////////////////////////////////
 
 static bool write_python_file(const wxString& python_file_path)
@@ -286,6 +585,45 @@ bool HeeksPyPostProcess(const CProgram* program, const wxString &filepath, const
 			::wxSetWorkingDirectory(standard_paths.GetTempDir());
 #endif
 
+			// run it with the python interpreter inside HeeksCNC, if there is one
+			if(theApp.m_use_embedded_python)
+			{
+				CPythonInterpreter* interpreter = CPythonInterpreter::Get();
+				if(interpreter)
+				{
+					wxBusyCursor wait;
+					wxStopWatch stop_watch;
+
+					// if the NC file can be read without python, show it as it is written, like CPyPostProcess does
+					CBackplotTail* tail = NULL;
+					if (include_backplot_processing && theApp.m_use_native_nc_reader && CIsoReader::CanRead(program->m_machine.reader) && program->NCCode())
+					{
+						tail = new CBackplotTail(program->NCCode(), NULL, true, filepath, true);
+					}
+
+					bool success = interpreter->RunInThread(theApp.m_program->m_python_program, file_str.GetFullPath(), _("Post-processing"), tail ? PollTail : NULL, NULL, tail);
+					wxLogMessage(_T("posted in %ld ms"), stop_watch.Time());
+
+					if (tail)
+					{
+						if (success)
+						{
+							tail->Poll(true);
+							LogBackplotTime(tail->NCCode(), _T("with the built-in reader, while post-processing"), stop_watch.Time());
+						}
+						delete tail;
+					}
+					else if (success && include_backplot_processing)
+					{
+						if (!NativeBackplot(program, (HeeksObj*)program, filepath) && !EmbeddedBackplot(program, (HeeksObj*)program, filepath))
+						{
+							(new CPyBackPlot(program, (HeeksObj*)program, filepath))->Do();
+						}
+					}
+					return success;
+				}
+			}
+
 			// call the python file
 			(new CPyPostProcess(program, filepath, include_backplot_processing))->Do();
 
@@ -304,6 +642,9 @@ bool HeeksPyBackplot(const CProgram* program, HeeksObj* into, const wxString &fi
 	try{
 		theApp.m_output_canvas->m_textCtrl->Clear(); // clear the output window
 
+		if (NativeBackplot(program, into, filepath)) return true;
+		if (EmbeddedBackplot(program, into, filepath)) return true;
+
 		::wxSetWorkingDirectory(theApp.GetDllFolder());
 
 		// call the python file
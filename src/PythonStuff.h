@@ -11,6 +11,7 @@ class CPyProcess : public wxProcess
 {
 protected:
   int m_pid;
+  bool m_poll;
 
 public:
   CPyProcess(void);
@@ -22,6 +23,7 @@ public:
   void OnTimer(wxTimerEvent& WXUNUSED(event));
 
   virtual void ThenDo(void) { }
+  virtual void Poll(void) { } // called every 100ms while the process runs, if m_poll is set
 
 private:
   wxTimer m_timer;
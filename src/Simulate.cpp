@@ -14,7 +14,12 @@
 #include "Program.h"
 #include "CTool.h"
 #include "Tools.h"
+#include "Stock.h"
+#include "Stocks.h"
+#include "NCCode.h"
+#include "DexelStock.h"
 #include <wx/stdpaths.h>
+#include <wx/stopwatch.h>
 
 #include <sstream>
 
@@ -104,3 +109,215 @@ void RunVoxelcutSimulation()
 	::wxSetWorkingDirectory(theApp.GetDllFolder());
 	wxExecute(wxString(_T("\"")) + theApp.GetDllFolder() + _T("\\VoxelCut.bat\""));
 }
+
+// the machined stock, from RunDexelSimulation; it isn't saved with the model
+class CSimulatedStock: public HeeksObj
+{
+	std::vector<float> m_triangles;
+	std::vector<float> m_normals; // one for each triangle
+	CBox m_box;
+	int m_gl_list;
+
+public:
+	static const int ObjType = SimulatedStockType;
+
+	CSimulatedStock(const CDexelStock &stock): HeeksObj(ObjType), m_gl_list(0)
+	{
+		stock.GetTriangles(m_triangles, m_normals);
+		for(size_t i = 0; i < m_triangles.size(); i += 3)
+		{
+			double p[3] = {m_triangles[i], m_triangles[i+1], m_triangles[i+2]};
+			m_box.Insert(p);
+		}
+	}
+	CSimulatedStock(const CSimulatedStock &rhs): HeeksObj(rhs), m_triangles(rhs.m_triangles), m_normals(rhs.m_normals), m_box(rhs.m_box), m_gl_list(0) {}
+	~CSimulatedStock(){ KillGLLists(); }
+
+	// HeeksObj's virtual functions
+	const wxChar* GetTypeString(void)const{return _("Simulated Stock");}
+	HeeksObj *MakeACopy(void)const{ return new CSimulatedStock(*this);}
+	void GetBox(CBox &box){ box.Insert(m_box); }
+	void KillGLLists(void)
+	{
+		if(m_gl_list)
+		{
+			glDeleteLists(m_gl_list, 1);
+			m_gl_list = 0;
+		}
+	}
+	void glCommands(bool select, bool marked, bool no_color)
+	{
+		if(!no_color)
+		{
+			glEnable(GL_LIGHTING);
+			glEnable(GL_COLOR_MATERIAL);
+			glColorMaterial(GL_FRONT_AND_BACK, GL_AMBIENT_AND_DIFFUSE);
+			HeeksColor(234, 123, 89).glColor();
+		}
+
+		if(m_gl_list)
+		{
+			glCallList(m_gl_list);
+		}
+		else
+		{
+			m_gl_list = glGenLists(1);
+			glNewList(m_gl_list, GL_COMPILE_AND_EXECUTE);
+			glBegin(GL_TRIANGLES);
+			for(size_t t = 0; t < m_normals.size() / 3; t++)
+			{
+				glNormal3fv(&m_normals[t * 3]);
+				glVertex3fv(&m_triangles[t * 9]);
+				glVertex3fv(&m_triangles[t * 9 + 3]);
+				glVertex3fv(&m_triangles[t * 9 + 6]);
+			}
+			glEnd();
+			glEndList();
+		}
+
+		if(!no_color)
+		{
+			glDisable(GL_COLOR_MATERIAL);
+			glDisable(GL_LIGHTING);
+		}
+	}
+};
+
+// the number of cells along the longest side of the stock
+static const double simulation_cells_along_longest_side = 500.0;
+
+static void GetStockBlocks(std::list<CBox> &blocks)
+{
+	// the solids of the program's stock objects
+	for(HeeksObj* object = theApp.m_program->Stocks()->GetFirstChild(); object != NULL; object = theApp.m_program->Stocks()->GetNextChild())
+	{
+		if(object->GetType() != StockType)continue;
+		CStock* stock = (CStock*)object;
+		for(std::list<int>::iterator It = stock->m_solids.begin(); It != stock->m_solids.end(); It++)
+		{
+			HeeksObj* solid = heeksCAD->GetIDObject(SolidType, *It);
+			if(solid == NULL)continue;
+			CBox box;
+			solid->GetBox(box);
+			if(box.m_valid)blocks.push_back(box);
+		}
+	}
+
+	if(blocks.size() > 0)return;
+
+	// or all the solids, like the VoxelCut simulation uses
+	for(HeeksObj* object = heeksCAD->GetFirstObject(); object != NULL; object = heeksCAD->GetNextObject())
+	{
+		if(object->GetIDGroupType() == SolidType)
+		{
+			CBox box;
+			object->GetBox(box);
+			if(box.m_valid)blocks.push_back(box);
+		}
+	}
+}
+
+static void GetBoxExtents(CBox &box, double* extents)
+{
+	extents[0] = box.MinX();
+	extents[1] = box.MinY();
+	extents[2] = box.MinZ();
+	extents[3] = box.MaxX();
+	extents[4] = box.MaxY();
+	extents[5] = box.MaxZ();
+}
+
+// the block which move i came from, or NULL
+static CNCCodeBlock* MoveBlock(CNCCode* nc_code, size_t i)
+{
+	if(i >= nc_code->m_moves.size())return NULL;
+	int block = nc_code->m_moves.m_block[i];
+	if(block < 0 || block >= (int)nc_code->m_blocks.size())return NULL;
+	return nc_code->m_blocks[block];
+}
+
+void RunDexelSimulation()
+{
+	CNCCode* nc_code = theApp.m_program->NCCode();
+	if(nc_code == NULL || nc_code->m_moves.size() == 0)
+	{
+		wxMessageBox(_("There is no NC code to simulate. Post-process the program, or open an NC file, first."));
+		return;
+	}
+
+	std::list<CBox> blocks;
+	GetStockBlocks(blocks);
+	if(blocks.size() == 0)
+	{
+		wxMessageBox(_("There are no solids to use as the stock"));
+		return;
+	}
+
+	wxBusyCursor wait;
+	wxStopWatch stop_watch;
+
+	CBox stock_box;
+	for(std::list<CBox>::iterator It = blocks.begin(); It != blocks.end(); It++)stock_box.Insert(*It);
+	double longest_side = stock_box.Width();
+	if(stock_box.Height() > longest_side)longest_side = stock_box.Height();
+
+	double box[6];
+	GetBoxExtents(stock_box, box);
+	CDexelStock stock(box, longest_side / simulation_cells_along_longest_side);
+	for(std::list<CBox>::iterator It = blocks.begin(); It != blocks.end(); It++)
+	{
+		GetBoxExtents(*It, box);
+		stock.AddBlock(box);
+	}
+	double volume_before = stock.Volume();
+
+	// the shape of each tool used
+	std::map<int, CDexelTool> tools;
+	std::vector< std::pair<size_t, CTool *> > paths = nc_code->GetPaths();
+	for(std::vector< std::pair<size_t, CTool *> >::iterator It = paths.begin(); It != paths.end(); It++)
+	{
+		int tool_number = nc_code->m_moves.m_tool_number[It->first];
+		if(tools.find(tool_number) != tools.end())continue;
+		const CToolParams &params = It->second->m_params;
+		tools[tool_number] = CDexelTool(params.m_diameter / 2, params.m_flat_radius, params.m_corner_radius, params.m_cutting_edge_angle);
+	}
+
+	std::vector<double> volumes;
+	stock.Cut(nc_code->m_moves, tools, &volumes);
+
+	// the move which removes the most material, the volume removed by each tool and the rapid moves which go into the material
+	size_t biggest = 0;
+	std::map<int, double> tool_volumes;
+	size_t rapid_cuts = 0;
+	size_t first_rapid_cut = 0;
+	for(size_t i = 0; i < volumes.size(); i++)
+	{
+		if(volumes[i] > volumes[biggest])biggest = i;
+		if(volumes[i] <= 0.0)continue;
+		tool_volumes[nc_code->m_moves.m_tool_number[i]] += volumes[i];
+		if(nc_code->m_moves.m_color[i] == ColorRapidType)
+		{
+			if(rapid_cuts == 0)first_rapid_cut = i;
+			rapid_cuts++;
+		}
+	}
+
+	wxLogMessage(_T("simulated %u moves on %u x %u cells in %ld ms, removed volume %g"), (unsigned int)nc_code->m_moves.size(), (unsigned int)stock.NumberOfCellsX(), (unsigned int)stock.NumberOfCellsY(), stop_watch.Time(), volume_before - stock.Volume());
+	for(std::map<int, double>::iterator It = tool_volumes.begin(); It != tool_volumes.end(); It++)
+	{
+		wxLogMessage(_T("tool %d removed volume %g"), It->first, It->second);
+	}
+	CNCCodeBlock* block = MoveBlock(nc_code, biggest);
+	if(volumes.size() > 0 && volumes[biggest] > 0.0 && block)
+	{
+		wxLogMessage(_T("the biggest cut, of volume %g, is at text position %ld"), volumes[biggest], block->m_from_pos);
+	}
+	block = MoveBlock(nc_code, first_rapid_cut);
+	if(rapid_cuts > 0 && block)
+	{
+		wxLogMessage(_T("%u rapid moves cut the stock, the first, of volume %g, at text position %ld"), (unsigned int)rapid_cuts, volumes[first_rapid_cut], block->m_from_pos);
+	}
+
+	heeksCAD->Add(new CSimulatedStock(stock), NULL);
+	heeksCAD->Repaint();
+}
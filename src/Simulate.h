@@ -2,4 +2,7 @@
 // Copyright (c) 2012, Dan Heeks
 // This program is released under the BSD license. See the file COPYING for details.
 
-extern void RunVoxelcutSimulation();
\ No newline at end of file
+extern void RunVoxelcutSimulation();
+
+// cuts the stock with the program's NC code, in HeeksCNC, and adds the machined stock to the model
+extern void RunDexelSimulation();
\ No newline at end of file
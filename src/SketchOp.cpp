@@ -59,6 +59,12 @@ void CSketchOp::GetBox(CBox &box)
 	}
 }
 
+void CSketchOp::GetMachinedObjects(std::list<HeeksObj*> &objects)
+{
+	HeeksObj* sketch = heeksCAD->GetIDObject(SketchType, m_sketch);
+	if (sketch)objects.push_back(sketch);
+}
+
 void CSketchOp::glCommands(bool select, bool marked, bool no_color)
 {
 	CDepthOp::glCommands(select, marked, no_color);
@@ -30,6 +30,7 @@ public:
 
 	// COp's virtual functions
 	Python AppendTextToProgram();
+	void GetMachinedObjects(std::list<HeeksObj*> &objects);
 	void GetTools(std::list<Tool*>* t_list, const wxPoint* p);
 
 	bool operator== ( const CSketchOp & rhs ) const;
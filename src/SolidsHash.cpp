@@ -0,0 +1,65 @@
+// SolidsHash.cpp
+/*
+ * Copyright (c) 2013, Dan Heeks
+ * This program is released under the BSD license. See the file COPYING for
+ * details.
+ */
+
+#include "stdafx.h"
+#include "SolidsHash.h"
+
+#include <stdio.h>
+
+// FNV-1a
+CSolidsHash::CSolidsHash(void): m_hash(14695981039346656037ULL), m_in_header(false)
+{
+}
+
+void CSolidsHash::Add(const void* data, size_t size)
+{
+	const unsigned char* bytes = (const unsigned char*)data;
+	for(size_t i = 0; i < size; i++)
+	{
+		m_hash ^= bytes[i];
+		m_hash *= 1099511628211ULL;
+	}
+}
+
+void CSolidsHash::AddLine()
+{
+	// the line without the spaces round it
+	size_t start = m_line.find_first_not_of(" \t");
+	size_t end = m_line.find_last_not_of(" \t");
+	std::string trimmed = (start == std::string::npos) ? std::string() : m_line.substr(start, end + 1 - start);
+
+	if(trimmed == "HEADER;")m_in_header = true;
+	else if(m_in_header)
+	{
+		if(trimmed == "ENDSEC;")m_in_header = false;
+	}
+	else
+	{
+		Add(m_line.data(), m_line.size());
+		Add("\n", 1);
+	}
+	m_line.clear();
+}
+
+void CSolidsHash::AddSaved(const char* text, size_t size)
+{
+	for(size_t i = 0; i < size; i++)
+	{
+		if(text[i] == '\n')AddLine();
+		else if(text[i] != '\r')m_line += text[i];
+	}
+}
+
+std::string CSolidsHash::FileName(const char* extension)
+{
+	// the end of the text, if it doesn't end with a new line
+	if(!m_line.empty())AddLine();
+
+	char name[17];
+	sprintf(name, "%08x%08x", (unsigned int)(m_hash >> 32), (unsigned int)(m_hash & 0xffffffff));
+	return std::string(name) + extension;
+}
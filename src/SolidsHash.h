@@ -0,0 +1,41 @@
+// SolidsHash.h
+/*
+ * Copyright (c) 2013, Dan Heeks
+ * This program is released under the BSD license. See the file COPYING for
+ * details.
+ */
+
+// A hash of some solids, as HeeksCAD saves them, which names a surface's STL file in the cache, so the solids are only made into
+// triangles again when they change.
+// HeeksCAD saves the solids as a STEP file, inside its XML file. The STEP file's HEADER section has the time it was written, and the
+// name of a temporary file, so it is left out of the hash. The DATA section has the geometry, as BRep entities, without any of the
+// triangles used for drawing, so it is the same each time the same solids are saved, in any session. test/solids_hash.cpp checks it.
+// It has no wx or OpenCascade in it.
+
+#pragma once
+
+#include <string>
+#include <cstddef>
+
+class CSolidsHash
+{
+	unsigned long long m_hash;
+	std::string m_line; // the saved text since the last new line
+	bool m_in_header;
+
+	void AddLine();
+
+public:
+	CSolidsHash(void);
+
+	void Add(const void* data, size_t size);
+	void Add(int i){ Add(&i, sizeof(i)); }
+	void Add(double d){ Add(&d, sizeof(d)); }
+
+	// adds some of the text of the saved solids, which can be given in pieces, leaving out the STEP file's HEADER section
+	// and any carriage returns
+	void AddSaved(const char* text, size_t size);
+
+	// the name of the file for the solids, the hash in hex then the extension
+	std::string FileName(const char* extension);
+};
@@ -14,6 +14,7 @@
 #include "tinyxml/tinyxml.h"
 #include "interface/Tool.h"
 #include "CTool.h"
+#include "NCCreator.h"
 
 CSpeedOpParams::CSpeedOpParams(CSpeedOp * parent)
 {
@@ -98,6 +99,21 @@ Python CSpeedOp::AppendTextToProgram()
     return(python);
 }
 
+void CSpeedOp::WriteNC(CNCCreator& creator)
+{
+	COp::WriteNC(creator);
+
+	if (m_speed_op_params.m_spindle_speed != 0)
+	{
+		creator.spindle(PythonNumber(m_speed_op_params.m_spindle_speed));
+	} // End if - then
+
+	double scale = Length::Conversion(theApp.m_program->m_units, UnitTypeMillimeter);
+	creator.feedrate_slot(PythonNumber(m_speed_op_params.m_slot_feed_rate / scale));
+	creator.feedrate_hv(PythonNumber(m_speed_op_params.m_horizontal_feed_rate / scale), PythonNumber(m_speed_op_params.m_vertical_feed_rate / scale));
+	creator.flush_nc();
+}
+
 /* static */ PropertyCheck CSpeedOp::m_auto_set_speeds_feeds = false;
 
 
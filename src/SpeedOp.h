@@ -52,6 +52,7 @@ public:
 	void WriteDefaultValues();
 	void ReadDefaultValues();
 	Python AppendTextToProgram();
+	void WriteNC(CNCCreator& creator);
 
 	static void GetOptions(std::list<Property *> *list);
 	static void ReadFromConfig();
@@ -10,8 +10,19 @@
 #include "interface/Property.h"
 #include "Reselect.h"
 #include "SurfaceDlg.h"
+#include "SolidsHash.h"
+#include "DropCutterMesh.h"
 
-int CSurface::number_for_stl_file = 1;
+#include <wx/stdpaths.h>
+#include <wx/filename.h>
+#include <wx/ffile.h>
+#include <wx/dir.h>
+
+static const double stl_tolerance = 0.01;
+static const size_t max_cached_stl_files = 20;
+
+// the STL file for each list of solids, since they last changed
+static std::map< std::list<int>, wxString > stl_file_for_solids;
 
 CSurface::CSurface()
  : IdNamedObj(ObjType)
@@ -140,3 +151,133 @@ HeeksObj* CSurface::PreferredPasteTarget()
 {
 	return theApp.m_program->Surfaces();
 }
+
+void CSurface::OnSolidsChanged()
+{
+	stl_file_for_solids.clear();
+}
+
+static bool AddFileToHash(CSolidsHash &hash, const wxString &filepath)
+{
+	wxFFile file(filepath, _T("rb"));
+	if(!file.IsOpened())return false;
+	std::vector<char> buffer(1 << 20);
+	while(!file.Eof())
+	{
+		size_t size = file.Read(&buffer[0], buffer.size());
+		if(size == 0)break;
+		hash.AddSaved(&buffer[0], size);
+	}
+	return !file.Error();
+}
+
+// writes the triangles of an STL file again as a binary STL file, for a smaller file which is quicker to read
+static bool WriteBinarySTLFile(const wxString &from_filepath, const wxString &to_filepath)
+{
+	DropCutterMesh mesh;
+	if(!mesh.ReadSTLFile(from_filepath.mb_str(wxConvFile)) || mesh.NumberOfTriangles() == 0)return false;
+	return mesh.WriteSTLFile(to_filepath.mb_str(wxConvFile));
+}
+
+static wxString GetSTLCacheDir()
+{
+#if wxCHECK_VERSION(3, 0, 0)
+	wxStandardPaths& standard_paths = wxStandardPaths::Get();
+#else
+	wxStandardPaths standard_paths;
+#endif
+	wxFileName dir(standard_paths.GetUserDataDir(), _T(""));
+	dir.AppendDir(_T("stl_cache"));
+	if(!dir.DirExists())dir.Mkdir(0777, wxPATH_MKDIR_FULL);
+	return dir.GetPath();
+}
+
+// only keep the most recently used files
+static void RemoveOldSTLFiles(const wxString &dir)
+{
+	wxArrayString files;
+	wxDir::GetAllFiles(dir, &files, _T("*.stl"), wxDIR_FILES);
+	if(files.GetCount() <= max_cached_stl_files)return;
+
+	std::multimap<time_t, wxString> files_by_time;
+	for(size_t i = 0; i < files.GetCount(); i++)
+	{
+		files_by_time.insert(std::make_pair(wxFileName(files[i]).GetModificationTime().GetTicks(), files[i]));
+	}
+
+	size_t number_to_remove = files.GetCount() - max_cached_stl_files;
+	for(std::multimap<time_t, wxString>::iterator It = files_by_time.begin(); It != files_by_time.end() && number_to_remove > 0; It++, number_to_remove--)
+	{
+		wxRemoveFile(It->second);
+	}
+}
+
+wxString CSurface::GetSTLFilePath()
+{
+	std::map< std::list<int>, wxString >::iterator FindIt = stl_file_for_solids.find(m_solids);
+	if(FindIt != stl_file_for_solids.end() && wxFileExists(FindIt->second))return FindIt->second;
+
+	// get the solids list
+	std::list<HeeksObj*> solids;
+	for (std::list<int>::iterator It = m_solids.begin(); It != m_solids.end(); It++)
+	{
+		HeeksObj* object = heeksCAD->GetIDObject(SolidType, *It);
+		if (object != NULL)solids.push_back(object);
+	} // End for
+
+#if wxCHECK_VERSION(3, 0, 0)
+	wxStandardPaths& standard_paths = wxStandardPaths::Get();
+#else
+	wxStandardPaths standard_paths;
+#endif
+
+	// hash the solids, as they would be saved in a file, which is much quicker than making triangles from them;
+	// see SolidsHash.h for why it's the same in every session
+	CSolidsHash hash;
+	hash.Add(stl_tolerance);
+	for (std::list<int>::iterator It = m_solids.begin(); It != m_solids.end(); It++)
+	{
+		hash.Add(*It);
+	}
+	wxFileName xml_filepath(standard_paths.GetTempDir().c_str(), _T("surface_solids.heeks"));
+	heeksCAD->SaveXMLFile(solids, xml_filepath.GetFullPath().c_str(), false);
+	bool hashed = AddFileToHash(hash, xml_filepath.GetFullPath());
+	wxRemoveFile(xml_filepath.GetFullPath());
+
+	wxString cache_dir = GetSTLCacheDir();
+	wxFileName filepath(cache_dir, wxString(hash.FileName(".stl").c_str(), wxConvUTF8));
+	if(!hashed)
+	{
+		// don't cache it
+		filepath.Assign(standard_paths.GetTempDir().c_str(), wxString::Format(_T("surface%d.stl"), GetID()));
+		heeksCAD->SaveSTLFile(solids, filepath.GetFullPath().c_str(), stl_tolerance);
+		return filepath.GetFullPath();
+	}
+
+	if(filepath.FileExists())
+	{
+		// it's being used, so it isn't one of the old ones
+		filepath.Touch();
+	}
+	else
+	{
+		// write it with another name first, so an unfinished file is never used
+		wxString part_filepath = filepath.GetFullPath() + _T(".part");
+		heeksCAD->SaveSTLFile(solids, part_filepath.c_str(), stl_tolerance);
+
+		// kept as binary, which ocl.STLReader and DropCutterMesh both read
+		wxString binary_filepath = filepath.GetFullPath() + _T(".binary.part");
+		if(WriteBinarySTLFile(part_filepath, binary_filepath))
+		{
+			wxRemoveFile(part_filepath);
+			part_filepath = binary_filepath;
+		}
+		else wxRemoveFile(binary_filepath);
+
+		wxRenameFile(part_filepath, filepath.GetFullPath());
+		RemoveOldSTLFiles(cache_dir);
+	}
+
+	stl_file_for_solids[m_solids] = filepath.GetFullPath();
+	return filepath.GetFullPath();
+}
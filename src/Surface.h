@@ -21,7 +21,6 @@ public:
 	PropertyLength m_tolerance;
 	PropertyLength m_material_allowance;
 	PropertyCheck m_same_for_each_pattern_position;
-	static int number_for_stl_file;
 
 	//	Constructors.
 	CSurface();
@@ -42,5 +41,12 @@ public:
 	HeeksObj* PreferredPasteTarget();
 
     static HeeksObj* ReadFromXMLElement(TiXmlElement* pElem);
+
+	// Returns a binary STL file of the solids, for ocl_funcs and nc/attach.py. The files are kept in a cache, named after a hash of the solids,
+	// see SolidsHash.h, so the solids are only made into triangles again when they change, in this session or another.
+	wxString GetSTLFilePath();
+
+	// forget the hashes of the solids, so they are checked again; call this when any solid changes
+	static void OnSolidsChanged();
 }; // End CSurface class definition.
 
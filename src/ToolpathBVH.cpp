@@ -0,0 +1,229 @@
+// ToolpathBVH.cpp
+/*
+ * Copyright (c) 2009, Dan Heeks
+ * This program is released under the BSD license. See the file COPYING for
+ * details.
+ */
+
+#include "stdafx.h"
+#include "ToolpathBVH.h"
+
+#include <algorithm>
+#include <math.h>
+
+static const unsigned int lines_per_leaf = 8;
+
+void CToolpathBVH::Clear(void)
+{
+	std::vector<Tree>().swap(m_trees);
+	m_number_of_lines = 0;
+}
+
+class CentreLess
+{
+	const std::vector<float> &m_centres;
+	int m_axis;
+	size_t m_first_line;
+public:
+	CentreLess(const std::vector<float> &centres, int axis, size_t first_line): m_centres(centres), m_axis(axis), m_first_line(first_line) {}
+	bool operator()(unsigned int a, unsigned int b)const { return m_centres[(a - m_first_line) * 3 + m_axis] < m_centres[(b - m_first_line) * 3 + m_axis]; }
+};
+
+void CToolpathBVH::Update(const std::vector<float> &vertices)
+{
+	size_t number_of_lines = vertices.size() / 6;
+	if(number_of_lines < m_number_of_lines)Clear(); // the vertices have been made again
+	if(number_of_lines == m_number_of_lines)return;
+
+	size_t first = m_number_of_lines;
+	while(!m_trees.empty() && m_trees.back().m_number_of_lines <= number_of_lines - first)
+	{
+		first = m_trees.back().m_first_line;
+		m_trees.pop_back();
+	}
+
+	m_trees.push_back(Tree());
+	m_trees.back().Build(vertices, first, number_of_lines - first);
+	m_number_of_lines = number_of_lines;
+}
+
+void CToolpathBVH::Tree::Build(const std::vector<float> &vertices, size_t first_line, size_t number_of_lines)
+{
+	m_first_line = first_line;
+	m_number_of_lines = number_of_lines;
+
+	// the centres are kept for this tree's lines only, so centre i is line first_line + i
+	std::vector<float> centres(m_number_of_lines * 3);
+	m_lines.resize(m_number_of_lines);
+	for(size_t i = 0; i < m_number_of_lines; i++)
+	{
+		size_t line = first_line + i;
+		m_lines[i] = (unsigned int)line;
+		for(int k = 0; k < 3; k++)centres[i * 3 + k] = (vertices[line * 6 + k] + vertices[line * 6 + 3 + k]) * 0.5f;
+	}
+
+	m_nodes.reserve(2 * m_number_of_lines / lines_per_leaf + 1);
+	m_nodes.push_back(Node());
+
+	// node index, first line, number of lines
+	std::vector< std::pair<unsigned int, std::pair<unsigned int, unsigned int> > > stack;
+	stack.push_back(std::make_pair(0u, std::make_pair(0u, (unsigned int)m_number_of_lines)));
+	while(!stack.empty())
+	{
+		unsigned int node_index = stack.back().first;
+		unsigned int first = stack.back().second.first;
+		unsigned int count = stack.back().second.second;
+		stack.pop_back();
+
+		// box around the lines, starting at the first line's start
+		float box[6];
+		for(int k = 0; k < 3; k++)
+		{
+			box[k] = vertices[m_lines[first] * 6 + k];
+			box[k + 3] = box[k];
+		}
+		for(unsigned int i = first; i < first + count; i++)
+		{
+			const float* v = &vertices[m_lines[i] * 6];
+			for(int e = 0; e < 2; e++)
+			{
+				for(int k = 0; k < 3; k++)
+				{
+					float x = v[e * 3 + k];
+					if(x < box[k])box[k] = x;
+					if(x > box[k + 3])box[k + 3] = x;
+				}
+			}
+		}
+		Node &node = m_nodes[node_index];
+		for(int k = 0; k < 6; k++)node.m_box[k] = box[k];
+
+		if(count <= lines_per_leaf)
+		{
+			node.m_first = first;
+			node.m_count = count;
+			continue;
+		}
+
+		// split at the middle line, along the longest side
+		int axis = 0;
+		for(int k = 1; k < 3; k++)if(box[k + 3] - box[k] > box[axis + 3] - box[axis])axis = k;
+		unsigned int half = count / 2;
+		std::nth_element(m_lines.begin() + first, m_lines.begin() + first + half, m_lines.begin() + first + count, CentreLess(centres, axis, m_first_line));
+
+		unsigned int child = (unsigned int)m_nodes.size();
+		node.m_first = child;
+		node.m_count = 0;
+		m_nodes.push_back(Node()); // node is no longer valid after this
+		m_nodes.push_back(Node());
+		stack.push_back(std::make_pair(child, std::make_pair(first, half)));
+		stack.push_back(std::make_pair(child + 1, std::make_pair(first + half, count - half)));
+	}
+}
+
+// the part of v at right angles to the unit vector d
+static void Perpendicular(const double* v, const double* d, double* p)
+{
+	double dot = v[0] * d[0] + v[1] * d[1] + v[2] * d[2];
+	for(int k = 0; k < 3; k++)p[k] = v[k] - dot * d[k];
+}
+
+static double LineToRaySquared(const float* a, const float* b, const double* s, const double* d)
+{
+	double as[3], ab[3], q0[3], q1[3];
+	for(int k = 0; k < 3; k++)
+	{
+		as[k] = a[k] - s[k];
+		ab[k] = b[k] - a[k];
+	}
+	Perpendicular(as, d, q0);
+	Perpendicular(ab, d, q1);
+	double q1_q1 = q1[0] * q1[0] + q1[1] * q1[1] + q1[2] * q1[2];
+	double u = (q1_q1 > 0.0) ? -(q0[0] * q1[0] + q0[1] * q1[1] + q0[2] * q1[2]) / q1_q1 : 0.0;
+	if(u < 0.0)u = 0.0;
+	if(u > 1.0)u = 1.0;
+	double dist = 0.0;
+	for(int k = 0; k < 3; k++)
+	{
+		double e = q0[k] + u * q1[k];
+		dist += e * e;
+	}
+	return dist;
+}
+
+// a lower limit for the distance from the ray to anything in the box, using the box's bounding sphere
+static double BoxToRay(const float* box, const double* s, const double* d)
+{
+	double cs[3];
+	double radius_squared = 0.0;
+	for(int k = 0; k < 3; k++)
+	{
+		cs[k] = (box[k] + box[k + 3]) * 0.5 - s[k];
+		double h = (box[k + 3] - box[k]) * 0.5;
+		radius_squared += h * h;
+	}
+	double p[3];
+	Perpendicular(cs, d, p);
+	double dist = sqrt(p[0] * p[0] + p[1] * p[1] + p[2] * p[2]) - sqrt(radius_squared);
+	return (dist > 0.0) ? dist : 0.0;
+}
+
+long CToolpathBVH::Nearest(const double* ray_start, const double* ray_direction, const std::vector<float> &vertices)const
+{
+	if(m_trees.empty())return -1;
+
+	double d[3] = {ray_direction[0], ray_direction[1], ray_direction[2]};
+	double length = sqrt(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+	if(length == 0.0)return -1;
+	for(int k = 0; k < 3; k++)d[k] /= length;
+
+	long best = -1;
+	double best_squared = 0.0;
+	for(std::vector<Tree>::const_iterator It = m_trees.begin(); It != m_trees.end(); It++)It->Nearest(ray_start, d, vertices, best, best_squared);
+
+	return best;
+}
+
+// d is the ray's direction, as a unit vector
+void CToolpathBVH::Tree::Nearest(const double* ray_start, const double* d, const std::vector<float> &vertices, long &best, double &best_squared)const
+{
+	// nodes to visit, with their distance from the ray
+	std::vector< std::pair<double, unsigned int> > stack;
+	stack.push_back(std::make_pair(BoxToRay(m_nodes[0].m_box, ray_start, d), 0u));
+	while(!stack.empty())
+	{
+		double node_dist = stack.back().first;
+		const Node &node = m_nodes[stack.back().second];
+		stack.pop_back();
+		if(best >= 0 && node_dist * node_dist >= best_squared)continue;
+
+		if(node.m_count > 0)
+		{
+			for(unsigned int i = node.m_first; i < node.m_first + node.m_count; i++)
+			{
+				unsigned int line = m_lines[i];
+				double dist_squared = LineToRaySquared(&vertices[line * 6], &vertices[line * 6 + 3], ray_start, d);
+				if(best < 0 || dist_squared < best_squared)
+				{
+					best = line;
+					best_squared = dist_squared;
+				}
+			}
+			continue;
+		}
+
+		// visit the nearer child first
+		double d0 = BoxToRay(m_nodes[node.m_first].m_box, ray_start, d);
+		double d1 = BoxToRay(m_nodes[node.m_first + 1].m_box, ray_start, d);
+		if(d0 < d1)
+		{
+			stack.push_back(std::make_pair(d1, node.m_first + 1));
+			stack.push_back(std::make_pair(d0, node.m_first));
+		}
+		else
+		{
+			stack.push_back(std::make_pair(d0, node.m_first));
+			stack.push_back(std::make_pair(d1, node.m_first + 1));
+		}
+	}
+}
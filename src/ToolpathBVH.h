@@ -0,0 +1,60 @@
+// ToolpathBVH.h
+/*
+ * Copyright (c) 2009, Dan Heeks
+ * This program is released under the BSD license. See the file COPYING for
+ * details.
+ */
+
+// A bounding volume hierarchy over the lines of CNCCode's GL_LINES vertices,
+// for finding the line nearest to a mouse click without drawing every block in select mode.
+// Lines are only ever added to the end of the vertices, while a file is read, so the lines added since the
+// last Update get a tree of their own. A tree is merged with the ones before it which are no bigger, by building
+// it again over all their lines, so there are only about log2(lines) trees, and each line is built into one
+// about log2(lines) times, rather than every time some lines are added.
+
+#pragma once
+
+#include <vector>
+#include <cstddef>
+
+class CToolpathBVH
+{
+public:
+	void Clear(void);
+
+	// adds the lines which have been added to vertices since the last call; vertices are pairs of xyz points, as drawn with GL_LINES
+	void Update(const std::vector<float> &vertices);
+
+	size_t NumberOfLines(void)const { return m_number_of_lines; }
+
+	// returns the index of the line nearest to the ray, or -1 if there are no lines
+	long Nearest(const double* ray_start, const double* ray_direction, const std::vector<float> &vertices)const;
+
+	size_t NumberOfTrees(void)const { return m_trees.size(); }
+
+	CToolpathBVH(void): m_number_of_lines(0) {}
+
+private:
+	class Node
+	{
+	public:
+		float m_box[6];
+		unsigned int m_first; // first child node, or first of m_lines for a leaf
+		unsigned int m_count; // number of lines, 0 for a node with two children
+	};
+
+	class Tree
+	{
+	public:
+		size_t m_first_line;
+		size_t m_number_of_lines;
+		std::vector<Node> m_nodes;
+		std::vector<unsigned int> m_lines; // line indexes, in the order of the leaves
+
+		void Build(const std::vector<float> &vertices, size_t first_line, size_t number_of_lines);
+		void Nearest(const double* ray_start, const double* d, const std::vector<float> &vertices, long &best, double &best_squared)const;
+	};
+
+	std::vector<Tree> m_trees; // the biggest first, with the lines in order
+	size_t m_number_of_lines;
+};
@@ -0,0 +1,328 @@
+// ToolpathLOD.cpp
+/*
+ * Copyright (c) 2009, Dan Heeks
+ * This program is released under the BSD license. See the file COPYING for
+ * details.
+ */
+
+#include "stdafx.h"
+#include "ToolpathLOD.h"
+
+#include <math.h>
+#include <string.h>
+
+// static
+double CToolpathLOD::max_pixel_error = 1.0;
+
+static const size_t vertices_per_chunk = 8192;
+
+// the simplified levels' tolerances, as fractions of the chunk's box diagonal
+static const double level_divisor[CToolpathLOD::NUMBER_OF_LEVELS] = {0.0, 1024.0, 256.0, 64.0, 16.0};
+
+CToolpathLOD::Chunk::Chunk(void): m_first_vertex(0), m_number_of_vertices(0)
+{
+	for(int i = 0; i < 6; i++)m_box[i] = 0.0f;
+	for(int i = 0; i < NUMBER_OF_LEVELS; i++)m_gl_list[i] = 0;
+}
+
+void CToolpathLOD::Chunk::DestroyGLLists(void)
+{
+	for(int i = 0; i < NUMBER_OF_LEVELS; i++)
+	{
+		if(m_gl_list[i])
+		{
+			glDeleteLists(m_gl_list[i], 1);
+			m_gl_list[i] = 0;
+		}
+	}
+}
+
+static double DistanceToSegmentSquared(const float* p, const float* a, const float* b)
+{
+	double ab[3], ap[3];
+	for(int i = 0; i < 3; i++)
+	{
+		ab[i] = b[i] - a[i];
+		ap[i] = p[i] - a[i];
+	}
+	double ab_ab = ab[0]*ab[0] + ab[1]*ab[1] + ab[2]*ab[2];
+	double t = (ab_ab > 0.0) ? (ap[0]*ab[0] + ap[1]*ab[1] + ap[2]*ab[2]) / ab_ab : 0.0;
+	if(t < 0.0)t = 0.0;
+	if(t > 1.0)t = 1.0;
+	double d = 0.0;
+	for(int i = 0; i < 3; i++)
+	{
+		double e = ap[i] - t * ab[i];
+		d += e * e;
+	}
+	return d;
+}
+
+// Douglas-Peucker; sets keep[i] for the points of the polyline to keep
+static void SimplifyPolyline(const std::vector<const float*> &points, double tolerance, std::vector<bool> &keep)
+{
+	keep.assign(points.size(), false);
+	keep.front() = true;
+	keep.back() = true;
+
+	double tolerance_squared = tolerance * tolerance;
+	std::vector< std::pair<size_t, size_t> > stack;
+	stack.push_back(std::make_pair((size_t)0, points.size() - 1));
+	while(!stack.empty())
+	{
+		size_t i0 = stack.back().first;
+		size_t i1 = stack.back().second;
+		stack.pop_back();
+
+		double worst = 0.0;
+		size_t worst_i = 0;
+		for(size_t i = i0 + 1; i < i1; i++)
+		{
+			double d = DistanceToSegmentSquared(points[i], points[i0], points[i1]);
+			if(d > worst)
+			{
+				worst = d;
+				worst_i = i;
+			}
+		}
+
+		if(worst > tolerance_squared)
+		{
+			keep[worst_i] = true;
+			stack.push_back(std::make_pair(i0, worst_i));
+			stack.push_back(std::make_pair(worst_i, i1));
+		}
+	}
+}
+
+void CToolpathLOD::Chunk::Simplify(const std::vector<float> &vertices, const std::vector<unsigned char> &colors)
+{
+	size_t end = m_first_vertex + m_number_of_vertices;
+
+	// box
+	for(size_t v = m_first_vertex; v < end; v++)
+	{
+		const float* p = &vertices[v * 3];
+		for(int i = 0; i < 3; i++)
+		{
+			if(v == m_first_vertex || p[i] < m_box[i])m_box[i] = p[i];
+			if(v == m_first_vertex || p[i] > m_box[i + 3])m_box[i + 3] = p[i];
+		}
+	}
+	double dx = m_box[3] - m_box[0], dy = m_box[4] - m_box[1], dz = m_box[5] - m_box[2];
+	double diagonal = sqrt(dx*dx + dy*dy + dz*dz);
+
+	std::vector<const float*> points;
+	std::vector<bool> keep;
+	for(int level = 1; level < NUMBER_OF_LEVELS; level++)
+	{
+		double tolerance = diagonal / level_divisor[level];
+		std::vector<float> &level_vertices = m_vertices[level - 1];
+		std::vector<unsigned char> &level_colors = m_colors[level - 1];
+		level_vertices.clear();
+		level_colors.clear();
+
+		// each run of joined up lines, of the same colour, is simplified as one polyline
+		for(size_t v = m_first_vertex; v < end;)
+		{
+			const unsigned char* color = &colors[v * 3];
+			points.clear();
+			points.push_back(&vertices[v * 3]);
+			points.push_back(&vertices[v * 3 + 3]);
+			v += 2;
+			while(v < end && memcmp(&colors[v * 3], color, 3) == 0 && memcmp(&vertices[v * 3], points.back(), 3 * sizeof(float)) == 0)
+			{
+				points.push_back(&vertices[v * 3 + 3]);
+				v += 2;
+			}
+
+			SimplifyPolyline(points, tolerance, keep);
+
+			const float* previous = points.front();
+			for(size_t i = 1; i < points.size(); i++)
+			{
+				if(!keep[i])continue;
+				level_vertices.insert(level_vertices.end(), previous, previous + 3);
+				level_vertices.insert(level_vertices.end(), points[i], points[i] + 3);
+				level_colors.insert(level_colors.end(), color, color + 3);
+				level_colors.insert(level_colors.end(), color, color + 3);
+				previous = points[i];
+			}
+		}
+	}
+}
+
+int CToolpathLOD::Chunk::Level(const double* m, const int* viewport)const
+{
+	// the box's corners in clip coordinates
+	double clip[8][4];
+	for(int c = 0; c < 8; c++)
+	{
+		double x = m_box[(c & 1) ? 3 : 0];
+		double y = m_box[(c & 2) ? 4 : 1];
+		double z = m_box[(c & 4) ? 5 : 2];
+		for(int i = 0; i < 4; i++)clip[c][i] = m[i] * x + m[4 + i] * y + m[8 + i] * z + m[12 + i];
+	}
+
+	// off the screen, if all the corners are outside the same side of the view volume
+	for(int axis = 0; axis < 3; axis++)
+	{
+		bool all_below = true, all_above = true;
+		for(int c = 0; c < 8; c++)
+		{
+			if(clip[c][axis] >= -clip[c][3])all_below = false;
+			if(clip[c][axis] <= clip[c][3])all_above = false;
+		}
+		if(all_below || all_above)return -1;
+	}
+
+	// size on the screen, in pixels
+	double xmin = 0.0, xmax = 0.0, ymin = 0.0, ymax = 0.0;
+	for(int c = 0; c < 8; c++)
+	{
+		double w = clip[c][3];
+		if(w <= 0.0)return 0; // goes behind the eye
+		double x = (clip[c][0] / w + 1.0) * 0.5 * viewport[2];
+		double y = (clip[c][1] / w + 1.0) * 0.5 * viewport[3];
+		if(c == 0 || x < xmin)xmin = x;
+		if(c == 0 || x > xmax)xmax = x;
+		if(c == 0 || y < ymin)ymin = y;
+		if(c == 0 || y > ymax)ymax = y;
+	}
+	double size = sqrt((xmax - xmin) * (xmax - xmin) + (ymax - ymin) * (ymax - ymin));
+
+	// the coarsest level whose error is small enough
+	for(int level = NUMBER_OF_LEVELS - 1; level > 0; level--)
+	{
+		if(size / level_divisor[level] <= max_pixel_error)return level;
+	}
+	return 0;
+}
+
+void CToolpathLOD::Chunk::Draw(int level, const std::vector<float> &vertices, const std::vector<unsigned char> &colors)
+{
+	if(m_gl_list[level])
+	{
+		glCallList(m_gl_list[level]);
+		return;
+	}
+
+	const float* v;
+	const unsigned char* c;
+	size_t first, count;
+	if(level == 0)
+	{
+		v = &vertices[0];
+		c = &colors[0];
+		first = m_first_vertex;
+		count = m_number_of_vertices;
+	}
+	else
+	{
+		if(m_vertices[level - 1].empty())return;
+		v = &m_vertices[level - 1][0];
+		c = &m_colors[level - 1][0];
+		first = 0;
+		count = m_vertices[level - 1].size() / 3;
+	}
+
+	m_gl_list[level] = glGenLists(1);
+	glNewList(m_gl_list[level], GL_COMPILE_AND_EXECUTE);
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glEnableClientState(GL_COLOR_ARRAY);
+	glVertexPointer(3, GL_FLOAT, 0, v);
+	glColorPointer(3, GL_UNSIGNED_BYTE, 0, c);
+	glDrawArrays(GL_LINES, (GLint)first, (GLsizei)count);
+	glDisableClientState(GL_COLOR_ARRAY);
+	glDisableClientState(GL_VERTEX_ARRAY);
+	glEndList();
+}
+
+CToolpathLOD::CToolpathLOD(void)
+{
+}
+
+CToolpathLOD::~CToolpathLOD(void)
+{
+	Clear();
+}
+
+void CToolpathLOD::Clear(void)
+{
+	for(std::vector<Chunk*>::iterator It = m_chunks.begin(); It != m_chunks.end(); It++)
+	{
+		Chunk* chunk = *It;
+		chunk->DestroyGLLists();
+		delete chunk;
+	}
+	m_chunks.clear();
+}
+
+void CToolpathLOD::DestroyGLLists(void)
+{
+	for(std::vector<Chunk*>::iterator It = m_chunks.begin(); It != m_chunks.end(); It++)
+	{
+		Chunk* chunk = *It;
+		chunk->DestroyGLLists();
+	}
+}
+
+void CToolpathLOD::Update(const std::vector<float> &vertices, const std::vector<unsigned char> &colors)
+{
+	size_t number_of_vertices = vertices.size() / 3;
+
+	// the last chunk is made again, if it wasn't full
+	size_t first = 0;
+	if(!m_chunks.empty())
+	{
+		Chunk* last = m_chunks.back();
+		first = last->m_first_vertex + last->m_number_of_vertices;
+		if(first == number_of_vertices)return;
+		if(last->m_number_of_vertices < vertices_per_chunk)
+		{
+			first = last->m_first_vertex;
+			last->DestroyGLLists();
+			delete last;
+			m_chunks.pop_back();
+		}
+	}
+
+	for(; first < number_of_vertices; first += vertices_per_chunk)
+	{
+		Chunk* chunk = new Chunk;
+		chunk->m_first_vertex = first;
+		chunk->m_number_of_vertices = number_of_vertices - first;
+		if(chunk->m_number_of_vertices > vertices_per_chunk)chunk->m_number_of_vertices = vertices_per_chunk;
+		chunk->Simplify(vertices, colors);
+		m_chunks.push_back(chunk);
+	}
+}
+
+void CToolpathLOD::glCommands(const std::vector<float> &vertices, const std::vector<unsigned char> &colors)
+{
+	if(vertices.empty())return;
+
+	double modelview[16], projection[16], m[16];
+	int viewport[4];
+	glGetDoublev(GL_MODELVIEW_MATRIX, modelview);
+	glGetDoublev(GL_PROJECTION_MATRIX, projection);
+	glGetIntegerv(GL_VIEWPORT, viewport);
+
+	// m = projection * modelview, column major
+	for(int col = 0; col < 4; col++)
+	{
+		for(int row = 0; row < 4; row++)
+		{
+			double d = 0.0;
+			for(int k = 0; k < 4; k++)d += projection[k * 4 + row] * modelview[col * 4 + k];
+			m[col * 4 + row] = d;
+		}
+	}
+
+	for(std::vector<Chunk*>::iterator It = m_chunks.begin(); It != m_chunks.end(); It++)
+	{
+		Chunk* chunk = *It;
+		int level = chunk->Level(m, viewport);
+		if(level >= 0)chunk->Draw(level, vertices, colors);
+	}
+}
@@ -0,0 +1,64 @@
+// ToolpathLOD.h
+/*
+ * Copyright (c) 2009, Dan Heeks
+ * This program is released under the BSD license. See the file COPYING for
+ * details.
+ */
+
+// Level of detail, for drawing the toolpath of a very large program.
+// CNCCode's GL_LINES vertices are cut into chunks of consecutive lines. Each chunk has a box, so chunks which
+// are off the screen aren't drawn, and simplified copies of its lines, so chunks which are small on the screen
+// are drawn with fewer lines. The simplified lines are never more than max_pixel_error pixels from the real ones.
+
+#pragma once
+
+#include <vector>
+#include <cstddef>
+
+class CToolpathLOD
+{
+public:
+	enum { NUMBER_OF_LEVELS = 5 }; // full detail and four simplified levels
+
+	static double max_pixel_error;
+
+	CToolpathLOD(void);
+	~CToolpathLOD(void);
+
+	// forget all the chunks, for when the vertices are cleared or changed
+	void Clear(void);
+
+	// delete the display lists, but keep the chunks
+	void DestroyGLLists(void);
+
+	// makes chunks for any vertices added since the last call
+	void Update(const std::vector<float> &vertices, const std::vector<unsigned char> &colors);
+
+	// draws the chunks which are on the screen, at the detail needed by the current GL matrices
+	void glCommands(const std::vector<float> &vertices, const std::vector<unsigned char> &colors);
+
+	size_t NumberOfChunks(void)const { return m_chunks.size(); }
+
+private:
+	class Chunk
+	{
+	public:
+		size_t m_first_vertex, m_number_of_vertices; // range of the full detail vertices
+		float m_box[6];
+		std::vector<float> m_vertices[NUMBER_OF_LEVELS - 1]; // the simplified levels, as GL_LINES
+		std::vector<unsigned char> m_colors[NUMBER_OF_LEVELS - 1];
+		unsigned int m_gl_list[NUMBER_OF_LEVELS];
+
+		Chunk(void);
+		void Simplify(const std::vector<float> &vertices, const std::vector<unsigned char> &colors);
+		int Level(const double* matrix, const int* viewport)const; // -1 if off the screen
+		void Draw(int level, const std::vector<float> &vertices, const std::vector<unsigned char> &colors);
+		void DestroyGLLists(void);
+	};
+
+	std::vector<Chunk*> m_chunks;
+
+	// not copied
+	CToolpathLOD(const CToolpathLOD&);
+	const CToolpathLOD& operator=(const CToolpathLOD&);
+};
@@ -74,7 +74,7 @@ void CTrsfNCCode::WriteCode(wxTextFile &f)
 {
 	CNCCode* code = (CNCCode*)GetFirstChild();
 
-	std::list<CNCCodeBlock*>::iterator it;
+	std::vector<CNCCodeBlock*>::iterator it;
 	for(it = code->m_blocks.begin(); it != code->m_blocks.end(); it++)
 	{
 		CNCCodeBlock* block = *it;
@@ -0,0 +1,300 @@
+// ZigZag.cpp
+/*
+ * Copyright (c) 2009, Dan Heeks
+ * This program is released under the BSD license. See the file COPYING for
+ * details.
+ */
+
+#include "stdafx.h"
+#include "ZigZag.h"
+
+#include <math.h>
+#include <algorithm>
+
+static const double PI = 3.1415926535897932;
+
+// lengths smaller than this are nothing
+static const double tiny_length = 1.0e-9;
+
+class CZigZagCrossing
+{
+public:
+	double x;
+	int span;
+
+	CZigZagCrossing(double x_, int span_): x(x_), span(span_) {}
+	bool operator<(const CZigZagCrossing &c)const{ return (x < c.x) || (x == c.x && span < c.span); }
+};
+
+static void AddVertex(CZigZag::Curve &curve, int type, double x, double y, double cx, double cy)
+{
+	const CZigZag::Vertex &last = curve.back();
+	if(fabs(x - last.x) < tiny_length && fabs(y - last.y) < tiny_length)return;
+	if(type == 0)curve.push_back(CZigZag::Vertex(0, x, y, 0.0, 0.0));
+	else curve.push_back(CZigZag::Vertex(type, x, y, cx, cy));
+}
+
+class CZigZagSweep
+{
+public:
+	CCurveSpans m_edges;
+	double m_base, m_stepover;
+	int m_num_lines;
+	std::vector< std::vector<CZigZagCrossing> > m_lines; // the crossings of each scanline, sorted in x
+	std::vector<int> m_first_line; // the first scanline each span crosses
+	std::vector<int> m_crossings_offset; // where the positions of each span's crossings are in m_crossing_index
+	std::vector<int> m_crossing_index; // where each crossing of each span is in its scanline
+
+	CZigZagSweep(double stepover): m_base(0.0), m_stepover(stepover), m_num_lines(0) {}
+
+	double LineY(int line)const{ return m_base + line * m_stepover; }
+
+	int CrossingIndex(int span, int line)const{ return m_crossing_index[m_crossings_offset[span] + line - m_first_line[span]]; }
+
+	// intersects all the spans with all the scanlines
+	void FindCrossings(double start_offset)
+	{
+		double xmin, ymin, xmax, ymax;
+		if(!m_edges.GetBox(xmin, ymin, xmax, ymax))return;
+
+		// the same scanlines as zigzag.py
+		m_base = ymin + start_offset;
+		m_num_lines = (int)((ymax - ymin) / m_stepover + 1);
+		m_lines.resize(m_num_lines);
+
+		int num_spans = (int)m_edges.m_spans.size();
+		m_first_line.resize(num_spans, 0);
+		m_crossings_offset.resize(num_spans, 0);
+		for(int i = 0; i < num_spans; i++)
+		{
+			const CCurveSpan &span = m_edges.m_spans[i];
+			m_crossings_offset[i] = (int)m_crossing_index.size();
+			if(span.ymin >= span.ymax)continue;
+
+			double first = ceil((span.ymin - m_base) / m_stepover);
+			int line = (first < 0.0) ? 0 : ((first > m_num_lines) ? m_num_lines : (int)first);
+			while(line > 0 && LineY(line - 1) >= span.ymin)line--;
+			while(line < m_num_lines && LineY(line) < span.ymin)line++;
+			m_first_line[i] = line;
+
+			for(; line < m_num_lines && span.Crosses(LineY(line)); line++)
+			{
+				m_lines[line].push_back(CZigZagCrossing(span.X(LineY(line)), i));
+				m_crossing_index.push_back(-1);
+			}
+		}
+
+		for(int line = 0; line < m_num_lines; line++)
+		{
+			std::vector<CZigZagCrossing> &crossings = m_lines[line];
+			std::sort(crossings.begin(), crossings.end());
+			for(int j = 0; j < (int)crossings.size(); j++)
+			{
+				int span = crossings[j].span;
+				m_crossing_index[m_crossings_offset[span] + line - m_first_line[span]] = j;
+			}
+		}
+	}
+
+	// Follows the edge of the area up from crossing of line, adding it to zig, if zig isn't NULL.
+	// Returns -1 if it gets to the next scanline, or the crossing of line it comes back down to.
+	int Zag(int line, int crossing, CZigZag::Curve* zig)const
+	{
+		double y_bottom = LineY(line);
+		double y_top = LineY(line + 1);
+
+		int span_index = m_lines[line][crossing].span;
+		const CCurveSpan &first_span = m_edges.m_spans[span_index];
+		bool forward = first_span.ey > first_span.sy;
+		int loop_size = first_span.loop_end - first_span.loop_begin;
+		int i = span_index;
+
+		for(int count = 0; count <= loop_size; count++)
+		{
+			const CCurveSpan &span = m_edges.m_spans[i];
+			int type = forward ? span.type : -span.type;
+			double y0 = forward ? span.sy : span.ey;
+			double x1 = forward ? span.ex : span.sx;
+			double y1 = forward ? span.ey : span.sy;
+
+			if(y1 > y0)
+			{
+				if(span.Crosses(y_top))
+				{
+					if(zig)AddVertex(*zig, type, span.X(y_top), y_top, span.cx, span.cy);
+					return -1;
+				}
+			}
+			else if(y1 < y0)
+			{
+				if(span.Crosses(y_bottom))
+				{
+					int c = CrossingIndex(i, line);
+					if(zig)AddVertex(*zig, type, m_lines[line][c].x, y_bottom, span.cx, span.cy);
+					return c;
+				}
+			}
+
+			if(zig)AddVertex(*zig, type, x1, y1, span.cx, span.cy);
+
+			if(forward)
+			{
+				i++;
+				if(i == span.loop_end)i = span.loop_begin;
+			}
+			else
+			{
+				if(i == span.loop_begin)i = span.loop_end;
+				i--;
+			}
+		}
+
+		return -1;
+	}
+};
+
+class CZigZagStart
+{
+public:
+	double x; // where the zig starts, along its scanline
+	int zig;
+
+	CZigZagStart(double x_, int zig_): x(x_), zig(zig_) {}
+};
+
+static bool StartsBefore(const CZigZagStart &a, const CZigZagStart &b){ return a.x < b.x; }
+static bool StartsAfter(const CZigZagStart &a, const CZigZagStart &b){ return a.x > b.x; }
+
+void CZigZag::Make(const std::vector<Curve> &curves, double stepover, bool unidirectional, double angle, double start_offset, double tolerance, std::vector<Curve> &zigs)
+{
+	zigs.clear();
+	if(stepover <= 0.0)return;
+
+	// rotate the area, so the scanlines are along the x axis
+	double radians = angle * PI / 180;
+	double cos_a = cos(-radians), sin_a = sin(-radians);
+
+	CZigZagSweep sweep(stepover);
+	for(std::vector<Curve>::const_iterator It = curves.begin(); It != curves.end(); It++)sweep.m_edges.AddCurve(*It, cos_a, sin_a);
+	sweep.FindCrossings(start_offset);
+
+	std::vector<Curve> line_zigs;
+	for(int line = 0; line < sweep.m_num_lines; line++)
+	{
+		const std::vector<CZigZagCrossing> &crossings = sweep.m_lines[line];
+		int num_pieces = (int)crossings.size() / 2; // the pieces of the scanline inside the area, between crossings 2n and 2n + 1
+		double y = sweep.LineY(line);
+		bool rightward = unidirectional || (line % 2 == 0);
+
+		// the zig along each piece goes from its start crossing to its end crossing, then up the edge
+		// where the edge comes back down to the scanline, the zig carries on along the next piece, so a zig starts at a piece nothing comes down to
+		std::vector<bool> comes_down_to(num_pieces, false);
+		for(int n = 0; n < num_pieces; n++)
+		{
+			int c = sweep.Zag(line, rightward ? 2 * n + 1 : 2 * n, NULL);
+			if(c >= 0)comes_down_to[c / 2] = true;
+		}
+
+		// the pieces which only come down to each other, round a part of the area which doesn't get to the next scanline, make one zig,
+		// from the piece furthest back, which stops at the end of the last piece, rather than going round to the start again
+		std::vector<int> piece_order;
+		for(int n = 0; n < num_pieces; n++)if(!comes_down_to[n])piece_order.push_back(n);
+		for(int k = 0; k < num_pieces; k++)
+		{
+			int n = rightward ? k : num_pieces - 1 - k;
+			if(comes_down_to[n])piece_order.push_back(n);
+		}
+
+		std::vector<bool> done(num_pieces, false);
+		std::vector<CZigZagStart> starts;
+		line_zigs.clear();
+		for(std::vector<int>::iterator It = piece_order.begin(); It != piece_order.end(); It++)
+		{
+			int n = *It;
+			if(done[n])continue;
+			int first = n;
+			int start = rightward ? 2 * n : 2 * n + 1;
+			if(fabs(crossings[2 * n + 1].x - crossings[2 * n].x) < tiny_length)
+			{
+				done[n] = true;
+				continue;
+			}
+
+			starts.push_back(CZigZagStart(crossings[start].x, (int)line_zigs.size()));
+			line_zigs.push_back(Curve());
+			Curve &zig = line_zigs.back();
+			zig.push_back(Vertex(0, crossings[start].x, y, 0.0, 0.0));
+			size_t size_after_pieces = 0;
+			bool got_to_next_line = false;
+			for(int count = 0; count < num_pieces; count++)
+			{
+				done[n] = true;
+				int end = rightward ? 2 * n + 1 : 2 * n;
+				AddVertex(zig, 0, crossings[end].x, y, 0.0, 0.0);
+				size_after_pieces = zig.size();
+				int c = sweep.Zag(line, end, &zig);
+				if(c < 0)
+				{
+					got_to_next_line = true;
+					break;
+				}
+				n = c / 2;
+				if(n == first)break;
+			}
+
+			// unidirectional zigs stay on the scanline
+			if(unidirectional || !got_to_next_line)zig.resize(size_after_pieces, zig.back());
+		}
+
+		// in the order they go, as zigzag.py gives them
+		std::stable_sort(starts.begin(), starts.end(), rightward ? StartsBefore : StartsAfter);
+		for(std::vector<CZigZagStart>::iterator It = starts.begin(); It != starts.end(); It++)zigs.push_back(line_zigs[It->zig]);
+	}
+
+	// rotate them back
+	double cos_b = cos(radians), sin_b = sin(radians);
+	for(std::vector<Curve>::iterator It = zigs.begin(); It != zigs.end(); It++)
+	{
+		for(Curve::iterator VIt = It->begin(); VIt != It->end(); VIt++)
+		{
+			Vertex &v = *VIt;
+			double x = v.x * cos_b - v.y * sin_b;
+			double y = v.x * sin_b + v.y * cos_b;
+			v.x = x;
+			v.y = y;
+			if(v.type != 0)
+			{
+				double cx = v.cx * cos_b - v.cy * sin_b;
+				double cy = v.cx * sin_b + v.cy * cos_b;
+				v.cx = cx;
+				v.cy = cy;
+			}
+		}
+	}
+
+	// put the zigs which start where another ends after it, as zigzag.py's reorder_zigs does
+	std::vector< std::vector<int> > chains;
+	for(int i = 0; i < (int)zigs.size(); i++)
+	{
+		const Vertex &s = zigs[i].front();
+		bool added = false;
+		for(std::vector< std::vector<int> >::iterator It = chains.begin(); It != chains.end(); It++)
+		{
+			const Vertex &e = zigs[It->back()].back();
+			if(fabs(s.x - e.x) < tolerance && fabs(s.y - e.y) < tolerance)
+			{
+				It->push_back(i);
+				added = true;
+				break;
+			}
+		}
+		if(!added)chains.push_back(std::vector<int>(1, i));
+	}
+	std::vector<Curve> ordered;
+	ordered.reserve(zigs.size());
+	for(std::vector< std::vector<int> >::iterator It = chains.begin(); It != chains.end(); It++)
+	{
+		for(std::vector<int>::iterator ZIt = It->begin(); ZIt != It->end(); ZIt++)ordered.push_back(zigs[*ZIt]);
+	}
+	zigs.swap(ordered);
+}
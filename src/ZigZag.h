@@ -0,0 +1,29 @@
+// ZigZag.h
+/*
+ * Copyright (c) 2009, Dan Heeks
+ * This program is released under the BSD license. See the file COPYING for
+ * details.
+ */
+
+// Makes the zig zag paths for clearing a pocket, the same as postprocessor/zigzag.py does, but with one sweep of scanlines across the whole area,
+// instead of intersecting the area with a rectangle for each stripe.
+// Each zig goes along a scanline, then follows the edge of the area up to the next scanline, where the next zig starts, going the other way.
+// Each zig is a curve of its own, so they are cut the same way as zigzag.py's, with a feed possible check between them.
+// It has no wx or OpenCascade in it.
+
+#pragma once
+
+#include "CurveSpans.h"
+
+class CZigZag
+{
+public:
+	typedef CCurveVertex Vertex;
+	typedef CCurve Curve;
+
+	// Sets zigs to the paths across the area made by curves, which are closed; the outsides and the islands, going either way round.
+	// The scanlines are stepover apart, at angle degrees from the x axis, and the first is start_offset above the bottom of the area.
+	// Unidirectional zigs all go the same way, without following the edge of the area up to the next scanline.
+	// Points closer than tolerance are the same point, for ordering the zigs.
+	static void Make(const std::vector<Curve> &curves, double stepover, bool unidirectional, double angle, double start_offset, double tolerance, std::vector<Curve> &zigs);
+};
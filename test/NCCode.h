@@ -0,0 +1,87 @@
+// NCCode.h : stands in for src/NCCode.h when the tests are built, like stdafx.h, so that CIsoReader and CNCCodeLoader can be built
+// without wxWidgets, OpenCascade or HeeksCAD. It has only the parts of CNCCode and CNCCodeBlock which they use, and the little bit
+// of wxString they use. It is copied next to the sources, see backplot_readers in CMakeLists.txt, so that it is the one they include.
+//
+// Copyright (c) 2009, Dan Heeks
+// This program is released under the BSD license. See the file COPYING for details.
+
+#pragma once
+
+#include "NCMoveBuffer.h"
+
+#include <list>
+#include <vector>
+#include <string>
+#include <string.h>
+
+#define _T(x) x
+
+enum wxConvStandIn { wxConvUTF8, wxConvFile };
+
+// 8 bit text only
+class wxString: public std::string
+{
+public:
+	wxString(){}
+	wxString(const char* s): std::string(s){}
+	wxString(const char* s, wxConvStandIn, size_t length): std::string(s, length){}
+	static wxString From8BitData(const char* s, size_t length){ return wxString(s, wxConvUTF8, length); }
+	size_t Len()const{ return size(); }
+	const char* mb_str(wxConvStandIn)const{ return c_str(); }
+};
+
+enum ColorEnum{
+	ColorDefaultType,
+	ColorBlockType,
+	ColorMiscType,
+	ColorProgramType,
+	ColorToolType,
+	ColorCommentType,
+	ColorVariableType,
+	ColorPrepType,
+	ColorAxisType,
+	ColorRapidType,
+	ColorFeedType,
+	MaxColorTypes
+};
+
+class ColouredText
+{
+public:
+	wxString m_str;
+	ColorEnum m_color_type;
+	ColouredText():m_color_type(ColorDefaultType){}
+};
+
+class CNCCode;
+
+class CNCCodeBlock
+{
+public:
+	std::list<ColouredText> m_text;
+	CNCCode* m_nc_code;
+	size_t m_first_move, m_number_of_moves;
+	long m_from_pos, m_to_pos;
+
+	CNCCodeBlock(CNCCode* nc_code = NULL) : m_nc_code(nc_code), m_first_move(0), m_number_of_moves(0), m_from_pos(-1), m_to_pos(-1) {}
+};
+
+class CNCCode
+{
+public:
+	std::vector<CNCCodeBlock*> m_blocks;
+	CNCMoveBuffer m_moves;
+
+	~CNCCode()
+	{
+		for(size_t i = 0; i < m_blocks.size(); i++)delete m_blocks[i];
+	}
+
+	// the names which CNCCode::InitializeColorProperties gives the colours
+	static ColorEnum GetColor(const char* name, ColorEnum def=ColorDefaultType)
+	{
+		static const char* names[MaxColorTypes] = {"default", "blocknum", "misc", "program", "tool", "comment", "variable", "prep", "axis", "rapid", "feed"};
+		for(int i = 0; i < MaxColorTypes; i++)if(!strcmp(name, names[i]))return (ColorEnum)i;
+		return def;
+	}
+};
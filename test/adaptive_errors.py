@@ -0,0 +1,107 @@
+################################################################################
+# adaptive_errors.py
+#
+# Checks that postprocessor/adaptive.py raises an error naming the pocket,
+# rather than doing offsets, which take full width cuts, instead of adaptive
+# paths; without HeeksCNC's own python, and for a pocket too big for the
+# grid, for which heekscnc.adaptive gives None. Then that the paths it does
+# get are used, with the finishing pass round the boundary after them.
+#
+# python adaptive_errors.py
+
+import sys
+import os
+import types
+
+heekscnc_dir = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..')
+sys.path.insert(0, heekscnc_dir)
+
+################################################################################
+# the area module, for one square
+
+class Point:
+    def __init__(self, x = 0.0, y = 0.0):
+        self.x = x
+        self.y = y
+
+class Vertex:
+    def __init__(self, type, p, c, user_data = 0):
+        self.type = type
+        self.p = p
+        self.c = c
+
+class Curve:
+    def __init__(self):
+        self.vertices = []
+
+    def append(self, v):
+        self.vertices.append(v)
+
+    def getVertices(self):
+        return self.vertices
+
+    def Reverse(self):
+        self.vertices.reverse()
+
+class Area:
+    def __init__(self):
+        self.curves = []
+
+    def append(self, curve):
+        self.curves.append(curve)
+
+    def getCurves(self):
+        return self.curves
+
+    def num_curves(self):
+        return len(self.curves)
+
+area = types.ModuleType('area')
+area.Point = Point
+area.Vertex = Vertex
+area.Curve = Curve
+area.Area = Area
+area.get_units = lambda: 1.0
+sys.modules['area'] = area
+
+################################################################################
+
+import postprocessor
+adaptive = sys.modules['postprocessor.adaptive']
+
+def square():
+    a = Area()
+    c = Curve()
+    for x, y in [(0, 0), (10, 0), (10, 10), (0, 10), (0, 0)]:
+        c.append(Vertex(0, Point(x, y), Point(0, 0)))
+    a.append(c)
+    return a
+
+def main():
+    failures = 0
+
+    for native, what in [(None, "without HeeksCNC's own python"), (lambda *args: None, 'for a pocket too big for the grid')]:
+        adaptive.native_adaptive = native
+        try:
+            curves = adaptive.adaptive(square(), square(), 1.0, 0.5, 'conventional', 'Roughing')
+            print '%s, %d curves were made instead of an error' % (what, len(curves))
+            failures = failures + 1
+        except Exception, e:
+            if str(e).find('"Roughing"') == -1:
+                print '%s, the error doesn\'t name the pocket: %s' % (what, e)
+                failures = failures + 1
+
+    adaptive.native_adaptive = lambda *args: [[(0, 2.0, 2.0, 0.0, 0.0), (0, 8.0, 2.0, 0.0, 0.0)]]
+    curves = adaptive.adaptive(square(), square(), 1.0, 0.5, 'conventional', 'Roughing')
+    if len(curves) != 2 or [(v.p.x, v.p.y) for v in curves[0].getVertices()] != [(2.0, 2.0), (8.0, 2.0)]:
+        print 'the path from heekscnc.adaptive, then the boundary, weren\'t given'
+        failures = failures + 1
+
+    if failures:
+        print '%d failures' % failures
+        return 1
+    print 'adaptive raised both errors, naming the pocket'
+    return 0
+
+if __name__ == '__main__':
+    sys.exit(main())
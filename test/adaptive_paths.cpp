@@ -0,0 +1,365 @@
+// adaptive_paths.cpp
+// Makes adaptive clearing paths with CAdaptive::Make for random rectangular pockets, and cuts them on a finer grid of its own, as
+// area_funcs.cut_curvelist does with joined_only: the cutter stays down from a path to the next one only if it starts where the last one ended,
+// else it is raised. Then the finishing pass postprocessor/adaptive.py adds goes round the boundary.
+// Half the pockets have round islands. The others have only a ring of material left in them, like a rest pocket, so the next place to start
+// is sometimes on the other side of the ring, where going straight there would go through it.
+// It checks that the centre of the cutter stays inside the boundary, that the paths which start where the last one ended never cut more
+// than twice the stepover, over the length of the cutter's diameter, and that nothing is left except the corners the cutter can't get into.
+// A slot straight through the material, like the cutter used to feed along between paths, is cut too, to check that that would be seen.
+// It checks that a pocket too big for cells a quarter of the stepover across is turned down.
+//
+// adaptive_paths [number of pockets] [size of the pockets]
+
+#include "stdafx.h"
+#include "Adaptive.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+static const double PI = 3.1415926535897932;
+
+static double Now()
+{
+	return (double)clock() / CLOCKS_PER_SEC;
+}
+
+static double Random(double a, double b)
+{
+	return a + (b - a) * rand() / RAND_MAX;
+}
+
+struct Island
+{
+	double x, y, radius;
+};
+
+struct Pocket
+{
+	double x0, y0, x1, y1;
+	std::vector<Island> islands;
+	double ring_inside, ring_outside; // the radii of the ring of material, about the middle of the pocket, or zero if it's all material
+};
+
+static CCurve Rectangle(double x0, double y0, double x1, double y1)
+{
+	CCurve curve;
+	curve.push_back(CCurveVertex(0, x0, y0, 0.0, 0.0));
+	curve.push_back(CCurveVertex(0, x1, y0, 0.0, 0.0));
+	curve.push_back(CCurveVertex(0, x1, y1, 0.0, 0.0));
+	curve.push_back(CCurveVertex(0, x0, y1, 0.0, 0.0));
+	curve.push_back(CCurveVertex(0, x0, y0, 0.0, 0.0));
+	return curve;
+}
+
+static CCurve Circle(double x, double y, double radius)
+{
+	CCurve curve;
+	curve.push_back(CCurveVertex(0, x + radius, y, 0.0, 0.0));
+	curve.push_back(CCurveVertex(1, x - radius, y, x, y));
+	curve.push_back(CCurveVertex(1, x + radius, y, x, y));
+	return curve;
+}
+
+static Pocket MakePocket(double size, double tool_radius, bool ring)
+{
+	Pocket pocket;
+	pocket.x0 = Random(-10, 10);
+	pocket.y0 = Random(-10, 10);
+	pocket.x1 = pocket.x0 + size * Random(0.6, 1.0);
+	pocket.y1 = pocket.y0 + size * Random(0.4, 0.8);
+	pocket.ring_inside = 0.0;
+	pocket.ring_outside = 0.0;
+	if(ring)
+	{
+		// with room for the cutter inside it and outside it
+		pocket.ring_outside = std::min(pocket.x1 - pocket.x0, pocket.y1 - pocket.y0) / 2 - tool_radius * 2 - 1;
+		pocket.ring_inside = std::max(pocket.ring_outside - Random(tool_radius * 2, tool_radius * 5), tool_radius * 2);
+		return pocket;
+	}
+
+	int num_islands = rand() % 4;
+	for(int tries = 0; tries < 100 && (int)pocket.islands.size() < num_islands; tries++)
+	{
+		// the islands and the boundary round them don't touch the sides, or each other
+		Island island;
+		island.radius = Random(2, size / 8);
+		double margin = island.radius + tool_radius * 2 + 1;
+		if(pocket.x1 - pocket.x0 < margin * 2 || pocket.y1 - pocket.y0 < margin * 2)continue;
+		island.x = Random(pocket.x0 + margin, pocket.x1 - margin);
+		island.y = Random(pocket.y0 + margin, pocket.y1 - margin);
+		bool apart = true;
+		for(size_t i = 0; i < pocket.islands.size(); i++)
+		{
+			const Island &other = pocket.islands[i];
+			double dx = island.x - other.x, dy = island.y - other.y;
+			if(sqrt(dx * dx + dy * dy) < island.radius + other.radius + tool_radius * 2 + 1)apart = false;
+		}
+		if(apart)pocket.islands.push_back(island);
+	}
+	return pocket;
+}
+
+// how far x, y is inside the boundary for the centre of the cutter, or less than zero if it is outside
+static double Inside(const Pocket &pocket, double tool_radius, double x, double y)
+{
+	double d = std::min(std::min(x - pocket.x0, pocket.x1 - x), std::min(y - pocket.y0, pocket.y1 - y)) - tool_radius;
+	for(size_t i = 0; i < pocket.islands.size(); i++)
+	{
+		const Island &island = pocket.islands[i];
+		d = std::min(d, sqrt((x - island.x) * (x - island.x) + (y - island.y) * (y - island.y)) - island.radius - tool_radius);
+	}
+	return d;
+}
+
+static bool IsMaterial(const Pocket &pocket, double x, double y)
+{
+	if(Inside(pocket, 0.0, x, y) <= 0.0)return false;
+	if(pocket.ring_outside == 0.0)return true;
+	double cx = (pocket.x0 + pocket.x1) / 2, cy = (pocket.y0 + pocket.y1) / 2;
+	double r = sqrt((x - cx) * (x - cx) + (y - cy) * (y - cy));
+	return r > pocket.ring_inside && r < pocket.ring_outside;
+}
+
+// the material, as a grid of its own, finer than CAdaptive's
+class Material
+{
+public:
+	double m_min_x, m_min_y, m_cell, m_radius;
+	int m_nx, m_ny;
+	std::vector<char> m_cells;
+
+	Material(const Pocket &pocket, double cell, double tool_radius): m_cell(cell), m_radius(tool_radius)
+	{
+		m_min_x = pocket.x0 - cell;
+		m_min_y = pocket.y0 - cell;
+		m_nx = (int)((pocket.x1 - pocket.x0) / cell) + 3;
+		m_ny = (int)((pocket.y1 - pocket.y0) / cell) + 3;
+		m_cells.resize(m_nx * m_ny, 0);
+		for(int j = 0; j < m_ny; j++)
+		{
+			for(int i = 0; i < m_nx; i++)m_cells[j * m_nx + i] = IsMaterial(pocket, m_min_x + (i + 0.5) * cell, m_min_y + (j + 0.5) * cell) ? 1 : 0;
+		}
+	}
+
+	// removes the material under the cutter at x, y, returning its area
+	double Cut(double x, double y)
+	{
+		int removed = 0;
+		int j0 = std::max((int)floor((y - m_radius - m_min_y) / m_cell), 0), j1 = std::min((int)floor((y + m_radius - m_min_y) / m_cell), m_ny - 1);
+		int i0 = std::max((int)floor((x - m_radius - m_min_x) / m_cell), 0), i1 = std::min((int)floor((x + m_radius - m_min_x) / m_cell), m_nx - 1);
+		for(int j = j0; j <= j1; j++)
+		{
+			double dy = m_min_y + (j + 0.5) * m_cell - y;
+			for(int i = i0; i <= i1; i++)
+			{
+				double dx = m_min_x + (i + 0.5) * m_cell - x;
+				char &c = m_cells[j * m_nx + i];
+				if(c && dx * dx + dy * dy <= m_radius * m_radius)
+				{
+					c = 0;
+					removed++;
+				}
+			}
+		}
+		return removed * m_cell * m_cell;
+	}
+
+	double Left()const
+	{
+		int left = 0;
+		for(size_t i = 0; i < m_cells.size(); i++)left += m_cells[i];
+		return left * m_cell * m_cell;
+	}
+};
+
+// cuts along the path, after its first point, returning the most cut over the length of the cutter's diameter, for the width of cut,
+// and setting outside if the centre of the cutter goes outside the boundary
+static double CutPath(Material &material, const Pocket &pocket, double tool_radius, const CCurve &path, bool &outside)
+{
+	std::vector<double> lengths, areas;
+	size_t window_start = 0;
+	double window_length = 0.0, window_area = 0.0, widest = 0.0;
+
+	for(size_t v = 1; v < path.size(); v++)
+	{
+		const CCurveVertex &a = path[v - 1];
+		const CCurveVertex &b = path[v];
+		double r = 0.0, a0 = 0.0, sweep = 0.0, length;
+		if(b.type == 0)
+		{
+			length = sqrt((b.x - a.x) * (b.x - a.x) + (b.y - a.y) * (b.y - a.y));
+		}
+		else
+		{
+			r = sqrt((a.x - b.cx) * (a.x - b.cx) + (a.y - b.cy) * (a.y - b.cy));
+			a0 = atan2(a.y - b.cy, a.x - b.cx);
+			sweep = atan2(b.y - b.cy, b.x - b.cx) - a0;
+			if(b.type == 1 && sweep <= 0.0)sweep += 2 * PI;
+			if(b.type == -1 && sweep >= 0.0)sweep -= 2 * PI;
+			length = fabs(sweep) * r;
+		}
+
+		int steps = (int)(length / material.m_cell) + 1;
+		for(int s = 1; s <= steps; s++)
+		{
+			double t = (double)s / steps;
+			double x = a.x + (b.x - a.x) * t, y = a.y + (b.y - a.y) * t;
+			if(b.type != 0)
+			{
+				x = b.cx + r * cos(a0 + sweep * t);
+				y = b.cy + r * sin(a0 + sweep * t);
+			}
+			if(Inside(pocket, tool_radius, x, y) < -1.0e-6)outside = true;
+
+			lengths.push_back(length / steps);
+			areas.push_back(material.Cut(x, y));
+			window_length += lengths.back();
+			window_area += areas.back();
+			while(window_length - lengths[window_start] >= tool_radius * 2)
+			{
+				window_length -= lengths[window_start];
+				window_area -= areas[window_start];
+				window_start++;
+			}
+			if(window_length >= tool_radius * 2)widest = std::max(widest, window_area / window_length);
+		}
+	}
+	return widest;
+}
+
+int main(int argc, char** argv)
+{
+	int number_of_pockets = 20;
+	double size = 60.0;
+	if(argc > 1)number_of_pockets = atoi(argv[1]);
+	if(argc > 2)size = atof(argv[2]);
+
+	srand(1);
+
+	int failures = 0;
+	double make_time = 0.0;
+	int joined = 0, raised = 0;
+	double widest = 0.0;
+
+	for(int p = 0; p < number_of_pockets; p++)
+	{
+		double tool_radius = Random(1.5, 4);
+		double stepover = tool_radius * Random(0.15, 0.5);
+		Pocket pocket = MakePocket(size, tool_radius, (p % 2) == 1);
+
+		std::vector<CCurve> material_curves, boundary_curves;
+		if(pocket.ring_outside > 0.0)
+		{
+			double cx = (pocket.x0 + pocket.x1) / 2, cy = (pocket.y0 + pocket.y1) / 2;
+			material_curves.push_back(Circle(cx, cy, pocket.ring_outside));
+			material_curves.push_back(Circle(cx, cy, pocket.ring_inside));
+		}
+		else
+		{
+			material_curves.push_back(Rectangle(pocket.x0, pocket.y0, pocket.x1, pocket.y1));
+		}
+		boundary_curves.push_back(Rectangle(pocket.x0 + tool_radius, pocket.y0 + tool_radius, pocket.x1 - tool_radius, pocket.y1 - tool_radius));
+		for(size_t i = 0; i < pocket.islands.size(); i++)
+		{
+			const Island &island = pocket.islands[i];
+			material_curves.push_back(Circle(island.x, island.y, island.radius));
+			boundary_curves.push_back(Circle(island.x, island.y, island.radius + tool_radius));
+		}
+
+		std::vector<CCurve> paths;
+		double start = Now();
+		if(!CAdaptive::Make(material_curves, boundary_curves, tool_radius, stepover, (p % 4) < 2, paths))
+		{
+			printf("  pocket %d was turned down\n", p);
+			failures++;
+			continue;
+		}
+		make_time += Now() - start;
+		size_t num_adaptive = paths.size();
+
+		// the finishing pass
+		for(size_t i = 0; i < boundary_curves.size(); i++)paths.push_back(boundary_curves[i]);
+
+		Material material(pocket, stepover / 8, tool_radius);
+		bool outside = false;
+		const CCurveVertex* prev = NULL;
+		for(size_t k = 0; k < paths.size(); k++)
+		{
+			const CCurve &path = paths[k];
+			bool join = (prev != NULL && path[0].x == prev->x && path[0].y == prev->y);
+			if(k < num_adaptive)
+			{
+				if(join)joined++;
+				else if(prev != NULL)raised++;
+			}
+			if(!join)material.Cut(path[0].x, path[0].y); // a plunge, or a rapid down to where it's cleared
+
+			double path_widest = CutPath(material, pocket, tool_radius, path, outside);
+
+			if(k < num_adaptive && join)
+			{
+				widest = std::max(widest, path_widest / stepover);
+				if(path_widest > stepover * 2)
+				{
+					printf("  pocket %d, path %d, which started where the last one ended, cut %.2f, with a stepover of %.2f\n", p, (int)k, path_widest, stepover);
+					failures++;
+				}
+			}
+			prev = &path.back();
+		}
+
+		if(outside)
+		{
+			printf("  pocket %d: the centre of the cutter went outside the boundary\n", p);
+			failures++;
+		}
+
+		// the corners of the pocket, and what's within a cell of an edge of what was cut
+		double corners = (pocket.ring_outside > 0.0) ? 0.0 : (4 - PI) * tool_radius * tool_radius;
+		double perimeter = 2 * (pocket.x1 - pocket.x0 + pocket.y1 - pocket.y0) + 2 * PI * (pocket.ring_inside + pocket.ring_outside);
+		for(size_t i = 0; i < pocket.islands.size(); i++)perimeter += 2 * PI * pocket.islands[i].radius;
+		double left = material.Left();
+		if(left > corners + perimeter * material.m_cell)
+		{
+			printf("  pocket %d: %.2f was left, not just the corners' %.2f\n", p, left, corners);
+			failures++;
+		}
+	}
+
+	// feeding straight through the material, as the cutter used to between paths, is seen
+	{
+		Pocket pocket = MakePocket(size, 3.0, false);
+		pocket.islands.clear();
+		Material material(pocket, 0.1, 3.0);
+		double y = (pocket.y0 + pocket.y1) / 2;
+		CCurve path;
+		path.push_back(CCurveVertex(0, pocket.x0 + 3.0, y, 0.0, 0.0));
+		path.push_back(CCurveVertex(0, pocket.x1 - 3.0, y, 0.0, 0.0));
+		material.Cut(path[0].x, path[0].y);
+		bool outside = false;
+		double widest = CutPath(material, pocket, 3.0, path, outside);
+		if(widest < 5.5)
+		{
+			printf("a slot through the material, with a 6 diameter cutter, was seen as only %.2f wide\n", widest);
+			failures++;
+		}
+	}
+
+	// a pocket which would need cells bigger than a quarter of the stepover
+	std::vector<CCurve> material_curves, boundary_curves, paths;
+	material_curves.push_back(Rectangle(0, 0, 5000, 5000));
+	boundary_curves.push_back(Rectangle(3, 3, 4997, 4997));
+	if(CAdaptive::Make(material_curves, boundary_curves, 3.0, 0.5, true, paths))
+	{
+		printf("a 5000 x 5000 pocket at a stepover of 0.5 wasn't turned down\n");
+		failures++;
+	}
+
+	printf("%d pockets: %d paths started where the last one ended, %d needed the cutter raised\n", number_of_pockets, joined, raised);
+	printf("the paths which started where the last one ended cut at most %.2f times the stepover, over the length of the cutter's diameter\n", widest);
+	printf("making the paths took %.3f s\n", make_time);
+
+	return (failures > 0) ? 1 : 0;
+}
@@ -0,0 +1,119 @@
+// backplot_readers.cpp
+// Reads an NC file with CIsoReader, as HeeksCNC does when the machine's reader is iso_read, and the backplot file which
+// nc/iso_read.py wrote from the same NC file with nc/hbin_writer.py, with CNCCodeLoader, as HeeksCNC does otherwise.
+// Then it checks that both give the same blocks, with the same words in the same colours, and the same moves, and prints how long
+// each took. backplot_readers.py makes the NC files and the backplot files, and times the python.
+//
+// backplot_readers nc_file hbin_file
+
+#include "stdafx.h"
+#include "IsoReader.h"
+#include "NCCodeLoader.h"
+
+#include <stdio.h>
+#include <time.h>
+
+static double Now()
+{
+	return (double)clock() / CLOCKS_PER_SEC;
+}
+
+// the backplot file has millionths of a unit, which may be inches
+static bool Same(const double* a, const double* b)
+{
+	for(int i = 0; i < 3; i++)if(fabs(a[i] - b[i]) > 0.00003)return false;
+	return true;
+}
+
+static void PrintMove(const char* reader, const CNCMoveBuffer &moves, size_t i)
+{
+	const double* x = moves.EndPoint(i);
+	printf("  %s: %s to %g, %g, %g", reader, (moves.Type(i) == CNCMoveBuffer::eArc) ? "arc" : "line", x[0], x[1], x[2]);
+	if(moves.Type(i) == CNCMoveBuffer::eArc)
+	{
+		const double* c = moves.ArcCentre(i);
+		printf(" about %g, %g, %g, direction %d", c[0], c[1], c[2], moves.ArcDir(i));
+	}
+	printf(", tool %d, colour %d, block %d\n", moves.m_tool_number[i], (int)moves.m_color[i], moves.m_block[i]);
+}
+
+static std::string BlockText(const CNCCodeBlock* block)
+{
+	std::string s;
+	for(std::list<ColouredText>::const_iterator It = block->m_text.begin(); It != block->m_text.end(); It++)
+	{
+		char colour[16];
+		sprintf(colour, "[%d]", (int)It->m_color_type);
+		s += It->m_str + colour;
+	}
+	return s;
+}
+
+// prints the first difference, and returns false, if there is one
+static bool Compare(const CNCCode &iso, const CNCCode &loaded)
+{
+	size_t number_of_blocks = std::min(iso.m_blocks.size(), loaded.m_blocks.size());
+	for(size_t b = 0; b < number_of_blocks; b++)
+	{
+		const CNCCodeBlock* a = iso.m_blocks[b];
+		const CNCCodeBlock* l = loaded.m_blocks[b];
+		std::string a_text = BlockText(a), l_text = BlockText(l);
+		if(a_text != l_text || a->m_from_pos != l->m_from_pos || a->m_to_pos != l->m_to_pos || a->m_first_move != l->m_first_move || a->m_number_of_moves != l->m_number_of_moves)
+		{
+			printf("block %u differs\n  CIsoReader:     %s, at %ld to %ld, moves %u to %u\n  CNCCodeLoader:  %s, at %ld to %ld, moves %u to %u\n", (unsigned)b,
+				a_text.c_str(), a->m_from_pos, a->m_to_pos, (unsigned)a->m_first_move, (unsigned)(a->m_first_move + a->m_number_of_moves),
+				l_text.c_str(), l->m_from_pos, l->m_to_pos, (unsigned)l->m_first_move, (unsigned)(l->m_first_move + l->m_number_of_moves));
+			return false;
+		}
+	}
+	if(iso.m_blocks.size() != loaded.m_blocks.size())
+	{
+		printf("CIsoReader has %u blocks, CNCCodeLoader %u\n", (unsigned)iso.m_blocks.size(), (unsigned)loaded.m_blocks.size());
+		return false;
+	}
+
+	const CNCMoveBuffer &a = iso.m_moves;
+	const CNCMoveBuffer &l = loaded.m_moves;
+	for(size_t i = 0; i < a.size() && i < l.size(); i++)
+	{
+		bool same = (a.Type(i) == l.Type(i) && Same(a.EndPoint(i), l.EndPoint(i)) && a.m_tool_number[i] == l.m_tool_number[i] && a.m_color[i] == l.m_color[i]
+			&& a.m_block[i] == l.m_block[i]);
+		if(same && a.Type(i) == CNCMoveBuffer::eArc)same = (Same(a.ArcCentre(i), l.ArcCentre(i)) && a.ArcDir(i) == l.ArcDir(i));
+		if(!same)
+		{
+			printf("move %u differs\n", (unsigned)i);
+			PrintMove("CIsoReader   ", a, i);
+			PrintMove("CNCCodeLoader", l, i);
+			return false;
+		}
+	}
+	if(a.size() != l.size())
+	{
+		printf("CIsoReader has %u moves, CNCCodeLoader %u\n", (unsigned)a.size(), (unsigned)l.size());
+		return false;
+	}
+	return true;
+}
+
+int main(int argc, char** argv)
+{
+	if(argc < 3)
+	{
+		printf("usage: backplot_readers nc_file hbin_file\n");
+		return 1;
+	}
+
+	CNCCode iso, loaded;
+	double t0 = Now();
+	CIsoReader reader(&iso);
+	if(!reader.ReadFile(argv[1])){ printf("couldn't read %s\n", argv[1]); return 1; }
+	double t1 = Now();
+	CNCCodeLoader loader(&loaded);
+	if(!loader.LoadFile(argv[2])){ printf("couldn't load %s\n", argv[2]); return 1; }
+	double t2 = Now();
+
+	bool same = Compare(iso, loaded);
+	printf("CIsoReader %.3f s, CNCCodeLoader %.3f s, %u blocks, %u moves%s\n", t1 - t0, t2 - t1, (unsigned)iso.m_blocks.size(), (unsigned)iso.m_moves.size(),
+		same ? "" : ", DIFFERENT");
+	return same ? 0 : 1;
+}
@@ -0,0 +1,141 @@
+################################################################################
+# backplot_readers.py
+#
+# Gives the same NC files to the two ways HeeksCNC backplots ISO NC code:
+# src/IsoReader.cpp, in HeeksCNC, and nc/iso_read.py, which writes the
+# backplot file with nc/hbin_writer.py for src/NCCodeLoader.cpp to load.
+# backplot_readers, built from backplot_readers.cpp, reads the NC file with
+# CIsoReader and loads the python's backplot file with CNCCodeLoader, checks
+# they have the same blocks and moves, and times both; the python is timed
+# here. The times are the best of three.
+# The NC files are a made up mixture of rapids, feeds and arcs, in mm and in
+# inches, and random programs written by the python posts of the machines
+# whose reader is iso_read, from the same calls as iso_backends.py makes.
+#
+# python backplot_readers.py backplot_readers [number of lines] [number of programs]
+
+import sys
+import os
+import re
+import time
+import random
+import tempfile
+import shutil
+import subprocess
+
+heekscnc_dir = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..')
+sys.path.insert(0, heekscnc_dir)
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+
+try:
+    import area
+except ImportError:
+    print 'backplot_readers.py needs the area module'
+    sys.exit(77) # skipped
+
+import nc.iso_read
+from nc.hbin_writer import HbinWriter
+import iso_backends
+
+def make_nc_file(path, lines, imperial):
+    rand = random.Random(lines)
+    f = open(path, 'w')
+    f.write('%s G90\nT1 M06\nG00 X0 Y0 Z5\n' % ('G20' if imperial else 'G21'))
+    x = 0.0
+    y = 0.0
+    n = 3
+    while n < lines:
+        r = rand.random()
+        if r < 0.1:
+            x = rand.uniform(0, 200)
+            y = rand.uniform(0, 200)
+            f.write('G00 X%.4f Y%.4f Z5\nG01 Z-1 F200\n' % (x, y))
+            n = n + 2
+        elif r < 0.6:
+            x = x + rand.uniform(-5, 5)
+            y = y + rand.uniform(-5, 5)
+            f.write('G01 X%.4f Y%.4f Z%.4f\n' % (x, y, rand.uniform(-2, 0)))
+            n = n + 1
+        elif r < 0.65:
+            f.write('(a comment %d)\n' % n)
+            n = n + 1
+        else:
+            # a half circle round a centre 2.5 away
+            f.write('N%d G0%d X%.4f Y%.4f I2.5 J0\n' % (n, rand.choice([2, 3]), x + 5, y))
+            x = x + 5
+            n = n + 1
+    f.write('M02\n')
+    f.close()
+
+def iso_read_posts():
+    f = open(os.path.join(heekscnc_dir, 'nc', 'machines.xml'))
+    posts = re.findall(r'<Machine[^>]*\spost="([^"]*)"[^>]*\sreader="iso_read"', f.read())
+    f.close()
+    return posts
+
+def write_backplot(nc_path, hbin_path):
+    parser = nc.iso_read.Parser(HbinWriter(open(hbin_path, 'wb')))
+    parser.Parse(nc_path)
+    # the writer closes its file when it is deleted
+    del parser
+
+def main():
+    if len(sys.argv) < 2:
+        print 'usage: python backplot_readers.py backplot_readers [number of lines] [number of programs]'
+        return 1
+    readers = sys.argv[1]
+    lines = 20000
+    number_of_programs = 5
+    if len(sys.argv) > 2: lines = int(sys.argv[2])
+    if len(sys.argv) > 3: number_of_programs = int(sys.argv[3])
+
+    temp_dir = tempfile.mkdtemp()
+    failures = 0
+    try:
+        nc_files = []
+        for imperial in [False, True]:
+            path = os.path.join(temp_dir, 'mixture_%s.nc' % ('inches' if imperial else 'mm'))
+            make_nc_file(path, lines, imperial)
+            nc_files.append(path)
+        for post in iso_read_posts():
+            for seed in range(0, number_of_programs):
+                path = os.path.join(temp_dir, '%s_%d.nc' % (post, seed))
+                iso_backends.python_replay(post, iso_backends.make_calls(random.Random(seed), lines / 30), path)
+                nc_files.append(path)
+
+        for nc_path in nc_files:
+            hbin_path = nc_path + '.hbin'
+            python_time = None
+            for i in range(0, 3):
+                start = time.time()
+                write_backplot(nc_path, hbin_path)
+                t = time.time() - start
+                if python_time == None or t < python_time: python_time = t
+
+            best = None
+            for i in range(0, 3):
+                process = subprocess.Popen([readers, nc_path, hbin_path], stdout = subprocess.PIPE)
+                output = process.communicate()[0]
+                if process.returncode != 0:
+                    print '%s:\n%s' % (os.path.basename(nc_path), output)
+                    kept = os.path.join(tempfile.gettempdir(), 'backplot_readers_' + os.path.basename(nc_path))
+                    shutil.copy(nc_path, kept)
+                    print '  the NC file is in ' + kept
+                    failures = failures + 1
+                    best = None
+                    break
+                times = [float(t) for t in re.findall(r'([\d.]+) s', output)]
+                if best == None or times[0] + times[1] < best[0] + best[1]: best = times
+            if best != None:
+                print '%-18s %7d bytes: iso_read.py writing the backplot file %.3f s, then CNCCodeLoader %.3f s; CIsoReader %.3f s' % (os.path.basename(nc_path),
+                    os.path.getsize(nc_path), python_time, best[1], best[0])
+    finally:
+        shutil.rmtree(temp_dir)
+
+    if failures:
+        print '%d of the NC files were backplotted differently' % failures
+        return 1
+    return 0
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,186 @@
+################################################################################
+# bench_backplot.py
+#
+# Compares the two backplot files, backplot.xml from nc/hxml_writer.py and
+# backplot.hbin from nc/hbin_writer.py, on the same NC file.
+# For each it times reading the NC file with nc/iso_read.py and writing the
+# backplot file, then times loading the backplot file again, and gives its size.
+# The time for reading the NC file without writing anything is given first.
+# The times are the best of three.
+# It also checks that both files have the same moves in them.
+# Both files are loaded in python here; HeeksCNC loads backplot.xml with TinyXML
+# and backplot.hbin with CNCCodeLoader, so the load times are only a guide.
+#
+# python bench_backplot.py [nc file | number of lines to make]
+#
+# Without an NC file, one is made, with a mixture of rapids, feeds and arcs.
+
+import sys
+import os
+import time
+import tempfile
+import random
+import struct
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), '..'))
+
+try:
+    import area
+except ImportError:
+    print 'bench_backplot.py needs the area module'
+    sys.exit(77) # skipped
+
+import nc.iso_read
+from nc.hxml_writer import HxmlWriter
+from nc.hbin_writer import HbinWriter
+from nc.backplot_writer import BackplotWriter
+import nc.hbin_writer as hbin
+
+class NullWriter(BackplotWriter):
+    # writes nothing, to time the NC file reader on its own
+    def begin_ncblock(self): pass
+    def end_ncblock(self): pass
+    def add_text(self, s, col, cdata): pass
+    def set_mode(self, units): pass
+    def begin_path(self, col): pass
+    def end_path(self): pass
+    def tool_change(self, id): pass
+    def add_line(self, x, y, z, a = None, b = None, c = None): pass
+    def add_arc(self, x, y, z, i, j, k, r = None, d = None): pass
+
+def make_nc_file(path, lines):
+    random.seed(1)
+    f = open(path, 'w')
+    f.write('G21 G90\nT1 M06\nG00 X0 Y0 Z5\n')
+    x = 0.0
+    y = 0.0
+    n = 3
+    while n < lines:
+        r = random.random()
+        if r < 0.1:
+            x = random.uniform(0, 200)
+            y = random.uniform(0, 200)
+            f.write('G00 X%.4f Y%.4f Z5\nG01 Z-1 F200\n' % (x, y))
+            n = n + 2
+        elif r < 0.7:
+            x = x + random.uniform(-5, 5)
+            y = y + random.uniform(-5, 5)
+            f.write('G01 X%.4f Y%.4f Z%.4f\n' % (x, y, random.uniform(-2, 0)))
+            n = n + 1
+        else:
+            # a half circle round a centre 2.5 away
+            f.write('G0%d X%.4f Y%.4f I2.5 J0\n' % (random.choice([2, 3]), x + 5, y))
+            x = x + 5
+            n = n + 1
+    f.write('M02\n')
+    f.close()
+
+def write_backplot(nc_path, writer):
+    parser = nc.iso_read.Parser(writer)
+    parser.Parse(nc_path)
+    # the writers close their files when they are deleted
+    del parser
+
+def read_xml(path):
+    # like CNCCode::ReadFromXMLElement, which has the whole document in memory
+    try:
+        import xml.etree.cElementTree as ElementTree
+    except ImportError:
+        import xml.etree.ElementTree as ElementTree
+    moves = []
+    for e in ElementTree.parse(path).getroot().iter():
+        if e.tag == 'line' or e.tag == 'arc':
+            moves.append((e.tag, coordinate(e.get('x')), coordinate(e.get('y')), coordinate(e.get('z'))))
+    return moves
+
+def coordinate(s):
+    if s == None: return None
+    return int(round(float(s) * 1000000.0))
+
+def read_varint(data, pos):
+    n = 0
+    shift = 0
+    while True:
+        b = ord(data[pos])
+        pos = pos + 1
+        n = n | ((b & 127) << shift)
+        if b < 128: return (n, pos)
+        shift = shift + 7
+
+def read_zigzag(data, pos):
+    (n, pos) = read_varint(data, pos)
+    if n & 1: return (-((n + 1) >> 1), pos)
+    return (n >> 1, pos)
+
+def read_hbin(path):
+    # like CNCCodeLoader::Decode, except that coordinates which weren't given are None
+    data = open(path, 'rb').read()
+    if data[0:4] != 'HNCB': raise ValueError(path + ' is not a backplot file')
+    pos = 5
+    last = [0, 0, 0]
+    moves = []
+    while pos < len(data):
+        type = ord(data[pos])
+        (length, pos) = read_varint(data, pos + 1)
+        if type == hbin.REC_LINE or type == hbin.REC_ARC:
+            p = pos + (3 if type == hbin.REC_ARC else 2)
+            flags = ord(data[p - 1])
+            xyz = [None, None, None]
+            for i in range(0, 3):
+                if flags & (1 << i):
+                    (delta, p) = read_zigzag(data, p)
+                    last[i] = last[i] + delta
+                    xyz[i] = last[i]
+            moves.append(('arc' if type == hbin.REC_ARC else 'line', xyz[0], xyz[1], xyz[2]))
+        pos = pos + length
+    return moves
+
+def main():
+    nc_path = None
+    lines = 200000
+    if len(sys.argv) > 1:
+        if sys.argv[1].isdigit(): lines = int(sys.argv[1])
+        else: nc_path = sys.argv[1]
+
+    if nc_path == None:
+        nc_path = os.path.join(tempfile.gettempdir(), 'bench_backplot.nc')
+        make_nc_file(nc_path, lines)
+
+    print '%s, %d bytes' % (nc_path, os.path.getsize(nc_path))
+
+    xml_path = os.path.join(tempfile.gettempdir(), 'backplot.xml')
+    hbin_path = os.path.join(tempfile.gettempdir(), 'backplot.hbin')
+
+    read_time = None
+    for i in range(0, 3):
+        t0 = time.time()
+        write_backplot(nc_path, NullWriter())
+        t1 = time.time()
+        if read_time == None or t1 - t0 < read_time: read_time = t1 - t0
+    print 'read  %7.2f s' % read_time
+
+    results = []
+    for (name, path, make_writer, read) in [('xml', xml_path, HxmlWriter, read_xml), ('hbin', hbin_path, HbinWriter, read_hbin)]:
+        write_time = None
+        load_time = None
+        for i in range(0, 3):
+            t0 = time.time()
+            write_backplot(nc_path, make_writer())
+            t1 = time.time()
+            moves = read(path)
+            t2 = time.time()
+            if write_time == None or t1 - t0 < write_time: write_time = t1 - t0
+            if load_time == None or t2 - t1 < load_time: load_time = t2 - t1
+        size = os.path.getsize(path)
+        print '%-5s write %7.2f s   load %7.2f s   %11d bytes   %d moves' % (name, write_time, load_time, size, len(moves))
+        results.append(moves)
+
+    if results[0] != results[1]:
+        for i in range(0, min(len(results[0]), len(results[1]))):
+            if results[0][i] != results[1][i]:
+                print 'move %d differs: %s %s' % (i, results[0][i], results[1][i])
+                break
+        print 'the xml and hbin backplots have different moves'
+        sys.exit(1)
+
+main()
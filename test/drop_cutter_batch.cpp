@@ -0,0 +1,145 @@
+// drop_cutter_batch.cpp
+// Checks that DropCutter's batch VertexTest, FacetTest and EdgeTest give the same heights as the scalar ones,
+// triangle by triangle, for flat, ball and bull nosed cutters, and times the scalar TriTest against the batch one.
+//
+// drop_cutter_batch [number of triangles] [number of cutter locations]
+
+#include "stdafx.h"
+#include "DropCutter.h"
+#include "GTri.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+static double Now()
+{
+	return (double)clock() / CLOCKS_PER_SEC;
+}
+
+static double Random(double a, double b)
+{
+	return a + (b - a) * rand() / RAND_MAX;
+}
+
+static const double no_contact = -10000000.0;
+
+// triangles around the origin, some of them with a flat top or a horizontal edge, so the tests take all their paths
+static void MakeTriangles(size_t number_of_triangles, std::vector<GTri> &tris)
+{
+	for(size_t i = 0; i < number_of_triangles; i++)
+	{
+		double x[9];
+		for(int v = 0; v < 3; v++)
+		{
+			x[v * 3] = Random(-6, 6);
+			x[v * 3 + 1] = Random(-6, 6);
+			x[v * 3 + 2] = Random(-3, 3);
+		}
+		switch(i % 4)
+		{
+		case 1: x[5] = x[8] = x[2]; break; // flat
+		case 2: x[5] = x[2]; break; // a horizontal edge
+		default: break;
+		}
+		tris.push_back(GTri(x));
+	}
+}
+
+// the biggest difference between the scalar and batch results, counting no contact as no_contact
+static void Check(double scalar, double batch, double &worst)
+{
+	if(scalar < no_contact)scalar = no_contact;
+	double d = fabs(scalar - batch);
+	if(d > worst)worst = d;
+}
+
+int main(int argc, char** argv)
+{
+	size_t number_of_triangles = 4000;
+	size_t number_of_points = 1000;
+	if(argc > 1)number_of_triangles = atol(argv[1]);
+	if(argc > 2)number_of_points = atol(argv[2]);
+	number_of_triangles -= number_of_triangles % GTriBatch::SIZE;
+	srand(1);
+
+	std::vector<GTri> tris;
+	MakeTriangles(number_of_triangles, tris);
+	std::vector<GTriBatch> batches(number_of_triangles / GTriBatch::SIZE);
+	for(size_t i = 0; i < number_of_triangles; i++)batches[i / GTriBatch::SIZE].set(i % GTriBatch::SIZE, tris[i]);
+
+	std::vector<double> points;
+	for(size_t i = 0; i < number_of_points; i++)
+	{
+		points.push_back(Random(-4, 4));
+		points.push_back(Random(-4, 4));
+		points.push_back(0.0);
+	}
+
+	Cutter cutters[3] = {Cutter(3.0, 0.0, 0.001), Cutter(3.0, 3.0, 0.001), Cutter(3.0, 1.0, 0.001)};
+	const char* names[3] = {"flat", "ball", "bull nosed"};
+	int failures = 0;
+	for(int c = 0; c < 3; c++)
+	{
+		const Cutter &cu = cutters[c];
+
+		// each test on its own, for the first few points
+		double vertex_worst = 0.0, facet_worst = 0.0, edge_worst = 0.0;
+		size_t contacts = 0;
+		for(size_t p = 0; p < number_of_points && p < 200; p++)
+		{
+			const double* e = &points[p * 3];
+			for(size_t b = 0; b < batches.size(); b++)
+			{
+				const GTriBatch &batch = batches[b];
+				double z[GTriBatch::SIZE];
+
+				for(int i = 0; i < GTriBatch::SIZE; i++)z[i] = no_contact;
+				DropCutter::FacetTest(cu, e, batch, z);
+				for(int i = 0; i < GTriBatch::SIZE; i++)Check(DropCutter::FacetTest(cu, e, tris[b * GTriBatch::SIZE + i]), z[i], facet_worst);
+
+				for(int v = 0; v < 3; v++)
+				{
+					int w = (v + 1) % 3;
+					for(int i = 0; i < GTriBatch::SIZE; i++)z[i] = no_contact;
+					DropCutter::EdgeTest(cu, e, batch.m_x[v], batch.m_y[v], batch.m_z[v], batch.m_x[w], batch.m_y[w], batch.m_z[w], z);
+					for(int i = 0; i < GTriBatch::SIZE; i++)
+					{
+						const GTri &tri = tris[b * GTriBatch::SIZE + i];
+						double s = DropCutter::EdgeTest(cu, e, &tri.m_p[v * 3], &tri.m_p[w * 3]);
+						if(s > no_contact)contacts++;
+						Check(s, z[i], edge_worst);
+					}
+
+					for(int i = 0; i < GTriBatch::SIZE; i++)z[i] = no_contact;
+					DropCutter::VertexTest(cu, e, batch.m_x[v], batch.m_y[v], batch.m_z[v], z);
+					for(int i = 0; i < GTriBatch::SIZE; i++)Check(DropCutter::VertexTest(cu, e, &tris[b * GTriBatch::SIZE + i].m_p[v * 3]), z[i], vertex_worst);
+				}
+			}
+		}
+
+		// all the tests together, timed; both give the highest z at each cutter location
+		std::vector<double> scalar_z(number_of_points, no_contact), batch_z(number_of_points, no_contact);
+		double t0 = Now();
+		for(size_t p = 0; p < number_of_points; p++)
+		{
+			for(size_t i = 0; i < number_of_triangles; i++)scalar_z[p] = DropCutter::TriTest(cu, &points[p * 3], tris[i], scalar_z[p]);
+		}
+		double t1 = Now();
+		for(size_t p = 0; p < number_of_points; p++)
+		{
+			for(size_t b = 0; b < batches.size(); b++)batch_z[p] = DropCutter::TriTest(cu, &points[p * 3], batches[b], batch_z[p]);
+		}
+		double t2 = Now();
+		double tri_test_worst = 0.0;
+		for(size_t p = 0; p < number_of_points; p++)Check(scalar_z[p], batch_z[p], tri_test_worst);
+
+		bool ok = (vertex_worst < 1.0e-9 && facet_worst < 1.0e-9 && edge_worst < 1.0e-9 && tri_test_worst < 1.0e-9);
+		if(!ok)failures++;
+		printf("%-10s biggest differences: vertex %g, facet %g, edge %g (%u edge contacts), TriTest %g%s\n", names[c], vertex_worst, facet_worst, edge_worst, (unsigned)contacts, tri_test_worst, ok ? "" : " WRONG");
+		printf("%-10s TriTest: scalar %.3f s, batch %.3f s\n", names[c], t1 - t0, t2 - t1);
+	}
+
+	printf("%u triangles, %u cutter locations\n", (unsigned)number_of_triangles, (unsigned)number_of_points);
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,262 @@
+// drop_cutter_mesh.cpp
+// Checks DropCutterMesh::Drop against DropCutter::TriTest for every triangle, with flat, ball and bull nosed cutters,
+// on a bumpy surface read back from binary and ascii STL files, and times them. The binary one is written again with
+// DropCutterMesh::WriteSTLFile and read back, which must give exactly the same heights.
+// Then it filters a path dropped onto the surface, as nc/attach.py does, with DropCutterMesh::Filter, checks that every point left out
+// is within tolerance of the line between the points kept either side of it, and times it against a filter which checks every point
+// since the last one kept, for each one it tries.
+//
+// drop_cutter_mesh [cells along each side of the surface] [number of points]
+
+#include "stdafx.h"
+#include "DropCutterMesh.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+static double Now()
+{
+	return (double)clock() / CLOCKS_PER_SEC;
+}
+
+static double Random(double a, double b)
+{
+	return a + (b - a) * rand() / RAND_MAX;
+}
+
+static double Height(double x, double y)
+{
+	return 5.0 * sin(x * 0.07) * cos(y * 0.05) + 2.0 * sin(x * 0.31 + y * 0.17);
+}
+
+// a 100 x 100 surface, with two triangles for each cell
+static void MakeSurface(int cells, std::list<GTri> &tris)
+{
+	double step = 100.0 / cells;
+	for(int i = 0; i < cells; i++)
+	{
+		for(int j = 0; j < cells; j++)
+		{
+			double x0 = i * step, y0 = j * step, x1 = x0 + step, y1 = y0 + step;
+			double a[9] = {x0, y0, Height(x0, y0), x1, y0, Height(x1, y0), x1, y1, Height(x1, y1)};
+			double b[9] = {x0, y0, Height(x0, y0), x1, y1, Height(x1, y1), x0, y1, Height(x0, y1)};
+			tris.push_back(GTri(a));
+			tris.push_back(GTri(b));
+		}
+	}
+}
+
+static bool WriteSTL(const char* filepath, const std::list<GTri> &tris, bool binary)
+{
+	FILE* fp = fopen(filepath, binary ? "wb" : "w");
+	if(fp == NULL)return false;
+	if(binary)
+	{
+		char header[80];
+		memset(header, 0, 80);
+		fwrite(header, 1, 80, fp);
+		unsigned int number_of_triangles = (unsigned int)tris.size();
+		fwrite(&number_of_triangles, 4, 1, fp);
+	}
+	else fprintf(fp, "solid surface\n");
+
+	for(std::list<GTri>::const_iterator It = tris.begin(); It != tris.end(); It++)
+	{
+		const GTri &tri = *It;
+		if(binary)
+		{
+			float f[12];
+			for(int k = 0; k < 3; k++)f[k] = (float)tri.m_n[k];
+			for(int k = 0; k < 9; k++)f[3 + k] = (float)tri.m_p[k];
+			fwrite(f, sizeof(float), 12, fp);
+			unsigned short attribute = 0;
+			fwrite(&attribute, 2, 1, fp);
+		}
+		else
+		{
+			fprintf(fp, " facet normal %g %g %g\n  outer loop\n", tri.m_n[0], tri.m_n[1], tri.m_n[2]);
+			for(int v = 0; v < 3; v++)fprintf(fp, "   vertex %.9g %.9g %.9g\n", tri.m_p[v * 3], tri.m_p[v * 3 + 1], tri.m_p[v * 3 + 2]);
+			fprintf(fp, "  endloop\n endfacet\n");
+		}
+	}
+
+	if(!binary)fprintf(fp, "endsolid surface\n");
+	fclose(fp);
+	return true;
+}
+
+// the distance of p from the line through a and b
+static double OffLine(const double* p, const double* a, const double* b)
+{
+	double d[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+	double v[3] = {p[0] - a[0], p[1] - a[1], p[2] - a[2]};
+	double dd = d[0] * d[0] + d[1] * d[1] + d[2] * d[2];
+	double t = (dd > 0.0) ? (v[0] * d[0] + v[1] * d[1] + v[2] * d[2]) / dd : 0.0;
+	double e[3] = {v[0] - d[0] * t, v[1] - d[1] * t, v[2] - d[2] * t};
+	return sqrt(e[0] * e[0] + e[1] * e[1] + e[2] * e[2]);
+}
+
+// the points which would be kept by checking every point since the last one kept, for each one tried
+static size_t NumberKeptByCheckingEveryPoint(const std::vector<double> &points, double tolerance)
+{
+	size_t n = points.size() / 3;
+	if(n < 3)return n;
+	size_t kept = 1, start = 0;
+	for(size_t i = 2; i < n; i++)
+	{
+		for(size_t j = start + 1; j < i; j++)
+		{
+			if(OffLine(&points[j * 3], &points[start * 3], &points[i * 3]) > tolerance)
+			{
+				kept++;
+				start = i - 1;
+				break;
+			}
+		}
+	}
+	return kept + 1;
+}
+
+// checks the points kept by DropCutterMesh::Filter; returns the furthest a point left out is from the line past it, or a big number if
+// the points kept aren't some of the points, in order, with the first and the last
+static double FilterWorst(const std::vector<double> &points, const std::vector<double> &kept)
+{
+	size_t n = points.size() / 3, m = kept.size() / 3;
+	if(m < 2 || memcmp(&points[0], &kept[0], 3 * sizeof(double)) || memcmp(&points[(n - 1) * 3], &kept[(m - 1) * 3], 3 * sizeof(double)))return 1.0e30;
+	double worst = 0.0;
+	size_t i = 0;
+	for(size_t k = 1; k < m; k++)
+	{
+		size_t start = i;
+		for(i++; i < n && memcmp(&points[i * 3], &kept[k * 3], 3 * sizeof(double)); i++);
+		if(i == n)return 1.0e30;
+		for(size_t j = start + 1; j < i; j++)worst = std::max(worst, OffLine(&points[j * 3], &points[start * 3], &points[i * 3]));
+	}
+	return worst;
+}
+
+int main(int argc, char** argv)
+{
+	int cells = 50;
+	size_t number_of_points = 2000;
+	if(argc > 1)cells = atoi(argv[1]);
+	if(argc > 2)number_of_points = atol(argv[2]);
+	srand(1);
+
+	std::list<GTri> tris;
+	MakeSurface(cells, tris);
+
+	// the STL files have floats, so the triangles to check against are read back from one of them too
+	const char* binary_file = "drop_cutter_mesh_binary.stl";
+	const char* ascii_file = "drop_cutter_mesh_ascii.stl";
+	if(!WriteSTL(binary_file, tris, true) || !WriteSTL(ascii_file, tris, false)){ printf("couldn't write the STL files\n"); return 1; }
+
+	DropCutterMesh mesh, ascii_mesh;
+	if(!mesh.ReadSTLFile(binary_file) || !ascii_mesh.ReadSTLFile(ascii_file)){ printf("couldn't read the STL files\n"); return 1; }
+	if(mesh.NumberOfTriangles() != tris.size() || ascii_mesh.NumberOfTriangles() != tris.size())
+	{
+		printf("%u triangles written, %u read from the binary file, %u from the ascii file\n", (unsigned)tris.size(), (unsigned)mesh.NumberOfTriangles(), (unsigned)ascii_mesh.NumberOfTriangles());
+		return 1;
+	}
+	mesh.Build();
+	ascii_mesh.Build();
+
+	const char* rewritten_file = "drop_cutter_mesh_rewritten.stl";
+	DropCutterMesh rewritten_mesh;
+	if(!mesh.WriteSTLFile(rewritten_file) || !rewritten_mesh.ReadSTLFile(rewritten_file) || rewritten_mesh.NumberOfTriangles() != tris.size())
+	{
+		printf("couldn't write the triangles to %s and read them back\n", rewritten_file);
+		return 1;
+	}
+	rewritten_mesh.Build();
+
+	std::list<GTri> read_tris;
+	{
+		// the same floats as the binary file
+		for(std::list<GTri>::iterator It = tris.begin(); It != tris.end(); It++)
+		{
+			double x[9];
+			for(int k = 0; k < 9; k++)x[k] = (float)It->m_p[k];
+			read_tris.push_back(GTri(x));
+		}
+	}
+
+	std::vector<double> points;
+	for(size_t i = 0; i < number_of_points; i++)
+	{
+		points.push_back(Random(-10, 110));
+		points.push_back(Random(-10, 110));
+		points.push_back(0.0);
+	}
+
+	const double minz = -100.0;
+	Cutter cutters[3] = {Cutter(3.0, 0.0, 0.001), Cutter(3.0, 3.0, 0.001), Cutter(3.0, 1.0, 0.001)};
+	const char* names[3] = {"flat", "ball", "bull nosed"};
+	int failures = 0;
+	for(int c = 0; c < 3; c++)
+	{
+		const Cutter &cu = cutters[c];
+
+		double t0 = Now();
+		std::vector<double> expected(number_of_points);
+		for(size_t i = 0; i < number_of_points; i++)expected[i] = DropCutter::TriTest(cu, &points[i * 3], read_tris, minz);
+		double t1 = Now();
+		std::vector<double> dropped = points;
+		mesh.Drop(cu, dropped, minz);
+		double t2 = Now();
+		std::vector<double> ascii_dropped = points;
+		ascii_mesh.Drop(cu, ascii_dropped, minz);
+		std::vector<double> rewritten_dropped = points;
+		rewritten_mesh.Drop(cu, rewritten_dropped, minz);
+
+		double worst = 0.0, ascii_worst = 0.0;
+		for(size_t i = 0; i < number_of_points; i++)
+		{
+			double d = fabs(dropped[i * 3 + 2] - expected[i]);
+			if(d > worst)worst = d;
+			d = fabs(ascii_dropped[i * 3 + 2] - expected[i]);
+			if(d > ascii_worst)ascii_worst = d;
+		}
+		bool ok = (worst < 1.0e-6 && ascii_worst < 1.0e-5 && rewritten_dropped == dropped);
+		if(!ok)failures++;
+		printf("%-10s every triangle %.3f s, DropCutterMesh %.3f s, biggest difference %g (ascii %g)%s\n", names[c], t1 - t0, t2 - t1, worst, ascii_worst, ok ? "" : " WRONG");
+	}
+
+	{
+		// a zig zag, sampled every 0.1 like nc/attach.py, starting and ending off the surface, where it's straight for a long way
+		std::vector<double> path;
+		int rows = (int)(number_of_points / 100) + 1;
+		for(int r = 0; r < rows; r++)
+		{
+			double y = 100.0 * (r + 0.5) / rows;
+			for(int i = 0; i <= 2000; i++)
+			{
+				double x = (r % 2) ? (130.0 - i * 0.08) : (-30.0 + i * 0.08);
+				path.push_back(x);
+				path.push_back(y + Random(-0.001, 0.001));
+				path.push_back(0.0);
+			}
+		}
+		mesh.Drop(cutters[2], path, -5.0);
+
+		const double tolerance = 0.005;
+		double t0 = Now();
+		size_t every_point_kept = NumberKeptByCheckingEveryPoint(path, tolerance);
+		double t1 = Now();
+		std::vector<double> kept = path;
+		DropCutterMesh::Filter(kept, tolerance);
+		double t2 = Now();
+		double worst = FilterWorst(path, kept);
+		bool ok = (worst <= tolerance * (1.0 + 1.0e-9));
+		if(!ok)failures++;
+		printf("filter     %u points, %u kept, furthest left out %g; checking every point %.3f s, %u kept, Filter %.4f s%s\n", (unsigned)(path.size() / 3),
+			(unsigned)(kept.size() / 3), worst, t1 - t0, (unsigned)every_point_kept, t2 - t1, ok ? "" : " WRONG");
+	}
+
+	remove(binary_file);
+	remove(ascii_file);
+	remove(rewritten_file);
+	printf("%u triangles, %u points\n", (unsigned)tris.size(), (unsigned)number_of_points);
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,309 @@
+// excellon.cpp
+// Reads generated Excellon panel files with ExcellonReader, which Excellon::Read uses, checks every hole it gives against the
+// ones which were written, and times it. Three files are written, one for each of the ways the coordinates can be given:
+//   inch digits:     INCH,LZ with the coordinates as 2.4 digits, without a decimal point
+//   mm decimal:      METRIC with a decimal point in each coordinate
+//   inch increments: INCH with decimal points, in incremental (G91) mode
+// The holes are on a 0.1 mm grid, a quarter of them drilled twice, so the points made for them can be checked too.
+// The points are found with PointLookup, as Excellon::Hole does, and, for the timing, with a std::map ordered with the
+// tolerance, as CNCPoint's operator< did before it.
+//
+// excellon [number of holes in each file]
+
+#include "stdafx.h"
+#include "ExcellonReader.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+static double Now()
+{
+	return (double)clock() / CLOCKS_PER_SEC;
+}
+
+static const double tolerance = 0.02; // twice HeeksCAD's default, as Excellon::Read uses
+static const int number_of_tools = 8;
+
+struct DrillHole
+{
+	int tool; // 1 to number_of_tools
+	double x, y; // mm
+};
+
+class TestReader: public ExcellonReader
+{
+	PointLookup m_points;
+	std::vector<double> m_diameters;
+
+public:
+	std::vector<DrillHole> m_holes;
+	std::vector<int> m_point_ids;
+	int m_number_of_points;
+
+	TestReader(): m_number_of_points(0) { m_points.SetTolerance(tolerance); }
+
+	int ToolNumber(const double diameter)
+	{
+		for(size_t i = 0; i < m_diameters.size(); i++)
+		{
+			if(fabs(m_diameters[i] - diameter) < 0.0001)return (int)i + 1;
+		}
+		m_diameters.push_back(diameter);
+		return (int)m_diameters.size();
+	}
+
+	bool Hole(const int tool_number, const double x, const double y, const double z)
+	{
+		int id = 0;
+		if(!m_points.Find(x, y, z, &id))
+		{
+			id = ++m_number_of_points;
+			m_points.Insert(x, y, z, id);
+		}
+		m_point_ids.push_back(id);
+		DrillHole hole = {tool_number, x, y};
+		m_holes.push_back(hole);
+		return true;
+	}
+};
+
+// the holes' grid positions, in tenths of a mm, with a quarter of them repeated
+static std::vector<DrillHole> MakeHoles(size_t number_of_holes)
+{
+	std::vector<DrillHole> holes;
+	std::set< std::pair<int, int> > used;
+	for(size_t i = 0; i < number_of_holes; i++)
+	{
+		DrillHole hole;
+		hole.tool = 1 + (int)(i * number_of_tools / number_of_holes); // the holes for each tool together, as CAM programs write them
+		if(holes.size() > 0 && rand() % 4 == 0)
+		{
+			DrillHole &other = holes[rand() % holes.size()];
+			hole.x = other.x;
+			hole.y = other.y;
+		}
+		else
+		{
+			int ix, iy;
+			do
+			{
+				ix = rand() % 5000 - 1000; // -100mm to 400mm, inside 2.4 inch digits
+				iy = rand() % 4000 - 1000;
+			}while(used.find(std::make_pair(ix, iy)) != used.end());
+			used.insert(std::make_pair(ix, iy));
+			hole.x = ix * 0.1;
+			hole.y = iy * 0.1;
+		}
+		holes.push_back(hole);
+	}
+	return holes;
+}
+
+enum Format
+{
+	InchDigits,
+	MmDecimal,
+	InchIncrements,
+};
+
+static const char* format_names[] = {"inch digits", "mm decimal", "inch increments"};
+
+static void WriteCoordinate(FILE* file, char axis, double mm, Format format)
+{
+	if(format == MmDecimal)
+	{
+		fprintf(file, "%c%.1f", axis, mm);
+	}
+	else
+	{
+		double inches = mm / 25.4;
+		long long digits = (long long)floor(fabs(inches) * 10000 + 0.5);
+		if(format == InchDigits)fprintf(file, "%c%s%06lld", axis, (inches < 0) ? "-" : "", digits);
+		else fprintf(file, "%c%s%lld.%04lld", axis, (inches < 0) ? "-" : "", digits / 10000, digits % 10000);
+	}
+}
+
+// the coordinate which will be read back, in mm
+static double Written(double mm, Format format)
+{
+	if(format == MmDecimal)return mm;
+	double inches = mm / 25.4;
+	double digits = floor(fabs(inches) * 10000 + 0.5);
+	return ((inches < 0) ? -digits : digits) / 10000 * 25.4;
+}
+
+static bool WriteFile(const char* path, const std::vector<DrillHole> &holes, Format format)
+{
+	FILE* file = fopen(path, "wb");
+	if(file == NULL)return false;
+	fprintf(file, "M48\r\n");
+	fprintf(file, (format == MmDecimal) ? "METRIC,LZ\r\n" : "INCH,LZ\r\n");
+	for(int t = 1; t <= number_of_tools; t++)
+	{
+		double mm = 0.3 + 0.1 * t;
+		if(format == MmDecimal)fprintf(file, "T%dC%.3f\r\n", t, mm);
+		else fprintf(file, "T%dC%.4f\r\n", t, mm / 25.4);
+	}
+	fprintf(file, "%%\r\nG05\r\n");
+	if(format == InchIncrements)fprintf(file, "G91\r\n");
+	int tool = 0;
+	long long x = 0, y = 0; // the position in 1/10000 inch, for the increments
+	for(size_t i = 0; i < holes.size(); i++)
+	{
+		if(holes[i].tool != tool)
+		{
+			tool = holes[i].tool;
+			fprintf(file, "T%d\r\n", tool);
+		}
+		if(format == InchIncrements)
+		{
+			long long nx = (long long)floor(holes[i].x / 25.4 * 10000 + 0.5);
+			long long ny = (long long)floor(holes[i].y / 25.4 * 10000 + 0.5);
+			if(nx != x)WriteCoordinate(file, 'X', (nx - x) * 25.4 / 10000, format);
+			if(ny != y)WriteCoordinate(file, 'Y', (ny - y) * 25.4 / 10000, format);
+			if(nx == x && ny == y)fprintf(file, "X0.0000");
+			x = nx;
+			y = ny;
+		}
+		else
+		{
+			WriteCoordinate(file, 'X', holes[i].x, format);
+			WriteCoordinate(file, 'Y', holes[i].y, format);
+		}
+		fprintf(file, "\r\n");
+	}
+	fprintf(file, "T0\r\nM30\r\n");
+	long size = ftell(file);
+	fclose(file);
+	printf("%s: %d holes, %.1f MB\n", format_names[format], (int)holes.size(), size / 1048576.0);
+	return true;
+}
+
+// the points, ordered with the tolerance, as CNCPoint's operator< did
+struct TolerantLess
+{
+	bool operator()(const std::pair<double, double> &a, const std::pair<double, double> &b) const
+	{
+		if(fabs(a.first - b.first) >= tolerance)return a.first < b.first;
+		if(fabs(a.second - b.second) >= tolerance)return a.second < b.second;
+		return false;
+	}
+};
+
+static double TimeTolerantMap(const std::vector<DrillHole> &holes, int &number_of_points)
+{
+	double start = Now();
+	std::map< std::pair<double, double>, int, TolerantLess > points;
+	for(size_t i = 0; i < holes.size(); i++)
+	{
+		std::pair<double, double> p(holes[i].x, holes[i].y);
+		if(points.find(p) == points.end())points.insert(std::make_pair(p, (int)points.size() + 1));
+	}
+	number_of_points = (int)points.size();
+	return Now() - start;
+}
+
+static double TimePointLookup(const std::vector<DrillHole> &holes, int &number_of_points)
+{
+	double start = Now();
+	PointLookup points;
+	points.SetTolerance(tolerance);
+	number_of_points = 0;
+	for(size_t i = 0; i < holes.size(); i++)
+	{
+		int id;
+		if(!points.Find(holes[i].x, holes[i].y, 0.0, &id))points.Insert(holes[i].x, holes[i].y, 0.0, ++number_of_points);
+	}
+	return Now() - start;
+}
+
+int main(int argc, char** argv)
+{
+	size_t number_of_holes = 400000;
+	if(argc > 1)number_of_holes = atoi(argv[1]);
+
+	srand(1);
+	std::vector<DrillHole> holes = MakeHoles(number_of_holes);
+	std::set< std::pair<double, double> > distinct;
+	for(size_t i = 0; i < holes.size(); i++)distinct.insert(std::make_pair(holes[i].x, holes[i].y));
+
+	const char* path = "excellon_test.drl";
+	int failures = 0;
+
+	for(int f = InchDigits; f <= InchIncrements; f++)
+	{
+		Format format = (Format)f;
+		if(!WriteFile(path, holes, format))
+		{
+			printf("couldn't write %s\n", path);
+			return 1;
+		}
+
+		TestReader reader;
+		double start = Now();
+		bool read = reader.ReadFile(path);
+		double read_time = Now() - start;
+		remove(path);
+
+		if(!read)
+		{
+			printf("  the file wasn't read\n");
+			failures++;
+			continue;
+		}
+		if(reader.m_holes.size() != holes.size())
+		{
+			printf("  %d holes were read, not %d\n", (int)reader.m_holes.size(), (int)holes.size());
+			failures++;
+			continue;
+		}
+
+		int wrong_holes = 0;
+		for(size_t i = 0; i < holes.size(); i++)
+		{
+			const DrillHole &h = reader.m_holes[i];
+			if(h.tool != holes[i].tool || fabs(h.x - Written(holes[i].x, format)) > 1e-6 || fabs(h.y - Written(holes[i].y, format)) > 1e-6)
+			{
+				if(wrong_holes < 5)printf("  hole %d is T%d %.6f %.6f, not T%d %.6f %.6f\n", (int)i, h.tool, h.x, h.y, holes[i].tool, holes[i].x, holes[i].y);
+				wrong_holes++;
+			}
+		}
+		if(wrong_holes)failures++;
+
+		// each hole's point must be the first one within the tolerance of it; checked against all of them, for the first few thousand
+		int wrong_points = 0;
+		size_t checked = (holes.size() < 3000) ? holes.size() : 3000;
+		for(size_t i = 0; i < checked; i++)
+		{
+			int expected = reader.m_point_ids[i];
+			for(size_t j = 0; j < i; j++)
+			{
+				const DrillHole &a = reader.m_holes[i];
+				const DrillHole &b = reader.m_holes[j];
+				if(sqrt((a.x - b.x) * (a.x - b.x) + (a.y - b.y) * (a.y - b.y)) < tolerance)
+				{
+					expected = reader.m_point_ids[j];
+					break;
+				}
+			}
+			if(expected != reader.m_point_ids[i])wrong_points++;
+		}
+		if(wrong_points > 0 || reader.m_number_of_points != (int)distinct.size())
+		{
+			printf("  %d points were made, not %d; %d of the first %d holes had the wrong point\n", reader.m_number_of_points, (int)distinct.size(), wrong_points, (int)checked);
+			failures++;
+		}
+
+		printf("  read in %.3f s, %d holes and %d points\n", read_time, (int)reader.m_holes.size(), reader.m_number_of_points);
+	}
+
+	// the points alone
+	int map_points, lookup_points;
+	double map_time = TimeTolerantMap(holes, map_points);
+	double lookup_time = TimePointLookup(holes, lookup_points);
+	printf("finding the points: tolerant std::map %.3f s, %d points; PointLookup %.3f s, %d points\n", map_time, map_points, lookup_time, lookup_points);
+	if(lookup_points != (int)distinct.size())failures++;
+
+	return (failures > 0) ? 1 : 0;
+}
@@ -0,0 +1,250 @@
+// feed_possible.cpp
+// Checks CFeedPossible, which area_funcs.feed_possible uses in HeeksCNC's own python, against a brute force, for random moves in random
+// areas; a rectangle, going either way round, with round and square islands, also going either way round, on a jittered grid.
+// The brute force works the clearance of the move out exactly, from each rectangle's sides and each circle, so it doesn't share
+// any of CCurveSpans' arithmetic. Moves which come within a millionth of the tool radius of an edge are left out, as either answer is right.
+// The time for each query is printed, for the biggest area.
+//
+// feed_possible [number of areas] [number of islands across the biggest area]
+
+#include "stdafx.h"
+#include "FeedPossible.h"
+
+#include <algorithm>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+static double Now()
+{
+	return (double)clock() / CLOCKS_PER_SEC;
+}
+
+static double Random(double a, double b)
+{
+	return a + (b - a) * rand() / RAND_MAX;
+}
+
+struct Box
+{
+	double x0, y0, x1, y1;
+};
+
+struct Round
+{
+	double x, y, radius;
+};
+
+struct Area
+{
+	Box outside;
+	std::vector<Box> boxes;
+	std::vector<Round> rounds;
+};
+
+static CCurve Rectangle(const Box &b, bool clockwise)
+{
+	CCurve curve;
+	curve.push_back(CCurveVertex(0, b.x0, b.y0, 0.0, 0.0));
+	if(clockwise)
+	{
+		curve.push_back(CCurveVertex(0, b.x0, b.y1, 0.0, 0.0));
+		curve.push_back(CCurveVertex(0, b.x1, b.y1, 0.0, 0.0));
+		curve.push_back(CCurveVertex(0, b.x1, b.y0, 0.0, 0.0));
+	}
+	else
+	{
+		curve.push_back(CCurveVertex(0, b.x1, b.y0, 0.0, 0.0));
+		curve.push_back(CCurveVertex(0, b.x1, b.y1, 0.0, 0.0));
+		curve.push_back(CCurveVertex(0, b.x0, b.y1, 0.0, 0.0));
+	}
+	curve.push_back(CCurveVertex(0, b.x0, b.y0, 0.0, 0.0));
+	return curve;
+}
+
+static CCurve Circle(const Round &r, bool clockwise)
+{
+	// in three arcs, starting anywhere
+	int dir = clockwise ? -1 : 1;
+	double a = Random(0, 6.2831853);
+	CCurve curve;
+	curve.push_back(CCurveVertex(0, r.x + r.radius * cos(a), r.y + r.radius * sin(a), 0.0, 0.0));
+	for(int k = 1; k <= 3; k++)
+	{
+		double b = a + dir * 2.0943951 * k;
+		curve.push_back(CCurveVertex(dir, r.x + r.radius * cos(b), r.y + r.radius * sin(b), r.x, r.y));
+	}
+	curve.back().x = curve.front().x;
+	curve.back().y = curve.front().y;
+	return curve;
+}
+
+static Area MakeArea(int islands_across, std::vector<CCurve> &curves)
+{
+	Area a;
+	double spacing = 10.0;
+	a.outside.x0 = Random(-20, 20);
+	a.outside.y0 = Random(-20, 20);
+	a.outside.x1 = a.outside.x0 + spacing * (islands_across + 1);
+	a.outside.y1 = a.outside.y0 + spacing * (islands_across / 2 + 2);
+	curves.push_back(Rectangle(a.outside, rand() % 2 == 0));
+
+	for(double y = a.outside.y0 + spacing; y < a.outside.y1 - spacing * 0.5; y += spacing)
+	{
+		for(double x = a.outside.x0 + spacing; x < a.outside.x1 - spacing * 0.5; x += spacing)
+		{
+			if(rand() % 4 == 0)continue;
+			double cx = x + Random(-1.5, 1.5), cy = y + Random(-1.5, 1.5);
+			double size = Random(0.5, 3.0);
+			if(rand() % 2 == 0)
+			{
+				Round r = {cx, cy, size};
+				a.rounds.push_back(r);
+				curves.push_back(Circle(r, rand() % 2 == 0));
+			}
+			else
+			{
+				Box b = {cx - size, cy - size * Random(0.3, 1.0), cx + size, cy + size * Random(0.3, 1.0)};
+				a.boxes.push_back(b);
+				curves.push_back(Rectangle(b, rand() % 2 == 0));
+			}
+		}
+	}
+	return a;
+}
+
+static double PointToSegment(double px, double py, double x0, double y0, double x1, double y1)
+{
+	double vx = x1 - x0, vy = y1 - y0;
+	double l2 = vx * vx + vy * vy;
+	double t = (l2 > 0.0) ? ((px - x0) * vx + (py - y0) * vy) / l2 : 0.0;
+	if(t < 0.0)t = 0.0;
+	if(t > 1.0)t = 1.0;
+	double dx = px - x0 - vx * t, dy = py - y0 - vy * t;
+	return sqrt(dx * dx + dy * dy);
+}
+
+static double Cross(double ax, double ay, double bx, double by)
+{
+	return ax * by - ay * bx;
+}
+
+static double SegmentToSegment(double ax, double ay, double bx, double by, double cx, double cy, double dx, double dy)
+{
+	double d1 = Cross(bx - ax, by - ay, cx - ax, cy - ay), d2 = Cross(bx - ax, by - ay, dx - ax, dy - ay);
+	double d3 = Cross(dx - cx, dy - cy, ax - cx, ay - cy), d4 = Cross(dx - cx, dy - cy, bx - cx, by - cy);
+	if(((d1 > 0) != (d2 > 0)) && ((d3 > 0) != (d4 > 0)))return 0.0; // they cross
+	double d = PointToSegment(ax, ay, cx, cy, dx, dy);
+	d = std::min(d, PointToSegment(bx, by, cx, cy, dx, dy));
+	d = std::min(d, PointToSegment(cx, cy, ax, ay, bx, by));
+	d = std::min(d, PointToSegment(dx, dy, ax, ay, bx, by));
+	return d;
+}
+
+static double BoxClearance(const Box &b, double x0, double y0, double x1, double y1)
+{
+	double d = SegmentToSegment(x0, y0, x1, y1, b.x0, b.y0, b.x1, b.y0);
+	d = std::min(d, SegmentToSegment(x0, y0, x1, y1, b.x1, b.y0, b.x1, b.y1));
+	d = std::min(d, SegmentToSegment(x0, y0, x1, y1, b.x1, b.y1, b.x0, b.y1));
+	d = std::min(d, SegmentToSegment(x0, y0, x1, y1, b.x0, b.y1, b.x0, b.y0));
+	return d;
+}
+
+static double RoundClearance(const Round &r, double x0, double y0, double x1, double y1)
+{
+	double nearest = PointToSegment(r.x, r.y, x0, y0, x1, y1);
+	double furthest = std::max(sqrt((x0 - r.x) * (x0 - r.x) + (y0 - r.y) * (y0 - r.y)), sqrt((x1 - r.x) * (x1 - r.x) + (y1 - r.y) * (y1 - r.y)));
+	if(nearest >= r.radius)return nearest - r.radius;
+	if(furthest <= r.radius)return r.radius - furthest;
+	return 0.0;
+}
+
+static bool InBox(const Box &b, double x, double y)
+{
+	return x > b.x0 && x < b.x1 && y > b.y0 && y < b.y1;
+}
+
+// the nearest the move comes to an edge, and whether it starts inside the area
+static double Clearance(const Area &a, double x0, double y0, double x1, double y1, bool &inside)
+{
+	double d = BoxClearance(a.outside, x0, y0, x1, y1);
+	inside = InBox(a.outside, x0, y0);
+	for(std::vector<Box>::const_iterator It = a.boxes.begin(); It != a.boxes.end(); It++)
+	{
+		d = std::min(d, BoxClearance(*It, x0, y0, x1, y1));
+		if(InBox(*It, x0, y0))inside = false;
+	}
+	for(std::vector<Round>::const_iterator It = a.rounds.begin(); It != a.rounds.end(); It++)
+	{
+		d = std::min(d, RoundClearance(*It, x0, y0, x1, y1));
+		if((x0 - It->x) * (x0 - It->x) + (y0 - It->y) * (y0 - It->y) < It->radius * It->radius)inside = false;
+	}
+	return d;
+}
+
+int main(int argc, char** argv)
+{
+	int number_of_areas = 40;
+	int islands_across = 40;
+	if(argc > 1)number_of_areas = atoi(argv[1]);
+	if(argc > 2)islands_across = atoi(argv[2]);
+
+	srand(1);
+	int failures = 0;
+	int moves = 0, possible = 0, left_out = 0;
+	for(int n = 0; n < number_of_areas; n++)
+	{
+		std::vector<CCurve> curves;
+		Area a = MakeArea(1 + n * (islands_across - 1) / std::max(number_of_areas - 1, 1), curves);
+		double radius = Random(0.2, 2.5);
+		CFeedPossible feed_possible(curves, radius);
+
+		for(int m = 0; m < 2000; m++)
+		{
+			// mostly short moves, like the links between the curves of a pocket, and some right across it
+			double x0 = Random(a.outside.x0 - 2, a.outside.x1 + 2), y0 = Random(a.outside.y0 - 2, a.outside.y1 + 2);
+			double length = (m % 10 == 0) ? Random(0, a.outside.x1 - a.outside.x0) : Random(0, 8);
+			double angle = Random(0, 6.2831853);
+			double x1 = x0 + length * cos(angle), y1 = y0 + length * sin(angle);
+
+			bool inside;
+			double clearance = Clearance(a, x0, y0, x1, y1, inside);
+			if(fabs(clearance - radius) < radius * 1e-6)
+			{
+				left_out++;
+				continue;
+			}
+			bool expected = inside && clearance > radius;
+			moves++;
+			if(expected)possible++;
+			if(feed_possible.Possible(x0, y0, x1, y1) != expected)
+			{
+				if(failures < 10)printf("area %d: the move from %g, %g to %g, %g, with radius %g, should %sbe possible; it comes within %g of an edge\n",
+					n, x0, y0, x1, y1, radius, expected ? "" : "not ", clearance);
+				failures++;
+			}
+		}
+	}
+	printf("%d moves in %d areas, %d possible, %d too near to call; %d wrong\n", moves, number_of_areas, possible, left_out, failures);
+
+	// the time for each query, in the biggest area
+	std::vector<CCurve> curves;
+	Area a = MakeArea(islands_across, curves);
+	int number_of_spans = 0;
+	for(std::vector<CCurve>::iterator It = curves.begin(); It != curves.end(); It++)number_of_spans += (int)It->size() - 1;
+	double start = Now();
+	CFeedPossible feed_possible(curves, 1.0);
+	double made = Now();
+	int queries = 200000, count = 0;
+	for(int q = 0; q < queries; q++)
+	{
+		double x0 = Random(a.outside.x0, a.outside.x1), y0 = Random(a.outside.y0, a.outside.y1);
+		if(feed_possible.Possible(x0, y0, x0 + Random(-5, 5), y0 + Random(-5, 5)))count++;
+	}
+	double finished = Now();
+	printf("an area of %d edges took %.3f s to make, then %.2f microseconds for each move; %d of %d possible\n",
+		number_of_spans, made - start, (finished - made) / queries * 1e6, count, queries);
+
+	return (failures > 0) ? 1 : 0;
+}
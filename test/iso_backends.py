@@ -0,0 +1,212 @@
+################################################################################
+# iso_backends.py
+#
+# Diffs the NC code from src/IsoCreator.cpp, which HeeksCNC writes without
+# python, against the NC code from the python post, for each machine in
+# nc/machines.xml. Random programs of calls are given to both. The calls are
+# the ones Drilling::WriteNC and CProgram::WriteNC make, which are all the C++
+# backend is used for, along with moves and arcs.
+# The date in emc2b's first line is left out of the comparison.
+#
+# python iso_backends.py iso_creator_replay [number of programs] [number of moves]
+#
+# iso_creator_replay is the program built from iso_creator_replay.cpp.
+
+import sys
+import os
+import re
+import time
+import random
+import tempfile
+import shutil
+import subprocess
+
+heekscnc_dir = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..')
+sys.path.insert(0, heekscnc_dir)
+
+import nc.nc as nc
+from depth_params import depth_params
+
+def number(rand, a, b):
+    # rounded, so there are numbers which land on the formats' rounding
+    return round(rand.uniform(a, b), rand.choice([0, 1, 3, 4, 6]))
+
+def make_calls(rand, number_of_moves):
+    calls = []
+    calls.append(['program_begin', 1, 'test'])
+    calls.append(['absolute'])
+    calls.append([rand.choice(['metric', 'imperial'])])
+    calls.append(['set_plane', 0])
+    tools = [1, 2, 3]
+    for t in tools:
+        calls.append(['tool_defn', t, 'tool%d' % t, number(rand, 1, 12), rand.choice([None, number(rand, 5, 40)])])
+    x, y = 0.0, 0.0
+    for t in tools:
+        calls.append(['comment', 'tool change to tool%d' % t])
+        calls.append(['tool_change', t])
+        calls.append(['spindle', number(rand, 1000, 20000), rand.choice([0, 1])])
+        if rand.random() < 0.5:
+            calls.append(['feedrate', number(rand, 50, 2000)])
+        else:
+            # as SpeedOp::WriteNC gives them
+            calls.append(['feedrate_slot', number(rand, 50, 1000)])
+            calls.append(['feedrate_hv', number(rand, 50, 2000), number(rand, 50, 500)])
+        calls.append(['flush_nc'])
+        # the operations start with a rapid to a known position, which nc/iso.py needs for feedrate_hv
+        calls.append(['rapid', x, y, 10.0])
+        in_cycle = False
+        for m in range(0, number_of_moves):
+            r = rand.random()
+            if r < 0.4:
+                # drilling; not pecking and dwell together, as nc/iso.py fails on those, see CIsoCreator::drill
+                if rand.random() < 0.8:
+                    x, y = number(rand, -50, 50), number(rand, -50, 50)
+                peck = rand.choice([0, 0, number(rand, 0.5, 3)])
+                dwell = 0 if peck else rand.choice([0, 0, number(rand, 0.1, 2)])
+                start = number(rand, -1, 1)
+                calls.append(['drill', x, y, dwell, number(rand, 3, 10), number(rand, 1, 3), start, peck, 0, 0, start - number(rand, 1, 20),
+                              rand.choice([0, 1]), 0, 0, rand.choice([0, 1])])
+                in_cycle = True
+                continue
+            if in_cycle:
+                calls.append(['end_canned_cycle'])
+                calls.append(['rapid', x, y, 10.0])
+                in_cycle = False
+            if r < 0.55:
+                calls.append(['rapid', rand.choice([None, number(rand, -50, 50)]), rand.choice([None, number(rand, -50, 50)]), rand.choice([None, number(rand, 0, 10)])])
+            elif r < 0.8:
+                calls.append(['feed', rand.choice([0.0, 0.5, 1.0]), rand.choice([None, number(rand, -50, 50)]), rand.choice([None, number(rand, -50, 50)]), rand.choice([None, number(rand, -5, 0)])])
+            elif r < 0.95:
+                calls.append([rand.choice(['arc_cw', 'arc_ccw']), rand.choice([0.0, 1.0]), number(rand, -50, 50), number(rand, -50, 50), rand.choice([None, number(rand, -5, 0)]),
+                              number(rand, -20, 20), number(rand, -20, 20), None, None])
+            elif r < 0.98:
+                calls.append(['dwell', number(rand, 0.1, 3)])
+            else:
+                calls.append(['comment', 'move %d' % m])
+        if in_cycle:
+            calls.append(['end_canned_cycle'])
+    calls.append(['program_end'])
+    return calls
+
+def arg_str(a):
+    if a == None:
+        return 'None'
+    if isinstance(a, float):
+        return '%.10g' % a
+    return str(a)
+
+def write_calls(calls, path):
+    f = open(path, 'w')
+    for call in calls:
+        f.write(' '.join([arg_str(a) for a in call]) + '\n')
+    f.close()
+
+def python_replay(post, calls, path):
+    # the calls as iso_creator_replay makes them, read back from the same text
+    module = __import__('nc.' + post, fromlist = ['Creator'])
+    c = module.Creator()
+    nc.creator = c
+    c.file_open(path)
+    for call in calls:
+        name = call[0]
+        a = [float(arg_str(v)) if isinstance(v, float) else v for v in call[1:]]
+        if name == 'program_begin': c.program_begin(a[0], a[1])
+        elif name == 'program_end': c.program_end()
+        elif name == 'flush_nc': c.flush_nc()
+        elif name == 'imperial': c.imperial()
+        elif name == 'metric': c.metric()
+        elif name == 'absolute': c.absolute()
+        elif name == 'set_plane': c.set_plane(a[0])
+        elif name == 'tool_defn': c.tool_defn(a[0], a[1], {'name':a[1], 'diameter':a[2], 'cutting edge height':a[3]})
+        elif name == 'tool_change': c.tool_change(a[0])
+        elif name == 'feedrate': c.feedrate(a[0])
+        elif name == 'feedrate_slot': c.feedrate_slot(a[0])
+        elif name == 'feedrate_hv': c.feedrate_hv(a[0], a[1])
+        elif name == 'spindle': c.spindle(a[0], a[1] == 1)
+        elif name == 'rapid': c.rapid(a[0], a[1], a[2])
+        elif name == 'feed': c.feed(a[0], a[1], a[2], a[3])
+        elif name == 'arc_cw': c.arc_cw(a[0], a[1], a[2], a[3], a[4], a[5], a[6], a[7])
+        elif name == 'arc_ccw': c.arc_ccw(a[0], a[1], a[2], a[3], a[4], a[5], a[6], a[7])
+        elif name == 'dwell': c.dwell(a[0])
+        elif name == 'drill':
+            d = depth_params(a[3], a[4], a[5], a[6], a[7], a[8], a[9], None)
+            c.drill(x = a[0], y = a[1], dwell = a[2], depthparams = d, retract_mode = a[10], spindle_mode = a[11], internal_coolant_on = (a[12] == 1), rapid_to_clearance = (a[13] == 1))
+        elif name == 'end_canned_cycle': c.end_canned_cycle()
+        elif name == 'comment': c.comment(a[0])
+        else: raise Exception('unknown call ' + name)
+
+date = re.compile(r'\d\d\d\d/\d\d/\d\d \d\d:\d\d')
+
+def read_nc(path):
+    f = open(path)
+    lines = [date.sub('date', line) for line in f.readlines()]
+    f.close()
+    return lines
+
+def machine_posts():
+    # machines.xml has a Machine element for each machine, without a root element, so it isn't read as one XML document
+    f = open(os.path.join(heekscnc_dir, 'nc', 'machines.xml'))
+    posts = re.findall(r'<Machine[^>]*\spost="([^"]*)"', f.read())
+    f.close()
+    return posts
+
+def main():
+    if len(sys.argv) < 2:
+        print 'usage: python iso_backends.py iso_creator_replay [number of programs] [number of moves]'
+        return 1
+    replay = sys.argv[1]
+    number_of_programs = 20
+    number_of_moves = 50
+    if len(sys.argv) > 2: number_of_programs = int(sys.argv[2])
+    if len(sys.argv) > 3: number_of_moves = int(sys.argv[3])
+
+    temp_dir = tempfile.mkdtemp()
+    failures = 0
+    try:
+        for post in machine_posts():
+            cpp_time = 0.0
+            python_time = 0.0
+            for seed in range(0, number_of_programs):
+                calls = make_calls(random.Random(seed), number_of_moves)
+                calls_path = os.path.join(temp_dir, post + '.calls')
+                write_calls(calls, calls_path)
+
+                cpp_path = os.path.join(temp_dir, post + '_cpp.nc')
+                start = time.time()
+                if subprocess.call([replay, post, calls_path, cpp_path]) != 0:
+                    print post + ': iso_creator_replay failed'
+                    failures = failures + 1
+                    break
+                cpp_time += time.time() - start
+
+                python_path = os.path.join(temp_dir, post + '_python.nc')
+                start = time.time()
+                python_replay(post, calls, python_path)
+                python_time += time.time() - start
+
+                cpp_lines = read_nc(cpp_path)
+                python_lines = read_nc(python_path)
+                if cpp_lines != python_lines:
+                    for i in range(0, max(len(cpp_lines), len(python_lines))):
+                        c = cpp_lines[i] if i < len(cpp_lines) else '<end>\n'
+                        p = python_lines[i] if i < len(python_lines) else '<end>\n'
+                        if c != p:
+                            print '%s, program %d, line %d:\n  C++:    %s  python: %s' % (post, seed, i + 1, c, p)
+                            break
+                    kept = os.path.join(tempfile.gettempdir(), 'iso_backends_%s_%d.calls' % (post, seed))
+                    shutil.copy(calls_path, kept)
+                    print '  the calls are in ' + kept
+                    failures = failures + 1
+                    break
+            # the C++ time includes starting iso_creator_replay for each program
+            print '%s: %d programs of %d moves for each of 3 tools, C++ %.3f s, python %.3f s' % (post, number_of_programs, number_of_moves, cpp_time, python_time)
+    finally:
+        shutil.rmtree(temp_dir)
+
+    if failures:
+        print '%d of the machines wrote different NC code' % failures
+        return 1
+    return 0
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,107 @@
+// iso_creator_replay.cpp
+// Gives the calls in a calls file to CIsoCreator, for iso_backends.py to compare with what the python post writes for the same calls.
+// Each line of the calls file is the name of a CNCCreator method and its arguments, separated by spaces, with None for a missing value;
+// see iso_backends.py for the arguments of each.
+//
+// iso_creator_replay post calls_file nc_file
+
+#include "stdafx.h"
+#include "IsoCreator.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sstream>
+#include <fstream>
+
+static CNCValue Value(const std::string &s)
+{
+	if(s == "None")return CNCValue();
+	return CNCValue(atof(s.c_str()));
+}
+
+int main(int argc, char** argv)
+{
+	if(argc < 4)
+	{
+		printf("usage: iso_creator_replay post calls_file nc_file\n");
+		return 1;
+	}
+
+	CIsoCreator* creator = CIsoCreator::New(argv[1]);
+	if(creator == NULL)
+	{
+		printf("CIsoCreator can't be %s\n", argv[1]);
+		return 1;
+	}
+
+	std::ifstream calls(argv[2]);
+	if(!calls)
+	{
+		printf("couldn't read %s\n", argv[2]);
+		return 1;
+	}
+
+	if(!creator->file_open(argv[3]))
+	{
+		printf("couldn't write %s\n", argv[3]);
+		return 1;
+	}
+
+	std::string line;
+	int line_number = 0;
+	while(std::getline(calls, line))
+	{
+		line_number++;
+		std::istringstream stream(line);
+		std::string name;
+		std::vector<std::string> a;
+		stream >> name;
+		std::string arg;
+		while(stream >> arg)a.push_back(arg);
+		a.resize(16, "None");
+
+		if(name == "program_begin")creator->program_begin(atoi(a[0].c_str()), a[1]);
+		else if(name == "program_end")creator->program_end();
+		else if(name == "flush_nc")creator->flush_nc();
+		else if(name == "imperial")creator->imperial();
+		else if(name == "metric")creator->metric();
+		else if(name == "absolute")creator->absolute();
+		else if(name == "set_plane")creator->set_plane(atoi(a[0].c_str()));
+		else if(name == "tool_defn")
+		{
+			CNCToolParams params;
+			params.name = a[1];
+			params.diameter = Value(a[2]);
+			params.cutting_edge_height = Value(a[3]);
+			creator->tool_defn(atoi(a[0].c_str()), a[1], params);
+		}
+		else if(name == "tool_change")creator->tool_change(atoi(a[0].c_str()));
+		else if(name == "workplane")creator->workplane(atoi(a[0].c_str()));
+		else if(name == "feedrate")creator->feedrate(atof(a[0].c_str()));
+		else if(name == "feedrate_slot")creator->feedrate_slot(atof(a[0].c_str()));
+		else if(name == "feedrate_hv")creator->feedrate_hv(atof(a[0].c_str()), atof(a[1].c_str()));
+		else if(name == "spindle")creator->spindle(atof(a[0].c_str()), a[1] == "1");
+		else if(name == "coolant")creator->coolant(atoi(a[0].c_str()));
+		else if(name == "rapid")creator->rapid(Value(a[0]), Value(a[1]), Value(a[2]));
+		else if(name == "feed")creator->feed(atof(a[0].c_str()), Value(a[1]), Value(a[2]), Value(a[3]));
+		else if(name == "arc_cw")creator->arc_cw(atof(a[0].c_str()), Value(a[1]), Value(a[2]), Value(a[3]), Value(a[4]), Value(a[5]), Value(a[6]), Value(a[7]));
+		else if(name == "arc_ccw")creator->arc_ccw(atof(a[0].c_str()), Value(a[1]), Value(a[2]), Value(a[3]), Value(a[4]), Value(a[5]), Value(a[6]), Value(a[7]));
+		else if(name == "dwell")creator->dwell(atof(a[0].c_str()));
+		else if(name == "drill")
+		{
+			CNCDepthParams depthparams(atof(a[3].c_str()), atof(a[4].c_str()), atof(a[5].c_str()), atof(a[6].c_str()), atof(a[7].c_str()), atof(a[8].c_str()), atof(a[9].c_str()));
+			creator->drill(Value(a[0]), Value(a[1]), atof(a[2].c_str()), depthparams, atoi(a[10].c_str()), atoi(a[11].c_str()), a[12] == "1", a[13] == "1");
+		}
+		else if(name == "end_canned_cycle")creator->end_canned_cycle();
+		else if(name == "comment")creator->comment(line.size() > 8 ? line.substr(8) : "");
+		else if(name.size() > 0)
+		{
+			printf("%s:%d: unknown call %s\n", argv[2], line_number, name.c_str());
+			delete creator;
+			return 1;
+		}
+	}
+
+	delete creator;
+	return 0;
+}
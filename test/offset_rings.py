@@ -0,0 +1,184 @@
+################################################################################
+# offset_rings.py
+#
+# Checks the rings postprocessor/offsets.py makes for offset pockets.
+#  - Offsetting the separate areas an area splits into in parallel processes
+#    gives the same rings, in the same order, as offsetting them one at a
+#    time, for both holes_linked settings. Both are timed.
+#  - The cached rings are used again for the same area and stepover, but not
+#    after the units or the accuracy of the area module change.
+# libarea's Offset is stood in for by an area module of rectangles, each with
+# many vertices along its sides, which get smaller by the offset, and split in
+# two when they get long and thin, so the areas split at many levels.
+#
+# python offset_rings.py [number of rectangles] [number of vertices on each]
+
+import sys
+import os
+import time
+import types
+import multiprocessing
+
+heekscnc_dir = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..')
+sys.path.insert(0, heekscnc_dir)
+
+################################################################################
+# the area module, for areas of rectangles
+
+class Point:
+    def __init__(self, x = 0.0, y = 0.0):
+        self.x = x
+        self.y = y
+
+class Vertex:
+    def __init__(self, type, p, c, user_data = 0):
+        self.type = type
+        self.p = p
+        self.c = c
+
+class Curve:
+    def __init__(self, curve = None):
+        self.vertices = [] if curve == None else list(curve.vertices)
+
+    def append(self, v):
+        self.vertices.append(v)
+
+    def getVertices(self):
+        return self.vertices
+
+    def Reverse(self):
+        self.vertices.reverse()
+
+    def IsClockwise(self):
+        return False
+
+def rectangle(x0, y0, x1, y1, number_of_vertices):
+    # anti-clockwise, with the vertices spread round it
+    c = Curve()
+    n = max(1, number_of_vertices / 4)
+    corners = [(x0, y0), (x1, y0), (x1, y1), (x0, y1)]
+    for k in range(0, 4):
+        ax, ay = corners[k]
+        bx, by = corners[(k + 1) % 4]
+        for i in range(0, n):
+            t = float(i) / n
+            c.append(Vertex(0, Point(ax + (bx - ax) * t, ay + (by - ay) * t), Point(0, 0)))
+    c.append(Vertex(0, Point(x0, y0), Point(0, 0)))
+    return c
+
+settings = {'units': 1.0, 'accuracy': 0.01, 'holes_linked': False}
+offset_calls = [0]
+
+class Area:
+    def __init__(self, a = None):
+        self.curves = [] if a == None else [Curve(c) for c in a.curves]
+
+    def append(self, curve):
+        self.curves.append(curve)
+
+    def getCurves(self):
+        return self.curves
+
+    def num_curves(self):
+        return len(self.curves)
+
+    def Reorder(self):
+        pass
+
+    def Offset(self, d):
+        offset_calls[0] += 1
+        curves = []
+        for c in self.curves:
+            xs = [v.p.x for v in c.vertices]
+            ys = [v.p.y for v in c.vertices]
+            x0, y0, x1, y1 = min(xs) + d, min(ys) + d, max(xs) - d, max(ys) - d
+            if x1 <= x0 or y1 <= y0:
+                continue
+            n = len(c.vertices) - 1
+            if x1 - x0 > 4 * (y1 - y0):
+                xm = (x0 + x1) * 0.5
+                curves.append(rectangle(x0, y0, xm - d, y1, n))
+                curves.append(rectangle(xm + d, y0, x1, y1, n))
+            else:
+                curves.append(rectangle(x0, y0, x1, y1, n))
+        self.curves = curves
+
+area = types.ModuleType('area')
+area.Point = Point
+area.Vertex = Vertex
+area.Curve = Curve
+area.Area = Area
+area.get_units = lambda: settings['units']
+area.set_units = lambda units: settings.__setitem__('units', units)
+area.get_accuracy = lambda: settings['accuracy']
+area.set_accuracy = lambda accuracy: settings.__setitem__('accuracy', accuracy)
+area.holes_linked = lambda: settings['holes_linked']
+sys.modules['area'] = area
+
+################################################################################
+
+import postprocessor
+offsets = sys.modules['postprocessor.offsets']
+
+def make_area(number_of_rectangles, number_of_vertices):
+    a = Area()
+    for i in range(0, number_of_rectangles):
+        a.append(rectangle(i * 150.0, 0.0, i * 150.0 + 100.0 + i * 7.0, 30.0 + i * 3.0, number_of_vertices))
+    return a
+
+def rings(a, stepover, in_parallel):
+    offsets.ring_cache.clear()
+    del offsets.ring_cache_order[:]
+    offsets.min_vertices_in_parallel = 0 if in_parallel else sys.maxint
+    start = time.time()
+    arealist = offsets.get_offset_areas(a, stepover)
+    return [offsets.curves_of(a) for a in arealist], time.time() - start
+
+def main():
+    number_of_rectangles = 6
+    number_of_vertices = 400
+    if len(sys.argv) > 1: number_of_rectangles = int(sys.argv[1])
+    if len(sys.argv) > 2: number_of_vertices = int(sys.argv[2])
+
+    # on one core offsets.py wouldn't start any processes
+    cores = multiprocessing.cpu_count()
+    multiprocessing.cpu_count = lambda: max(2, cores)
+
+    failures = 0
+    a = make_area(number_of_rectangles, number_of_vertices)
+    stepover = 0.5
+
+    for holes_linked in [False, True]:
+        settings['holes_linked'] = holes_linked
+        one_at_a_time, serial_time = rings(a, stepover, False)
+        in_parallel, parallel_time = rings(a, stepover, True)
+        print 'holes linked %s: %d rings, one at a time %.3f s, in parallel %.3f s' % (holes_linked, len(one_at_a_time), serial_time, parallel_time)
+        if in_parallel != one_at_a_time:
+            for i in range(0, min(len(in_parallel), len(one_at_a_time))):
+                if in_parallel[i] != one_at_a_time[i]:
+                    break
+            print '  ring %d differs, of %d in parallel and %d one at a time' % (i, len(in_parallel), len(one_at_a_time))
+            failures = failures + 1
+
+    # the cache
+    settings['holes_linked'] = False
+    offsets.ring_cache.clear()
+    del offsets.ring_cache_order[:]
+    offsets.min_vertices_in_parallel = sys.maxint
+    for setting, value, made_again in [(None, None, True), (None, None, False), ('units', 25.4, True), ('units', 1.0, False),
+                                       ('accuracy', 0.001, True), ('accuracy', 0.01, False)]:
+        if setting != None:
+            settings[setting] = value
+        offset_calls[0] = 0
+        offsets.offsets(a, stepover, False, 'conventional')
+        if (offset_calls[0] > 0) != made_again:
+            print 'the rings were %s with %s %s' % ('made again' if offset_calls[0] > 0 else 'taken from the cache', setting, value)
+            failures = failures + 1
+
+    if failures:
+        print '%d failures' % failures
+        return 1
+    return 0
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,58 @@
+################################################################################
+# op_cache_subroutines.py
+#
+# Checks that nc/op_cache.py doesn't keep the NC code of an operation which wrote
+# a subroutine, as the subroutine wouldn't be written when the code was used again.
+# iso.py writes all the subroutines to one temporary file, so the second operation
+# to write one doesn't add a file.
+#
+# python op_cache_subroutines.py
+
+import sys
+import os
+import tempfile
+import shutil
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), '..'))
+
+import nc.nc as nc
+import nc.iso as iso
+import nc.op_cache as op_cache
+
+def op_with_subroutine():
+    nc.creator.sub_begin(None)
+    nc.creator.rapid(0, 0, 5)
+    nc.creator.feed(1, 2, 3)
+    nc.creator.sub_end()
+    nc.creator.sub_call(None)
+
+def main():
+    cache_dir = tempfile.mkdtemp()
+    nc_path = os.path.join(cache_dir, 'test.tap')
+    try:
+        nc.creator = iso.Creator()
+        nc.creator.file_open(nc_path)
+        nc.creator.program_begin(1, 'op_cache_subroutines')
+        op_cache.cache_begin(cache_dir)
+
+        failures = 0
+        for i in range(0, 2):
+            key = 'op%d' % i
+            if op_cache.op_begin(key):
+                op_with_subroutine()
+            op_cache.op_end()
+            kept = [name for name in os.listdir(cache_dir) if name.startswith(key + '_')]
+            if len(kept) > 0:
+                print 'operation %d, which wrote a subroutine, was kept: %s' % (i + 1, kept)
+                failures = failures + 1
+
+        nc.creator.program_end()
+        nc.creator.file_close()
+    finally:
+        shutil.rmtree(cache_dir)
+
+    if failures:
+        sys.exit(1)
+    print 'neither operation was kept'
+
+main()
@@ -0,0 +1,182 @@
+// op_scheduler.cpp
+// Schedules random programs with COpScheduler, as CProgram::GetOperationsInOrder does, checks that no operation is moved
+// in front of one it depends on, and compares the tool changes and rapid travel with doing them in the order they were made.
+// Each program is made by a few people, one after another, each with their own few tools, roughing and then finishing some
+// sketches, drilling and then tapping some points, with the odd script operation, the odd operation told to follow another,
+// and the odd rest machining pocket, which follows all the operations before it which cut anything, as GetOperationsInOrder has it.
+//
+// op_scheduler [number of programs] [number of operations in each]
+
+#include "stdafx.h"
+#include "OpScheduler.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+static double Now()
+{
+	return (double)clock() / CLOCKS_PER_SEC;
+}
+
+static double Random(double a, double b)
+{
+	return a + (b - a) * rand() / RAND_MAX;
+}
+
+static const int SketchType = 1;
+static const int PointType = 2;
+
+static std::vector<COpScheduler::Op> MakeProgram(int number_of_ops)
+{
+	std::vector<COpScheduler::Op> ops;
+	int next_object = 1;
+	while((int)ops.size() < number_of_ops)
+	{
+		// a person, with their own tools, working on one part of the table
+		int tools[4];
+		for(int t = 0; t < 4; t++)tools[t] = 1 + rand() % 12;
+		double cx = Random(0, 500), cy = Random(0, 300);
+		int person_ops = 5 + rand() % 20;
+		for(int k = 0; k < person_ops && (int)ops.size() < number_of_ops; k++)
+		{
+			COpScheduler::Op op;
+			int r = rand() % 20;
+			if(r == 0)
+			{
+				op.barrier = true; // a script operation
+			}
+			else
+			{
+				op.tool = tools[rand() % 4];
+				op.has_location = (rand() % 10 != 0);
+				op.x = cx + Random(-50, 50);
+				op.y = cy + Random(-50, 50);
+				int type = (rand() % 3 == 0) ? PointType : SketchType;
+				if(k > 0 && rand() % 3 == 0 && ops.back().objects.size() > 0)
+				{
+					// finishing what was roughed, or tapping what was drilled
+					op.objects = ops.back().objects;
+					op.x = ops.back().x;
+					op.y = ops.back().y;
+				}
+				else
+				{
+					op.objects.push_back(std::make_pair(type, next_object++));
+				}
+				if(ops.size() > 0 && rand() % 15 == 0)op.after.push_back(rand() % ops.size());
+				if(type == SketchType && rand() % 40 == 0)
+				{
+					for(int j = 0; j < (int)ops.size(); j++)
+					{
+						if(!ops[j].barrier)op.after.push_back(j);
+					}
+				}
+			}
+			ops.push_back(op);
+		}
+	}
+	return ops;
+}
+
+// checks the order against the dependencies described in OpScheduler.h, worked out the slow way
+static bool CheckOrder(const std::vector<COpScheduler::Op> &ops, const std::vector<int> &order)
+{
+	int n = (int)ops.size();
+	if((int)order.size() != n)
+	{
+		printf("  %d operations in the order, not %d\n", (int)order.size(), n);
+		return false;
+	}
+	std::vector<int> position(n, -1);
+	for(int p = 0; p < n; p++)
+	{
+		if(order[p] < 0 || order[p] >= n || position[order[p]] != -1)
+		{
+			printf("  the order isn't of each operation once\n");
+			return false;
+		}
+		position[order[p]] = p;
+	}
+
+	for(int i = 0; i < n; i++)
+	{
+		for(int j = 0; j < i; j++)
+		{
+			bool must_follow = ops[i].barrier || ops[j].barrier;
+			for(size_t a = 0; a < ops[i].after.size(); a++)
+			{
+				if(ops[i].after[a] == j)must_follow = true;
+			}
+			for(size_t a = 0; a < ops[i].objects.size(); a++)
+			{
+				for(size_t b = 0; b < ops[j].objects.size(); b++)
+				{
+					if(ops[i].objects[a] == ops[j].objects[b])must_follow = true;
+				}
+			}
+			if(must_follow && position[i] < position[j])
+			{
+				printf("  operation %d was moved in front of operation %d\n", i, j);
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+int main(int argc, char** argv)
+{
+	int number_of_programs = 100;
+	int number_of_ops = 200;
+	if(argc > 1)number_of_programs = atoi(argv[1]);
+	if(argc > 2)number_of_ops = atoi(argv[2]);
+
+	srand(1);
+
+	int failures = 0;
+	int tool_changes_before = 0, tool_changes_after = 0;
+	double travel_before = 0.0, travel_after = 0.0;
+	double schedule_time = 0.0;
+	int worse = 0;
+
+	for(int p = 0; p < number_of_programs; p++)
+	{
+		std::vector<COpScheduler::Op> ops = MakeProgram(number_of_ops);
+		std::vector<int> tree_order;
+		for(int i = 0; i < (int)ops.size(); i++)tree_order.push_back(i);
+
+		std::vector<int> order;
+		double start = Now();
+		COpScheduler::Schedule(ops, order);
+		schedule_time += Now() - start;
+
+		if(!CheckOrder(ops, order))
+		{
+			printf("  in program %d\n", p);
+			failures++;
+			continue;
+		}
+
+		int before = COpScheduler::ToolChanges(ops, tree_order);
+		int after = COpScheduler::ToolChanges(ops, order);
+		if(after > before)worse++;
+		tool_changes_before += before;
+		tool_changes_after += after;
+		travel_before += COpScheduler::Travel(ops, tree_order);
+		travel_after += COpScheduler::Travel(ops, order);
+	}
+
+	printf("%d programs of %d operations: %d tool changes instead of %d, %.0f mm of rapid travel instead of %.0f\n",
+		number_of_programs, number_of_ops, tool_changes_after, tool_changes_before, travel_after, travel_before);
+	printf("%d programs had more tool changes than in the order they were made\n", worse);
+	printf("scheduling took %.3f s, %.3f ms for each program\n", schedule_time, schedule_time * 1000 / number_of_programs);
+
+	if(tool_changes_after > tool_changes_before)
+	{
+		printf("scheduling made more tool changes\n");
+		failures++;
+	}
+
+	return (failures > 0) ? 1 : 0;
+}
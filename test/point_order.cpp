@@ -0,0 +1,136 @@
+// point_order.cpp
+// Times CPointOrder on sets of drilling locations, and gives the rapid distance in the given order, and sorted,
+// which is what the comment CDrilling writes in the python program says. Checks that each order has every point
+// once, and that points in the same place are drilled one after the other.
+//
+// point_order [number of points]
+
+#include "stdafx.h"
+#include "PointOrder.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+static double Now()
+{
+	return (double)clock() / CLOCKS_PER_SEC;
+}
+
+static double Random(double a, double b)
+{
+	return a + (b - a) * rand() / RAND_MAX;
+}
+
+static void Shuffle(std::vector<CPointOrder::Point> &points)
+{
+	for(size_t i = points.size(); i > 1; i--)
+	{
+		size_t j = rand() % i;
+		std::swap(points[i - 1], points[j]);
+	}
+}
+
+// returns false if order isn't a good order for points
+static bool Check(const char* name, const std::vector<CPointOrder::Point> &points, const std::vector<int> &order)
+{
+	if(order.size() != points.size())
+	{
+		printf("%s: %d points were ordered, not %d\n", name, (int)order.size(), (int)points.size());
+		return false;
+	}
+	std::vector<bool> used(points.size(), false);
+	for(size_t i = 0; i < order.size(); i++)
+	{
+		if(order[i] < 0 || order[i] >= (int)points.size() || used[order[i]])
+		{
+			printf("%s: point %d is missing, or in the order twice\n", name, order[i]);
+			return false;
+		}
+		used[order[i]] = true;
+	}
+
+	// the points in one place are together
+	std::set< std::pair<double, double> > finished;
+	for(size_t i = 0; i < order.size(); i++)
+	{
+		const CPointOrder::Point &p = points[order[i]];
+		std::pair<double, double> place(p.x, p.y);
+		if(finished.find(place) != finished.end())
+		{
+			printf("%s: the points at %g, %g aren't together\n", name, p.x, p.y);
+			return false;
+		}
+		if(i + 1 < order.size())
+		{
+			const CPointOrder::Point &next = points[order[i + 1]];
+			if(next.x != p.x || next.y != p.y)finished.insert(place);
+		}
+	}
+	return true;
+}
+
+static bool Run(const char* name, const std::vector<CPointOrder::Point> &points)
+{
+	CPointOrder::Point start(0.0, 0.0);
+	std::vector<int> given;
+	for(size_t i = 0; i < points.size(); i++)given.push_back((int)i);
+
+	std::vector<int> order;
+	double t = Now();
+	CPointOrder::Order(start, points, order);
+	t = Now() - t;
+
+	double before = CPointOrder::Length(start, points, given);
+	double after = CPointOrder::Length(start, points, order);
+	printf("%-24s %7d points  %8.3f s  rapids %12.1f given, %12.1f sorted (%.1f%%)\n", name, (int)points.size(), t, before, after, (before > 0.0) ? after * 100.0 / before : 100.0);
+	return Check(name, points, order);
+}
+
+int main(int argc, char** argv)
+{
+	int number_of_points = 20000;
+	if(argc > 1)number_of_points = atoi(argv[1]);
+
+	srand(1);
+	bool ok = true;
+
+	// holes anywhere on a 1 m plate
+	std::vector<CPointOrder::Point> points;
+	for(int i = 0; i < number_of_points; i++)points.push_back(CPointOrder::Point(Random(0, 1000), Random(0, 1000)));
+	ok = Run("random", points) && ok;
+
+	// a perforated plate, on a 2.54 mm grid, in no order
+	points.clear();
+	int side = (int)sqrt((double)number_of_points);
+	for(int i = 0; i < side; i++)for(int j = 0; j < side; j++)points.push_back(CPointOrder::Point(i * 2.54, j * 2.54));
+	Shuffle(points);
+	ok = Run("shuffled grid", points) && ok;
+
+	// the same hole many times
+	points.clear();
+	for(int i = 0; i < number_of_points; i++)points.push_back(CPointOrder::Point(10.0, 20.0));
+	ok = Run("all the same", points) && ok;
+
+	// a pattern whose copies overlap, so each hole is there ten times
+	points.clear();
+	for(int i = 0; i < number_of_points / 10; i++)
+	{
+		CPointOrder::Point p(Random(0, 1000), Random(0, 1000));
+		for(int j = 0; j < 10; j++)points.push_back(p);
+	}
+	Shuffle(points);
+	ok = Run("each ten times", points) && ok;
+
+	// a PCB, with clusters of holes
+	points.clear();
+	while((int)points.size() < number_of_points)
+	{
+		double cx = Random(0, 300), cy = Random(0, 200);
+		for(int j = 0; j < 40; j++)points.push_back(CPointOrder::Point(cx + Random(-5, 5), cy + Random(-5, 5)));
+	}
+	Shuffle(points);
+	ok = Run("clusters", points) && ok;
+
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,253 @@
+// python_text.cpp
+// Checks FormatNumber, which writes the numbers in the python programs, against the stream formatting it replaced,
+// and times building a sketch heavy program, like CProfile::WriteSketchDefn's, three ways:
+//   streams:   a wostringstream, with the "C" locale, for each number, appended to one string, as it was done before
+//   string:    FormatNumber, appended to one string, as Python::operator<< does now; Python is a wxString
+//   chunks:    FormatNumber, into a list of fixed size chunks, joined into one string at the end
+// The program is made of sketches, each built in a string of its own, then appended to the program, as the operations do.
+// wxString, in the unicode builds, is a std::wstring, or grows like one, so std::wstring stands in for it here.
+//
+// python_text [number of points] [number of points in each sketch]
+
+#include "stdafx.h"
+#include "PythonNumber.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <sstream>
+#include <iomanip>
+#include <locale>
+#include <limits>
+
+static double Now()
+{
+	return (double)clock() / CLOCKS_PER_SEC;
+}
+
+static double Random(double a, double b)
+{
+	return a + (b - a) * rand() / RAND_MAX;
+}
+
+// the old PythonString( const double value )
+static std::wstring StreamNumber(double value)
+{
+	std::wostringstream s;
+	s.imbue(std::locale("C"));
+	s << std::setprecision(10);
+	s << value;
+	return s.str();
+}
+
+static void AppendNumber(std::wstring &text, double value)
+{
+	char number[32];
+	int length = FormatNumber(value, number);
+	wchar_t characters[32];
+	for(int i = 0; i <= length; i++)characters[i] = number[i];
+	text.append(characters, length);
+}
+
+// a text builder which never moves what it has, made of chunks of a fixed size
+class ChunkedText
+{
+	enum { chunk_size = 1 << 16 };
+	std::list< std::vector<wchar_t> > m_chunks;
+	size_t m_used; // in the last chunk
+	size_t m_length;
+
+	void Append(const wchar_t* s, size_t length)
+	{
+		while(length > 0)
+		{
+			if(m_chunks.size() == 0 || m_used == chunk_size)
+			{
+				m_chunks.push_back(std::vector<wchar_t>(chunk_size));
+				m_used = 0;
+			}
+			size_t n = chunk_size - m_used;
+			if(n > length)n = length;
+			memcpy(&m_chunks.back()[m_used], s, n * sizeof(wchar_t));
+			m_used += n;
+			m_length += n;
+			s += n;
+			length -= n;
+		}
+	}
+
+public:
+	ChunkedText(): m_used(0), m_length(0) {}
+
+	ChunkedText &operator<<(const wchar_t* s) { Append(s, wcslen(s)); return *this; }
+	ChunkedText &operator<<(double value)
+	{
+		char number[32];
+		int length = FormatNumber(value, number);
+		wchar_t characters[32];
+		for(int i = 0; i <= length; i++)characters[i] = number[i];
+		Append(characters, length);
+		return *this;
+	}
+	ChunkedText &operator<<(const ChunkedText &text)
+	{
+		std::list< std::vector<wchar_t> >::const_iterator last = text.m_chunks.end();
+		for(std::list< std::vector<wchar_t> >::const_iterator It = text.m_chunks.begin(); It != text.m_chunks.end(); It++)
+		{
+			std::list< std::vector<wchar_t> >::const_iterator next = It;
+			next++;
+			Append(&(*It)[0], (next == last) ? text.m_used : chunk_size);
+		}
+		return *this;
+	}
+
+	std::wstring str(void)const
+	{
+		std::wstring s;
+		s.reserve(m_length);
+		std::list< std::vector<wchar_t> >::const_iterator last = m_chunks.end();
+		for(std::list< std::vector<wchar_t> >::const_iterator It = m_chunks.begin(); It != m_chunks.end(); It++)
+		{
+			std::list< std::vector<wchar_t> >::const_iterator next = It;
+			next++;
+			s.append(&(*It)[0], (next == last) ? m_used : chunk_size);
+		}
+		return s;
+	}
+};
+
+static const wchar_t* sketch_begin = L"\ncomment('sketch')\ncurve = area.Curve()\n";
+static const wchar_t* point_begin = L"curve.append(area.Point(";
+static const wchar_t* point_middle = L", ";
+static const wchar_t* point_end = L"))\n";
+
+static std::wstring WithStreams(const std::vector<double> &xy, size_t points_per_sketch)
+{
+	std::wstring program;
+	for(size_t p = 0; p < xy.size() / 2; p += points_per_sketch)
+	{
+		std::wstring sketch = sketch_begin;
+		for(size_t i = p; i < p + points_per_sketch && i < xy.size() / 2; i++)
+		{
+			sketch += point_begin;
+			sketch += StreamNumber(xy[i * 2]);
+			sketch += point_middle;
+			sketch += StreamNumber(xy[i * 2 + 1]);
+			sketch += point_end;
+		}
+		program += sketch;
+	}
+	return program;
+}
+
+static std::wstring WithString(const std::vector<double> &xy, size_t points_per_sketch)
+{
+	std::wstring program;
+	for(size_t p = 0; p < xy.size() / 2; p += points_per_sketch)
+	{
+		std::wstring sketch = sketch_begin;
+		for(size_t i = p; i < p + points_per_sketch && i < xy.size() / 2; i++)
+		{
+			sketch += point_begin;
+			AppendNumber(sketch, xy[i * 2]);
+			sketch += point_middle;
+			AppendNumber(sketch, xy[i * 2 + 1]);
+			sketch += point_end;
+		}
+		program += sketch;
+	}
+	return program;
+}
+
+static std::wstring WithChunks(const std::vector<double> &xy, size_t points_per_sketch)
+{
+	ChunkedText program;
+	for(size_t p = 0; p < xy.size() / 2; p += points_per_sketch)
+	{
+		ChunkedText sketch;
+		sketch << sketch_begin;
+		for(size_t i = p; i < p + points_per_sketch && i < xy.size() / 2; i++)
+		{
+			sketch << point_begin << xy[i * 2] << point_middle << xy[i * 2 + 1] << point_end;
+		}
+		program << sketch;
+	}
+	return program.str();
+}
+
+// the best of three
+static double Time(std::wstring (*build)(const std::vector<double> &, size_t), const std::vector<double> &xy, size_t points_per_sketch, std::wstring &program)
+{
+	double best = 0.0;
+	for(int i = 0; i < 3; i++)
+	{
+		double start = Now();
+		program = (*build)(xy, points_per_sketch);
+		double t = Now() - start;
+		if(i == 0 || t < best)best = t;
+	}
+	return best;
+}
+
+int main(int argc, char** argv)
+{
+	size_t number_of_points = 1000000;
+	size_t points_per_sketch = 100;
+	if(argc > 1)number_of_points = atoi(argv[1]);
+	if(argc > 2)points_per_sketch = atoi(argv[2]);
+	if(points_per_sketch < 1)points_per_sketch = 1;
+
+	srand(1);
+
+	// the numbers which take each of FormatNumber's paths, then random ones
+	std::vector<double> numbers;
+	double special[] = {0.0, -0.0, 1.0, -1.0, 0.1, 0.5, 1e-4, 9.9999999995e-5, 1e-5, 123456789.0, 1234567890.0, 9999999999.5, 1e10, 1e100, -1e-100,
+		1.00000000005, 2.5e-310, std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity(), std::numeric_limits<double>::quiet_NaN()};
+	for(size_t i = 0; i < sizeof(special) / sizeof(double); i++)numbers.push_back(special[i]);
+	for(int i = -320; i <= 308; i++)
+	{
+		numbers.push_back(pow(10.0, i));
+		numbers.push_back(-Random(1, 10) * pow(10.0, i));
+	}
+	for(size_t i = 0; i < number_of_points; i++)
+	{
+		numbers.push_back(Random(-1000, 1000));
+		numbers.push_back(floor(Random(-100000, 100000)) / 1000); // like a coordinate typed in
+		numbers.push_back((floor(Random(1e9, 1e10)) + 0.5) / pow(10.0, rand() % 14)); // half way between two 10 digit numbers
+	}
+
+	int failures = 0;
+	for(size_t i = 0; i < numbers.size(); i++)
+	{
+		std::wstring s;
+		AppendNumber(s, numbers[i]);
+		std::wstring expected = StreamNumber(numbers[i]);
+		if(s != expected)
+		{
+			if(failures < 10)printf("%.17g gave %ls, not %ls\n", numbers[i], s.c_str(), expected.c_str());
+			failures++;
+		}
+	}
+	printf("FormatNumber: %d of %d numbers differed from the stream\n", failures, (int)numbers.size());
+
+	std::vector<double> xy;
+	for(size_t i = 0; i < number_of_points * 2; i++)xy.push_back(Random(-1000, 1000));
+
+	std::wstring with_streams, with_string, with_chunks;
+	double streams_time = Time(WithStreams, xy, points_per_sketch, with_streams);
+	double string_time = Time(WithString, xy, points_per_sketch, with_string);
+	double chunks_time = Time(WithChunks, xy, points_per_sketch, with_chunks);
+
+	if(with_string != with_streams || with_chunks != with_streams)
+	{
+		printf("the programs differ\n");
+		failures++;
+	}
+
+	printf("%d points, %d in each sketch, %d characters\n", (int)number_of_points, (int)points_per_sketch, (int)with_streams.size());
+	printf("streams: %.3f s\n", streams_time);
+	printf("string:  %.3f s\n", string_time);
+	printf("chunks:  %.3f s\n", chunks_time);
+
+	return (failures > 0) ? 1 : 0;
+}
@@ -0,0 +1,322 @@
+################################################################################
+# rest_material.py
+#
+# Checks what area_funcs takes away from a rest machining pocket's material for
+# each kind of operation before it; pocket_cleared, profile_cleared, for closed
+# and open curves, going either way round, on each side, and holes_cleared,
+# then get_rest_key and get_rest_material with some of them.
+# Each area made is compared with the shape it should be, worked out from
+# distances to rectangles, lines and points; each point of the area has to be
+# in that shape grown by a tolerance, and each point of that shape shrunk by
+# the tolerance has to be in the area.
+# libarea is stood in for by an area module which keeps each area as a grid of
+# cells, so offsetting, adding and taking away areas is easy to get right.
+#
+# python rest_material.py
+
+import sys
+import os
+import math
+import types
+
+heekscnc_dir = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..')
+sys.path.insert(0, heekscnc_dir)
+
+################################################################################
+# the area module, for areas as grids of cells
+
+cell = 0.5
+min_x, min_y = -20.0, -20.0
+nx, ny = 240, 200
+
+class Point:
+    def __init__(self, x = 0.0, y = 0.0):
+        self.x = x
+        self.y = y
+
+    def __add__(self, p): return Point(self.x + p.x, self.y + p.y)
+    def __sub__(self, p): return Point(self.x - p.x, self.y - p.y)
+    def __mul__(self, d): return Point(self.x * d, self.y * d)
+    def __neg__(self): return Point(-self.x, -self.y)
+
+    def length(self):
+        return math.sqrt(self.x * self.x + self.y * self.y)
+
+    def normalize(self):
+        d = self.length()
+        self.x = self.x / d
+        self.y = self.y / d
+
+class Vertex:
+    def __init__(self, type, p, c, user_data = 0):
+        self.type = type
+        self.p = p
+        self.c = c
+
+class Curve:
+    def __init__(self, curve = None):
+        self.vertices = [] if curve == None else list(curve.vertices)
+
+    def append(self, v):
+        if isinstance(v, Point):
+            v = Vertex(0, v, Point(0, 0))
+        self.vertices.append(v)
+
+    def getVertices(self):
+        return self.vertices
+
+    def IsClosed(self):
+        return len(self.vertices) > 1 and self.vertices[0].p.x == self.vertices[-1].p.x and self.vertices[0].p.y == self.vertices[-1].p.y
+
+    def Offset(self, d):
+        # to the left, for open curves of lines only, with the corners mitred
+        if len([v for v in self.vertices[1:] if v.type != 0]) > 0:
+            return False
+        points = [v.p for v in self.vertices]
+        lines = []
+        for k in range(0, len(points) - 1):
+            v = points[k + 1] - points[k]
+            v.normalize()
+            left = Point(-v.y, v.x) * d
+            lines.append((points[k] + left, points[k + 1] + left))
+        new_points = [lines[0][0]]
+        for k in range(0, len(lines) - 1):
+            (a, b), (c, e) = lines[k], lines[k + 1]
+            u, w = b - a, e - c
+            t = ((c.x - a.x) * w.y - (c.y - a.y) * w.x) / (u.x * w.y - u.y * w.x)
+            new_points.append(a + u * t)
+        new_points.append(lines[-1][1])
+        self.vertices = [Vertex(0, p, Point(0, 0)) for p in new_points]
+        return True
+
+def polygon(curve):
+    # the points of the curve, with its arcs made of short lines
+    points = []
+    prev_p = None
+    for v in curve.getVertices():
+        if prev_p != None and v.type != 0:
+            r = (prev_p - v.c).length()
+            a0 = math.atan2(prev_p.y - v.c.y, prev_p.x - v.c.x)
+            a1 = math.atan2(v.p.y - v.c.y, v.p.x - v.c.x)
+            sweep = (a1 - a0) * v.type
+            while sweep <= 0.0:
+                sweep = sweep + 2 * math.pi
+            n = int(sweep / 0.02) + 1
+            for i in range(1, n):
+                angle = a0 + sweep * v.type * i / n
+                points.append((v.c.x + r * math.cos(angle), v.c.y + r * math.sin(angle)))
+        points.append((v.p.x, v.p.y))
+        prev_p = v.p
+    return points
+
+def fill(curves):
+    # the cells with their centres inside an odd number of the closed curves
+    edges = []
+    for curve in curves:
+        if not curve.IsClosed():
+            continue
+        points = polygon(curve)
+        for k in range(0, len(points) - 1):
+            edges.append((points[k], points[k + 1]))
+    cells = set()
+    for j in range(0, ny):
+        y = min_y + (j + 0.5) * cell
+        xs = []
+        for (x0, y0), (x1, y1) in edges:
+            if (y0 <= y < y1) or (y1 <= y < y0):
+                xs.append(x0 + (y - y0) * (x1 - x0) / (y1 - y0))
+        xs.sort()
+        for k in range(0, len(xs) - 1, 2):
+            i0 = int(math.ceil((xs[k] - min_x) / cell - 0.5))
+            i1 = int(math.ceil((xs[k + 1] - min_x) / cell - 0.5))
+            for i in range(max(i0, 0), min(i1, nx)):
+                cells.add((i, j))
+    return cells
+
+def grow(cells, d):
+    n = int(d / cell)
+    disk = [(di, dj) for di in range(-n, n + 1) for dj in range(-n, n + 1) if di * di + dj * dj <= (d / cell) * (d / cell)]
+    edge = [(i, j) for (i, j) in cells if (i + 1, j) not in cells or (i - 1, j) not in cells or (i, j + 1) not in cells or (i, j - 1) not in cells]
+    grown = set(cells)
+    for i, j in edge:
+        for di, dj in disk:
+            if 0 <= i + di < nx and 0 <= j + dj < ny:
+                grown.add((i + di, j + dj))
+    return grown
+
+all_cells = set([(i, j) for i in range(0, nx) for j in range(0, ny)])
+
+class Area:
+    def __init__(self, a = None):
+        self.cells = set() if a == None else set(a.cells)
+        self.curves = [] if a == None else list(a.curves)
+
+    def append(self, curve):
+        self.curves.append(curve)
+
+    def getCurves(self):
+        return self.curves
+
+    def num_curves(self):
+        return len(self.get_cells()) > 0
+
+    def get_cells(self):
+        # the curves are only kept until the area is changed
+        if len(self.curves) > 0:
+            self.cells = self.cells ^ fill(self.curves)
+            self.curves = []
+        return self.cells
+
+    def Reorder(self):
+        pass
+
+    def Offset(self, d):
+        cells = self.get_cells()
+        if d < 0:
+            self.cells = grow(cells, -d)
+        else:
+            self.cells = cells - grow(all_cells - cells, d)
+
+    def Union(self, a):
+        self.cells = self.get_cells() | Area(a).get_cells()
+
+    def Subtract(self, a):
+        self.cells = self.get_cells() - Area(a).get_cells()
+
+    def Intersect(self, a):
+        self.cells = self.get_cells() & Area(a).get_cells()
+
+area = types.ModuleType('area')
+area.Point = Point
+area.Vertex = Vertex
+area.Curve = Curve
+area.Area = Area
+area.get_units = lambda: 1.0
+sys.modules['area'] = area
+
+################################################################################
+
+import area_funcs
+
+def rectangle(x0, y0, x1, y1, clockwise = False):
+    c = Curve()
+    corners = [(x0, y0), (x1, y0), (x1, y1), (x0, y1), (x0, y0)]
+    if clockwise:
+        corners.reverse()
+    for x, y in corners:
+        c.append(Point(x, y))
+    return c
+
+def area_of(*curves):
+    a = Area()
+    for c in curves:
+        a.append(c)
+    return a
+
+def distance_to_rectangle(x, y, rect):
+    x0, y0, x1, y1 = rect
+    dx = max(x0 - x, 0.0, x - x1)
+    dy = max(y0 - y, 0.0, y - y1)
+    return math.sqrt(dx * dx + dy * dy)
+
+def distance_to_line(x, y, line):
+    (x0, y0), (x1, y1) = line
+    vx, vy = x1 - x0, y1 - y0
+    t = max(0.0, min(1.0, ((x - x0) * vx + (y - y0) * vy) / (vx * vx + vy * vy)))
+    return math.hypot(x - x0 - vx * t, y - y0 - vy * t)
+
+# the shapes are given as functions of x, y and t, true if x, y is in the shape shrunk by t, or grown by -t
+def within(d, r, t):
+    return d <= r - t
+
+def beyond(d, r, t):
+    return d > r + t
+
+def in_rectangle(x, y, rect, t):
+    x0, y0, x1, y1 = rect
+    return x0 + t <= x <= x1 - t and y0 + t <= y <= y1 - t
+
+tolerance = 2 * cell
+
+def mismatches(a, expected):
+    # the cells where a isn't in the expected shape grown by the tolerance, or the shape shrunk by it isn't in a
+    cells = a.get_cells()
+    count = 0
+    for i in range(0, nx, 2):
+        for j in range(0, ny, 2):
+            x, y = min_x + (i + 0.5) * cell, min_y + (j + 0.5) * cell
+            if (i, j) in cells:
+                if not expected(x, y, -tolerance):
+                    count = count + 1
+            elif expected(x, y, tolerance):
+                count = count + 1
+    return count
+
+def main():
+    failures = 0
+    checks = 0
+    rect = (0.0, 0.0, 60.0, 40.0)
+    line = ((10.0, 50.0), (50.0, 50.0))
+
+    cases = []
+
+    # a pocket, with a 10 radius tool and 2 left on
+    cases.append(('pocket', area_funcs.pocket_cleared(area_of(rectangle(*rect)), 10.0, 2.0),
+                  lambda x, y, t: within(distance_to_rectangle(x, y, (12.0, 12.0, 48.0, 28.0)), 10.0, t)))
+
+    # profiles of the rectangle, going either way round; inside, with 0.5 left on, and outside
+    for clockwise in [False, True]:
+        cases.append(('profile inside, clockwise %s' % clockwise, area_funcs.profile_cleared(area_of(rectangle(*rect, clockwise = clockwise)), -1, 3.0, 0.5),
+                      lambda x, y, t: within(distance_to_rectangle(x, y, (3.5, 3.5, 56.5, 36.5)), 3.0, t) and not in_rectangle(x, y, (6.5, 6.5, 53.5, 33.5), -t)))
+        cases.append(('profile outside, clockwise %s' % clockwise, area_funcs.profile_cleared(area_of(rectangle(*rect, clockwise = clockwise)), 1, 3.0, 0.0),
+                      lambda x, y, t: beyond(distance_to_rectangle(x, y, rect), 0.0, t) and within(distance_to_rectangle(x, y, rect), 6.0, t)))
+
+    # profiles of an open line, going either way, on each side, with 1 left on
+    for side, offset in [(1, 3.0), (-1, -3.0), (0, 0.0)]:
+        for backwards in [False, True]:
+            (x0, y0), (x1, y1) = line
+            if backwards:
+                (x0, y0), (x1, y1) = (x1, y1), (x0, y0)
+            c = Curve()
+            c.append(Point(x0, y0))
+            c.append(Point(x1, y1))
+            y = line[0][1] + (-offset if backwards else offset)
+            centre = ((x0, y), (x1, y))
+            cases.append(('open profile, side %d, backwards %s' % (side, backwards), area_funcs.profile_cleared(area_of(c), side, 2.0, 1.0),
+                          lambda x, y, t, centre = centre: within(distance_to_line(x, y, centre), 2.0, t)))
+
+    # a profile on an open arc, the top half of a circle
+    c = Curve()
+    c.append(Point(90.0, 40.0))
+    c.append(Vertex(1, Point(70.0, 40.0), Point(80.0, 40.0)))
+    cases.append(('open arc', area_funcs.profile_cleared(area_of(c), 0, 2.0, 0.0),
+                  lambda x, y, t: (y >= 40.0 and within(abs(math.hypot(x - 80.0, y - 40.0) - 10.0), 2.0, t)) or within(math.hypot(x - 90.0, y - 40.0), 2.0, t) or within(math.hypot(x - 70.0, y - 40.0), 2.0, t)))
+
+    # holes
+    cases.append(('holes', area_funcs.holes_cleared([(30.0, 20.0), (45.0, 10.0)], 4.0),
+                  lambda x, y, t: within(math.hypot(x - 30.0, y - 20.0), 4.0, t) or within(math.hypot(x - 45.0, y - 10.0), 4.0, t)))
+
+    # a pocket to 10 deep, then a hole to 5 deep, taken away from the material
+    rest_areas = [(area_funcs.pocket_cleared(area_of(rectangle(*rect)), 10.0, 0.0), 0.0, -10.0), (area_funcs.holes_cleared([(5.0, 5.0)], 4.0), 0.0, -5.0)]
+    for start_depth, final_depth, key in [(0.0, -5.0, (0, 1)), (-5.0, -10.0, (0,)), (-10.0, -12.0, None)]:
+        checks = checks + 1
+        if area_funcs.get_rest_key(rest_areas, start_depth, final_depth) != key:
+            print 'the rest key from %g to %g is %s, not %s' % (start_depth, final_depth, area_funcs.get_rest_key(rest_areas, start_depth, final_depth), key)
+            failures = failures + 1
+    cases.append(('rest material', area_funcs.get_rest_material(area_of(rectangle(*rect)), rest_areas),
+                  lambda x, y, t: in_rectangle(x, y, rect, t) and beyond(distance_to_rectangle(x, y, (10.0, 10.0, 50.0, 30.0)), 10.0, t) and beyond(math.hypot(x - 5.0, y - 5.0), 4.0, t)))
+
+    for name, a, expected in cases:
+        checks = checks + 1
+        count = mismatches(a, expected)
+        if count > 0:
+            print '%s: %d points are the wrong side of its edge' % (name, count)
+            failures = failures + 1
+
+    print '%d checks, %d failed' % (checks, failures)
+    if failures:
+        return 1
+    return 0
+
+if __name__ == '__main__':
+    sys.exit(main())
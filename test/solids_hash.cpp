@@ -0,0 +1,103 @@
+// solids_hash.cpp
+// Checks that CSolidsHash, which names the cached STL file of a surface's solids, gives the same file name for the same solids saved in
+// two sessions; HeeksCAD's XML file with the STEP file in it, as CSurface::GetSTLFilePath hashes it, with a different time and temporary
+// file in the STEP file's HEADER, and carriage returns in one of them, read in pieces of random sizes. Then that a small change to a
+// solid, or another tolerance, gives another name. The time to hash is printed.
+//
+// solids_hash [number of faces in the solids]
+
+#include "stdafx.h"
+#include "SolidsHash.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+static double Now()
+{
+	return (double)clock() / CLOCKS_PER_SEC;
+}
+
+// what HeeksCAD saves for some solids, as if in a session at time, with the STEP file written to temp_file
+static std::string SavedSolids(int number_of_faces, const char* time, const char* temp_file, const char* new_line, double bump)
+{
+	std::string s;
+	char line[512];
+	sprintf(line, "<?xml version=\"1.0\" encoding=\"UTF-8\" ?>%s<HeeksCAD_Document>%s", new_line, new_line);
+	s += line;
+	sprintf(line, "    <Solid title=\"Solid\" id=\"3\" col=\"8421504\" opacity=\"1\">%s        <faces><face id=\"1\"/></faces>%s    </Solid>%s", new_line, new_line, new_line);
+	s += line;
+	sprintf(line, "    <STEP_file>%s        <file_text><![CDATA[ISO-10303-21;%sHEADER;%sFILE_DESCRIPTION(('Open CASCADE Model'),'2;1');%s", new_line, new_line, new_line, new_line);
+	s += line;
+	sprintf(line, "FILE_NAME('%s','%s',('Author'),(%s    'Open CASCADE'),'Open CASCADE STEP processor 6.5','Open CASCADE 6.5'%s  ,'Unknown');%s", temp_file, time, new_line, new_line, new_line);
+	s += line;
+	sprintf(line, "FILE_SCHEMA(('AUTOMOTIVE_DESIGN { 1 0 10303 214 1 1 1 1 }'));%sENDSEC;%sDATA;%s", new_line, new_line, new_line);
+	s += line;
+	for(int i = 0; i < number_of_faces; i++)
+	{
+		double z = (i == number_of_faces / 2) ? bump : 0.0;
+		sprintf(line, "#%d = ADVANCED_FACE('',(#%d),#%d,.T.);%s#%d = CARTESIAN_POINT('',(%.15g,%.15g,%.15g));%s", i * 2 + 10, i * 2 + 11, i * 2 + 12, new_line,
+			i * 2 + 11, i * 0.5, i * 0.25, z, new_line);
+		s += line;
+	}
+	sprintf(line, "ENDSEC;%sEND-ISO-10303-21;%s]]></file_text>%s    </STEP_file>%s</HeeksCAD_Document>%s", new_line, new_line, new_line, new_line, new_line);
+	s += line;
+	return s;
+}
+
+// as CSurface::GetSTLFilePath does it, but in pieces of random sizes
+static std::string FileName(const std::string &saved, double tolerance)
+{
+	CSolidsHash hash;
+	hash.Add(tolerance);
+	hash.Add(3);
+	for(size_t i = 0; i < saved.size();)
+	{
+		size_t size = std::min((size_t)(1 + rand() % 100), saved.size() - i);
+		hash.AddSaved(&saved[i], size);
+		i += size;
+	}
+	return hash.FileName(".stl");
+}
+
+int main(int argc, char** argv)
+{
+	int number_of_faces = 1000;
+	if(argc > 1)number_of_faces = atoi(argv[1]);
+	srand(1);
+
+	std::string first_session = SavedSolids(number_of_faces, "2013-05-01T10:12:42", "C:/Temp/temp_HeeksCAD_STEP_file.step", "\n", 0.0);
+	std::string second_session = SavedSolids(number_of_faces, "2013-06-17T16:03:09", "/tmp/temp_HeeksCAD_STEP_file.step", "\r\n", 0.0);
+	std::string changed = SavedSolids(number_of_faces, "2013-05-01T10:12:42", "C:/Temp/temp_HeeksCAD_STEP_file.step", "\n", 0.001);
+
+	int failures = 0;
+	std::string first_name = FileName(first_session, 0.01);
+	std::string second_name = FileName(second_session, 0.01);
+	if(first_name != second_name)
+	{
+		printf("the same solids, saved in two sessions, give %s and %s\n", first_name.c_str(), second_name.c_str());
+		failures++;
+	}
+	std::string changed_name = FileName(changed, 0.01);
+	if(changed_name == first_name)
+	{
+		printf("a solid with a point moved gives the same file, %s\n", changed_name.c_str());
+		failures++;
+	}
+	std::string tolerance_name = FileName(first_session, 0.001);
+	if(tolerance_name == first_name)
+	{
+		printf("another tolerance gives the same file, %s\n", tolerance_name.c_str());
+		failures++;
+	}
+
+	double start = Now();
+	CSolidsHash hash;
+	hash.AddSaved(first_session.data(), first_session.size());
+	hash.FileName(".stl");
+	double seconds = Now() - start;
+
+	printf("%s for both sessions, %s with a point moved, %s with another tolerance; %.1f MB hashed in %.3f s\n", first_name.c_str(), changed_name.c_str(),
+		tolerance_name.c_str(), first_session.size() / 1.0e6, seconds);
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,15 @@
+// stdafx.h : stands in for src/stdafx.h when the tests are built, with only the standard headers,
+// so that the HeeksCNC sources which don't use wxWidgets, OpenCascade or HeeksCAD can be built without them.
+// The sources are copied next to this file, see heekscnc_sources in CMakeLists.txt, so that it is the one they include.
+//
+// Copyright (c) 2009, Dan Heeks
+// This program is released under the BSD license. See the file COPYING for details.
+
+#include <list>
+#include <vector>
+#include <map>
+#include <set>
+#include <string>
+#include <string.h>
+#include <algorithm>
+#include <math.h>
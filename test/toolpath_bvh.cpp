@@ -0,0 +1,120 @@
+// toolpath_bvh.cpp
+// Checks CToolpathBVH::Nearest against looking at every line, with lines added a few at a time, as CNCCode adds them
+// while a file is read, and times CToolpathBVH::Update against building the whole tree again each time.
+// Only the first 20000 lines are checked, as looking at every line for every ray takes a long time.
+//
+// toolpath_bvh [number of lines]
+
+#include "stdafx.h"
+#include "ToolpathBVH.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+static double Now()
+{
+	return (double)clock() / CLOCKS_PER_SEC;
+}
+
+static double Random(double a, double b)
+{
+	return a + (b - a) * rand() / RAND_MAX;
+}
+
+// the same measure as CToolpathBVH, the square of the distance from the ray to the line
+static double LineToRay(const float* v, const double* s, const double* d)
+{
+	double a[3], u[3];
+	for(int k = 0; k < 3; k++){ a[k] = v[k] - s[k]; u[k] = v[3 + k] - v[k]; }
+	double uu = u[0] * u[0] + u[1] * u[1] + u[2] * u[2];
+	double ud = u[0] * d[0] + u[1] * d[1] + u[2] * d[2];
+	double au = a[0] * u[0] + a[1] * u[1] + a[2] * u[2];
+	double ad = a[0] * d[0] + a[1] * d[1] + a[2] * d[2];
+	double den = uu - ud * ud;
+	double t = (den > 1.0e-12) ? (ud * ad - au) / den : 0.0;
+	if(t < 0.0)t = 0.0;
+	if(t > 1.0)t = 1.0;
+	double p[3], best = 0.0;
+	for(int k = 0; k < 3; k++)p[k] = a[k] + u[k] * t;
+	double pd = p[0] * d[0] + p[1] * d[1] + p[2] * d[2];
+	for(int k = 0; k < 3; k++){ double e = p[k] - d[k] * pd; best += e * e; }
+	return best;
+}
+
+int main(int argc, char** argv)
+{
+	size_t lines = 20000;
+	if(argc > 1)lines = atol(argv[1]);
+	srand(1);
+
+	std::vector<float> vertices;
+	vertices.reserve(lines * 6);
+	double x = 0.0, y = 0.0, z = 0.0;
+	for(size_t i = 0; i < lines; i++)
+	{
+		vertices.push_back((float)x); vertices.push_back((float)y); vertices.push_back((float)z);
+		x += Random(-5, 5); y += Random(-5, 5); z = Random(-2, 0);
+		vertices.push_back((float)x); vertices.push_back((float)y); vertices.push_back((float)z);
+	}
+
+	// add the lines in batches of a few hundred, checking some rays after each
+	CToolpathBVH bvh;
+	std::vector<float> added;
+	int failures = 0;
+	size_t rays = 0;
+	size_t checked_lines = (lines < 20000) ? lines : 20000;
+	for(size_t n = 0; n < checked_lines;)
+	{
+		n += 1 + rand() % 500;
+		if(n > checked_lines)n = checked_lines;
+		added.assign(vertices.begin(), vertices.begin() + n * 6);
+		bvh.Update(added);
+		if(bvh.NumberOfLines() != n){ printf("%u lines, but the tree has %u\n", (unsigned)n, (unsigned)bvh.NumberOfLines()); return 1; }
+
+		for(int r = 0; r < 20; r++, rays++)
+		{
+			const float* v = &added[(rand() % n) * 6];
+			double s[3] = {v[0] + Random(-3, 3), v[1] + Random(-3, 3), 100.0};
+			double d[3] = {Random(-0.1, 0.1), Random(-0.1, 0.1), -1.0};
+			double length = sqrt(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+			double unit[3] = {d[0] / length, d[1] / length, d[2] / length};
+
+			double best_squared = -1.0;
+			for(size_t i = 0; i < n; i++)
+			{
+				double dist = LineToRay(&added[i * 6], s, unit);
+				if(best_squared < 0.0 || dist < best_squared)best_squared = dist;
+			}
+
+			long line = bvh.Nearest(s, d, added);
+			// a different line is fine, if it is as near
+			if(line < 0 || LineToRay(&added[line * 6], s, unit) > best_squared + 1.0e-6)
+			{
+				if(failures++ < 10)printf("after %u lines, ray %u: got line %ld\n", (unsigned)n, (unsigned)rays, line);
+			}
+		}
+	}
+	printf("%u lines, %u rays, %u trees at the end, %d wrong\n", (unsigned)checked_lines, (unsigned)rays, (unsigned)bvh.NumberOfTrees(), failures);
+
+	// timings, adding 100 lines at a time
+	double t0 = Now();
+	CToolpathBVH incremental;
+	for(size_t n = 100; n <= lines; n += 100)
+	{
+		added.assign(vertices.begin(), vertices.begin() + n * 6);
+		incremental.Update(added);
+	}
+	double t1 = Now();
+	CToolpathBVH rebuilt;
+	for(size_t n = 100; n <= lines; n += 100)
+	{
+		added.assign(vertices.begin(), vertices.begin() + n * 6);
+		rebuilt.Clear();
+		rebuilt.Update(added);
+	}
+	double t2 = Now();
+	printf("adding 100 lines at a time: Update %.3f s, building again %.3f s\n", t1 - t0, t2 - t1);
+
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,204 @@
+################################################################################
+# transform_patterns.py
+#
+# Checks the copies of a pattern, made by nc/transform.py and by
+# area_funcs.pocket's shifts.
+#  - After a pattern done with a subroutine, the machine's position and modal
+#    state, like the last feed rate written, are what they are after writing
+#    every copy out.
+#  - Running out of fixtures raises, rather than calling copies without one.
+#  - A pocket's curves cut at each of its shifts write the same NC code as
+#    transform.py copying the pocket's moves.
+# Random programs of the moves area_funcs and kurve_funcs make are used.
+# It needs the area module, for area_funcs; it is skipped, with 77, without it.
+#
+# python transform_patterns.py [number of programs]
+
+import sys
+import os
+import random
+import tempfile
+import shutil
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), '..'))
+
+try:
+    import area_funcs
+except ImportError:
+    print 'no area module'
+    sys.exit(77)
+
+import nc.nc as nc
+import nc.iso as iso
+import nc.transform as transform
+
+class Shift:
+    # a pattern's matrix, which is only ever a translation
+    def __init__(self, dx, dy):
+        self.dx = dx
+        self.dy = dy
+
+    def TransformedPoint(self, x, y, z):
+        return x + self.dx, y + self.dy, z
+
+class Point:
+    def __init__(self, x, y):
+        self.x = x
+        self.y = y
+
+class Vertex:
+    def __init__(self, type, p, c):
+        self.type = type
+        self.p = p
+        self.c = c
+
+class Curve:
+    def __init__(self, vertices):
+        self.vertices = vertices
+
+    def getVertices(self):
+        return self.vertices
+
+    def FirstVertex(self):
+        return self.vertices[0]
+
+def make_shifts(rand, columns, rows):
+    return [Shift(c * 40.0, r * 30.0) for r in range(0, rows) for c in range(0, columns)]
+
+def make_curves(rand):
+    curves = []
+    for c in range(0, rand.randint(1, 4)):
+        x, y = round(rand.uniform(0, 20), 3), round(rand.uniform(0, 20), 3)
+        vertices = [Vertex(0, Point(x, y), Point(0, 0))]
+        for v in range(0, rand.randint(1, 8)):
+            if rand.random() < 0.3:
+                # a half circle, about a centre to one side
+                cx, cy = x + round(rand.uniform(-3, 3), 3), y + round(rand.uniform(-3, 3), 3)
+                x, y = 2 * cx - x, 2 * cy - y
+                vertices.append(Vertex(rand.choice([-1, 1]), Point(x, y), Point(cx, cy)))
+            else:
+                x, y = round(rand.uniform(0, 20), 3), round(rand.uniform(0, 20), 3)
+                vertices.append(Vertex(0, Point(x, y), Point(0, 0)))
+        curves.append(Curve(vertices))
+    return curves
+
+class DepthParams:
+    def __init__(self, rand):
+        self.clearance_height = 5.0
+        self.rapid_safety_space = 1.0
+        self.start_depth = 0.0
+        self.depths = [-round(rand.uniform(0.5, 2), 3) * (d + 1) for d in range(0, rand.randint(1, 3))]
+
+    def get_depths(self):
+        return self.depths
+
+def begin(path):
+    nc.creator = iso.Creator()
+    nc.creator.file_open(path)
+    nc.creator.program_begin(1, 'transform_patterns')
+    nc.creator.absolute()
+    nc.creator.metric()
+    nc.creator.tool_defn(1, 'tool1', {'name':'tool1', 'diameter':2.0, 'cutting edge height':10.0})
+    nc.creator.tool_change(1)
+    nc.creator.feedrate_slot(100)
+    nc.creator.feedrate_hv(400, 150)
+    nc.creator.rapid(0, 0, 10)
+
+def end():
+    creator = nc.creator
+    nc.creator.program_end()
+    return creator
+
+def read(path):
+    f = open(path)
+    text = f.read()
+    f.close()
+    return text
+
+def cut_pocket(curves, depthparams, dx = 0.0, dy = 0.0):
+    # as area_funcs.pocket does for each shift, with the curves already made, then WritePocketPython's rapid up
+    area_funcs.pocket_copy(None, None, 1.0, 1.0, depthparams, depthparams.get_depths(), False, 'zigzag', 0.0, None, 'conventional', None, {None: curves}, dx, dy)
+
+def state(creator):
+    return (creator.x, creator.y, creator.z, creator.f.previous, creator.prev_g0123, creator.fh, creator.fv, creator.fhv)
+
+def main():
+    number_of_programs = 50
+    if len(sys.argv) > 1: number_of_programs = int(sys.argv[1])
+
+    # area_funcs.feed_possible needs the real area; these check the copies, not the links between the curves
+    area_funcs.feed_possible = lambda p0, p1: p0.x < p1.x
+
+    temp_dir = tempfile.mkdtemp()
+    failures = 0
+    try:
+        for seed in range(0, number_of_programs):
+            rand = random.Random(seed)
+            curves = make_curves(rand)
+            depthparams = DepthParams(rand)
+            shifts = make_shifts(rand, rand.randint(1, 4), rand.randint(1, 3))
+
+            # the modal state, after a subroutine, and after writing all the copies out
+            states = []
+            for use_subroutine in [True, False]:
+                path = os.path.join(temp_dir, 'subroutine.tap' if use_subroutine else 'copies.tap')
+                begin(path)
+                transform.transform_begin(shifts, use_subroutine)
+                cut_pocket(curves, depthparams)
+                nc.rapid(z = depthparams.clearance_height)
+                transform.transform_end()
+                states.append(state(end()))
+                transform.matrix_fixtures.clear()
+            if states[0] != states[1]:
+                print 'program %d: after the subroutine the state is %s, not %s' % (seed, states[0], states[1])
+                failures = failures + 1
+
+            # the pocket's shifts, and transform.py
+            texts = []
+            for native in [True, False]:
+                path = os.path.join(temp_dir, 'native.tap' if native else 'transform.tap')
+                begin(path)
+                if native:
+                    for shift in shifts:
+                        cut_pocket(curves, depthparams, shift.dx, shift.dy)
+                else:
+                    transform.transform_begin(shifts, False)
+                    cut_pocket(curves, depthparams)
+                    nc.rapid(z = depthparams.clearance_height)
+                    transform.transform_end()
+                nc.rapid(z = depthparams.clearance_height)
+                end()
+                texts.append(read(path).split('\n'))
+            if texts[0] != texts[1]:
+                for i in range(0, min(len(texts[0]), len(texts[1]))):
+                    if texts[0][i] != texts[1][i]:
+                        break
+                print 'program %d, line %d: the shifts wrote %s, transform.py wrote %s' % (seed, i + 1, texts[0][i], texts[1][i])
+                failures = failures + 1
+
+        # fixtures; iso.py has 55 of them
+        for number_of_copies in [55, 56]:
+            begin(os.path.join(temp_dir, 'fixtures.tap'))
+            raised = False
+            try:
+                transform.transform_begin([Shift(i, 0) for i in range(0, number_of_copies)], True)
+            except Exception:
+                raised = True
+            nc.creator = nc.creator.original if transform.transformed and not raised else nc.creator
+            transform.transformed = False
+            transform.matrix_fixtures.clear()
+            end()
+            if raised != (number_of_copies > 55):
+                print '%d copies with a fixture each %s' % (number_of_copies, 'raised' if raised else "didn't raise")
+                failures = failures + 1
+    finally:
+        shutil.rmtree(temp_dir)
+
+    print '%d programs checked' % number_of_programs
+    if failures:
+        print '%d failures' % failures
+        return 1
+    return 0
+
+if __name__ == '__main__':
+    sys.exit(main())
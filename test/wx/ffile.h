@@ -0,0 +1,35 @@
+// wx/ffile.h : stands in for wxWidgets' wx/ffile.h when the tests are built, see NCCode.h in this folder, with only the parts of
+// wxFFile which CIsoReader and CNCCodeLoader use.
+//
+// Copyright (c) 2009, Dan Heeks
+// This program is released under the BSD license. See the file COPYING for details.
+
+#pragma once
+
+#include <stdio.h>
+
+typedef long long wxFileOffset;
+
+class wxFFile
+{
+	FILE* m_fp;
+
+public:
+	wxFFile(const wxString& filepath, const char* mode): m_fp(fopen(filepath.c_str(), mode)){}
+	~wxFFile(){ if(m_fp)fclose(m_fp); }
+
+	bool IsOpened()const{ return m_fp != NULL; }
+	bool Eof()const{ return feof(m_fp) != 0; }
+	bool Error()const{ return ferror(m_fp) != 0; }
+
+	wxFileOffset Length()const
+	{
+		long pos = ftell(m_fp);
+		fseek(m_fp, 0, SEEK_END);
+		long length = ftell(m_fp);
+		fseek(m_fp, pos, SEEK_SET);
+		return length;
+	}
+
+	size_t Read(void* buffer, size_t count){ return fread(buffer, 1, count, m_fp); }
+};
@@ -0,0 +1,337 @@
+################################################################################
+# zigzag_paths.py
+#
+# Compares the zig zag paths from src/ZigZag.cpp, which HeeksCNC's python has
+# as heekscnc.zigzag, with the ones postprocessor/zigzag.py makes itself, for
+# random areas, then the NC code area_funcs writes for each of them.
+# zigzag.py intersects the area with a stripe for each scanline, which needs
+# libarea; this has its own intersection of a stripe with an area of straight
+# edges, given to zigzag.py as the area module, so it doesn't need libarea.
+# Its curves come out as libarea's do: the outsides clockwise, each starting
+# anywhere, in any order.
+# Vertices closer than the tolerance to a scanline are moved off it, as
+# zigzag.py takes those as on it and src/ZigZag.cpp doesn't.
+#
+# python zigzag_paths.py zigzag_replay [number of areas] [number of vertices]
+#
+# zigzag_replay is the program built from zigzag_replay.cpp.
+
+import sys
+import os
+import math
+import time
+import random
+import tempfile
+import shutil
+import subprocess
+import types
+
+heekscnc_dir = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..')
+sys.path.insert(0, heekscnc_dir)
+
+################################################################################
+# the area module, for areas with only straight edges
+
+class Point:
+    def __init__(self, x = 0.0, y = 0.0):
+        self.x = x
+        self.y = y
+
+class Vertex:
+    def __init__(self, type, p, c, user_data = 0):
+        self.type = type
+        self.p = p
+        self.c = c
+
+class Curve:
+    def __init__(self):
+        self.vertices = []
+
+    def append(self, v):
+        self.vertices.append(v)
+
+    def getVertices(self):
+        return self.vertices
+
+    def FirstVertex(self):
+        return self.vertices[0]
+
+    def LastVertex(self):
+        return self.vertices[-1]
+
+    def Reverse(self):
+        self.vertices = [Vertex(0, v.p, Point(0, 0)) for v in reversed(self.vertices)]
+
+class Box:
+    def __init__(self):
+        self.box = None
+
+    def MinX(self): return self.box[0]
+    def MinY(self): return self.box[1]
+    def MaxX(self): return self.box[2]
+    def MaxY(self): return self.box[3]
+
+class Area:
+    rand = random.Random(0) # for the order of the curves, and where they start
+
+    def __init__(self):
+        self.curves = []
+
+    def append(self, curve):
+        self.curves.append(curve)
+
+    def getCurves(self):
+        return self.curves
+
+    def num_curves(self):
+        return len(self.curves)
+
+    def GetBox(self, box):
+        xs = [v.p.x for c in self.curves for v in c.getVertices()]
+        ys = [v.p.y for c in self.curves for v in c.getVertices()]
+        box.box = (min(xs), min(ys), max(xs), max(ys))
+
+    def Intersect(self, a):
+        # this is one of zigzag.py's stripes, which are wider than the area
+        b = Box()
+        self.GetBox(b)
+        self.curves = stripe_pieces(a, b.MinY(), b.MaxY())
+
+def stripe_pieces(a, y0, y1):
+    # the area's edges, with the area on their left, cut to the stripe, then the pieces of y0 and y1 inside the area, joined up into loops
+    next_point = {}
+    crossings = {y0: [], y1: []}
+    for curve in a.getCurves():
+        points = [(v.p.x, v.p.y) for v in curve.getVertices()]
+        if points[0] == points[-1]:
+            points = points[:-1]
+        for k in range(0, len(points)):
+            p = points[k]
+            q = points[(k + 1) % len(points)]
+            s, e = p, q
+            if p[1] != q[1]:
+                for y in [y0, y1]:
+                    if (p[1] - y) * (q[1] - y) < 0:
+                        c = (p[0] + (y - p[1]) * (q[0] - p[0]) / (q[1] - p[1]), y)
+                        crossings[y].append(c[0])
+                        if (p[1] < y) == (y == y0): s = c
+                        else: e = c
+            if y0 < (s[1] + e[1]) * 0.5 < y1:
+                next_point[s] = e
+    for y in [y0, y1]:
+        xs = sorted(crossings[y])
+        for k in range(0, len(xs) - 1, 2):
+            if y == y0: next_point[(xs[k], y)] = (xs[k + 1], y)
+            else: next_point[(xs[k + 1], y)] = (xs[k], y)
+
+    loops = []
+    while len(next_point) > 0:
+        start = min(next_point.keys())
+        loop = [start]
+        p = next_point.pop(start)
+        while p != start:
+            loop.append(p)
+            p = next_point.pop(p)
+        loops.append(loop)
+
+    curves = []
+    for loop in loops:
+        loop.reverse()
+        k = Area.rand.randint(0, len(loop) - 1)
+        loop = loop[k:] + loop[:k]
+        c = Curve()
+        for p in loop + [loop[0]]:
+            c.append(Vertex(0, Point(p[0], p[1]), Point(0, 0)))
+        curves.append(c)
+    Area.rand.shuffle(curves)
+    return curves
+
+area = types.ModuleType('area')
+area.Point = Point
+area.Vertex = Vertex
+area.Curve = Curve
+area.Box = Box
+area.Area = Area
+area.get_units = lambda: 1.0
+sys.modules['area'] = area
+
+################################################################################
+
+import nc.nc as nc
+import nc.iso as iso
+import area_funcs
+import postprocessor
+zigzag = sys.modules['postprocessor.zigzag']
+
+def rotated_y(x, y, angle):
+    # as zigzag.py rotates them
+    radians = angle * math.pi / 180
+    return x * math.sin(-radians) + y * math.cos(-radians)
+
+def make_loop(rand, cx, cy, r0, r1, number_of_vertices, clockwise):
+    # a star shape, which never crosses itself, as [centre x, centre y, angle step, k, smallest radius, biggest radius, angle, radius] for each vertex
+    step = 2 * math.pi / number_of_vertices
+    if clockwise: step = -step
+    loop = []
+    for k in range(0, number_of_vertices):
+        v = [cx, cy, step, k, r0, r1, 0.0, 0.0]
+        move_vertex(rand, v)
+        loop.append(v)
+    return loop
+
+def move_vertex(rand, v):
+    cx, cy, step, k, r0, r1, a, r = v
+    v[6] = step * (k + rand.uniform(-0.3, 0.3))
+    v[7] = rand.uniform(r0, r1)
+
+def loop_point(v):
+    cx, cy, step, k, r0, r1, a, r = v
+    return cx + r * math.cos(a), cy + r * math.sin(a)
+
+def make_area(rand, number_of_vertices, stepover, angle):
+    radius = 20.0
+    loops = [make_loop(rand, 0.0, 0.0, radius * 0.3, radius, number_of_vertices, False)]
+    for h in range(0, rand.randint(0, 2)):
+        loops.append(make_loop(rand, (h * 2 - 1) * radius * 0.12, 0.0, radius * 0.02, radius * 0.08, rand.randint(3, 8), True))
+
+    # move the vertices near a scanline off it; the scanlines are from the lowest point, so they move when it does
+    moved = True
+    while moved:
+        moved = False
+        lowest = min([rotated_y(x, y, angle) for x, y in [loop_point(v) for v in loops[0]]])
+        for loop in loops:
+            for v in loop:
+                x, y = loop_point(v)
+                d = (rotated_y(x, y, angle) - lowest - 0.1) / stepover
+                if math.fabs(d - round(d)) * stepover < 0.01:
+                    move_vertex(rand, v)
+                    moved = True
+
+    a = Area()
+    for loop in loops:
+        c = Curve()
+        for v in loop + [loop[0]]:
+            x, y = loop_point(v)
+            c.append(Vertex(0, Point(x, y), Point(0, 0)))
+        a.append(c)
+    return a
+
+def zigzag_replay(replay, temp_dir):
+    # heekscnc.zigzag, with src/ZigZag.cpp in zigzag_replay
+    def native_zigzag(curves, stepover, unidirectional, angle, start_offset, tolerance):
+        area_path = os.path.join(temp_dir, 'area.txt')
+        zigs_path = os.path.join(temp_dir, 'zigs.txt')
+        f = open(area_path, 'w')
+        f.write('%.17g %d %.17g %.17g %.17g\n' % (stepover, 1 if unidirectional else 0, angle, start_offset, tolerance))
+        for curve in curves:
+            f.write('curve\n')
+            for v in curve:
+                f.write('%d %.17g %.17g %.17g %.17g\n' % v)
+        f.close()
+        if subprocess.call([replay, area_path, zigs_path]) != 0:
+            raise Exception('zigzag_replay failed')
+        zigs = []
+        f = open(zigs_path)
+        for line in f.readlines():
+            words = line.split()
+            if words[0] == 'zig':
+                zigs.append([])
+            else:
+                zigs[-1].append((int(words[0]), float(words[1]), float(words[2]), float(words[3]), float(words[4])))
+        f.close()
+        return zigs
+    return native_zigzag
+
+def same_zigs(python_zigs, native_zigs):
+    if len(python_zigs) != len(native_zigs):
+        return '%d zigs from python, %d from C++' % (len(python_zigs), len(native_zigs))
+    for i in range(0, len(python_zigs)):
+        pv = python_zigs[i].getVertices()
+        cv = native_zigs[i].getVertices()
+        if len(pv) != len(cv):
+            return 'zig %d has %d vertices from python, %d from C++' % (i, len(pv), len(cv))
+        for j in range(0, len(pv)):
+            if pv[j].type != cv[j].type or math.fabs(pv[j].p.x - cv[j].p.x) > 1e-9 or math.fabs(pv[j].p.y - cv[j].p.y) > 1e-9:
+                return 'zig %d, vertex %d is %d %.6f %.6f from python, %d %.6f %.6f from C++' % (i, j, pv[j].type, pv[j].p.x, pv[j].p.y, cv[j].type, cv[j].p.x, cv[j].p.y)
+    return None
+
+def write_nc(path, zigs):
+    # as area_funcs.pocket cuts them, at two depths
+    nc.creator = iso.Creator()
+    nc.creator.file_open(path)
+    nc.creator.program_begin(1, 'zigzag_paths')
+    nc.creator.absolute()
+    nc.creator.metric()
+    nc.creator.feedrate_slot(100)
+    nc.creator.feedrate_hv(400, 150)
+    nc.creator.rapid(0, 0, 10)
+    prev_p = None
+    for depth in [-1.0, -2.0]:
+        prev_p = area_funcs.cut_curvelist(prev_p, zigs, 1.0, depth + 1.0, depth, 5.0)
+    nc.creator.program_end()
+    f = open(path)
+    lines = f.readlines()
+    f.close()
+    return lines
+
+def main():
+    if len(sys.argv) < 2:
+        print 'usage: python zigzag_paths.py zigzag_replay [number of areas] [number of vertices]'
+        return 1
+    replay = sys.argv[1]
+    number_of_areas = 50
+    number_of_vertices = 40
+    if len(sys.argv) > 2: number_of_areas = int(sys.argv[2])
+    if len(sys.argv) > 3: number_of_vertices = int(sys.argv[3])
+
+    # area_funcs.feed_possible needs libarea; these compare the moves, not the checks, so any answer which depends only on the points does
+    area_funcs.feed_possible = lambda p0, p1: (int(p0.x * 7 + p1.y * 3) % 3) != 0
+
+    temp_dir = tempfile.mkdtemp()
+    native_zigzag = zigzag_replay(replay, temp_dir)
+    failures = 0
+    python_time = 0.0
+    native_time = 0.0
+    try:
+        for seed in range(0, number_of_areas):
+            rand = random.Random(seed)
+            stepover = rand.uniform(0.4, 3.0)
+            angle = rand.choice([0.0, 0.0, rand.uniform(0, 180)])
+            unidirectional = (rand.random() < 0.3)
+            a = make_area(rand, number_of_vertices, stepover, angle)
+
+            zigzag.native_zigzag = None
+            start = time.time()
+            python_zigs = zigzag.zigzag(a, stepover, unidirectional, angle)
+            python_time += time.time() - start
+
+            zigzag.native_zigzag = native_zigzag
+            start = time.time()
+            native_zigs = zigzag.zigzag(a, stepover, unidirectional, angle)
+            native_time += time.time() - start
+
+            difference = same_zigs(python_zigs, native_zigs)
+            if difference == None:
+                python_nc = write_nc(os.path.join(temp_dir, 'python.tap'), python_zigs)
+                native_nc = write_nc(os.path.join(temp_dir, 'native.tap'), native_zigs)
+                for i in range(0, max(len(python_nc), len(native_nc))):
+                    p = python_nc[i] if i < len(python_nc) else '<end>\n'
+                    c = native_nc[i] if i < len(native_nc) else '<end>\n'
+                    if p != c:
+                        difference = 'line %d of the NC code is %s from python, %s from C++' % (i + 1, p.strip(), c.strip())
+                        break
+            if difference != None:
+                print 'area %d, stepover %.3f, angle %.1f%s: %s' % (seed, stepover, angle, ', unidirectional' if unidirectional else '', difference)
+                failures = failures + 1
+    finally:
+        shutil.rmtree(temp_dir)
+
+    # the C++ time includes starting zigzag_replay for each area
+    print '%d areas of %d vertices: python %.3f s, C++ %.3f s' % (number_of_areas, number_of_vertices, python_time, native_time)
+    if failures:
+        print '%d of the areas had different zigs' % failures
+        return 1
+    return 0
+
+if __name__ == '__main__':
+    sys.exit(main())
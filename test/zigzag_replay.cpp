@@ -0,0 +1,79 @@
+// zigzag_replay.cpp
+// Gives the area in an area file to CZigZag::Make, and writes the zigs, for zigzag_paths.py to compare with what postprocessor/zigzag.py makes
+// for the same area, in place of the heekscnc.zigzag HeeksCNC's python has.
+// The area file's first line is the stepover, 1 for unidirectional or 0, the angle, the start offset and the tolerance, as heekscnc.zigzag takes them.
+// Then each curve is a line with "curve" on it, then a line for each vertex, with its type, x, y, and the centre x and y.
+// The zigs are written the same way, with "zig" for "curve".
+//
+// zigzag_replay area_file zigs_file
+
+#include "stdafx.h"
+#include "ZigZag.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int main(int argc, char** argv)
+{
+	if(argc < 3)
+	{
+		printf("usage: zigzag_replay area_file zigs_file\n");
+		return 1;
+	}
+
+	FILE* file = fopen(argv[1], "r");
+	if(file == NULL)
+	{
+		printf("couldn't read %s\n", argv[1]);
+		return 1;
+	}
+	double stepover, angle, start_offset, tolerance;
+	int unidirectional;
+	if(fscanf(file, "%lf %d %lf %lf %lf", &stepover, &unidirectional, &angle, &start_offset, &tolerance) != 5)
+	{
+		printf("%s hasn't the zig zag's settings on its first line\n", argv[1]);
+		fclose(file);
+		return 1;
+	}
+	std::vector<CZigZag::Curve> curves;
+	char word[32];
+	while(fscanf(file, "%31s", word) == 1)
+	{
+		if(strcmp(word, "curve") == 0)
+		{
+			curves.push_back(CZigZag::Curve());
+			continue;
+		}
+		int type = atoi(word);
+		double x, y, cx, cy;
+		if(curves.size() == 0 || fscanf(file, "%lf %lf %lf %lf", &x, &y, &cx, &cy) != 4)
+		{
+			printf("%s has a vertex without a curve, or without its numbers\n", argv[1]);
+			fclose(file);
+			return 1;
+		}
+		curves.back().push_back(CZigZag::Vertex(type, x, y, cx, cy));
+	}
+	fclose(file);
+
+	std::vector<CZigZag::Curve> zigs;
+	CZigZag::Make(curves, stepover, unidirectional != 0, angle, start_offset, tolerance, zigs);
+
+	file = fopen(argv[2], "w");
+	if(file == NULL)
+	{
+		printf("couldn't write %s\n", argv[2]);
+		return 1;
+	}
+	for(std::vector<CZigZag::Curve>::iterator It = zigs.begin(); It != zigs.end(); It++)
+	{
+		fprintf(file, "zig\n");
+		for(CZigZag::Curve::iterator VIt = It->begin(); VIt != It->end(); VIt++)
+		{
+			fprintf(file, "%d %.17g %.17g %.17g %.17g\n", VIt->type, VIt->x, VIt->y, VIt->cx, VIt->cy);
+		}
+	}
+	fclose(file);
+	return 0;
+}